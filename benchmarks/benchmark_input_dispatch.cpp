@@ -0,0 +1,247 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures how many pointer events per second make it from an input device,
+// through DefaultInputDeviceHub and BasicSeat, to a surface via
+// SurfaceInputDispatcher.
+
+#include "src/server/input/default_input_device_hub.h"
+#include "src/server/input/basic_seat.h"
+#include "src/server/input/surface_input_dispatcher.h"
+#include "src/server/report/null/seat_report.h"
+
+#include "mir/test/doubles/stub_cursor_listener.h"
+#include "mir/test/doubles/stub_display_configuration.h"
+#include "mir/test/doubles/stub_input_scene.h"
+#include "mir/test/doubles/stub_touch_visualizer.h"
+
+#include "mir/cookie/authority.h"
+#include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/graphics/display_configuration_observer.h"
+#include "mir/input/device_capability.h"
+#include "mir/input/event_builder.h"
+#include "mir/input/input_device.h"
+#include "mir/input/input_device_info.h"
+#include "mir/input/input_sink.h"
+#include "mir/input/pointer_settings.h"
+#include "mir/input/surface.h"
+#include "mir/input/touchpad_settings.h"
+#include "mir/input/touchscreen_settings.h"
+#include "mir/input/xkb_mapper.h"
+#include "mir/server_status_listener.h"
+#include "mir/time/steady_clock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace mi = mir::input;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+geom::Rectangle const screen{{0, 0}, {1920, 1080}};
+
+class CountingSurface : public mi::Surface
+{
+public:
+    CountingSurface(geom::Rectangle const& bounds, std::atomic<uint64_t>& delivered)
+        : bounds{bounds},
+          delivered(delivered)
+    {
+    }
+
+    std::string name() const override { return "benchmark"; }
+    geom::Rectangle input_bounds() const override { return bounds; }
+    bool input_area_contains(geom::Point const& point) const override { return bounds.contains(point); }
+    std::shared_ptr<mg::CursorImage> cursor_image() const override { return nullptr; }
+    mi::InputReceptionMode reception_mode() const override { return mi::InputReceptionMode::normal; }
+    void consume(MirEvent const*) override { ++delivered; }
+
+private:
+    geom::Rectangle const bounds;
+    std::atomic<uint64_t>& delivered;
+};
+
+class Scene : public mtd::StubInputScene
+{
+public:
+    Scene(int surface_count, std::atomic<uint64_t>& delivered)
+    {
+        // Overlapping windows cascading across the screen
+        for (int i = 0; i != surface_count; ++i)
+        {
+            geom::Point const top_left{(i * 37) % 1280, (i * 23) % 600};
+            surfaces.push_back(std::make_shared<CountingSurface>(geom::Rectangle{top_left, {640, 480}}, delivered));
+        }
+    }
+
+    void for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback) override
+    {
+        for (auto const& surface : surfaces)
+            callback(surface);
+    }
+
+private:
+    std::vector<std::shared_ptr<mi::Surface>> surfaces;
+};
+
+class DisplayConfigurationRegistrar : public mir::ObserverRegistrar<mg::DisplayConfigurationObserver>
+{
+public:
+    void register_interest(std::weak_ptr<mg::DisplayConfigurationObserver> const& observer) override
+    {
+        if (auto const o = observer.lock())
+            o->initial_configuration(std::make_shared<mtd::StubDisplayConfig>(std::vector<geom::Rectangle>{screen}));
+    }
+
+    void register_interest(std::weak_ptr<mg::DisplayConfigurationObserver> const& observer, mir::Executor&) override
+    {
+        register_interest(observer);
+    }
+
+    void unregister_interest(mg::DisplayConfigurationObserver const&) override
+    {
+    }
+};
+
+class NullServerStatusListener : public mir::ServerStatusListener
+{
+public:
+    void paused() override {}
+    void resumed() override {}
+    void started() override {}
+    void ready_for_user_input() override {}
+    void stop_receiving_input() override {}
+};
+
+class Mouse : public mi::InputDevice
+{
+public:
+    void start(mi::InputSink* destination, mi::EventBuilder* builder) override
+    {
+        sink = destination;
+        this->builder = builder;
+    }
+
+    void stop() override
+    {
+        sink = nullptr;
+        builder = nullptr;
+    }
+
+    mi::InputDeviceInfo get_device_info() override
+    {
+        return {"benchmark mouse", "benchmark-mouse", mi::DeviceCapability::pointer};
+    }
+
+    mir::optional_value<mi::PointerSettings> get_pointer_settings() const override
+    {
+        return mi::PointerSettings{};
+    }
+
+    void apply_settings(mi::PointerSettings const&) override {}
+
+    mir::optional_value<mi::TouchpadSettings> get_touchpad_settings() const override
+    {
+        return {};
+    }
+
+    void apply_settings(mi::TouchpadSettings const&) override {}
+
+    mir::optional_value<mi::TouchscreenSettings> get_touchscreen_settings() const override
+    {
+        return {};
+    }
+
+    void apply_settings(mi::TouchscreenSettings const&) override {}
+
+    void move(float dx, float dy)
+    {
+        auto const now = std::chrono::steady_clock::now().time_since_epoch();
+        std::shared_ptr<MirEvent> const event =
+            builder->pointer_event(now, mir_pointer_action_motion, 0, 0.0f, 0.0f, dx, dy);
+        sink->handle_input(event);
+    }
+
+private:
+    mi::InputSink* sink{nullptr};
+    mi::EventBuilder* builder{nullptr};
+};
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of surfaces> <event count>"<<std::endl;
+        exit(1);
+    }
+
+    int const surface_count = std::atoi(argv[1]);
+    uint64_t const event_count = std::atoll(argv[2]);
+
+    std::atomic<uint64_t> delivered{0};
+
+    auto const scene = std::make_shared<Scene>(surface_count, delivered);
+    auto const dispatcher = std::make_shared<mi::SurfaceInputDispatcher>(scene);
+    auto const key_mapper = std::make_shared<mi::receiver::XKBMapper>();
+    auto const seat = std::make_shared<mi::BasicSeat>(
+        dispatcher,
+        std::make_shared<mtd::StubTouchVisualizer>(),
+        std::make_shared<mtd::StubCursorListener>(),
+        std::make_shared<DisplayConfigurationRegistrar>(),
+        key_mapper,
+        std::make_shared<mir::time::SteadyClock>(),
+        std::make_shared<mir::report::null::SeatReport>());
+    auto const hub = std::make_shared<mi::DefaultInputDeviceHub>(
+        seat,
+        std::make_shared<mir::dispatch::MultiplexingDispatchable>(),
+        mir::cookie::Authority::create(),
+        key_mapper,
+        std::make_shared<NullServerStatusListener>());
+    auto const mouse = std::make_shared<Mouse>();
+
+    dispatcher->start();
+    hub->add_device(mouse);
+
+    auto const start = std::chrono::steady_clock::now();
+
+    // Sweep back and forth across the screen, crossing between surfaces
+    float step = 1.0f;
+    for (uint64_t i = 0; i != event_count; ++i)
+    {
+        if (i % screen.size.width.as_int() == 0)
+            step = -step;
+        mouse->move(step, step * 0.5f);
+    }
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+    auto const seconds = std::chrono::duration<double>(duration).count();
+
+    hub->remove_device(mouse);
+    dispatcher->stop();
+
+    std::cout<<"Dispatching "<<event_count<<" events to "<<surface_count<<" surfaces took "
+             <<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns ("
+             <<static_cast<uint64_t>(event_count / seconds)<<" events/s, "
+             <<delivered<<" deliveries)"<<std::endl;
+    exit(0);
+}
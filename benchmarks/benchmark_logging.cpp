@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures the time mir::log() takes its callers on several threads at once, logging to a
+// Logger that takes a lock and does some work per message (standing in for the terminal),
+// both directly and through an AsyncLogger.
+
+#include "mir/log.h"
+#include "mir/logging/async_logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ml = mir::logging;
+
+namespace
+{
+class SlowLogger : public ml::Logger
+{
+public:
+    void log(ml::Severity, std::string const& message, std::string const& component) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto const until = std::chrono::steady_clock::now() + std::chrono::microseconds{2};
+        while (std::chrono::steady_clock::now() < until)
+            ;
+        written += message.size() + component.size();
+    }
+
+private:
+    std::mutex mutex;
+    size_t written{0};
+};
+
+auto time_logging(std::shared_ptr<ml::Logger> const& logger, int thread_count, int message_count)
+    -> std::chrono::nanoseconds
+{
+    ml::set_logger(logger);
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != thread_count; ++t)
+    {
+        threads.emplace_back([t, message_count]
+            {
+                for (int i = 0; i != message_count; ++i)
+                    mir::log(ml::Severity::informational, "benchmark", "Thread %d message %d", t, i);
+            });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    ml::set_logger(std::make_shared<SlowLogger>());
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <messages per thread>"<<std::endl;
+        exit(1);
+    }
+
+    int const thread_count = std::atoi(argv[1]);
+    int const message_count = std::atoi(argv[2]);
+
+    auto const report = [&](char const* name, std::chrono::nanoseconds duration)
+        {
+            std::cout<<name<<": "<<message_count * thread_count<<" messages on "<<thread_count
+                     <<" threads took "<<duration.count()<<"ns ("
+                     <<duration.count() / (message_count * thread_count)<<"ns/message)"<<std::endl;
+        };
+
+    report("Synchronous",
+        time_logging(std::make_shared<SlowLogger>(), thread_count, message_count));
+
+    auto const async = std::make_shared<ml::AsyncLogger>(std::make_shared<SlowLogger>(), 4096);
+    report("AsyncLogger", time_logging(async, thread_count, message_count));
+    std::cout<<"AsyncLogger dropped "<<async->dropped()<<" messages"<<std::endl;
+    exit(0);
+}
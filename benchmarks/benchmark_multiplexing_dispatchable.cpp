@@ -18,6 +18,7 @@
 
 #include "mir/dispatch/multiplexing_dispatchable.h"
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -31,8 +32,8 @@ namespace md = mir::dispatch;
 class TestDispatchable : public md::Dispatchable
 {
 public:
-    TestDispatchable(uint64_t limit)
-        : dispatch_limit{limit}
+    TestDispatchable(std::atomic<int64_t>& remaining)
+        : remaining(remaining)
     {
         int pipefds[2];
         if (pipe(pipefds) < 0)
@@ -56,8 +57,7 @@ public:
     }
     bool dispatch(md::FdEvents) override
     {
-        ++dispatch_count;
-        return (dispatch_count < dispatch_limit);
+        return --remaining > 0;
     }
     md::FdEvents relevant_events() const override
     {
@@ -65,13 +65,10 @@ public:
     }
 
 private:
-    static thread_local uint64_t dispatch_count;
-    uint64_t const dispatch_limit;
+    std::atomic<int64_t>& remaining;
     mir::Fd read_fd, write_fd;
 };
 
-thread_local uint64_t TestDispatchable::dispatch_count = 0;
-
 bool fd_is_readable(int fd)
 {
     struct pollfd poller {
@@ -82,19 +79,23 @@ bool fd_is_readable(int fd)
     return poll(&poller, 1, 0);
 }
 
-int main(int argc, char** argv)
+std::chrono::steady_clock::duration time_dispatch(
+    int thread_count,
+    int fd_count,
+    uint64_t dispatch_count,
+    int max_events_per_dispatch)
 {
-    if (argc != 3)
-    {
-        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count>"<<std::endl;
-        exit(1);
-    }
+    std::atomic<int64_t> remaining{static_cast<int64_t>(dispatch_count)};
 
-    int const thread_count = std::atoi(argv[1]);
-    uint64_t const dispatch_count = std::atoll(argv[2]);
+    // A single fd is dispatched reentrantly, as before; several fds model
+    // a burst of ready clients or input devices, each dispatched sequentially
+    auto const reentrancy = fd_count == 1 ? md::DispatchReentrancy::reentrant : md::DispatchReentrancy::sequential;
 
-    auto dispatcher = std::make_shared<md::MultiplexingDispatchable>();
-    dispatcher->add_watch(std::make_shared<TestDispatchable>(dispatch_count / thread_count), md::DispatchReentrancy::reentrant);
+    auto dispatcher = std::make_shared<md::MultiplexingDispatchable>(max_events_per_dispatch);
+    for (int i = 0; i < fd_count; ++i)
+    {
+        dispatcher->add_watch(std::make_shared<TestDispatchable>(remaining), reentrancy);
+    }
 
     auto start = std::chrono::steady_clock::now();
 
@@ -115,7 +116,29 @@ int main(int argc, char** argv)
         thread.join();
     }
 
-    auto duration = std::chrono::steady_clock::now() - start;
-    std::cout<<"Dispatching "<<dispatch_count<<" times took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+    return std::chrono::steady_clock::now() - start;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count> [<number of fds>]"<<std::endl;
+        exit(1);
+    }
+
+    int const thread_count = std::atoi(argv[1]);
+    uint64_t const dispatch_count = std::atoll(argv[2]);
+    int const fd_count = argc == 4 ? std::atoi(argv[3]) : 1;
+
+    int const batched = md::MultiplexingDispatchable::max_batched_events;
+
+    for (auto const max_events : {1, batched})
+    {
+        auto duration = time_dispatch(thread_count, fd_count, dispatch_count, max_events);
+        std::cout<<"Dispatching "<<dispatch_count<<" times across "<<fd_count<<" fds, up to "
+                 <<max_events<<" per call, took "
+                 <<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+    }
     exit(0);
 }
@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures broadcasting to a list of observers, as surfaces do on every move, resize, frame
+// and input event, from several threads at once (standing in for the compositor, input and
+// Wayland threads) while another thread keeps adding and removing an observer.
+// Compares ThreadSafeList with RcuList (which BasicObservers uses).
+
+#include "mir/thread_safe_list.h"
+#include "mir/rcu_list.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Observer
+{
+    virtual ~Observer() = default;
+    virtual void frame_posted(int frames) = 0;
+};
+
+struct CountingObserver : Observer
+{
+    void frame_posted(int frames) override
+    {
+        count.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> count{0};
+};
+
+template<typename List>
+auto time_broadcasts(int observer_count, int thread_count, uint64_t broadcast_count) -> std::chrono::nanoseconds
+{
+    List observers;
+    std::vector<std::shared_ptr<CountingObserver>> registered;
+    for (int i = 0; i != observer_count; ++i)
+    {
+        registered.push_back(std::make_shared<CountingObserver>());
+        observers.add(registered.back());
+    }
+
+    std::atomic<bool> broadcasting{true};
+
+    std::thread churn{[&]
+        {
+            auto const transient = std::make_shared<CountingObserver>();
+            while (broadcasting)
+            {
+                observers.add(transient);
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+                observers.remove(transient);
+            }
+        }};
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> broadcasters;
+    for (int i = 0; i != thread_count; ++i)
+    {
+        broadcasters.emplace_back([&observers, broadcast_count]
+            {
+                for (uint64_t n = 0; n != broadcast_count; ++n)
+                {
+                    observers.for_each(
+                        [](std::shared_ptr<Observer> const& observer) { observer->frame_posted(1); });
+                }
+            });
+    }
+
+    for (auto& broadcaster : broadcasters)
+        broadcaster.join();
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    broadcasting = false;
+    churn.join();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of observers> <number of threads> <broadcasts per thread>"<<std::endl;
+        exit(1);
+    }
+
+    int const observer_count = std::atoi(argv[1]);
+    int const thread_count = std::atoi(argv[2]);
+    uint64_t const broadcast_count = std::atoll(argv[3]);
+
+    auto const report = [&](char const* name, std::chrono::nanoseconds duration)
+        {
+            std::cout<<name<<": "<<broadcast_count * thread_count<<" broadcasts to "<<observer_count
+                     <<" observers on "<<thread_count<<" threads took "<<duration.count()<<"ns ("
+                     <<duration.count() / (broadcast_count * thread_count)<<"ns/broadcast)"<<std::endl;
+        };
+
+    report("ThreadSafeList",
+        time_broadcasts<mir::ThreadSafeList<std::shared_ptr<Observer>>>(observer_count, thread_count, broadcast_count));
+    report("RcuList",
+        time_broadcasts<mir::RcuList<std::shared_ptr<Observer>>>(observer_count, thread_count, broadcast_count));
+    exit(0);
+}
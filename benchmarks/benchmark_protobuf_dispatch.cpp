@@ -0,0 +1,198 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures how many invocations per second a client can make over a socket
+// through SocketConnection, ProtobufMessageProcessor and ProtobufResponder.
+
+#include "src/server/frontend/protobuf_message_processor.h"
+#include "src/server/frontend/protobuf_responder.h"
+#include "src/server/frontend/socket_connection.h"
+#include "src/server/frontend/socket_messenger.h"
+#include "src/server/frontend/resource_cache.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/test/doubles/stub_display_server.h"
+
+#include "mir/frontend/connections.h"
+#include "mir/protobuf/protocol_version.h"
+#include "mir_protobuf.pb.h"
+#include "mir_protobuf_wire.pb.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace mtd = mir::test::doubles;
+namespace ba = boost::asio;
+
+namespace
+{
+// Limit the requests in flight so neither side fills its socket buffer
+uint64_t const max_in_flight = 256;
+
+class DisplayServer : public mtd::StubDisplayServer
+{
+public:
+    void submit_buffer(
+        mir::protobuf::BufferRequest const*,
+        mir::protobuf::Void*,
+        google::protobuf::Closure* done) override
+    {
+        done->Run();
+    }
+};
+
+std::vector<char> framed(google::protobuf::MessageLite const& message)
+{
+    auto const size = message.ByteSizeLong();
+    std::vector<char> result(2 + size);
+    result[0] = static_cast<char>((size >> 8) & 0xff);
+    result[1] = static_cast<char>((size >> 0) & 0xff);
+    message.SerializeToArray(result.data() + 2, size);
+    return result;
+}
+
+bool read_fully(int fd, char* data, size_t size)
+{
+    while (size > 0)
+    {
+        auto const result = read(fd, data, size);
+        if (result <= 0)
+            return false;
+        data += result;
+        size -= result;
+    }
+    return true;
+}
+
+bool write_fully(int fd, std::vector<char> const& data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto const result = write(fd, data.data() + written, data.size() - written);
+        if (result <= 0)
+            return false;
+        written += result;
+    }
+    return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <invocation count>"<<std::endl;
+        exit(1);
+    }
+
+    uint64_t const invocation_count = std::atoll(argv[1]);
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+    {
+        std::cerr<<"Failed to create socket pair"<<std::endl;
+        exit(1);
+    }
+    int const client_fd = fds[1];
+
+    ba::io_service io;
+    auto const socket = std::make_shared<ba::local::stream_protocol::socket>(
+        io, ba::local::stream_protocol(), fds[0]);
+    auto const messenger = std::make_shared<mfd::SocketMessenger>(socket);
+    auto const responder = std::make_shared<mfd::ProtobufResponder>(
+        messenger, std::make_shared<mf::ResourceCache>());
+    auto const processor = std::make_shared<mfd::ProtobufMessageProcessor>(
+        responder,
+        std::make_shared<DisplayServer>(),
+        mir::report::null_message_processor_report());
+    auto const connections = std::make_shared<mfd::Connections<mfd::SocketConnection>>();
+    auto const connection = std::make_shared<mfd::SocketConnection>(messenger, 0, connections, processor);
+
+    connections->add(connection);
+    connection->read_next_message();
+
+    std::thread server{[&io] { io.run(); }};
+
+    std::atomic<uint64_t> responses{0};
+    std::thread reader{[&]
+        {
+            std::vector<char> body;
+            while (responses != invocation_count)
+            {
+                unsigned char header[2];
+                if (!read_fully(client_fd, reinterpret_cast<char*>(header), sizeof header))
+                    break;
+
+                body.resize((header[0] << 8) + header[1]);
+                if (!read_fully(client_fd, body.data(), body.size()))
+                    break;
+
+                mir::protobuf::wire::Result result;
+                result.ParseFromArray(body.data(), body.size());
+                ++responses;
+            }
+        }};
+
+    mir::protobuf::BufferRequest request;
+    request.mutable_id()->set_value(1);
+    request.mutable_buffer()->set_buffer_id(1);
+
+    mir::protobuf::wire::Invocation invocation;
+    invocation.set_method_name("submit_buffer");
+    invocation.set_parameters(request.SerializeAsString());
+    invocation.set_protocol_version(mir::protobuf::current_protocol_version());
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i != invocation_count; ++i)
+    {
+        while (i - responses >= max_in_flight)
+            std::this_thread::yield();
+
+        invocation.set_id(i);
+        if (!write_fully(client_fd, framed(invocation)))
+        {
+            std::cerr<<"Server closed the connection"<<std::endl;
+            break;
+        }
+    }
+
+    reader.join();
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+    auto const seconds = std::chrono::duration<double>(duration).count();
+
+    close(client_fd);
+    io.stop();
+    server.join();
+
+    std::cout<<"Dispatching "<<invocation_count<<" invocations took "
+             <<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns ("
+             <<static_cast<uint64_t>(responses / seconds)<<" invocations/s)"<<std::endl;
+    exit(0);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures the cost of taking a scene snapshot with SurfaceStack::scene_elements_for()
+// and releasing it again, as each compositor does every frame. Heap allocations
+// are counted by replacing the global operator new.
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace ms = mir::scene;
+namespace mg = mir::graphics;
+namespace mi = mir::input;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto const block = std::malloc(size))
+        return block;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of surfaces> <number of compositors> <frames per compositor>"<<std::endl;
+        exit(1);
+    }
+
+    int const surface_count = std::atoi(argv[1]);
+    int const compositor_count = std::atoi(argv[2]);
+    uint64_t const frame_count = std::atoll(argv[3]);
+
+    auto const report = mir::report::null_scene_report();
+    ms::SurfaceStack stack{report};
+
+    std::vector<std::shared_ptr<ms::Surface>> surfaces;
+    for (int i = 0; i != surface_count; ++i)
+    {
+        geom::Rectangle const area{{(i * 37) % 1280, (i * 23) % 600}, {640, 480}};
+        surfaces.push_back(std::make_shared<ms::BasicSurface>(
+            nullptr /* session */,
+            "benchmark",
+            area,
+            mir_pointer_unconfined,
+            std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, {}}},
+            std::shared_ptr<mg::CursorImage>(),
+            report));
+        stack.add_surface(surfaces.back(), mi::InputReceptionMode::normal);
+    }
+
+    std::vector<int> compositor_ids(compositor_count);
+    for (auto const& id : compositor_ids)
+        stack.register_compositor(&id);
+
+    // Let each compositor warm up its own storage before counting
+    for (auto const& id : compositor_ids)
+        stack.scene_elements_for(&id);
+
+    auto const allocations_before = allocations.load();
+    auto const start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> compositors;
+    for (auto const& id : compositor_ids)
+    {
+        compositors.emplace_back([&stack, &id, frame_count]
+            {
+                for (uint64_t frame = 0; frame != frame_count; ++frame)
+                {
+                    auto elements = stack.scene_elements_for(&id);
+                    for (auto const& element : elements)
+                        element->rendered();
+                    elements.clear();
+                }
+            });
+    }
+
+    for (auto& compositor : compositors)
+        compositor.join();
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+    auto const frames = frame_count * compositor_count;
+    auto const allocations_per_frame = static_cast<double>(allocations - allocations_before) / frames;
+
+    for (auto const& id : compositor_ids)
+        stack.unregister_compositor(&id);
+
+    std::cout<<"Composited "<<frames<<" frames of "<<surface_count<<" surfaces on "<<compositor_count
+             <<" compositors in "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns ("
+             <<allocations_per_frame<<" allocations/frame)"<<std::endl;
+    exit(0);
+}
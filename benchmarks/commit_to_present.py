@@ -1,11 +1,16 @@
 #!/usr/bin/env python3
 
-import babeltrace
+import json
 import sys
-from text_histogram import histogram
 
 howto = """
-Process a LTTNG trace for per-client commit-to-present latencies.
+Report per-surface commit-to-present latencies, either from the metrics file
+a Mir server keeps with the --compositor-metrics-file option:
+
+> miral-app --compositor-metrics-file=/tmp/mir-metrics.json
+> python3 commit_to_present.py /tmp/mir-metrics.json
+
+or by processing an LTTNG trace for per-client commit-to-present latencies.
 
 This works on an lttng trace with the mir_server_wayland:sw_buffer_committed
 and mir_server_compositor:buffers_in_frame tracepoints enabled. To generate
@@ -33,6 +38,44 @@ This trace can then be processed with
 > python3 commit_to_present.py ~/lttng-traces/mir-trace-$DIGITS-$MORE_DIGITS/ust/uid/$YOUR_UID/64-bit
 """
 
+def bucket_histogram(limits, stats):
+    if stats['count'] == 0:
+        print("  (no samples)")
+        return
+
+    print("  mean {:.3f} ms over {} samples".format(stats['total'] / stats['count'] / 1000, stats['count']))
+    lower = 0
+    for limit, count in zip(limits, stats['buckets']):
+        if count:
+            bar = '*' * max(1, count * 60 // stats['count'])
+            print("  {:>9.3f} - {:>9.3f} ms [{:>6}]: {}".format(lower / 1000, limit / 1000, count, bar))
+        lower = limit
+
+def report_metrics(path):
+    with open(path) as file:
+        metrics = json.load(file)
+
+    limits = metrics['histogram_buckets_usec']
+    for output in metrics['outputs']:
+        frames = output['frames']
+        print("Output {}: {} frames, {} bypassed, {} missed".format(
+            output['id'], frames, output['bypassed'], output['missed']))
+        print(" composite-to-present:")
+        bucket_histogram(limits, output['composite_to_present_usec'])
+
+    for surface in metrics['surfaces']:
+        print("Surface {}: {} committed, {} shown, {} dropped".format(
+            surface['id'], surface['committed'], surface['shown'], surface['dropped']))
+        print(" commit-to-present:")
+        bucket_histogram(limits, surface['commit_to_present_usec'])
+
+if len(sys.argv) > 1 and sys.argv[1].endswith('.json'):
+    report_metrics(sys.argv[1])
+    sys.exit(0)
+
+import babeltrace
+from text_histogram import histogram
+
 try:
     trace_path = sys.argv[1]
 
@@ -55,6 +55,16 @@ class MultiplexingDispatchable final : public Dispatchable
 public:
     MultiplexingDispatchable();
     MultiplexingDispatchable(std::initializer_list<std::shared_ptr<Dispatchable>> dispatchees);
+    /**
+     * \param [in] max_events_per_dispatch The most ready dispatchees a single dispatch() call
+     *                                     will handle; between 1 (the default) and
+     *                                     max_batched_events.
+     *
+     * Handling a burst of ready fds in batches saves an epoll_wait() and a lock for each one.
+     * Note that, just as when several threads dispatch, a dispatchee may still be dispatched
+     * once after it has been removed by another dispatchee in the same batch.
+     */
+    explicit MultiplexingDispatchable(int max_events_per_dispatch);
     virtual ~MultiplexingDispatchable() noexcept;
 
     MultiplexingDispatchable& operator=(MultiplexingDispatchable const&) = delete;
@@ -94,7 +104,12 @@ public:
      * \param [in] fd   File descriptor of watch to remove.
      */
     void remove_watch(Fd const& fd);
+
+    static int const max_batched_events = 64;
+
 private:
+    int const max_events_per_dispatch;
+
     PosixRWMutex lifetime_mutex;
     std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
 
@@ -21,6 +21,7 @@
 
 #include <mir/geometry/rectangle.h>
 #include <mir/graphics/renderable.h>
+#include <mir/graphics/frame.h>
 #include <mir_toolkit/common.h>
 #include <glm/glm.hpp>
 
@@ -77,6 +78,16 @@ public:
      */
     virtual glm::mat2 transformation() const = 0;
 
+    /**
+     * Returns timing information for the last frame posted to this display
+     * buffer. This is only meaningful after the DisplaySyncGroup owning the
+     * buffer has completed post().
+     *
+     * Platforms that have no hardware counters should count posts and
+     * timestamp each with the time it completed.
+     */
+    virtual Frame last_frame() const = 0;
+
     /** Returns a pointer to the native display buffer object backing this
      *  display buffer.
      *
@@ -197,6 +197,15 @@ struct EGLExtensions
         PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC const eglCreatePlatformWindowSurface;
     };
     std::experimental::optional<PlatformBaseEXT> const platform_base;
+
+    /// Requires a display, so is not a member: construct it where the display is known
+    struct EXTImageDmaBufImportModifiers
+    {
+        explicit EXTImageDmaBufImportModifiers(EGLDisplay dpy);
+
+        PFNEGLQUERYDMABUFFORMATSEXTPROC const eglQueryDmaBufFormatsExt;
+        PFNEGLQUERYDMABUFMODIFIERSEXTPROC const eglQueryDmaBufModifiersExt;
+    };
 };
 
 }
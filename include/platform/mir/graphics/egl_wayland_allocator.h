@@ -20,9 +20,14 @@
 #ifndef MIR_PLATFORM_EGL_WAYLAND_ALLOCATOR_H_
 #define MIR_PLATFORM_EGL_WAYLAND_ALLOCATOR_H_
 
+#include "mir/geometry/size.h"
+#include "mir/graphics/texture.h"
+#include "mir_toolkit/common.h"
+
 #include <memory>
 #include <functional>
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 struct wl_resource;
 struct wl_display;
@@ -56,6 +61,24 @@ auto buffer_from_resource(
     EGLExtensions const& extensions,
     std::shared_ptr<Executor> wayland_executor) -> std::unique_ptr<Buffer>;
 
+/**
+ * The Buffer for a client buffer that has been imported as image
+ *
+ * The Buffer samples a texture sibling of image, so image can be destroyed once this returns.
+ *
+ * \note Must be called with a current EGL context
+ */
+auto buffer_from_image(
+    EGLImageKHR image,
+    geometry::Size size,
+    gl::Texture::Layout layout,
+    MirPixelFormat format,
+    std::function<void()>&& on_consumed,
+    std::function<void()>&& on_release,
+    std::shared_ptr<renderer::gl::Context> ctx,
+    EGLExtensions const& extensions,
+    std::shared_ptr<Executor> wayland_executor) -> std::unique_ptr<Buffer>;
+
 }
 }
 }
@@ -21,6 +21,8 @@
 
 #include <experimental/optional>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/graphics/buffer_id.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -72,7 +74,22 @@ public:
 
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
 
+    /**
+     * The parts of screen_position() that the client has promised are fully
+     * opaque, even though shaped(). These can be drawn without blending and
+     * hide whatever is underneath.
+     */
+    virtual geometry::Rectangles opaque_region() const = 0;
+
     virtual unsigned int swap_interval() const = 0;
+
+    /**
+     * Return the area of buffer(), in buffer coordinates, whose content
+     * differs from the earlier buffer with ID previous. Returns nothing if
+     * that is unknown, in which case all of buffer() should be assumed to
+     * have changed.
+     */
+    virtual std::experimental::optional<geometry::Rectangles> damage_since(BufferID previous) const = 0;
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
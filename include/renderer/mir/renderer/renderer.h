@@ -20,6 +20,7 @@
 #define MIR_RENDERER_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
 #include <glm/glm.hpp>
@@ -36,6 +37,14 @@ public:
 
     virtual void set_viewport(geometry::Rectangle const& rect) = 0;
     virtual void set_output_transform(glm::mat2 const&) = 0;
+
+    /**
+     * Sets the area of the viewport that differs from the last frame passed
+     * to render(). Renderers may use this to avoid repainting the unchanged
+     * parts of the output. If this is not called before render() then the
+     * whole viewport is repainted.
+     */
+    virtual void set_damage(geometry::Rectangles const& damage) = 0;
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_INCREMENTAL_TEXTURE_SOURCE_H_
+#define MIR_RENDERER_GL_INCREMENTAL_TEXTURE_SOURCE_H_
+
+#include "mir/geometry/rectangles.h"
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/// Implemented by TextureSources that can update part of an existing texture
+class IncrementalTextureSource
+{
+public:
+    virtual ~IncrementalTextureSource() = default;
+
+    //Uploads only the damaged areas (in buffer coordinates) into the bound
+    //texture, which must already hold the contents of an earlier buffer of
+    //the same size and pixel format.
+    virtual void bind_damage(geometry::Rectangles const& damage) = 0;
+
+    //Whether the buffer's contents can still be read. If not, the last
+    //bind() or bind_damage() couldn't upload them, so later buffers mustn't
+    //be uploaded as damage against this one.
+    virtual bool contents_readable() const = 0;
+
+protected:
+    IncrementalTextureSource() = default;
+    IncrementalTextureSource(IncrementalTextureSource const&) = delete;
+    IncrementalTextureSource& operator=(IncrementalTextureSource const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_GL_INCREMENTAL_TEXTURE_SOURCE_H_ */
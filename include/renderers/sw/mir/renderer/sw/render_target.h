@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+
+#include <functional>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * A display buffer the CPU can draw into, exposed through
+ * DisplayBuffer::native_display_buffer() by platforms without (or not
+ * wanting) GL composition.
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /** The size in pixels of the buffer, with any output transform already applied */
+    virtual geometry::Size size() const = 0;
+    /**
+     * Maps the buffer that will be shown on the next swap_buffers() for writing.
+     * The pixels are mir_pixel_format_argb_8888 and still hold the previous
+     * frame, so only changed areas need to be written.
+     */
+    virtual void write(std::function<void(unsigned char* pixels, geometry::Stride stride)> const& do_with_pixels) = 0;
+    /** Shows the buffer written since the last swap */
+    virtual void swap_buffers() = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDER_TARGET_H_ */
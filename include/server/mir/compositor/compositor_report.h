@@ -20,6 +20,8 @@
 #define MIR_COMPOSITOR_COMPOSITOR_REPORT_H_
 
 #include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/frame.h"
 
 namespace mir
 {
@@ -30,11 +32,15 @@ class CompositorReport
 {
 public:
     typedef const void* SubCompositorId;  // e.g. thread/display buffer ID
+    typedef const void* StreamId;         // matches graphics::Renderable::id() of the stream's renderables
     virtual void added_display(int width, int height, int x, int y, SubCompositorId id) = 0;
     virtual void began_frame(SubCompositorId id) = 0;
     virtual void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) = 0;
     virtual void rendered_frame(SubCompositorId id) = 0;
     virtual void finished_frame(SubCompositorId id) = 0;
+    virtual void missed_frame(SubCompositorId id) = 0;  // shown after the vblank the frame was scheduled for
+    virtual void presented_frame(SubCompositorId id, graphics::Frame const& frame) = 0;
+    virtual void submitted_buffer(StreamId stream, graphics::BufferID buffer) = 0;
     virtual void started() = 0;
     virtual void stopped() = 0;
     virtual void scheduled() = 0;
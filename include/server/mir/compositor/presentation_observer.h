@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_PRESENTATION_OBSERVER_H_
+#define MIR_COMPOSITOR_PRESENTATION_OBSERVER_H_
+
+namespace mir
+{
+namespace geometry { struct Rectangle; }
+namespace graphics { struct Frame; }
+namespace compositor
+{
+class PresentationObserver
+{
+public:
+    /**
+     * Notification that a frame has been posted to a display buffer.
+     *
+     * This is called from the compositor thread once the display buffer's
+     * DisplaySyncGroup has completed post().
+     *
+     * \param [in] view_area    The area of the scene shown by the display buffer
+     * \param [in] frame        The display buffer's last_frame() after the post
+     */
+    virtual void frame_presented(geometry::Rectangle const& view_area, graphics::Frame const& frame) = 0;
+
+protected:
+    PresentationObserver() = default;
+    virtual ~PresentationObserver() = default;
+    PresentationObserver(PresentationObserver const&) = delete;
+    PresentationObserver& operator=(PresentationObserver const&) = delete;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_PRESENTATION_OBSERVER_H_ */
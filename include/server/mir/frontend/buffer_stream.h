@@ -22,6 +22,7 @@
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 #include <functional>
 #include <memory>
 
@@ -41,8 +42,17 @@ class BufferStream
 public:
     virtual ~BufferStream() = default;
 
+    /// Submits a buffer whose entire content may differ from the previous one
     virtual void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
 
+    /**
+     * Submits a buffer that differs from the previously submitted buffer only
+     * within damage (in buffer coordinates).
+     */
+    virtual void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) = 0;
+
     virtual void set_frame_posted_callback(
         std::function<void(geometry::Size const&)> const& callback) = 0;
 
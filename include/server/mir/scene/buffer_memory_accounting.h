@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_BUFFER_MEMORY_ACCOUNTING_H_
+#define MIR_SCENE_BUFFER_MEMORY_ACCOUNTING_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace mir
+{
+namespace scene
+{
+class Session;
+
+/// The buffers the server holds on behalf of a client
+struct BufferMemoryUsage
+{
+    size_t buffers{0};      ///< Buffers currently held
+    size_t bytes{0};        ///< Estimated memory of those buffers
+    size_t evicted{0};      ///< Buffers dropped so far to keep within the limit
+    size_t rejected{0};     ///< Allocations refused so far to keep within the limit
+};
+
+/// What to do when an allocation would take a client over its limit
+enum class BufferMemoryPolicy
+{
+    /// Drop the least recently used buffers the client has released (even if the server is still
+    /// showing them); reject if that isn't enough. Buffers the client holds are never dropped.
+    evict_least_recently_used,
+    /// Refuse the allocation
+    reject
+};
+
+/**
+ * Tracks the memory of buffers allocated for each client (hardware and shm alike)
+ *
+ * The frontend keeps this up to date; the shell can query it to find (and deal with)
+ * clients using more than their share.
+ */
+class BufferMemoryAccounting
+{
+public:
+    /// \param limit    the bytes of buffers a client may hold (zero for no limit)
+    BufferMemoryAccounting(size_t limit, BufferMemoryPolicy policy);
+
+    auto limit() const -> size_t;
+    auto policy() const -> BufferMemoryPolicy;
+
+    /// \return usage of session (all zero if none has been recorded)
+    auto usage_of(Session const* session) const -> BufferMemoryUsage;
+
+    /// Calls f for each session with recorded usage
+    /// \note f is called with a lock held, so must not call back into this object
+    void for_each(std::function<void(Session const*, BufferMemoryUsage const&)> const& f) const;
+
+    /// Records the current usage of session
+    void update(Session const* session, BufferMemoryUsage const& usage);
+
+    /// Forgets session (when its client disconnects)
+    void remove(Session const* session);
+
+private:
+    BufferMemoryAccounting(BufferMemoryAccounting const&) = delete;
+    BufferMemoryAccounting& operator=(BufferMemoryAccounting const&) = delete;
+
+    size_t const limit_;
+    BufferMemoryPolicy const policy_;
+
+    std::mutex mutable mutex;
+    std::map<Session const*, BufferMemoryUsage> usage;
+};
+}
+}
+
+#endif // MIR_SCENE_BUFFER_MEMORY_ACCOUNTING_H_
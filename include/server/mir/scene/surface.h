@@ -41,6 +41,7 @@ struct StreamInfo
     std::shared_ptr<compositor::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    std::vector<geometry::Rectangle> opaque_region{}; ///< In stream-local coordinates
 };
 
 class SurfaceObserver;
@@ -87,6 +88,13 @@ public:
      * set_input_region({Rectangle{}}).
      */
     virtual void set_input_region(std::vector<geometry::Rectangle> const& region) = 0;
+    /**
+     * Bounds of the area input_area_contains() may be true in.
+     *
+     * This is input_bounds() unless a custom input region is set, which may
+     * extend beyond them (e.g. to include subsurfaces outside their parent).
+     */
+    virtual geometry::Rectangle input_area_bounds() const = 0;
     /// Given value is the frame size of the window
     virtual void resize(geometry::Size const& window_size) = 0;
     virtual void set_transformation(glm::mat4 const& t) = 0;
@@ -64,6 +64,7 @@ class SurfaceStack;
 namespace scene
 {
 class ApplicationNotRespondingDetector;
+class BufferMemoryAccounting;
 class BufferStreamFactory;
 class PromptSessionListener;
 class PromptSessionManager;
@@ -438,6 +439,9 @@ public:
     auto the_session_mediator_observer_registrar() const ->
         std::shared_ptr<ObserverRegistrar<frontend::SessionMediatorObserver>>;
 
+    /// \return the memory accounting (and limits) for buffers allocated for clients
+    auto the_buffer_memory_accounting() const -> std::shared_ptr<scene::BufferMemoryAccounting>;
+
 
 /** @} */
 
@@ -24,12 +24,14 @@
 #include "mir/frontend/surface_id.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
 #include "mir/graphics/buffer_properties.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/frontend/buffer_stream_id.h"
 
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -50,6 +52,7 @@ struct StreamSpecification
     std::weak_ptr<frontend::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    std::vector<geometry::Rectangle> opaque_region{}; ///< In stream-local coordinates
 };
 auto operator==(StreamSpecification const& lhs, StreamSpecification const& rhs) -> bool;
 
@@ -174,6 +174,11 @@ public:
     MOCK_METHOD4(eglQueryWaylandBufferWL,
         EGLBoolean(EGLDisplay, struct wl_resource*, EGLint, EGLint*));
 
+    MOCK_METHOD4(eglQueryDmaBufFormatsEXT,
+        EGLBoolean(EGLDisplay, EGLint, EGLint*, EGLint*));
+    MOCK_METHOD6(eglQueryDmaBufModifiersEXT,
+        EGLBoolean(EGLDisplay, EGLint, EGLint, EGLuint64KHR*, EGLBoolean*, EGLint*));
+
     EGLDisplay const fake_egl_display;
     EGLConfig const* const fake_configs;
     EGLint const fake_configs_num;
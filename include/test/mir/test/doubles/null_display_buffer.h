@@ -34,6 +34,7 @@ public:
     geometry::Rectangle view_area() const override { return geometry::Rectangle(); }
     bool overlay(graphics::RenderableList const&) override { return false; }
     glm::mat2 transformation() const override { return glm::mat2(1); }
+    graphics::Frame last_frame() const override { return {}; }
     NativeDisplayBuffer* native_display_buffer() override { return this; }
 };
 
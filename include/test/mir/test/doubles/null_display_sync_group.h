@@ -51,6 +51,9 @@ public:
 
     void post() override
     {
+        for (auto& db : display_buffers)
+            db.frame_posted();
+
         /* yield() is needed to ensure reasonable runtime under valgrind for some tests */
         std::this_thread::yield();
     }
@@ -21,6 +21,7 @@
 
 #include "mir/test/doubles/null_display_buffer.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/graphics/atomic_frame.h"
 
 namespace mir
 {
@@ -35,9 +36,14 @@ public:
     StubDisplayBuffer(geometry::Rectangle const& view_area_) : view_area_(view_area_) {}
     StubDisplayBuffer(StubDisplayBuffer const& s) : view_area_(s.view_area_) {}
     geometry::Rectangle view_area() const override { return view_area_; }
+    graphics::Frame last_frame() const override { return last_frame_.load(); }
+
+    /// Called by the owning sync group's post(), so that frames advance as they would on hardware
+    void frame_posted() { last_frame_.increment_now(); }
 
 private:
     geometry::Rectangle view_area_;
+    graphics::AtomicFrame last_frame_;
 };
 
 }
@@ -44,6 +44,7 @@ struct StubSurface : scene::Surface
     geometry::Point top_left() const override { return {}; }
     geometry::Rectangle input_bounds() const override { return {}; }
     bool input_area_contains(geometry::Point const&) const override { return false; }
+    geometry::Rectangle input_area_bounds() const override { return {}; }
     void consume(MirEvent const*) override {}
     void set_alpha(float) override {}
     void set_orientation(MirOrientation) override {}
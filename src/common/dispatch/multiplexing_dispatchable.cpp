@@ -72,9 +72,20 @@ private:
 }
 
 md::MultiplexingDispatchable::MultiplexingDispatchable()
-    : lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
+    : MultiplexingDispatchable(1)
+{
+}
+
+md::MultiplexingDispatchable::MultiplexingDispatchable(int max_events_per_dispatch)
+    : max_events_per_dispatch{max_events_per_dispatch},
+      lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
       epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}}
 {
+    if (max_events_per_dispatch < 1 || max_events_per_dispatch > max_batched_events)
+    {
+        BOOST_THROW_EXCEPTION((std::logic_error{"Invalid number of events per dispatch"}));
+    }
+
     if (epoll_fd == mir::Fd::invalid)
     {
         BOOST_THROW_EXCEPTION((std::system_error{errno,
@@ -108,43 +119,66 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    epoll_event ready[max_batched_events];
+    decltype(dispatchee_holder)::value_type sources[max_batched_events];
+    int ready_count{0};
 
     {
         std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
+        ready_count = epoll_wait(epoll_fd, ready, max_events_per_dispatch, 0);
 
-        if (result < 0)
+        if (ready_count < 0)
         {
             BOOST_THROW_EXCEPTION((std::system_error{errno,
                                                      std::system_category(),
                                                      "Failed to wait on fds"}));
         }
 
-        if (result == 0)
+        // If nothing is ready some other thread must have stolen the event we
+        // were woken for; that's ok, just return.
+
+        for (int i = 0; i != ready_count; ++i)
         {
-            // Some other thread must have stolen the event we were woken for;
-            // that's ok, just return.
-            return true;
+            sources[i] = *reinterpret_cast<decltype(dispatchee_holder)::pointer>(ready[i].data.ptr);
         }
-
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
-
-        source = event_source->first;
-        rearm_source = event_source->second;
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
-    {
-        remove_watch(source);
-    }
-    else if (rearm_source)
+    auto const rearm = [this, &ready, &sources](int i)
+        {
+            auto const& source = sources[i].first;
+            ready[i].events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &ready[i]);
+        };
+
+    for (int i = 0; i != ready_count; ++i)
     {
-        event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
-        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
+        auto const& source = sources[i].first;
+
+        bool keep_source;
+        try
+        {
+            keep_source = source->dispatch(epoll_to_fd_event(ready[i]));
+        }
+        catch (...)
+        {
+            // Don't leave the rest of the batch disarmed
+            for (int j = i + 1; j != ready_count; ++j)
+            {
+                if (sources[j].second)
+                    rearm(j);
+            }
+            throw;
+        }
+
+        if (!keep_source)
+        {
+            remove_watch(source);
+        }
+        else if (sources[i].second)
+        {
+            rearm(i);
+        }
     }
 
     return true;
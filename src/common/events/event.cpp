@@ -39,11 +39,19 @@
 
 namespace ml = mir::logging;
 
-MirEvent::MirEvent(MirEvent const& e)
+namespace
+{
+auto copy_into(::capnp::MessageBuilder& message, mir::capnp::Event::Reader const& reader)
+    -> mir::capnp::Event::Builder
 {
-    auto reader = e.event.asReader();
     message.setRoot(reader);
-    event = message.getRoot<mir::capnp::Event>();
+    return message.getRoot<mir::capnp::Event>();
+}
+}
+
+MirEvent::MirEvent(MirEvent const& e)
+    : event{copy_into(message, e.event.asReader())}
+{
 }
 
 MirEvent& MirEvent::operator=(MirEvent const& e)
@@ -40,35 +40,35 @@ mir::fd_reception_error::fd_reception_error(std::string const& message) :
 {
 }
 
-void mir::send_fds(
+ssize_t mir::send_with_fds(
     mir::Fd const& socket,
-    std::vector<mir::Fd> const& fds)
+    iovec* iov,
+    size_t iov_count,
+    std::vector<mir::Fd> const& fds,
+    int flags)
 {
-    if (fds.size() > 0)
+    // Allocate space for control message
+    static auto const builtin_n_fds = 5;
+    static auto const builtin_cmsg_space = CMSG_SPACE(builtin_n_fds * sizeof(int));
+    auto const fds_bytes = fds.size() * sizeof(int);
+    mir::VariableLengthArray<builtin_cmsg_space> control{fds.empty() ? 0 : CMSG_SPACE(fds_bytes)};
+
+    // Message to send
+    struct msghdr header;
+    header.msg_name = NULL;
+    header.msg_namelen = 0;
+    header.msg_iov = iov;
+    header.msg_iovlen = iov_count;
+    header.msg_controllen = 0;
+    header.msg_control = NULL;
+    header.msg_flags = 0;
+
+    if (!fds.empty())
     {
-        // We send dummy data
-        struct iovec iov;
-        char dummy_iov_data = 'M';
-        iov.iov_base = &dummy_iov_data;
-        iov.iov_len = 1;
-
-        // Allocate space for control message
-        static auto const builtin_n_fds = 5;
-        static auto const builtin_cmsg_space = CMSG_SPACE(builtin_n_fds * sizeof(int));
-        auto const fds_bytes = fds.size() * sizeof(int);
-        mir::VariableLengthArray<builtin_cmsg_space> control{CMSG_SPACE(fds_bytes)};
         // Silence valgrind uninitialized memory complaint
         memset(control.data(), 0, control.size());
-
-        // Message to send
-        struct msghdr header;
-        header.msg_name = NULL;
-        header.msg_namelen = 0;
-        header.msg_iov = &iov;
-        header.msg_iovlen = 1;
         header.msg_controllen = control.size();
         header.msg_control = control.data();
-        header.msg_flags = 0;
 
         // Control message contains file descriptors
         struct cmsghdr *message = CMSG_FIRSTHDR(&header);
@@ -80,8 +80,24 @@ void mir::send_fds(
         int i = 0;
         for (auto& fd : fds)
             data[i++] = fd;
+    }
+
+    return sendmsg(socket, &header, flags);
+}
+
+void mir::send_fds(
+    mir::Fd const& socket,
+    std::vector<mir::Fd> const& fds)
+{
+    if (fds.size() > 0)
+    {
+        // We send dummy data
+        struct iovec iov;
+        char dummy_iov_data = 'M';
+        iov.iov_base = &dummy_iov_data;
+        iov.iov_len = 1;
 
-        auto const sent = sendmsg(socket, &header, MSG_NOSIGNAL);
+        auto const sent = send_with_fds(socket, &iov, 1, fds, MSG_NOSIGNAL);
         if (sent < 0)
             BOOST_THROW_EXCEPTION(std::runtime_error("Failed to send fds: " + std::string(strerror(errno))));
     }
@@ -25,19 +25,7 @@
 
 namespace mir {
 
-void logv(logging::Severity sev, char const* component,
-          char const* fmt, va_list va)
-{
-    char message[1024];
-    int max = sizeof(message) - 1;
-    int len = vsnprintf(message, max, fmt, va);
-    if (len > max)
-        len = max;
-    message[len] = '\0';
-
-    // Suboptimal: Constructing a std::string for message/component.
-    logging::log(sev, message, component);
-}
+// logv() is defined alongside the installed logger, in logging/logger.cpp
 
 void log(logging::Severity sev, char const* component,
          char const* fmt, ...)
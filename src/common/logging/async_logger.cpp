@@ -0,0 +1,321 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace ml = mir::logging;
+
+struct ml::AsyncLogger::Entry
+{
+    uint64_t sequence;
+    Severity severity;
+    char component[32];
+    char message[400];
+    std::string long_message;   ///< Used instead of message if that's too short
+};
+
+struct ml::AsyncLogger::Ring
+{
+    explicit Ring(size_t capacity) : entries(capacity) {}
+
+    std::vector<Entry> entries;
+    std::atomic<uint64_t> head{0};  ///< Next entry to fill: only changed by the logging thread
+    std::atomic<uint64_t> tail{0};  ///< Next entry to write: only changed by the writer thread
+    std::atomic<bool> thread_exited{false};
+    std::atomic<bool> logger_destroyed{false};
+};
+
+namespace
+{
+std::atomic<uint64_t> next_logger_id{0};
+
+auto format(char const* format, va_list args) -> std::string
+{
+    va_list copy;
+    va_copy(copy, args);
+    auto const length = vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
+
+    if (length <= 0)
+        return {};
+
+    std::string result(length, '\0');
+    vsnprintf(&result[0], length + 1, format, args);
+    return result;
+}
+}
+
+ml::AsyncLogger::AsyncLogger(std::shared_ptr<Logger> const& next, size_t capacity) :
+    next{next},
+    capacity{std::max<size_t>(capacity, 1)},
+    id{next_logger_id.fetch_add(1)},
+    writer{[this] { write_messages(); }}
+{
+}
+
+ml::AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<decltype(wake_mutex)> lock{wake_mutex};
+        stopping = true;
+    }
+    wake_cv.notify_one();
+    writer.join();
+
+    std::lock_guard<decltype(rings_mutex)> lock{rings_mutex};
+    for (auto const& ring : rings)
+        ring->logger_destroyed = true;
+}
+
+void ml::AsyncLogger::log(Severity severity, std::string const& message, std::string const& component)
+{
+    if (severity == Severity::critical)
+    {
+        flush();
+        next->log(severity, message, component);
+        return;
+    }
+
+    if (auto const entry = reserve(severity, component.c_str()))
+    {
+        if (message.size() < sizeof entry->message)
+        {
+            memcpy(entry->message, message.c_str(), message.size() + 1);
+            entry->long_message.clear();
+        }
+        else
+        {
+            entry->long_message = message;
+        }
+        commit();
+    }
+}
+
+void ml::AsyncLogger::log(char const* component, Severity severity, char const* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    logv(severity, component, format, args);
+    va_end(args);
+}
+
+void ml::AsyncLogger::logv(Severity severity, char const* component, char const* format, va_list args)
+{
+    if (severity == Severity::critical)
+    {
+        flush();
+        next->log(severity, ::format(format, args), component);
+        return;
+    }
+
+    if (auto const entry = reserve(severity, component))
+    {
+        va_list copy;
+        va_copy(copy, args);
+        auto const length = vsnprintf(entry->message, sizeof entry->message, format, copy);
+        va_end(copy);
+
+        if (length >= 0 && static_cast<size_t>(length) >= sizeof entry->message)
+            entry->long_message = ::format(format, args);
+        else
+            entry->long_message.clear();
+
+        commit();
+    }
+}
+
+void ml::AsyncLogger::flush()
+{
+    // The next logger may itself log: that can't wait for the writer
+    if (std::this_thread::get_id() == writer.get_id())
+        return;
+
+    std::unique_lock<decltype(wake_mutex)> lock{wake_mutex};
+    auto const flush = ++flushes_requested;
+    wake_cv.notify_one();
+    flushed_cv.wait(lock, [&] { return flushes_done >= flush; });
+}
+
+auto ml::AsyncLogger::dropped() const -> uint64_t
+{
+    return dropped_count.load();
+}
+
+auto ml::AsyncLogger::ring_for_this_thread() -> Ring&
+{
+    struct ThreadRings
+    {
+        ~ThreadRings()
+        {
+            for (auto const& ring : rings)
+                ring.second->thread_exited = true;
+        }
+
+        std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+    };
+
+    static thread_local ThreadRings this_thread;
+
+    for (auto const& ring : this_thread.rings)
+    {
+        if (ring.first == id)
+            return *ring.second;
+    }
+
+    this_thread.rings.erase(
+        std::remove_if(
+            this_thread.rings.begin(),
+            this_thread.rings.end(),
+            [](auto const& ring) { return ring.second->logger_destroyed.load(); }),
+        this_thread.rings.end());
+
+    auto const ring = std::make_shared<Ring>(capacity);
+    {
+        std::lock_guard<decltype(rings_mutex)> lock{rings_mutex};
+        rings.push_back(ring);
+    }
+    this_thread.rings.emplace_back(id, ring);
+
+    return *ring;
+}
+
+auto ml::AsyncLogger::reserve(Severity severity, char const* component) -> Entry*
+{
+    auto& ring = ring_for_this_thread();
+    auto const head = ring.head.load(std::memory_order_relaxed);
+
+    if (head - ring.tail.load(std::memory_order_acquire) >= ring.entries.size())
+    {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+        wake_writer();
+        return nullptr;
+    }
+
+    auto& entry = ring.entries[head % ring.entries.size()];
+    entry.sequence = next_sequence.fetch_add(1, std::memory_order_relaxed);
+    entry.severity = severity;
+    strncpy(entry.component, component, sizeof entry.component - 1);
+    entry.component[sizeof entry.component - 1] = '\0';
+
+    return &entry;
+}
+
+void ml::AsyncLogger::commit()
+{
+    auto& ring = ring_for_this_thread();
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    wake_writer();
+}
+
+void ml::AsyncLogger::wake_writer()
+{
+    // Only the first message since the writer last woke needs to wake it
+    if (!wake_pending.exchange(true))
+    {
+        std::lock_guard<decltype(wake_mutex)> lock{wake_mutex};
+        wake_cv.notify_one();
+    }
+}
+
+void ml::AsyncLogger::write_messages()
+{
+    mir::set_thread_name("Mir/Logger");
+
+    uint64_t reported_drops{0};
+    std::unique_lock<decltype(wake_mutex)> lock{wake_mutex};
+
+    for (;;)
+    {
+        wake_cv.wait(lock, [this] { return wake_pending || stopping || flushes_done != flushes_requested; });
+        wake_pending = false;
+        auto const stop = stopping;
+        auto const flushes = flushes_requested;
+        lock.unlock();
+
+        write_waiting_messages();
+
+        auto const drops = dropped_count.load();
+        if (drops != reported_drops)
+        {
+            next->log(
+                Severity::warning,
+                std::to_string(drops - reported_drops) + " log messages dropped: logging faster than they can be written",
+                "logging");
+            reported_drops = drops;
+        }
+
+        lock.lock();
+        flushes_done = flushes;
+        flushed_cv.notify_all();
+
+        if (stop)
+            return;
+    }
+}
+
+void ml::AsyncLogger::write_waiting_messages()
+{
+    std::vector<std::shared_ptr<Ring>> current;
+    {
+        std::lock_guard<decltype(rings_mutex)> lock{rings_mutex};
+
+        rings.erase(
+            std::remove_if(
+                rings.begin(),
+                rings.end(),
+                [](auto const& ring) { return ring->thread_exited && ring->tail == ring->head; }),
+            rings.end());
+
+        current = rings;
+    }
+
+    // Write the oldest waiting message of any thread until none are left
+    for (;;)
+    {
+        Ring* oldest = nullptr;
+        for (auto const& ring : current)
+        {
+            auto const tail = ring->tail.load(std::memory_order_relaxed);
+            if (tail == ring->head.load(std::memory_order_acquire))
+                continue;
+
+            if (!oldest ||
+                ring->entries[tail % capacity].sequence <
+                oldest->entries[oldest->tail.load(std::memory_order_relaxed) % capacity].sequence)
+            {
+                oldest = ring.get();
+            }
+        }
+
+        if (!oldest)
+            return;
+
+        auto const tail = oldest->tail.load(std::memory_order_relaxed);
+        auto const& entry = oldest->entries[tail % capacity];
+
+        next->log(
+            entry.severity,
+            entry.long_message.empty() ? std::string{entry.message} : entry.long_message,
+            entry.component);
+
+        oldest->tail.store(tail + 1, std::memory_order_release);
+    }
+}
@@ -16,10 +16,13 @@
  * Authored by: Cemil Azizoglu <cemil.azizoglu@canonical.com>
  */
 
+#include "mir/logging/async_logger.h"
 #include "mir/logging/dumb_console_logger.h"
 #include "mir/logging/logger.h"
+#include "mir/log.h"
+#include "mir/rcu_ptr.h"
 
-#include <mutex>
+#include <memory>
 #include <cstdarg>
 #include <cstdio>
 
@@ -40,34 +43,92 @@ void ml::Logger::log(char const* component, Severity severity, char const* forma
 
 namespace
 {
-std::mutex log_mutex;
-std::shared_ptr<ml::Logger> the_logger;
+struct Installed
+{
+    std::shared_ptr<ml::Logger> const logger;
+    ml::AsyncLogger* const async;   ///< logger, if it is an AsyncLogger
+};
 
-std::shared_ptr<ml::Logger> get_logger()
+// Log calls use the installed logger without locking. A logger replaced by set_logger()
+// is released once no log call is in progress.
+class Loggers
 {
-    std::lock_guard<decltype(log_mutex)> lock{log_mutex};
+public:
+    template<typename F>
+    void with_current(F&& f)
+    {
+        installed.read(
+            [&](Installed const* current)
+            {
+                if (current)
+                {
+                    f(*current);
+                    return;
+                }
 
-    if (!the_logger)
-        the_logger = std::make_shared<ml::DumbConsoleLogger>();
+                install_default();
+                installed.read([&](Installed const* current) { f(*current); });
+            });
+    }
 
-    return the_logger;
-}
+    void install(std::shared_ptr<ml::Logger> const& logger)
+    {
+        installed.update(
+            [&](Installed const*)
+            {
+                return std::make_unique<Installed>(Installed{logger, dynamic_cast<ml::AsyncLogger*>(logger.get())});
+            });
+    }
+
+private:
+    mir::RcuPtr<Installed> installed;
+
+    void install_default()
+    {
+        installed.update(
+            [](Installed const* current) -> std::unique_ptr<Installed>
+            {
+                if (current)
+                    return nullptr;
+
+                return std::make_unique<Installed>(Installed{std::make_shared<ml::DumbConsoleLogger>(), nullptr});
+            });
+    }
+} loggers;
 }
 
 void ml::log(ml::Severity severity, const std::string& message, const std::string& component)
 {
-    auto const logger = get_logger();
-
-    logger->log(severity, message, component);
+    loggers.with_current([&](Installed const& current) { current.logger->log(severity, message, component); });
 }
 
 void ml::set_logger(std::shared_ptr<Logger> const& new_logger)
 {
     if (new_logger)
-    {
-        std::lock_guard<decltype(log_mutex)> lock{log_mutex};
-        the_logger = new_logger;
-    }
+        loggers.install(new_logger);
+}
+
+void mir::logv(ml::Severity sev, char const* component, char const* fmt, va_list va)
+{
+    loggers.with_current(
+        [&](Installed const& current)
+        {
+            if (current.async)
+            {
+                current.async->logv(sev, component, fmt, va);
+                return;
+            }
+
+            char message[1024];
+            int max = sizeof(message) - 1;
+            int len = vsnprintf(message, max, fmt, va);
+            if (len > max)
+                len = max;
+            message[len] = '\0';
+
+            // Suboptimal: Constructing a std::string for message/component.
+            current.logger->log(sev, message, component);
+        });
 }
 
 namespace mir
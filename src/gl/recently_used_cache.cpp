@@ -20,6 +20,7 @@
 #include "recently_used_cache.h"
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/gl/texture_source.h"
+#include "mir/renderer/gl/incremental_texture_source.h"
 
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
@@ -42,9 +43,29 @@ std::shared_ptr<mgl::Texture> mgl::RecentlyUsedCache::load(mg::Renderable const&
 
     if ((texture.last_bound_buffer != buffer_id) || (!texture.valid_binding))
     {
-        texture_source->bind();
+        auto const incremental_source = dynamic_cast<mrgl::IncrementalTextureSource*>(texture_source);
+
+        // The texture can only be patched up if it still holds the previous buffer as-is
+        std::experimental::optional<geom::Rectangles> damage;
+        if (incremental_source &&
+            texture.valid_binding &&
+            texture.holds_contents &&
+            texture.last_bound_size == buffer->size() &&
+            texture.last_bound_format == buffer->pixel_format())
+        {
+            damage = renderable.damage_since(texture.last_bound_buffer);
+        }
+
+        if (damage)
+            incremental_source->bind_damage(damage.value());
+        else
+            texture_source->bind();
+
         texture.resource = buffer;
         texture.last_bound_buffer = buffer_id;
+        texture.last_bound_size = buffer->size();
+        texture.last_bound_format = buffer->pixel_format();
+        texture.holds_contents = !incremental_source || incremental_source->contents_readable();
     }
     texture_source->secure_for_render();
 
@@ -20,9 +20,43 @@
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/buffer.h"
 
+#include <algorithm>
+
 namespace mg = mir::graphics;
 namespace mgl = mir::gl;
 namespace geom = mir::geometry;
+
+namespace
+{
+// Beyond this the extra draw calls are likely to cost more than blending saves
+auto const max_opaque_rectangles = 8u;
+
+mgl::Primitive rectangle_primitive(
+    geom::Rectangle const& piece, geom::Rectangle const& whole, geom::Displacement const& offset, bool opaque)
+{
+    auto const tex_x = [&](geom::X x)
+        { return GLfloat(x.as_int() - whole.left().as_int()) / whole.size.width.as_int(); };
+    auto const tex_y = [&](geom::Y y)
+        { return GLfloat(y.as_int() - whole.top().as_int()) / whole.size.height.as_int(); };
+
+    GLfloat const left = piece.left().as_int() - offset.dx.as_int();
+    GLfloat const right = piece.right().as_int() - offset.dx.as_int();
+    GLfloat const top = piece.top().as_int() - offset.dy.as_int();
+    GLfloat const bottom = piece.bottom().as_int() - offset.dy.as_int();
+
+    mgl::Primitive rectangle;
+    rectangle.type = GL_TRIANGLE_STRIP;
+    rectangle.opaque = opaque;
+
+    auto& vertices = rectangle.vertices;
+    vertices[0] = {{left,  top,    0.0f}, {tex_x(piece.left()),  tex_y(piece.top())}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex_x(piece.left()),  tex_y(piece.bottom())}};
+    vertices[2] = {{right, top,    0.0f}, {tex_x(piece.right()), tex_y(piece.top())}};
+    vertices[3] = {{right, bottom, 0.0f}, {tex_x(piece.right()), tex_y(piece.bottom())}};
+    return rectangle;
+}
+}
+
 mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mg::Renderable const& renderable, geom::Displacement const& offset)
 {
@@ -46,3 +80,73 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
     return rectangle;
 }
+
+void mgl::tessellate_renderable_by_opacity(
+    std::vector<Primitive>& primitives,
+    mg::Renderable const& renderable,
+    geom::Displacement const& offset)
+{
+    auto const whole = renderable.screen_position();
+
+    std::vector<geom::Rectangle> opaque;
+    for (auto const& rect : renderable.opaque_region())
+    {
+        auto const visible = rect.intersection_with(whole);
+        if (visible.size.width > geom::Width{0} && visible.size.height > geom::Height{0})
+            opaque.push_back(visible);
+    }
+
+    if (opaque.empty() || opaque.size() > max_opaque_rectangles)
+    {
+        primitives.push_back(tessellate_renderable_into_rectangle(renderable, offset));
+        return;
+    }
+
+    // Cut along every edge of the opaque rectangles: each resulting cell is
+    // then either entirely inside one of them or outside all of them.
+    std::vector<geom::X> xs{whole.left(), whole.right()};
+    std::vector<geom::Y> ys{whole.top(), whole.bottom()};
+    for (auto const& rect : opaque)
+    {
+        xs.push_back(rect.left());
+        xs.push_back(rect.right());
+        ys.push_back(rect.top());
+        ys.push_back(rect.bottom());
+    }
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+    for (auto y = ys.begin(); std::next(y) != ys.end(); ++y)
+    {
+        auto const height = geom::Height{(*std::next(y) - *y).as_int()};
+
+        // Join neighbouring cells of the same opacity into one rectangle per run
+        auto run_start = xs.front();
+        bool run_opaque = false;
+
+        for (auto x = xs.begin(); std::next(x) != xs.end(); ++x)
+        {
+            geom::Rectangle const cell{{*x, *y}, {geom::Width{(*std::next(x) - *x).as_int()}, height}};
+            bool const cell_opaque = std::any_of(
+                opaque.begin(), opaque.end(),
+                [&cell](geom::Rectangle const& rect) { return rect.contains(cell); });
+
+            if (x == xs.begin())
+            {
+                run_opaque = cell_opaque;
+            }
+            else if (cell_opaque != run_opaque)
+            {
+                geom::Rectangle const run{{run_start, *y}, {geom::Width{(*x - run_start).as_int()}, height}};
+                primitives.push_back(rectangle_primitive(run, whole, offset, run_opaque));
+                run_start = *x;
+                run_opaque = cell_opaque;
+            }
+        }
+
+        geom::Rectangle const run{{run_start, *y}, {geom::Width{(xs.back() - run_start).as_int()}, height}};
+        primitives.push_back(rectangle_primitive(run, whole, offset, run_opaque));
+    }
+}
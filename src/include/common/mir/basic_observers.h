@@ -19,13 +19,13 @@
 #ifndef MIR_BASIC_OBSERVERS_H_
 #define MIR_BASIC_OBSERVERS_H_
 
-#include "mir/thread_safe_list.h"
+#include "mir/rcu_list.h"
 #include <memory>
 
 namespace mir
 {
 template<class Observer>
-class BasicObservers : protected ThreadSafeList<std::shared_ptr<Observer>>
+class BasicObservers : protected RcuList<std::shared_ptr<Observer>>
 {
 };
 }
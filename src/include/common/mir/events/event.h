@@ -25,6 +25,7 @@
 
 #include <capnp/message.h>
 
+#include <array>
 #include <cstring>
 
 struct MirEvent
@@ -76,7 +77,13 @@ struct MirEvent
 protected:
     MirEvent() = default;
 
-    ::capnp::MallocMessageBuilder message;
+    // Enough for any input event, so building or copying one doesn't need
+    // further allocations. Larger events (e.g. keymaps) spill onto the heap.
+    static size_t const inline_segment_words = 64;
+
+    // capnp requires the first segment to start zeroed
+    std::array<::capnp::word, inline_segment_words> inline_segment{};
+    ::capnp::MallocMessageBuilder message{kj::ArrayPtr<::capnp::word>{inline_segment.data(), inline_segment.size()}};
     mir::capnp::Event::Builder event{message.initRoot<mir::capnp::Event>()};
 };
 
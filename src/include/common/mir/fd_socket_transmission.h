@@ -19,6 +19,8 @@
 #ifndef MIR_FD_SOCKET_TRANSMISSION_H_
 #define MIR_FD_SOCKET_TRANSMISSION_H_
 #include "mir/fd.h"
+#include <sys/types.h>
+#include <sys/uio.h>
 #include <vector>
 #include <system_error>
 #include <stdexcept>
@@ -42,6 +44,8 @@ struct fd_reception_error : std::runtime_error
 
 bool socket_error_is_transient(int error_code);
 void send_fds(mir::Fd const& socket, std::vector<mir::Fd> const& fd);
+/// Sends iov, with fds (if any) attached as SCM_RIGHTS, in a single sendmsg(); returns what that returns
+ssize_t send_with_fds(mir::Fd const& socket, iovec* iov, size_t iov_count, std::vector<mir::Fd> const& fds, int flags);
 void receive_data(mir::Fd const& socket, void* buffer, size_t bytes_requested, std::vector<mir::Fd>& fds);
 }
 #endif /* MIR_FD_SOCKET_TRANSMISSION_H_ */
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_ASYNC_LOGGER_H_
+#define MIR_LOGGING_ASYNC_LOGGER_H_
+
+#include "mir/logging/logger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace logging
+{
+/**
+ * Passes messages on to another Logger from a thread of its own, so that logging threads
+ * don't wait on the terminal (or whatever the other Logger writes to).
+ *
+ * Each logging thread formats its messages into a ring buffer of its own, which needs no
+ * locking; the writer thread merges the rings in the order messages were logged. When a
+ * thread's ring is full its messages are dropped (and counted) rather than waiting, and the
+ * writer reports how many were dropped.
+ *
+ * Critical messages are only returned from once they've been written, as the process may be
+ * about to abort.
+ */
+class AsyncLogger : public Logger
+{
+public:
+    /// \param capacity  Messages each thread can have waiting to be written
+    explicit AsyncLogger(std::shared_ptr<Logger> const& next, size_t capacity = 256);
+
+    /// Writes any messages still waiting
+    ~AsyncLogger();
+
+    void log(Severity severity, std::string const& message, std::string const& component) override;
+    void log(char const* component, Severity severity, char const* format, ...) override
+        __attribute__ ((format (printf, 4, 5)));
+
+    /// Formats straight into this thread's ring (mir::logv() uses this when this is the logger)
+    void logv(Severity severity, char const* component, char const* format, va_list args);
+
+    /// Returns once every message logged before the call has been written
+    void flush();
+
+    /// The number of messages dropped because a thread's ring was full
+    auto dropped() const -> uint64_t;
+
+private:
+    struct Entry;
+    struct Ring;
+
+    std::shared_ptr<Logger> const next;
+    size_t const capacity;
+    uint64_t const id;
+    std::atomic<uint64_t> next_sequence{0};
+    std::atomic<uint64_t> dropped_count{0};
+
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable flushed_cv;
+    std::atomic<bool> wake_pending{false};
+    bool stopping{false};
+    uint64_t flushes_requested{0};
+    uint64_t flushes_done{0};
+
+    std::thread writer;
+
+    auto ring_for_this_thread() -> Ring&;
+    /// The next entry in this thread's ring, or nullptr if the ring is full
+    auto reserve(Severity severity, char const* component) -> Entry*;
+    /// Passes the reserved entry to the writer
+    void commit();
+    void wake_writer();
+    void write_messages();
+    void write_waiting_messages();
+};
+}
+}
+
+#endif // MIR_LOGGING_ASYNC_LOGGER_H_
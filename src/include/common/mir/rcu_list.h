@@ -0,0 +1,258 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RCU_LIST_H_
+#define MIR_RCU_LIST_H_
+
+#include "mir/rcu_ptr.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace detail
+{
+/// The list items this thread is currently calling for_each() functions with
+inline auto items_in_use_by_this_thread() -> std::vector<void const*>&
+{
+    static thread_local std::vector<void const*> items;
+    return items;
+}
+}
+
+/*
+ * A list that is iterated far more often than it is changed (e.g. observers).
+ *
+ * for_each() never takes a lock: it reads the current snapshot of the list (an immutable
+ * array of items, held in an RcuPtr) and only updates atomic counters. add(), remove() etc.
+ * publish a new snapshot and the old one is deleted once no for_each() is in progress.
+ *
+ * As with ThreadSafeList:
+ *  - an element removed during for_each() is not called afterwards in that iteration;
+ *  - remove() waits for other threads' calls on the element to finish, but may be
+ *    called on the element from within its own for_each() call.
+ * Unlike ThreadSafeList, an element added during for_each() is not seen by that iteration.
+ *
+ * Requirements for type 'Element'
+ *  - copy-constructible
+ *  - conversion to bool: indicates whether this is a valid element
+ *  - Element{}: value initialization should create an invalid element
+ *  - bool operator==: equality of elements
+ */
+template<class Element>
+class RcuList
+{
+public:
+    RcuList() = default;
+
+    void add(Element const& element);
+    void remove(Element const& element);
+    unsigned int remove_all(Element const& element);
+    void clear();
+
+    /// Calls f(Element const&) for each element
+    template<typename F>
+    void for_each(F&& f);
+
+    RcuList(RcuList const&) = delete;
+    RcuList& operator=(RcuList const&) = delete;
+
+private:
+    struct Item
+    {
+        explicit Item(Element const& element) : element{element} {}
+
+        Element element;
+        std::atomic<bool> removed{false};
+        std::atomic<bool> released{false};
+        std::atomic<unsigned> in_use{0};
+    };
+
+    using Snapshot = std::vector<std::shared_ptr<Item>>;
+
+    RcuPtr<Snapshot> snapshot;
+
+    std::mutex removal_mutex;
+    std::condition_variable removal_cv;
+
+    /// Publishes a snapshot of the items keep() accepts, plus added (if any)
+    template<typename Keep>
+    void update(Keep keep, std::vector<std::shared_ptr<Item>>& dropped, Element const* added);
+    void finish_removal(std::vector<std::shared_ptr<Item>> const& dropped);
+    void release_if_unused(Item& item);
+};
+
+template<class Element>
+template<typename F>
+void RcuList<Element>::for_each(F&& f)
+{
+    snapshot.read(
+        [&](Snapshot const* items)
+        {
+            if (!items)
+                return;
+
+            for (auto const& item : *items)
+            {
+                struct Use
+                {
+                    explicit Use(RcuList& list, Item& item) : list{list}, item{item} { item.in_use.fetch_add(1); }
+
+                    ~Use()
+                    {
+                        item.in_use.fetch_sub(1);
+                        if (item.removed.load())
+                        {
+                            { std::lock_guard<std::mutex> lock{list.removal_mutex}; }
+                            list.removal_cv.notify_all();
+                            list.release_if_unused(item);
+                        }
+                    }
+
+                    RcuList& list;
+                    Item& item;
+                } const use{*this, *item};
+
+                if (item->removed.load())
+                    continue;
+
+                auto& in_use_here = detail::items_in_use_by_this_thread();
+                in_use_here.push_back(item.get());
+                try
+                {
+                    f(static_cast<Element const&>(item->element));
+                }
+                catch (...)
+                {
+                    in_use_here.pop_back();
+                    throw;
+                }
+                in_use_here.pop_back();
+            }
+        });
+}
+
+template<class Element>
+void RcuList<Element>::add(Element const& element)
+{
+    std::vector<std::shared_ptr<Item>> dropped;
+    update([](Item const&) { return true; }, dropped, &element);
+}
+
+template<class Element>
+void RcuList<Element>::remove(Element const& element)
+{
+    std::vector<std::shared_ptr<Item>> dropped;
+    update(
+        [&, found = false](Item const& item) mutable
+        {
+            if (!found && item.element == element)
+            {
+                found = true;
+                return false;
+            }
+            return true;
+        },
+        dropped,
+        nullptr);
+    finish_removal(dropped);
+}
+
+template<class Element>
+unsigned int RcuList<Element>::remove_all(Element const& element)
+{
+    std::vector<std::shared_ptr<Item>> dropped;
+    update([&](Item const& item) { return !(item.element == element); }, dropped, nullptr);
+    finish_removal(dropped);
+    return dropped.size();
+}
+
+template<class Element>
+void RcuList<Element>::clear()
+{
+    std::vector<std::shared_ptr<Item>> dropped;
+    update([](Item const&) { return false; }, dropped, nullptr);
+    finish_removal(dropped);
+}
+
+template<class Element>
+template<typename Keep>
+void RcuList<Element>::update(Keep keep, std::vector<std::shared_ptr<Item>>& dropped, Element const* added)
+{
+    snapshot.update(
+        [&](Snapshot const* old_snapshot) -> std::unique_ptr<Snapshot>
+        {
+            auto new_snapshot = std::make_unique<Snapshot>();
+
+            if (old_snapshot)
+            {
+                new_snapshot->reserve(old_snapshot->size() + (added ? 1 : 0));
+                for (auto const& item : *old_snapshot)
+                {
+                    if (keep(*item))
+                    {
+                        new_snapshot->push_back(item);
+                    }
+                    else
+                    {
+                        item->removed.store(true);
+                        dropped.push_back(item);
+                    }
+                }
+            }
+
+            if (added && *added)
+                new_snapshot->push_back(std::make_shared<Item>(*added));
+            else if (dropped.empty())
+                return nullptr;
+
+            return new_snapshot;
+        });
+}
+
+template<class Element>
+void RcuList<Element>::finish_removal(std::vector<std::shared_ptr<Item>> const& dropped)
+{
+    auto const& in_use_here = detail::items_in_use_by_this_thread();
+
+    for (auto const& item : dropped)
+    {
+        // Calls on this thread are further up the stack, so can't be waited for
+        auto const own_uses = std::count(in_use_here.begin(), in_use_here.end(), item.get());
+
+        std::unique_lock<std::mutex> lock{removal_mutex};
+        removal_cv.wait(lock, [&] { return item->in_use.load() <= static_cast<unsigned>(own_uses); });
+        lock.unlock();
+
+        release_if_unused(*item);
+    }
+}
+
+/// Once a removed item is no longer being called the element is released, rather than with the snapshot
+template<class Element>
+void RcuList<Element>::release_if_unused(Item& item)
+{
+    if (item.in_use.load() == 0 && !item.released.exchange(true))
+        item.element = Element{};
+}
+}
+
+#endif /* MIR_RCU_LIST_H_ */
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RCU_PTR_H_
+#define MIR_RCU_PTR_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+/*
+ * An owning pointer to an immutable value that is read far more often than it is replaced.
+ *
+ * read() never takes a lock: it counts itself as a reader while it uses the current value.
+ * update() publishes a replacement (read-copy-update) and retires the value it replaced,
+ * which is deleted once no read() is in progress. Until then retired values accumulate,
+ * so this suits short reads.
+ */
+template<class T>
+class RcuPtr
+{
+public:
+    RcuPtr() = default;
+    ~RcuPtr();
+
+    /// Calls f(T const*) with the current value, or nullptr if none has been published
+    template<typename F>
+    void read(F&& f);
+
+    /**
+     * Calls replace(T const*) with the current value (or nullptr) and publishes what it returns.
+     *
+     * Updates are serialized, so replace() sees the latest value. If it returns nullptr the
+     * current value is kept.
+     */
+    template<typename Replace>
+    void update(Replace&& replace);
+
+    RcuPtr(RcuPtr const&) = delete;
+    RcuPtr& operator=(RcuPtr const&) = delete;
+
+private:
+    std::atomic<T*> current{nullptr};
+    std::atomic<unsigned> readers{0};
+
+    std::mutex update_mutex;    // Serializes updates and guards retired
+    std::vector<std::unique_ptr<T>> retired;
+    std::atomic<bool> have_retired{false};
+
+    void reclaim();
+};
+
+template<class T>
+RcuPtr<T>::~RcuPtr()
+{
+    delete current.load();
+}
+
+template<class T>
+template<typename F>
+void RcuPtr<T>::read(F&& f)
+{
+    struct ReadSection
+    {
+        explicit ReadSection(RcuPtr& ptr) : ptr{ptr} { ptr.readers.fetch_add(1); }
+
+        ~ReadSection()
+        {
+            if (ptr.readers.fetch_sub(1) == 1 && ptr.have_retired.load())
+            {
+                std::unique_lock<std::mutex> lock{ptr.update_mutex, std::try_to_lock};
+                if (lock.owns_lock())
+                    ptr.reclaim();
+            }
+        }
+
+        RcuPtr& ptr;
+    } const section{*this};
+
+    f(static_cast<T const*>(current.load()));
+}
+
+template<class T>
+template<typename Replace>
+void RcuPtr<T>::update(Replace&& replace)
+{
+    std::lock_guard<std::mutex> lock{update_mutex};
+
+    std::unique_ptr<T> replacement{replace(static_cast<T const*>(current.load()))};
+    if (!replacement)
+        return;
+
+    if (auto const replaced = current.exchange(replacement.release()))
+    {
+        retired.emplace_back(replaced);
+        have_retired.store(true);
+    }
+
+    reclaim();
+}
+
+/// Deletes retired values if no read() can still be using them. Requires update_mutex.
+template<class T>
+void RcuPtr<T>::reclaim()
+{
+    // Any read() that loaded a retired value has counted itself in readers before doing so,
+    // and any that starts after this check can only load the current value
+    if (readers.load() != 0)
+        return;
+
+    retired.clear();
+    have_retired.store(false);
+}
+}
+
+#endif /* MIR_RCU_PTR_H_ */
@@ -37,7 +37,7 @@ struct Primitive
     enum {max_vertices = 4};
 
     Primitive()
-        : type(GL_TRIANGLE_FAN), nvertices(4)
+        : type(GL_TRIANGLE_FAN), nvertices(4), opaque(false)
     {
         // Default is a quad. Just need to assign vertices[] and tex_id.
     }
@@ -45,6 +45,7 @@ struct Primitive
     GLenum type; // GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES etc
     int nvertices;
     Vertex vertices[max_vertices];
+    bool opaque; // lies within the renderable's opaque region, so needs no blending
 };
 }
 }
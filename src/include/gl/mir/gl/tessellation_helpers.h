@@ -21,6 +21,8 @@
 #include "mir/gl/primitive.h"
 #include "mir/geometry/displacement.h"
 
+#include <vector>
+
 namespace mir
 {
 namespace graphics { class Renderable; }
@@ -30,6 +32,16 @@ namespace gl
 Primitive tessellate_renderable_into_rectangle(
     graphics::Renderable const& renderable, geometry::Displacement const& offset);
 
+/**
+ * Like tessellate_renderable_into_rectangle(), but splits the rectangle into
+ * pieces that lie either entirely inside (marked opaque) or entirely outside
+ * the renderable's opaque region.
+ */
+void tessellate_renderable_by_opacity(
+    std::vector<Primitive>& primitives,
+    graphics::Renderable const& renderable,
+    geometry::Displacement const& offset);
+
 }
 }
 #endif /* MIR_GL_TESSELLATION_HELPERS_H_ */
@@ -36,7 +36,9 @@ extern char const* const session_mediator_report_opt;
 extern char const* const msg_processor_report_opt;
 extern char const* const shared_library_prober_report_opt;
 extern char const* const shell_report_opt;
+extern char const* const async_logging_opt;
 extern char const* const compositor_report_opt;
+extern char const* const compositor_metrics_opt;
 extern char const* const display_report_opt;
 extern char const* const legacy_input_report_opt;
 extern char const* const connector_report_opt;
@@ -50,10 +52,14 @@ extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const gl_batch_draws_opt;
+extern char const* const renderer_opt;
 extern char const* const enable_key_repeat_opt;
 extern char const* const x11_display_opt;
 extern char const* const wayland_extensions_opt;
 extern char const* const enable_mirclient_opt;
+extern char const* const client_buffer_memory_limit_opt;
+extern char const* const client_buffer_memory_policy_opt;
 
 extern char const* const name_opt;
 extern char const* const offscreen_opt;
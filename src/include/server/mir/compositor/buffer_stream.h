@@ -24,7 +24,9 @@
 #include "mir/frontend/buffer_stream.h"
 #include "mir_toolkit/common.h"
 #include "mir/graphics/buffer_id.h"
+#include "mir/geometry/rectangles.h"
 
+#include <experimental/optional>
 #include <memory>
 
 namespace mir
@@ -49,6 +51,15 @@ public:
     virtual void drop_old_buffers() = 0;
     virtual auto has_submitted_buffer() const -> bool = 0;
     virtual auto framedropping() const -> bool = 0;
+
+    /**
+     * The area (in buffer coordinates) in which the content of the buffer
+     * current differs from the earlier buffer previous. Both buffers must have
+     * been submitted to this stream. If the difference is unknown (e.g. previous
+     * is too old) returns nothing and the whole buffer should be assumed to differ.
+     */
+    virtual auto damage_between(graphics::BufferID previous, graphics::BufferID current) const
+        -> std::experimental::optional<geometry::Rectangles> = 0;
 };
 
 }
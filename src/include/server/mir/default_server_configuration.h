@@ -56,6 +56,7 @@ class Drawer;
 class DisplayBufferCompositorFactory;
 class Compositor;
 class CompositorReport;
+class PresentationObserver;
 }
 namespace frontend
 {
@@ -111,6 +112,7 @@ class SceneReport;
 class PromptSessionListener;
 class PromptSessionManager;
 class CoordinateTranslator;
+class BufferMemoryAccounting;
 }
 namespace graphics
 {
@@ -252,6 +254,8 @@ public:
     virtual std::shared_ptr<compositor::DisplayBufferCompositorFactory> the_display_buffer_compositor_factory();
     virtual std::shared_ptr<compositor::DisplayBufferCompositorFactory> wrap_display_buffer_compositor_factory(
         std::shared_ptr<compositor::DisplayBufferCompositorFactory> const& wrapped);
+    std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>>
+        the_presentation_observer_registrar();
     /** @} */
 
     /** @name compositor configuration - dependencies
@@ -328,6 +332,7 @@ public:
      *  @{ */
     virtual std::shared_ptr<scene::SessionCoordinator>  the_session_coordinator();
     virtual std::shared_ptr<scene::CoordinateTranslator> the_coordinate_translator();
+    virtual std::shared_ptr<scene::BufferMemoryAccounting> the_buffer_memory_accounting();
     /** @} */
 
 
@@ -377,6 +382,7 @@ protected:
     std::shared_ptr<graphics::nested::MirClientHostConnection>  the_mir_client_host_connection();
     std::shared_ptr<input::DefaultInputDeviceHub>  the_default_input_device_hub();
     std::shared_ptr<graphics::DisplayConfigurationObserver> the_display_configuration_observer();
+    std::shared_ptr<compositor::PresentationObserver> the_presentation_observer();
     std::shared_ptr<input::SeatObserver> the_seat_observer();
     std::shared_ptr<frontend::SessionMediatorObserver> the_session_mediator_observer();
 
@@ -459,6 +465,7 @@ protected:
     CachedPtr<scene::PromptSessionManager> prompt_session_manager;
     CachedPtr<scene::SessionCoordinator> session_coordinator;
     CachedPtr<scene::CoordinateTranslator> coordinate_translator;
+    CachedPtr<scene::BufferMemoryAccounting> buffer_memory_accounting;
     CachedPtr<EmergencyCleanup> emergency_cleanup;
     CachedPtr<shell::HostLifecycleEventListener> host_lifecycle_event_listener;
     CachedPtr<shell::PersistentSurfaceStore> persistent_surface_store;
@@ -476,6 +483,8 @@ private:
     std::shared_ptr<input::EventFilter> default_filter;
     CachedPtr<ObserverMultiplexer<graphics::DisplayConfigurationObserver>>
         display_configuration_observer_multiplexer;
+    CachedPtr<ObserverMultiplexer<compositor::PresentationObserver>>
+        presentation_observer_multiplexer;
     CachedPtr<ObserverMultiplexer<input::SeatObserver>>
         seat_observer_multiplexer;
     CachedPtr<ObserverMultiplexer<frontend::SessionMediatorObserver>>
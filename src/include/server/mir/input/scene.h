@@ -20,6 +20,8 @@
 #ifndef MIR_INPUT_INPUT_SCENE_H_
 #define MIR_INPUT_INPUT_SCENE_H_
 
+#include "mir/geometry/point.h"
+
 #include <memory>
 #include <functional>
 
@@ -45,6 +47,10 @@ public:
 
     virtual void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) = 0;
 
+    // The topmost surface whose input area contains point (or nullptr if there is none). This is
+    // called for every pointer event, so implementations should avoid visiting every surface.
+    virtual auto input_surface_at(geometry::Point point) -> std::shared_ptr<input::Surface> = 0;
+
     virtual void add_observer(std::shared_ptr<scene::Observer> const& observer) = 0;
     virtual void remove_observer(std::weak_ptr<scene::Observer> const& observer) = 0;
 
@@ -101,15 +101,47 @@ EGLint get_wl_egl_format(wl_resource* resource, mg::EGLExtensions::WaylandExtens
     return format;
 }
 
-class WaylandTexBuffer :
+/// Pretends to be the closest MirPixelFormat; external code only uses it to tell whether there's an alpha channel
+MirPixelFormat pixel_format_for(EGLint egl_format)
+{
+    /* TODO: These are lies, but the only piece of information external code uses
+     * out of the MirPixelFormat is whether or not the buffer has an alpha channel.
+     */
+    switch(egl_format)
+    {
+    case EGL_TEXTURE_RGB:
+        return mir_pixel_format_xrgb_8888;
+    case EGL_TEXTURE_RGBA:
+        return mir_pixel_format_argb_8888;
+    case EGL_TEXTURE_EXTERNAL_WL:
+        // Unspecified whether it has an alpha channel; say it does.
+        return mir_pixel_format_argb_8888;
+    case EGL_TEXTURE_Y_U_V_WL:
+    case EGL_TEXTURE_Y_UV_WL:
+        // These are just absolutely not RGB at all!
+        // But they're defined to not have an alpha channel, so xrgb it is!
+        return mir_pixel_format_xrgb_8888;
+    case EGL_TEXTURE_Y_XUXV_WL:
+        // This is a planar format, but *does* have alpha.
+        return mir_pixel_format_argb_8888;
+    default:
+        // We've covered all possibilities above
+        BOOST_THROW_EXCEPTION((std::logic_error{"Unexpected texture format!"}));
+    }
+}
+
+class EGLImageTexBuffer :
     public mg::BufferBasic,
     public mg::NativeBufferBase,
     public mg::gl::Texture
 {
 public:
     // Note: Must be called with a current EGL context
-    WaylandTexBuffer(
-        wl_resource* buffer,
+    EGLImageTexBuffer(
+        EGLImageKHR image,
+        geom::Size size,
+        Layout layout,
+        MirPixelFormat format,
         std::shared_ptr<mir::renderer::gl::Context> ctx,
         mg::EGLExtensions const& extensions,
         std::function<void()>&& on_consumed,
@@ -119,47 +151,23 @@ public:
           tex{get_tex_id()},
           on_consumed{std::move(on_consumed)},
           on_release{std::move(on_release)},
-          size_{get_wl_buffer_size(buffer, *extensions.wayland)},
-          layout_{get_texture_layout(buffer, *extensions.wayland)},
-          egl_format{get_wl_egl_format(buffer, *extensions.wayland)},
+          size_{size},
+          layout_{layout},
+          format{format},
           wayland_executor{std::move(wayland_executor)}
     {
-        if (egl_format != EGL_TEXTURE_RGB && egl_format != EGL_TEXTURE_RGBA)
-        {
-            BOOST_THROW_EXCEPTION((std::runtime_error{"YUV textures unimplemented"}));
-        }
         eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
 
-        const EGLint image_attrs[] =
-            {
-                EGL_IMAGE_PRESERVED_KHR, EGL_TRUE,
-                EGL_WAYLAND_PLANE_WL, 0,
-                EGL_NONE
-            };
-
-        auto egl_image = extensions.eglCreateImageKHR(
-            eglGetCurrentDisplay(),
-            EGL_NO_CONTEXT,
-            EGL_WAYLAND_BUFFER_WL,
-            buffer,
-            image_attrs);
-
-        if (egl_image == EGL_NO_IMAGE_KHR)
-            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGLImage"));
-
+        // tex becomes an EGLImage sibling, so the image may be freed without freeing the backing data
         glBindTexture(GL_TEXTURE_2D, tex);
-        extensions.glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, egl_image);
+        extensions.glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // tex is now an EGLImage sibling, so we can free the EGLImage without
-        // freeing the backing data.
-        extensions.eglDestroyImageKHR(eglGetCurrentDisplay(), egl_image);
     }
 
-    ~WaylandTexBuffer()
+    ~EGLImageTexBuffer()
     {
         wayland_executor->spawn(
             [context = ctx, tex = tex]()
@@ -186,30 +194,7 @@ public:
 
     MirPixelFormat pixel_format() const override
     {
-        /* TODO: These are lies, but the only piece of information external code uses
-         * out of the MirPixelFormat is whether or not the buffer has an alpha channel.
-         */
-        switch(egl_format)
-        {
-        case EGL_TEXTURE_RGB:
-            return mir_pixel_format_xrgb_8888;
-        case EGL_TEXTURE_RGBA:
-            return mir_pixel_format_argb_8888;
-        case EGL_TEXTURE_EXTERNAL_WL:
-            // Unspecified whether it has an alpha channel; say it does.
-            return mir_pixel_format_argb_8888;
-        case EGL_TEXTURE_Y_U_V_WL:
-        case EGL_TEXTURE_Y_UV_WL:
-            // These are just absolutely not RGB at all!
-            // But they're defined to not have an alpha channel, so xrgb it is!
-            return mir_pixel_format_xrgb_8888;
-        case EGL_TEXTURE_Y_XUXV_WL:
-            // This is a planar format, but *does* have alpha.
-            return mir_pixel_format_argb_8888;
-        default:
-            // We've covered all possibilities above
-            BOOST_THROW_EXCEPTION((std::logic_error{"Unexpected texture format!"}));
-        }
+        return format;
     }
 
     NativeBufferBase* native_buffer_base() override
@@ -257,7 +242,7 @@ private:
 
     geom::Size const size_;
     Layout const layout_;
-    EGLint const egl_format;
+    MirPixelFormat const format;
 
     std::shared_ptr<mir::Executor> const wayland_executor;
 };
@@ -286,11 +271,74 @@ auto mg::wayland::buffer_from_resource(
     mg::EGLExtensions const& extensions,
     std::shared_ptr<mir::Executor> wayland_executor) -> std::unique_ptr<mg::Buffer>
 {
-    return std::make_unique<WaylandTexBuffer>(
+    auto const egl_format = get_wl_egl_format(buffer, *extensions.wayland);
+    if (egl_format != EGL_TEXTURE_RGB && egl_format != EGL_TEXTURE_RGBA)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"YUV textures unimplemented"}));
+    }
+    auto const size = get_wl_buffer_size(buffer, *extensions.wayland);
+    auto const layout = get_texture_layout(buffer, *extensions.wayland);
+
+    const EGLint image_attrs[] =
+        {
+            EGL_IMAGE_PRESERVED_KHR, EGL_TRUE,
+            EGL_WAYLAND_PLANE_WL, 0,
+            EGL_NONE
+        };
+
+    auto egl_image = extensions.eglCreateImageKHR(
+        eglGetCurrentDisplay(),
+        EGL_NO_CONTEXT,
+        EGL_WAYLAND_BUFFER_WL,
         buffer,
-        ctx,
+        image_attrs);
+
+    if (egl_image == EGL_NO_IMAGE_KHR)
+        BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGLImage"));
+
+    std::unique_ptr<mg::Buffer> tex_buffer;
+    try
+    {
+        tex_buffer = buffer_from_image(
+            egl_image,
+            size,
+            layout,
+            pixel_format_for(egl_format),
+            std::move(on_consumed),
+            std::move(on_release),
+            std::move(ctx),
+            extensions,
+            std::move(wayland_executor));
+    }
+    catch (...)
+    {
+        extensions.eglDestroyImageKHR(eglGetCurrentDisplay(), egl_image);
+        throw;
+    }
+    extensions.eglDestroyImageKHR(eglGetCurrentDisplay(), egl_image);
+
+    return tex_buffer;
+}
+
+auto mg::wayland::buffer_from_image(
+    EGLImageKHR image,
+    geom::Size size,
+    gl::Texture::Layout layout,
+    MirPixelFormat format,
+    std::function<void()>&& on_consumed,
+    std::function<void()>&& on_release,
+    std::shared_ptr<mir::renderer::gl::Context> ctx,
+    mg::EGLExtensions const& extensions,
+    std::shared_ptr<mir::Executor> wayland_executor) -> std::unique_ptr<mg::Buffer>
+{
+    return std::make_unique<EGLImageTexBuffer>(
+        image,
+        size,
+        layout,
+        format,
+        std::move(ctx),
         extensions,
         std::move(on_consumed),
         std::move(on_release),
-        wayland_executor);
+        std::move(wayland_executor));
 }
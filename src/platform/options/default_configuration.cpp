@@ -34,6 +34,7 @@ char const* const mo::enable_input_opt            = "enable-input,i";
 char const* const mo::session_mediator_report_opt = "session-mediator-report";
 char const* const mo::msg_processor_report_opt    = "msg-processor-report";
 char const* const mo::compositor_report_opt       = "compositor-report";
+char const* const mo::compositor_metrics_opt      = "compositor-metrics-file";
 char const* const mo::display_report_opt          = "display-report";
 char const* const mo::legacy_input_report_opt     = "legacy-input-report";
 char const* const mo::connector_report_opt        = "connector-report";
@@ -42,6 +43,7 @@ char const* const mo::input_report_opt            = "input-report";
 char const* const mo::seat_report_opt            = "seat-report";
 char const* const mo::shared_library_prober_report_opt = "shared-library-prober-report";
 char const* const mo::shell_report_opt            = "shell-report";
+char const* const mo::async_logging_opt           = "async-logging";
 char const* const mo::host_socket_opt             = "host-socket";
 char const* const mo::nested_passthrough_opt      = "nested-passthrough";
 char const* const mo::name_opt                    = "name";
@@ -51,10 +53,14 @@ char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::gl_batch_draws_opt          = "gl-batch-draws";
+char const* const mo::renderer_opt                = "renderer";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
 char const* const mo::enable_mirclient_opt        = "enable-mirclient";
+char const* const mo::client_buffer_memory_limit_opt  = "client-buffer-memory-limit";
+char const* const mo::client_buffer_memory_policy_opt = "client-buffer-memory-policy";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
@@ -166,6 +172,13 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "Compositor reporting [{log,lttng,off}]")
+        (compositor_metrics_opt, po::value<std::string>(),
+            "File to keep updated (every second) with frame timing metrics "
+            "from the compositor, as JSON. Default: no metrics are collected.")
+        (async_logging_opt, po::value<bool>()->default_value(false),
+            "Write log messages from a thread of their own, so that logging doesn't "
+            "wait on the terminal. Messages are dropped (and counted) if they "
+            "are logged faster than they can be written.")
         (connector_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Connector report. [{log,lttng,off}]")
         (display_report_opt, po::value<std::string>()->default_value(off_opt_value),
@@ -191,6 +204,12 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (gl_batch_draws_opt, po::value<bool>()->default_value(false),
+            "Stream each frame's geometry into one vertex buffer and merge "
+            "draws that share GL state, reducing per-draw driver overhead.")
+        (renderer_opt, po::value<std::string>()->default_value("gl"),
+            "Renderer to composite with [{gl,software}]. Outputs that can't "
+            "be drawn to by the CPU use gl regardless.")
         (name_opt, po::value<std::string>(),
             "When nested, the name Mir uses when registering with the host.")
         (nested_passthrough_opt, po::value<bool>()->default_value(true),
@@ -210,6 +229,14 @@ mo::DefaultConfiguration::DefaultConfiguration(
         (debug_opt, "Enable extra development debugging. "
             "This is only interesting for people doing Mir server or client development.")
         (enable_mirclient_opt, "Enable deprecated mirclient socket (for running old clients)")
+        (client_buffer_memory_limit_opt, po::value<int>()->default_value(0),
+            "Megabytes of buffers the server will allocate for each mirclient client. "
+            "Default: 0, for no limit.")
+        (client_buffer_memory_policy_opt, po::value<std::string>()->default_value("evict"),
+            "What to do when a mirclient client would exceed --client-buffer-memory-limit "
+            "[{evict,reject}]. evict stops counting the least recently used buffers the client "
+            "has released but the server is still showing (rejecting the allocation if that isn't "
+            "enough); reject refuses the allocation.")
         (console_provider,
             po::value<std::string>()->default_value("auto"),
             "Console device handling\n"
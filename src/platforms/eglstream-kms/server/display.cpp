@@ -31,6 +31,7 @@
 #include "mir/graphics/virtual_output.h"
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/atomic_frame.h"
 #include "mir/graphics/transformation.h"
 #include "mir/renderer/gl/render_target.h"
 #include "mir/renderer/gl/context.h"
@@ -241,6 +242,11 @@ public:
         return transform;
     }
 
+    mg::Frame last_frame() const override
+    {
+        return last_frame_.load();
+    }
+
     mir::graphics::NativeDisplayBuffer* native_display_buffer() override
     {
         return this;
@@ -276,6 +282,9 @@ public:
         {
             BOOST_THROW_EXCEPTION(mg::egl_error("Failed to submit frame from EGLStream for display"));
         }
+
+        // The driver's flip events carry no usable counters (see above), so count posts instead
+        last_frame_.increment_now();
     }
 
     void bind() override
@@ -302,6 +311,7 @@ private:
     std::future<void> pending_flip;
     mg::EGLExtensions::NVStreamAttribExtensions nv_stream;
     std::shared_ptr<mg::DisplayReport> const display_report;
+    mg::AtomicFrame last_frame_;
 };
 
 mge::KMSDisplayConfiguration create_display_configuration(
@@ -25,6 +25,7 @@
 #include "display_helpers.h"
 #include "software_buffer.h"
 #include "gbm_format_conversions.h"
+#include "linux_dmabuf.h"
 #include "mir/graphics/egl_extensions.h"
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/buffer_properties.h"
@@ -47,6 +48,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <system_error>
+#include <type_traits>
 #include <gbm.h>
 #include <cassert>
 #include <fcntl.h>
@@ -257,6 +259,14 @@ mgm::BufferAllocator::BufferAllocator(
 {
 }
 
+mgm::BufferAllocator::~BufferAllocator()
+{
+    if (dmabuf_extension)
+    {
+        wl_list_remove(&display_destroyed.listener.link);
+    }
+}
+
 std::shared_ptr<mg::Buffer> mgm::BufferAllocator::alloc_buffer(
     BufferProperties const& buffer_properties)
 {
@@ -370,6 +380,30 @@ void mgm::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
 
     mg::wayland::bind_display(dpy, display, *egl_extensions);
 
+    try
+    {
+        dmabuf_extension = std::make_unique<LinuxDmaBufUnstable>(display, dpy, egl_extensions);
+
+        static_assert(
+            std::is_standard_layout<DisplayDestroyedListener>::value,
+            "DisplayDestroyedListener must be standard layout for wl_container_of to be defined behaviour");
+
+        display_destroyed.allocator = this;
+        display_destroyed.listener.notify = [](wl_listener* listener, void*)
+            {
+                DisplayDestroyedListener* self;
+                self = wl_container_of(listener, self, listener);
+
+                wl_list_remove(&self->listener.link);
+                self->allocator->dmabuf_extension.reset();
+            };
+        wl_display_add_destroy_listener(display, &display_destroyed.listener);
+    }
+    catch (std::runtime_error const& error)
+    {
+        mir::log_info("Cannot enable linux-dmabuf import: %s", error.what());
+    }
+
     this->wayland_executor = std::move(wayland_executor);
 }
 
@@ -382,6 +416,19 @@ std::shared_ptr<mg::Buffer> mgm::BufferAllocator::buffer_from_resource(
         [this]() { ctx->make_current(); },
         [this]() { ctx->release_current(); });
 
+    if (dmabuf_extension)
+    {
+        if (auto dmabuf = dmabuf_extension->buffer_from_resource(
+            buffer,
+            std::move(on_consumed),
+            std::move(on_release),
+            ctx,
+            wayland_executor))
+        {
+            return dmabuf;
+        }
+    }
+
     return mg::wayland::buffer_from_resource(
         buffer,
         std::move(on_consumed),
@@ -51,6 +51,7 @@ struct EGLExtensions;
 
 namespace mesa
 {
+class LinuxDmaBufUnstable;
 
 enum class BufferImportMethod
 {
@@ -68,6 +69,7 @@ public:
         gbm_device* device,
         BypassOption bypass_option,
         BufferImportMethod const buffer_import_method);
+    ~BufferAllocator();
 
     std::shared_ptr<Buffer> alloc_buffer(
         geometry::Size size, uint32_t native_format, uint32_t native_flags) override;
@@ -91,6 +93,16 @@ private:
 
     BypassOption const bypass_option;
     BufferImportMethod const buffer_import_method;
+
+    /// zwp_linux_dmabuf_v1, if the EGL implementation can import dmabufs
+    std::unique_ptr<LinuxDmaBufUnstable> dmabuf_extension;
+
+    /// The wl_display frees its globals, so dmabuf_extension must go first
+    struct DisplayDestroyedListener
+    {
+        wl_listener listener;
+        BufferAllocator* allocator;
+    } display_destroyed;
 };
 
 }
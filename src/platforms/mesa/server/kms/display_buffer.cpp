@@ -21,6 +21,7 @@
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
 #include "bypass.h"
+#include "plane_assigner.h"
 #include "gbm_buffer.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
@@ -48,6 +49,24 @@ namespace mgm = mir::graphics::mesa;
 namespace geom = mir::geometry;
 namespace mgmh = mir::graphics::mesa::helpers;
 
+namespace
+{
+/*
+ * How many frames the renderables must be steady for before scanning them out
+ * of planes; a few frames of compositing are cheaper than flip-flopping.
+ */
+unsigned const frames_before_plane_scanout{3};
+
+/// Whether showing layers takes more than a plain page flip to a fullscreen buffer
+bool needs_planes(std::vector<mgm::PlaneLayer> const& layers, geom::Size const& output_size)
+{
+    geom::Rectangle const whole_output{{0, 0}, output_size};
+
+    return layers.size() > 1 ||
+           (layers.size() == 1 && (layers.front().source != whole_output || layers.front().destination != whole_output));
+}
+}
+
 mgm::GBMOutputSurface::FrontBuffer::FrontBuffer()
     : surf{nullptr},
       bo{nullptr}
@@ -439,7 +458,8 @@ mgm::DisplayBuffer::DisplayBuffer(
       area(area),
       transform{transformation},
       needs_set_crtc{false},
-      page_flips_pending{false}
+      page_flips_pending{false},
+      plane_assigner{std::make_unique<PlaneAssigner>(frames_before_plane_scanout)}
 {
     listener->report_successful_setup_of_native_resources();
 
@@ -517,6 +537,15 @@ glm::mat2 mgm::DisplayBuffer::transformation() const
     return transform;
 }
 
+mg::Frame mgm::DisplayBuffer::last_frame() const
+{
+    /*
+     * In clone mode we don't wait for the page flip in post(), so this will
+     * be the previous frame until the next one is scheduled.
+     */
+    return outputs.front()->last_frame();
+}
+
 void mgm::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectangle const& a)
 {
     transform = t;
@@ -529,31 +558,76 @@ bool mgm::DisplayBuffer::overlay(RenderableList const& renderable_list)
     if (transform == no_transformation &&
        (bypass_option == mgm::BypassOption::allowed))
     {
+        /*
+         * Hardware planes are per-CRTC, so only try them when we're the only
+         * thing on the output (i.e. not in clone mode).
+         */
+        if (outputs.size() == 1 && outputs.front()->max_layers() > 0)
+            return assign_planes(renderable_list);
+
         mgm::BypassMatch bypass_match(area);
         auto bypass_it = std::find_if(renderable_list.rbegin(), renderable_list.rend(), bypass_match);
         if (bypass_it != renderable_list.rend())
         {
             auto bypass_buffer = (*bypass_it)->buffer();
-            auto native = std::dynamic_pointer_cast<mgm::NativeBuffer>(bypass_buffer->native_buffer_handle());
-            if (native && native->flags & mir_buffer_flag_can_scanout &&
-                bypass_buffer->size() == surface.size() &&
-                !needs_bounce_buffer(*outputs.front(), native->bo))
+            if (bypass_buffer->size() == surface.size())
             {
-                if (auto bufobj = outputs.front()->fb_for(native->bo))
+                if (auto bufobj = scanout_fb_for(*bypass_buffer))
                 {
-                    bypass_buf = bypass_buffer;
-                    bypass_bufobj = bufobj;
+                    bypass_bufs = {bypass_buffer};
+                    bypass_layers = {{bufobj, {{0, 0}, surface.size()}, {{0, 0}, surface.size()}}};
                     return true;
                 }
             }
         }
     }
 
-    bypass_buf = nullptr;
-    bypass_bufobj = nullptr;
+    plane_assigner->reset();
+    clear_bypass();
     return false;
 }
 
+auto mgm::DisplayBuffer::scanout_fb_for(Buffer& buffer) const -> FBHandle*
+{
+    auto native = std::dynamic_pointer_cast<mgm::NativeBuffer>(buffer.native_buffer_handle());
+    if (native && native->flags & mir_buffer_flag_can_scanout &&
+        !needs_bounce_buffer(*outputs.front(), native->bo))
+    {
+        return outputs.front()->fb_for(native->bo);
+    }
+
+    return nullptr;
+}
+
+bool mgm::DisplayBuffer::assign_planes(RenderableList const& renderable_list)
+{
+    // A modeset can only show a single unscaled buffer, so composite the frame that does it
+    if (needs_set_crtc)
+    {
+        plane_assigner->reset();
+        clear_bypass();
+        return false;
+    }
+
+    auto const& output = outputs.front();
+    auto assignment = plane_assigner->assign(
+        renderable_list,
+        area,
+        output->max_layers(),
+        [this](Buffer& buffer) { return scanout_fb_for(buffer); },
+        [&output](std::vector<PlaneLayer> const& layers) { return output->can_show(layers); });
+
+    bypass_bufs = std::move(assignment.buffers);
+    bypass_layers = std::move(assignment.layers);
+    return !bypass_layers.empty();
+}
+
+void mgm::DisplayBuffer::clear_bypass()
+{
+    bypass_bufs.clear();
+    bypass_layers.clear();
+}
+
 void mgm::DisplayBuffer::for_each_display_buffer(
     std::function<void(graphics::DisplayBuffer&)> const& f)
 {
@@ -563,8 +637,7 @@ void mgm::DisplayBuffer::for_each_display_buffer(
 void mgm::DisplayBuffer::swap_buffers()
 {
     surface.swap_buffers();
-    bypass_buf = nullptr;
-    bypass_bufobj = nullptr;
+    clear_bypass();
 }
 
 void mgm::DisplayBuffer::set_crtc(FBHandle const& forced_frame)
@@ -595,10 +668,10 @@ void mgm::DisplayBuffer::post()
      */
     wait_for_page_flip();
 
-    mgm::FBHandle *bufobj;
-    if (bypass_buf)
+    mgm::FBHandle const* bufobj;
+    if (!bypass_layers.empty())
     {
-        bufobj = bypass_bufobj;
+        bufobj = bypass_layers.front().fb;
     }
     else
     {
@@ -612,8 +685,15 @@ void mgm::DisplayBuffer::post()
      * Try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
      */
-    if (!needs_set_crtc && !schedule_page_flip(*bufobj))
-        needs_set_crtc = true;
+    if (!needs_set_crtc)
+    {
+        auto const scheduled = needs_planes(bypass_layers, surface.size()) ?
+            schedule_page_flip(bypass_layers) :
+            schedule_page_flip(*bufobj);
+
+        if (!scheduled)
+            needs_set_crtc = true;
+    }
 
     /*
      * Fallback blitting: Not pretty, since it may tear. VirtualBox seems
@@ -630,7 +710,7 @@ void mgm::DisplayBuffer::post()
     // Predicted worst case render time for the next frame...
     auto predicted_render_time = 50ms;
 
-    if (bypass_buf)
+    if (!bypass_bufs.empty())
     {
         /*
          * For composited frames we defer wait_for_page_flip till just before
@@ -641,7 +721,7 @@ void mgm::DisplayBuffer::post()
          * Also, bypass does not need the deferred page flip because it has
          * no compositing/rendering step for which to save time for.
          */
-        scheduled_bypass_frame = bypass_buf;
+        scheduled_bypass_frame = bypass_bufs;
         wait_for_page_flip();
 
         // It's very likely the next frame will be bypassed like this one so
@@ -668,8 +748,7 @@ void mgm::DisplayBuffer::post()
     }
 
     // Buffer lifetimes are managed exclusively by scheduled*/visible* now
-    bypass_buf = nullptr;
-    bypass_bufobj = nullptr;
+    clear_bypass();
 
     recommend_sleep = 0ms;
     if (outputs.size() == 1)
@@ -686,6 +765,17 @@ std::chrono::milliseconds mgm::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
+bool mgm::DisplayBuffer::schedule_page_flip(std::vector<PlaneLayer> const& layers)
+{
+    for (auto& output : outputs)
+    {
+        if (output->schedule_page_flip(layers))
+            page_flips_pending = true;
+    }
+
+    return page_flips_pending;
+}
+
 bool mgm::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
 {
     /*
@@ -711,13 +801,13 @@ void mgm::DisplayBuffer::wait_for_page_flip()
         page_flips_pending = false;
     }
 
-    if (scheduled_bypass_frame || scheduled_composite_frame)
+    if (!scheduled_bypass_frame.empty() || scheduled_composite_frame)
     {
         // Why are both of these grouped into a single statement?
         // Because in either case both types of frame need releasing each time.
 
-        visible_bypass_frame = scheduled_bypass_frame;
-        scheduled_bypass_frame = nullptr;
+        visible_bypass_frame = std::move(scheduled_bypass_frame);
+        scheduled_bypass_frame.clear();
 
         visible_composite_frame = std::move(scheduled_composite_frame);
         scheduled_composite_frame = nullptr;
@@ -24,6 +24,7 @@
 #include "mir/renderer/gl/render_target.h"
 #include "display_helpers.h"
 #include "egl_helper.h"
+#include "kms_output.h"
 #include "platform_common.h"
 
 #include <vector>
@@ -42,9 +43,8 @@ namespace mesa
 {
 
 class Platform;
-class FBHandle;
-class KMSOutput;
 class NativeBuffer;
+class PlaneAssigner;
 
 class GBMOutputSurface : public renderer::gl::RenderTarget
 {
@@ -120,6 +120,7 @@ public:
     std::chrono::milliseconds recommended_sleep() const override;
 
     glm::mat2 transformation() const override;
+    Frame last_frame() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
     void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a);
@@ -128,11 +129,19 @@ public:
 
 private:
     bool schedule_page_flip(FBHandle const& bufobj);
+    bool schedule_page_flip(std::vector<PlaneLayer> const& layers);
     void set_crtc(FBHandle const&);
+    FBHandle* scanout_fb_for(Buffer& buffer) const;
+    bool assign_planes(RenderableList const& renderable_list);
+    void clear_bypass();
 
-    std::shared_ptr<graphics::Buffer> visible_bypass_frame, scheduled_bypass_frame;
-    std::shared_ptr<Buffer> bypass_buf{nullptr};
-    FBHandle* bypass_bufobj{nullptr};
+    /*
+     * The buffers shown on hardware planes instead of compositing (bottom first);
+     * without atomic modesetting that's at most a single fullscreen buffer.
+     */
+    std::vector<std::shared_ptr<graphics::Buffer>> visible_bypass_frame, scheduled_bypass_frame;
+    std::vector<std::shared_ptr<Buffer>> bypass_bufs;
+    std::vector<PlaneLayer> bypass_layers;
     std::shared_ptr<DisplayReport> const listener;
     BypassOption bypass_option;
 
@@ -155,6 +164,7 @@ private:
     std::atomic<bool> needs_set_crtc;
     std::chrono::milliseconds recommend_sleep{0};
     bool page_flips_pending;
+    std::unique_ptr<PlaneAssigner> const plane_assigner;
 };
 
 }
@@ -22,6 +22,7 @@
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/frame.h"
 #include "mir_toolkit/common.h"
@@ -30,6 +31,8 @@
 
 #include <gbm.h>
 
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -41,6 +44,14 @@ namespace mesa
 
 class FBHandle;
 
+/// A framebuffer to show on a hardware plane
+struct PlaneLayer
+{
+    FBHandle const* fb;
+    geometry::Rectangle source;         ///< The region of fb to show
+    geometry::Rectangle destination;    ///< Where to show it, relative to the output
+};
+
 class KMSOutput
 {
 public:
@@ -69,6 +80,26 @@ public:
     virtual bool schedule_page_flip(FBHandle const& fb) = 0;
     virtual void wait_for_page_flip() = 0;
 
+    /**
+     * The most layers the output can show on hardware planes: its primary plane
+     * plus any overlay planes, or zero if it can't use atomic modesetting.
+     */
+    virtual size_t max_layers() const = 0;
+
+    /**
+     * Check (with a test-only atomic commit) whether the hardware can show layers.
+     *
+     * \param [in] layers  Bottom first; the bottom layer goes on the primary plane
+     */
+    virtual bool can_show(std::vector<PlaneLayer> const& layers) = 0;
+
+    /**
+     * Schedule an atomic page flip to layers, as accepted by can_show().
+     *
+     * Wait for it with wait_for_page_flip(), as for any other page flip.
+     */
+    virtual bool schedule_page_flip(std::vector<PlaneLayer> const& layers) = 0;
+
     virtual bool set_cursor(gbm_bo* buffer) = 0;
     virtual void move_cursor(geometry::Point destination) = 0;
     virtual bool clear_cursor() = 0;
@@ -64,6 +64,44 @@ mgm::KMSPageFlipper::KMSPageFlipper(
 bool mgm::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
                                         uint32_t fb_id,
                                         uint32_t connector_id)
+{
+    /*
+     * It appears we can't tell the difference between flipping being
+     * unsupported or failing for other reasons. On VirtualBox this always
+     * fails with -22 (Invalid argument) despite the arguments being
+     * apparently valid.
+     */
+    return schedule(
+        crtc_id,
+        connector_id,
+        [this, crtc_id, fb_id](void* event_data)
+        {
+            return drmModePageFlip(drm_fd, crtc_id, fb_id, DRM_MODE_PAGE_FLIP_EVENT, event_data);
+        });
+}
+
+bool mgm::KMSPageFlipper::schedule_atomic_flip(uint32_t crtc_id,
+                                               drmModeAtomicReq* request,
+                                               uint32_t connector_id)
+{
+    /*
+     * The kernel delivers the completion of an atomic commit as a page flip
+     * event carrying our data, so waiting for it works as for a legacy flip.
+     */
+    return schedule(
+        crtc_id,
+        connector_id,
+        [this, request](void* event_data)
+        {
+            return drmModeAtomicCommit(
+                drm_fd, request, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, event_data);
+        });
+}
+
+bool mgm::KMSPageFlipper::schedule(
+    uint32_t crtc_id,
+    uint32_t connector_id,
+    std::function<int(void* event_data)> const& flip)
 {
     std::unique_lock<std::mutex> lock{pf_mutex};
 
@@ -72,15 +110,7 @@ bool mgm::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
 
     pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this};
 
-    /*
-     * It appears we can't tell the difference between flipping being
-     * unsupported or failing for other reasons. On VirtualBox this always
-     * fails with -22 (Invalid argument) despite the arguments being
-     * apparently valid.
-     */
-    auto ret = drmModePageFlip(drm_fd, crtc_id, fb_id,
-                               DRM_MODE_PAGE_FLIP_EVENT,
-                               &pending_page_flips[crtc_id]);
+    auto ret = flip(&pending_page_flips[crtc_id]);
 
     if (ret)
         pending_page_flips.erase(crtc_id);
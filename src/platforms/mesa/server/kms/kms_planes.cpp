@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kms_planes.h"
+#include "kms-utils/drm_mode_resources.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace mgm = mir::graphics::mesa;
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+uint32_t crtc_mask_for(int drm_fd, uint32_t crtc_id)
+{
+    mgk::DRMModeResources resources{drm_fd};
+
+    uint32_t mask{1};
+    for (auto const& crtc : resources.crtcs())
+    {
+        if (crtc->crtc_id == crtc_id)
+            return mask;
+        mask <<= 1;
+    }
+
+    BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to find index of CRTC " + std::to_string(crtc_id)});
+}
+
+/*
+ * Primary planes are often usable with any CRTC, so the first compatible one isn't
+ * necessarily ours: two outputs would fight over it. Prefer the plane already driving
+ * the CRTC, then the one the kernel created for it (primary planes are created in CRTC
+ * order).
+ */
+uint32_t primary_plane_for(int drm_fd, uint32_t crtc_id)
+{
+    auto const crtc_mask = crtc_mask_for(drm_fd, crtc_id);
+    mgk::PlaneResources const plane_resources{drm_fd};
+
+    uint32_t at_crtc_index{0};
+    uint32_t first_compatible{0};
+    uint32_t primary_mask{1};
+
+    for (auto const& plane : plane_resources.planes())
+    {
+        mgk::ObjectProperties const props{drm_fd, plane};
+        if (props["type"] != DRM_PLANE_TYPE_PRIMARY)
+            continue;
+
+        auto const index_mask = primary_mask;
+        primary_mask <<= 1;
+
+        if (!(plane->possible_crtcs & crtc_mask))
+            continue;
+
+        if (plane->crtc_id == crtc_id)
+            return plane->plane_id;
+
+        if (index_mask == crtc_mask)
+            at_crtc_index = plane->plane_id;
+
+        if (!first_compatible)
+            first_compatible = plane->plane_id;
+    }
+
+    if (at_crtc_index)
+        return at_crtc_index;
+
+    if (first_compatible)
+        return first_compatible;
+
+    BOOST_THROW_EXCEPTION(std::runtime_error{"Could not find primary plane for CRTC " + std::to_string(crtc_id)});
+}
+
+std::vector<uint32_t> overlay_planes_for(int drm_fd, uint32_t crtc_id)
+{
+    auto const crtc_mask = crtc_mask_for(drm_fd, crtc_id);
+
+    mgk::PlaneResources const plane_resources{drm_fd};
+
+    std::vector<std::pair<uint64_t, uint32_t>> zpos_and_id;
+    bool all_have_zpos{true};
+
+    for (auto const& plane : plane_resources.planes())
+    {
+        if (plane->possible_crtcs != crtc_mask)
+            continue;
+
+        mgk::ObjectProperties const props{drm_fd, plane};
+        if (props["type"] != DRM_PLANE_TYPE_OVERLAY)
+            continue;
+
+        all_have_zpos = all_have_zpos && props.has_property("zpos");
+        zpos_and_id.emplace_back(props.has_property("zpos") ? props["zpos"] : 0, plane->plane_id);
+    }
+
+    /*
+     * Without zpos we can't know how the overlays stack relative to each other,
+     * only that they're all above the primary plane; so stick to one of them.
+     */
+    if (!all_have_zpos && zpos_and_id.size() > 1)
+        zpos_and_id.resize(1);
+
+    std::stable_sort(zpos_and_id.begin(), zpos_and_id.end());
+
+    std::vector<uint32_t> ids;
+    for (auto const& overlay : zpos_and_id)
+        ids.push_back(overlay.second);
+    return ids;
+}
+}
+
+mgm::KMSPlanes::Plane::Plane(int drm_fd, uint32_t id)
+    : id{id}
+{
+    mgk::ObjectProperties const props{drm_fd, id, DRM_MODE_OBJECT_PLANE};
+
+    fb_id_prop = props.id_for("FB_ID");
+    crtc_id_prop = props.id_for("CRTC_ID");
+    src_x_prop = props.id_for("SRC_X");
+    src_y_prop = props.id_for("SRC_Y");
+    src_w_prop = props.id_for("SRC_W");
+    src_h_prop = props.id_for("SRC_H");
+    crtc_x_prop = props.id_for("CRTC_X");
+    crtc_y_prop = props.id_for("CRTC_Y");
+    crtc_w_prop = props.id_for("CRTC_W");
+    crtc_h_prop = props.id_for("CRTC_H");
+}
+
+void mgm::KMSPlanes::Plane::add_layer(drmModeAtomicReq* request, uint32_t crtc_id, Layer const& layer) const
+{
+    /* Source coordinates are 16.16 fixed point */
+    drmModeAtomicAddProperty(request, id, src_x_prop, uint64_t(layer.source.top_left.x.as_int()) << 16);
+    drmModeAtomicAddProperty(request, id, src_y_prop, uint64_t(layer.source.top_left.y.as_int()) << 16);
+    drmModeAtomicAddProperty(request, id, src_w_prop, uint64_t(layer.source.size.width.as_uint32_t()) << 16);
+    drmModeAtomicAddProperty(request, id, src_h_prop, uint64_t(layer.source.size.height.as_uint32_t()) << 16);
+
+    /* ...destination coordinates are not (and CRTC_X/Y are signed) */
+    drmModeAtomicAddProperty(request, id, crtc_x_prop, layer.destination.top_left.x.as_int());
+    drmModeAtomicAddProperty(request, id, crtc_y_prop, layer.destination.top_left.y.as_int());
+    drmModeAtomicAddProperty(request, id, crtc_w_prop, layer.destination.size.width.as_uint32_t());
+    drmModeAtomicAddProperty(request, id, crtc_h_prop, layer.destination.size.height.as_uint32_t());
+
+    drmModeAtomicAddProperty(request, id, fb_id_prop, layer.fb_id);
+    drmModeAtomicAddProperty(request, id, crtc_id_prop, crtc_id);
+}
+
+void mgm::KMSPlanes::Plane::add_disabled(drmModeAtomicReq* request) const
+{
+    drmModeAtomicAddProperty(request, id, fb_id_prop, 0);
+    drmModeAtomicAddProperty(request, id, crtc_id_prop, 0);
+}
+
+mgm::KMSPlanes::KMSPlanes(int drm_fd, uint32_t crtc_id)
+    : crtc_id{crtc_id},
+      primary{drm_fd, primary_plane_for(drm_fd, crtc_id)}
+{
+    for (auto const id : overlay_planes_for(drm_fd, crtc_id))
+        overlays.emplace_back(drm_fd, id);
+}
+
+size_t mgm::KMSPlanes::max_layers() const
+{
+    return 1 + overlays.size();
+}
+
+void mgm::KMSPlanes::add_layers(drmModeAtomicReq* request, std::vector<Layer> const& layers) const
+{
+    if (layers.empty() || layers.size() > max_layers())
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error{
+            "Can't show " + std::to_string(layers.size()) + " layers on " +
+            std::to_string(max_layers()) + " planes"});
+    }
+
+    primary.add_layer(request, crtc_id, layers.front());
+
+    for (auto overlay = 0u; overlay != overlays.size(); ++overlay)
+    {
+        if (overlay + 1 < layers.size())
+            overlays[overlay].add_layer(request, crtc_id, layers[overlay + 1]);
+        else
+            overlays[overlay].add_disabled(request);
+    }
+}
+
+void mgm::KMSPlanes::add_overlays_disabled(drmModeAtomicReq* request) const
+{
+    for (auto const& overlay : overlays)
+        overlay.add_disabled(request);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_KMS_PLANES_H_
+#define MIR_GRAPHICS_MESA_KMS_PLANES_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <xf86drmMode.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+
+/**
+ * The hardware planes a CRTC scans out from, driven by atomic modesetting
+ *
+ * The primary plane shows the bottom layer and the overlay planes any layers
+ * above it. Cursor planes are left to the legacy cursor ioctls (which the
+ * kernel maps onto them), and overlay planes that other CRTCs could also use
+ * are left alone, so that outputs never contend for a plane.
+ */
+class KMSPlanes
+{
+public:
+    struct Layer
+    {
+        uint32_t fb_id;
+        geometry::Rectangle source;         ///< The region of the framebuffer to show
+        geometry::Rectangle destination;    ///< Where to show it, relative to the CRTC
+    };
+
+    /**
+     * \throws std::system_error if the planes can't be queried (e.g. the kernel
+     *                           or driver lacks atomic modesetting)
+     * \throws std::runtime_error if crtc_id has no primary plane
+     */
+    KMSPlanes(int drm_fd, uint32_t crtc_id);
+
+    /// The most layers add_layers() can show: the primary plane plus the usable overlays
+    size_t max_layers() const;
+
+    /**
+     * Adds the properties showing layers (bottom first) to request, disabling any
+     * overlay planes left over.
+     *
+     * \throws std::logic_error if there are more than max_layers() layers
+     */
+    void add_layers(drmModeAtomicReq* request, std::vector<Layer> const& layers) const;
+
+    /// Adds the properties disabling the overlay planes to request
+    void add_overlays_disabled(drmModeAtomicReq* request) const;
+
+private:
+    struct Plane
+    {
+        Plane(int drm_fd, uint32_t id);
+
+        void add_layer(drmModeAtomicReq* request, uint32_t crtc_id, Layer const& layer) const;
+        void add_disabled(drmModeAtomicReq* request) const;
+
+        uint32_t id;
+        uint32_t fb_id_prop, crtc_id_prop;
+        uint32_t src_x_prop, src_y_prop, src_w_prop, src_h_prop;
+        uint32_t crtc_x_prop, crtc_y_prop, crtc_w_prop, crtc_h_prop;
+    };
+
+    uint32_t const crtc_id;
+    Plane const primary;
+    std::vector<Plane> overlays;    ///< Bottom first
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_KMS_PLANES_H_ */
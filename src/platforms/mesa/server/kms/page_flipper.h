@@ -22,6 +22,8 @@
 #include "mir/graphics/frame.h"
 #include <cstdint>
 
+typedef struct _drmModeAtomicReq drmModeAtomicReq;
+
 namespace mir
 {
 namespace graphics
@@ -35,6 +37,8 @@ public:
     virtual ~PageFlipper() {}
 
     virtual bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /// Commits request (which must update crtc_id) as a non-blocking atomic page flip
+    virtual bool schedule_atomic_flip(uint32_t crtc_id, drmModeAtomicReq* request, uint32_t connector_id) = 0;
     virtual Frame wait_for_flip(uint32_t crtc_id) = 0;
 
 protected:
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "plane_assigner.h"
+#include "mir/graphics/buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mg = mir::graphics;
+namespace mgm = mir::graphics::mesa;
+namespace geom = mir::geometry;
+
+namespace
+{
+bool is_opaque(mg::Renderable const& renderable)
+{
+    return renderable.alpha() == 1.0f && !renderable.shaped();
+}
+
+/// Scales an offset within position to the matching offset within the buffer
+int to_buffer(int offset, int buffer_extent, int position_extent)
+{
+    return static_cast<int>(std::lround(static_cast<double>(offset) * buffer_extent / position_extent));
+}
+
+/// The region of a buffer, stretched over position, that shows in visible
+geom::Rectangle source_for(geom::Size const& buffer_size, geom::Rectangle const& position, geom::Rectangle const& visible)
+{
+    auto const buffer_width = buffer_size.width.as_int();
+    auto const buffer_height = buffer_size.height.as_int();
+    auto const position_width = position.size.width.as_int();
+    auto const position_height = position.size.height.as_int();
+
+    auto const left = to_buffer((visible.left() - position.left()).as_int(), buffer_width, position_width);
+    auto const top = to_buffer((visible.top() - position.top()).as_int(), buffer_height, position_height);
+    auto const right = to_buffer((visible.right() - position.left()).as_int(), buffer_width, position_width);
+    auto const bottom = to_buffer((visible.bottom() - position.top()).as_int(), buffer_height, position_height);
+
+    return {{left, top}, {right - left, bottom - top}};
+}
+}
+
+bool mgm::PlaneAssigner::Placement::operator==(Placement const& other) const
+{
+    return id == other.id && source == other.source && destination == other.destination;
+}
+
+mgm::PlaneAssigner::PlaneAssigner(unsigned stable_frames)
+    : stable_frames{stable_frames}
+{
+}
+
+auto mgm::PlaneAssigner::assign(
+    RenderableList const& renderables,
+    geom::Rectangle const& area,
+    size_t max_layers,
+    ScanoutFB const& scanout_fb,
+    LayerCheck const& can_show) -> Assignment
+{
+    glm::mat4 const identity(1);
+
+    // Collected top first, as that's the order we find out what's hidden
+    std::vector<Placement> placements;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    std::vector<FBHandle const*> fbs;
+    bool bottom_is_opaque{false};
+
+    for (auto renderable = renderables.rbegin(); renderable != renderables.rend(); ++renderable)
+    {
+        auto const position = (*renderable)->screen_position();
+        auto visible = position.intersection_with(area);
+        if (auto const clip = (*renderable)->clip_area())
+            visible = visible.intersection_with(*clip);
+
+        // Offscreen (or clipped away) renderables don't need a plane
+        if (visible.size.width == geom::Width{} || visible.size.height == geom::Height{})
+            continue;
+
+        /*
+         * Planes can scale, but not (portably) rotate or fade what they show;
+         * per-pixel alpha is fine, as overlays blend with what's below them.
+         */
+        if (placements.size() == max_layers ||
+            (*renderable)->alpha() != 1.0f ||
+            (*renderable)->transformation() != identity)
+        {
+            reset();
+            return {};
+        }
+
+        auto const buffer = (*renderable)->buffer();
+        auto const source = source_for(buffer->size(), position, visible);
+        auto const fb = scanout_fb(*buffer);
+        if (!fb || source.size.width == geom::Width{} || source.size.height == geom::Height{})
+        {
+            reset();
+            return {};
+        }
+
+        placements.push_back({(*renderable)->id(), source, {geom::Point{} + (visible.top_left - area.top_left), visible.size}});
+        buffers.push_back(buffer);
+        fbs.push_back(fb);
+        bottom_is_opaque = is_opaque(**renderable);
+
+        // Nothing under an opaque renderable filling the output shows
+        if (bottom_is_opaque && visible == area)
+            break;
+    }
+
+    if (placements.empty() || !bottom_is_opaque)
+    {
+        reset();
+        return {};
+    }
+
+    std::reverse(placements.begin(), placements.end());
+    std::reverse(buffers.begin(), buffers.end());
+    std::reverse(fbs.begin(), fbs.end());
+
+    if (placements == candidate)
+    {
+        ++candidate_frames;
+    }
+    else
+    {
+        candidate = placements;
+        candidate_frames = 1;
+    }
+
+    // Once on the planes we stay on them while the hardware agrees; getting there takes a steady scene
+    if ((!on_planes && candidate_frames < stable_frames) || placements == rejected)
+    {
+        on_planes = false;
+        return {};
+    }
+
+    std::vector<PlaneLayer> layers;
+    for (auto i = 0u; i != placements.size(); ++i)
+        layers.push_back({fbs[i], placements[i].source, placements[i].destination});
+
+    if (!can_show(layers))
+    {
+        rejected = placements;
+        on_planes = false;
+        return {};
+    }
+
+    on_planes = true;
+    return {std::move(buffers), std::move(layers)};
+}
+
+void mgm::PlaneAssigner::reset()
+{
+    candidate.clear();
+    candidate_frames = 0;
+    on_planes = false;
+}
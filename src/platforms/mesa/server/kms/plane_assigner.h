@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_PLANE_ASSIGNER_H_
+#define MIR_GRAPHICS_MESA_PLANE_ASSIGNER_H_
+
+#include "kms_output.h"
+#include "mir/graphics/renderable.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+
+namespace mesa
+{
+
+/**
+ * Decides which renderables to scan out of hardware planes rather than composite
+ *
+ * This generalises BypassMatch to several planes: the renderables visible on
+ * the output go on the planes bottom up, scaled and clipped by the planes'
+ * source and destination rectangles, but only if all of them can. The bottom
+ * one needn't cover the output (the rest is black, as when compositing) but
+ * it must be opaque, as the primary plane has nothing to blend with.
+ *
+ * A candidate assignment has to be unchanged for a few frames before it goes
+ * on the planes, and one the hardware rejected isn't tried again until it
+ * changes. That stops e.g. a window being dragged across a fullscreen one from
+ * flipping the output between compositing and scanout every frame.
+ *
+ * The cursor isn't assigned: the hardware cursor is already above all of this.
+ */
+class PlaneAssigner
+{
+public:
+    /// The framebuffer to scan buffer out of, or nullptr if it can't be scanned out
+    using ScanoutFB = std::function<FBHandle const*(Buffer& buffer)>;
+    /// Whether the planes can show layers (as KMSOutput::can_show())
+    using LayerCheck = std::function<bool(std::vector<PlaneLayer> const& layers)>;
+
+    struct Assignment
+    {
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        std::vector<PlaneLayer> layers;     ///< Bottom first; empty if the renderables need compositing
+    };
+
+    /// \param [in] stable_frames  The frames a candidate must be unchanged for before it's used
+    explicit PlaneAssigner(unsigned stable_frames);
+
+    /**
+     * Assign renderables (as for DisplayBuffer::overlay()) to planes, once per frame.
+     *
+     * \param [in] area        The output's area; layer destinations are relative to it
+     * \param [in] max_layers  The layers the planes can show (as KMSOutput::max_layers())
+     */
+    auto assign(
+        RenderableList const& renderables,
+        geometry::Rectangle const& area,
+        size_t max_layers,
+        ScanoutFB const& scanout_fb,
+        LayerCheck const& can_show) -> Assignment;
+
+    /// Forget the candidates seen so far, e.g. because the renderables are being composited anyway
+    void reset();
+
+private:
+    struct Placement
+    {
+        Renderable::ID id;
+        geometry::Rectangle source;
+        geometry::Rectangle destination;
+
+        bool operator==(Placement const& other) const;
+    };
+
+    unsigned const stable_frames;
+
+    std::vector<Placement> candidate;
+    unsigned candidate_frames{0};
+    bool on_planes{false};
+    std::vector<Placement> rejected;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_PLANE_ASSIGNER_H_ */
@@ -19,6 +19,7 @@
 #include "real_kms_output.h"
 #include "mir/graphics/display_configuration.h"
 #include "page_flipper.h"
+#include "kms_planes.h"
 #include "kms-utils/kms_connector.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
@@ -69,6 +70,11 @@ void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
     delete bufobj;
 }
 
+bool enable_atomic_modesetting(int drm_fd)
+{
+    /* Client capabilities are per-fd and idempotent, so each output can just ask */
+    return drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+}
 }
 
 mgm::RealKMSOutput::RealKMSOutput(
@@ -80,6 +86,7 @@ mgm::RealKMSOutput::RealKMSOutput(
       connector{std::move(connector)},
       mode_index{0},
       current_crtc(),
+      atomic_modesetting{enable_atomic_modesetting(drm_fd)},
       saved_crtc(),
       using_saved_crtc{true},
       has_cursor_{false},
@@ -140,6 +147,7 @@ void mgm::RealKMSOutput::reset()
 
     /* Discard previously current crtc */
     current_crtc = nullptr;
+    planes = nullptr;
 }
 
 geom::Size mgm::RealKMSOutput::size() const
@@ -179,9 +187,13 @@ bool mgm::RealKMSOutput::set_crtc(FBHandle const& fb)
     if (ret)
     {
         current_crtc = nullptr;
+        planes = nullptr;
         return false;
     }
 
+    /* Setting the CRTC only replaces the primary plane */
+    clear_overlays();
+
     using_saved_crtc = false;
     return true;
 }
@@ -205,6 +217,7 @@ void mgm::RealKMSOutput::clear_crtc()
 
     auto result = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                                  0, 0, 0, nullptr, 0, nullptr);
+    planes = nullptr;
     if (result)
     {
         if (result == -EACCES || result == -EPERM)
@@ -233,6 +246,10 @@ void mgm::RealKMSOutput::clear_crtc()
 
 bool mgm::RealKMSOutput::schedule_page_flip(FBHandle const& fb)
 {
+    /* If we can, flip atomically: that also takes down any overlays from the last frame */
+    if (planes)
+        return schedule_page_flip(std::vector<PlaneLayer>{whole_output_layer(fb)});
+
     std::unique_lock<std::mutex> lg(power_mutex);
     if (power_mode != mir_power_mode_on)
         return true;
@@ -262,6 +279,39 @@ void mgm::RealKMSOutput::wait_for_page_flip()
     last_frame_.store(page_flipper->wait_for_flip(current_crtc->crtc_id));
 }
 
+size_t mgm::RealKMSOutput::max_layers() const
+{
+    return planes ? planes->max_layers() : 0;
+}
+
+bool mgm::RealKMSOutput::can_show(std::vector<PlaneLayer> const& layers)
+{
+    if (!current_crtc || !planes || layers.empty() || layers.size() > planes->max_layers())
+        return false;
+
+    auto const request = atomic_request_for(layers);
+    return drmModeAtomicCommit(drm_fd_, request.get(), DRM_MODE_ATOMIC_TEST_ONLY, nullptr) == 0;
+}
+
+bool mgm::RealKMSOutput::schedule_page_flip(std::vector<PlaneLayer> const& layers)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!current_crtc || !planes)
+    {
+        mir::log_error("Output %s has no associated CRTC planes to schedule page flips on",
+                       mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    auto const request = atomic_request_for(layers);
+    return page_flipper->schedule_atomic_flip(
+        current_crtc->crtc_id,
+        request.get(),
+        connector->connector_id);
+}
+
 mg::Frame mgm::RealKMSOutput::last_frame() const
 {
     return last_frame_.load();
@@ -335,15 +385,72 @@ bool mgm::RealKMSOutput::ensure_crtc()
         return false;
 
     current_crtc = mgk::find_crtc_for_connector(drm_fd_, connector);
-
+    update_planes();
 
     return (current_crtc != nullptr);
 }
 
+void mgm::RealKMSOutput::update_planes()
+{
+    planes = nullptr;
+
+    if (!current_crtc || !atomic_modesetting)
+        return;
+
+    try
+    {
+        planes = std::make_unique<KMSPlanes>(drm_fd_, current_crtc->crtc_id);
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_info("Output %s can't use hardware planes, so won't use atomic modesetting: %s",
+                      mgk::connector_name(connector).c_str(), error.what());
+    }
+}
+
+void mgm::RealKMSOutput::clear_overlays()
+{
+    if (!planes || planes->max_layers() == 1)
+        return;
+
+    std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReq*)> request{
+        drmModeAtomicAlloc(),
+        &drmModeAtomicFree};
+    planes->add_overlays_disabled(request.get());
+
+    if (auto const result = drmModeAtomicCommit(drm_fd_, request.get(), 0, nullptr))
+    {
+        mir::log_warning("Failed to clear overlay planes of output %s (%s)",
+                         mgk::connector_name(connector).c_str(), strerror(-result));
+    }
+}
+
+auto mgm::RealKMSOutput::whole_output_layer(FBHandle const& fb) const -> PlaneLayer
+{
+    return {&fb, {geom::Point{} + fb_offset, size()}, {{0, 0}, size()}};
+}
+
+auto mgm::RealKMSOutput::atomic_request_for(std::vector<PlaneLayer> const& layers) const
+    -> std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReq*)>
+{
+    std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReq*)> request{
+        drmModeAtomicAlloc(),
+        &drmModeAtomicFree};
+
+    std::vector<KMSPlanes::Layer> kms_layers;
+    for (auto const& layer : layers)
+        kms_layers.push_back({layer.fb->get_drm_fb_id(), layer.source, layer.destination});
+
+    planes->add_layers(request.get(), kms_layers);
+    return request;
+}
+
 void mgm::RealKMSOutput::restore_saved_crtc()
 {
     if (!using_saved_crtc)
     {
+        clear_overlays();
+
         drmModeSetCrtc(drm_fd_, saved_crtc.crtc_id, saved_crtc.buffer_id,
                        saved_crtc.x, saved_crtc.y,
                        &connector->connector_id, 1, &saved_crtc.mode);
@@ -412,6 +519,8 @@ void mgm::RealKMSOutput::refresh_hardware_state()
             current_crtc = kms::get_crtc(drm_fd_, encoder->crtc_id);
         }
     }
+
+    update_planes();
 }
 
 namespace
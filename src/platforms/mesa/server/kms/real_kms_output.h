@@ -34,6 +34,7 @@ namespace mesa
 {
 
 class PageFlipper;
+class KMSPlanes;
 
 class RealKMSOutput : public KMSOutput
 {
@@ -56,6 +57,10 @@ public:
     bool schedule_page_flip(FBHandle const& fb) override;
     void wait_for_page_flip() override;
 
+    size_t max_layers() const override;
+    bool can_show(std::vector<PlaneLayer> const& layers) override;
+    bool schedule_page_flip(std::vector<PlaneLayer> const& layers) override;
+
     bool set_cursor(gbm_bo* buffer) override;
     void move_cursor(geometry::Point destination) override;
     bool clear_cursor() override;
@@ -76,6 +81,11 @@ public:
 private:
     bool ensure_crtc();
     void restore_saved_crtc();
+    void update_planes();
+    void clear_overlays();
+    auto whole_output_layer(FBHandle const& fb) const -> PlaneLayer;
+    auto atomic_request_for(std::vector<PlaneLayer> const& layers) const
+        -> std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReq*)>;
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
@@ -84,6 +94,9 @@ private:
     size_t mode_index;
     geometry::Displacement fb_offset;
     kms::DRMModeCrtcUPtr current_crtc;
+    bool const atomic_modesetting;
+    /// The planes of current_crtc, if we can drive them with atomic modesetting
+    std::unique_ptr<KMSPlanes> planes;
     drmModeCrtc saved_crtc;
     bool using_saved_crtc;
     bool has_cursor_;
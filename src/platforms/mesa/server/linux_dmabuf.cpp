@@ -0,0 +1,638 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linux_dmabuf.h"
+#include "wayland_wrapper.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/egl_extensions.h"
+#include "mir/graphics/egl_error.h"
+#include "mir/graphics/egl_wayland_allocator.h"
+#include "mir/graphics/texture.h"
+#include "mir/fd.h"
+
+#define MIR_LOG_COMPONENT "linux-dmabuf-import"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <drm_fourcc.h>
+#include <wayland-server.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <experimental/optional>
+#include <stdexcept>
+#include <vector>
+
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
+namespace mg = mir::graphics;
+namespace mgm = mir::graphics::mesa;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// The most planes a format can have (and that EGL_EXT_image_dma_buf_import_modifiers can import)
+size_t const max_planes = 4;
+
+std::experimental::optional<mg::EGLExtensions::EXTImageDmaBufImportModifiers> maybe_modifiers_ext(EGLDisplay dpy)
+{
+    try
+    {
+        return mg::EGLExtensions::EXTImageDmaBufImportModifiers{dpy};
+    }
+    catch (std::runtime_error const&)
+    {
+        return {};
+    }
+}
+
+bool has_alpha(uint32_t format)
+{
+    switch (format)
+    {
+    case DRM_FORMAT_ARGB8888:
+    case DRM_FORMAT_ABGR8888:
+    case DRM_FORMAT_RGBA8888:
+    case DRM_FORMAT_BGRA8888:
+    case DRM_FORMAT_ARGB2101010:
+    case DRM_FORMAT_ABGR2101010:
+    case DRM_FORMAT_RGBA1010102:
+    case DRM_FORMAT_BGRA1010102:
+    case DRM_FORMAT_ARGB4444:
+    case DRM_FORMAT_ABGR4444:
+    case DRM_FORMAT_RGBA4444:
+    case DRM_FORMAT_BGRA4444:
+    case DRM_FORMAT_ARGB1555:
+    case DRM_FORMAT_ABGR1555:
+    case DRM_FORMAT_RGBA5551:
+    case DRM_FORMAT_BGRA5551:
+        return true;
+    default:
+        return false;
+    }
+}
+
+struct Plane
+{
+    mir::Fd fd;
+    uint32_t offset;
+    uint32_t stride;
+    uint64_t modifier;
+};
+
+/// A wl_buffer created from client dmabufs; owns the EGLImage they were imported as
+class DmaBufBuffer : public mw::Buffer
+{
+public:
+    DmaBufBuffer(
+        wl_resource* resource,
+        EGLDisplay dpy,
+        std::shared_ptr<mg::EGLExtensions> const& egl_extensions,
+        EGLImageKHR image,
+        geom::Size size,
+        uint32_t format,
+        mg::gl::Texture::Layout layout)
+        : Buffer{resource, Version<1>{}},
+          dpy{dpy},
+          egl_extensions{egl_extensions},
+          image{image},
+          size{size},
+          format{format},
+          layout{layout}
+    {
+    }
+
+    ~DmaBufBuffer()
+    {
+        egl_extensions->eglDestroyImageKHR(dpy, image);
+    }
+
+    /// The DmaBufBuffer for resource, or nullptr if the wl_buffer is not a DmaBufBuffer
+    static auto maybe_from(wl_resource* resource) -> DmaBufBuffer*
+    {
+        if (!is_instance(resource))
+            return nullptr;
+
+        return dynamic_cast<DmaBufBuffer*>(Buffer::from(resource));
+    }
+
+    EGLDisplay const dpy;
+    std::shared_ptr<mg::EGLExtensions> const egl_extensions;
+    EGLImageKHR const image;
+    geom::Size const size;
+    uint32_t const format;
+    mg::gl::Texture::Layout const layout;
+
+private:
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+};
+}
+
+/// The formats, and their modifiers, that EGL can import as GL_TEXTURE_2D
+class mgm::DmaBufFormatDescriptors
+{
+public:
+    explicit DmaBufFormatDescriptors(EGLDisplay dpy)
+    {
+        if (auto const ext = maybe_modifiers_ext(dpy))
+        {
+            explicit_modifiers = true;
+            query_formats(dpy, *ext);
+        }
+        else
+        {
+            // Without EGL_EXT_image_dma_buf_import_modifiers the driver picks the layout and
+            // we can only assume the formats that every driver imports
+            explicit_modifiers = false;
+            formats.push_back({DRM_FORMAT_ARGB8888, {DRM_FORMAT_MOD_INVALID}});
+            formats.push_back({DRM_FORMAT_XRGB8888, {DRM_FORMAT_MOD_INVALID}});
+        }
+    }
+
+    bool supports(uint32_t format, uint64_t modifier) const
+    {
+        for (auto const& descriptor : formats)
+        {
+            if (descriptor.format != format)
+                continue;
+
+            // Clients (and version 2 of the protocol) may leave the modifier implicit
+            if (modifier == DRM_FORMAT_MOD_INVALID)
+                return true;
+
+            return std::find(descriptor.modifiers.begin(), descriptor.modifiers.end(), modifier) !=
+                descriptor.modifiers.end();
+        }
+        return false;
+    }
+
+    struct Descriptor
+    {
+        uint32_t format;
+        std::vector<uint64_t> modifiers;
+    };
+    std::vector<Descriptor> formats;
+
+    /// Whether modifiers can be passed to EGL (otherwise only DRM_FORMAT_MOD_INVALID is supported)
+    bool explicit_modifiers;
+
+private:
+    void query_formats(EGLDisplay dpy, EGLExtensions::EXTImageDmaBufImportModifiers const& ext)
+    {
+        EGLint num_formats;
+        if (ext.eglQueryDmaBufFormatsExt(dpy, 0, nullptr, &num_formats) != EGL_TRUE)
+        {
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to query number of dma-buf formats"));
+        }
+
+        std::vector<EGLint> egl_formats(num_formats);
+        if (ext.eglQueryDmaBufFormatsExt(dpy, num_formats, egl_formats.data(), &num_formats) != EGL_TRUE)
+        {
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to query dma-buf formats"));
+        }
+        egl_formats.resize(num_formats);
+
+        for (auto const format : egl_formats)
+        {
+            EGLint num_modifiers;
+            if (ext.eglQueryDmaBufModifiersExt(dpy, format, 0, nullptr, nullptr, &num_modifiers) != EGL_TRUE)
+            {
+                BOOST_THROW_EXCEPTION(mg::egl_error("Failed to query number of dma-buf format modifiers"));
+            }
+
+            std::vector<EGLuint64KHR> modifiers(num_modifiers);
+            std::vector<EGLBoolean> external_only(num_modifiers);
+            if (num_modifiers > 0 &&
+                ext.eglQueryDmaBufModifiersExt(
+                    dpy,
+                    format,
+                    num_modifiers,
+                    modifiers.data(),
+                    external_only.data(),
+                    &num_modifiers) != EGL_TRUE)
+            {
+                BOOST_THROW_EXCEPTION(mg::egl_error("Failed to query dma-buf format modifiers"));
+            }
+
+            Descriptor descriptor{static_cast<uint32_t>(format), {}};
+
+            // We only sample through GL_TEXTURE_2D, so can't use external-only modifiers
+            for (EGLint i = 0; i != num_modifiers; ++i)
+            {
+                if (!external_only[i])
+                    descriptor.modifiers.push_back(modifiers[i]);
+            }
+
+            if (num_modifiers == 0)
+                descriptor.modifiers.push_back(DRM_FORMAT_MOD_INVALID);
+
+            if (!descriptor.modifiers.empty())
+                formats.push_back(std::move(descriptor));
+        }
+    }
+};
+
+namespace
+{
+class LinuxDmaBufParams : public mw::LinuxBufferParamsV1
+{
+public:
+    LinuxDmaBufParams(
+        wl_resource* new_resource,
+        EGLDisplay dpy,
+        std::shared_ptr<mg::EGLExtensions> const& egl_extensions,
+        std::shared_ptr<mgm::DmaBufFormatDescriptors const> const& formats)
+        : LinuxBufferParamsV1{new_resource, Version<3>{}},
+          dpy{dpy},
+          egl_extensions{egl_extensions},
+          formats{formats}
+    {
+    }
+
+private:
+    EGLDisplay const dpy;
+    std::shared_ptr<mg::EGLExtensions> const egl_extensions;
+    std::shared_ptr<mgm::DmaBufFormatDescriptors const> const formats;
+
+    std::array<std::experimental::optional<Plane>, max_planes> planes;
+    bool consumed{false};
+
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    void add(
+        mir::Fd fd,
+        uint32_t plane_idx,
+        uint32_t offset,
+        uint32_t stride,
+        uint32_t modifier_hi,
+        uint32_t modifier_lo) override
+    {
+        if (consumed)
+        {
+            wl_resource_post_error(resource, Error::already_used, "Params already used to create a buffer");
+            return;
+        }
+        if (plane_idx >= planes.size())
+        {
+            wl_resource_post_error(
+                resource,
+                Error::plane_idx,
+                "Plane index %u exceeds the maximum of %zu planes",
+                plane_idx,
+                planes.size());
+            return;
+        }
+        if (planes[plane_idx])
+        {
+            wl_resource_post_error(resource, Error::plane_set, "Plane %u already set", plane_idx);
+            return;
+        }
+
+        planes[plane_idx] = Plane{fd, offset, stride, (static_cast<uint64_t>(modifier_hi) << 32) | modifier_lo};
+    }
+
+    void create(int32_t width, int32_t height, uint32_t format, uint32_t flags) override
+    {
+        if (!validate(width, height, format))
+            return;
+
+        try
+        {
+            auto const image = import(width, height, format, flags);
+
+            auto const buffer = wl_resource_create(client, &wl_buffer_interface, 1, 0);
+            if (!buffer)
+            {
+                egl_extensions->eglDestroyImageKHR(dpy, image);
+                wl_client_post_no_memory(client);
+                return;
+            }
+
+            new DmaBufBuffer{buffer, dpy, egl_extensions, image, {width, height}, format, layout_for(flags)};
+            send_created_event(buffer);
+        }
+        catch (std::exception const&)
+        {
+            mir::log(
+                mir::logging::Severity::informational,
+                MIR_LOG_COMPONENT,
+                std::current_exception(),
+                "Failed to import client dmabufs");
+            send_failed_event();
+        }
+    }
+
+    void create_immed(
+        wl_resource* buffer_id,
+        int32_t width,
+        int32_t height,
+        uint32_t format,
+        uint32_t flags) override
+    {
+        if (!validate(width, height, format))
+            return;
+
+        try
+        {
+            auto const image = import(width, height, format, flags);
+            new DmaBufBuffer{buffer_id, dpy, egl_extensions, image, {width, height}, format, layout_for(flags)};
+        }
+        catch (std::exception const&)
+        {
+            mir::log(
+                mir::logging::Severity::informational,
+                MIR_LOG_COMPONENT,
+                std::current_exception(),
+                "Failed to import client dmabufs");
+            wl_resource_post_error(resource, Error::invalid_wl_buffer, "Failed to import dmabufs");
+        }
+    }
+
+    /// Posts a protocol error (and returns false) for anything the client should have known was wrong
+    bool validate(int32_t width, int32_t height, uint32_t format)
+    {
+        if (consumed)
+        {
+            wl_resource_post_error(resource, Error::already_used, "Params already used to create a buffer");
+            return false;
+        }
+        consumed = true;
+
+        if (width <= 0 || height <= 0)
+        {
+            wl_resource_post_error(resource, Error::invalid_dimensions, "Invalid size %dx%d", width, height);
+            return false;
+        }
+
+        auto const plane_count = std::find(planes.begin(), planes.end(), std::experimental::nullopt) - planes.begin();
+        if (plane_count == 0 ||
+            std::any_of(planes.begin() + plane_count, planes.end(), [](auto const& plane) { return !!plane; }))
+        {
+            wl_resource_post_error(resource, Error::incomplete, "Planes must be set from index 0 without gaps");
+            return false;
+        }
+
+        auto const modifier = planes[0]->modifier;
+        for (auto i = 1; i != plane_count; ++i)
+        {
+            if (planes[i]->modifier != modifier)
+            {
+                wl_resource_post_error(resource, Error::invalid_format, "All planes must have the same modifier");
+                return false;
+            }
+        }
+
+        if (!formats->supports(format, modifier) ||
+            (modifier != DRM_FORMAT_MOD_INVALID && !formats->explicit_modifiers))
+        {
+            wl_resource_post_error(
+                resource,
+                Error::invalid_format,
+                "Format 0x%x with modifier 0x%llx is not supported",
+                format,
+                static_cast<unsigned long long>(modifier));
+            return false;
+        }
+
+        for (auto i = 0; i != plane_count; ++i)
+        {
+            auto const& plane = *planes[i];
+
+            // Not every exporter can tell us the size, in which case the import has to check
+            auto const size = lseek(plane.fd, 0, SEEK_END);
+            if (size == -1)
+                continue;
+            lseek(plane.fd, 0, SEEK_SET);
+
+            // Other planes may be subsampled, so only the first can be checked against the height
+            auto const end = plane.offset + (i == 0 ? static_cast<uint64_t>(plane.stride) * height : 0);
+            if (plane.offset >= static_cast<uint64_t>(size) || end > static_cast<uint64_t>(size))
+            {
+                wl_resource_post_error(
+                    resource,
+                    Error::out_of_bounds,
+                    "Plane %d extends beyond the end of its dmabuf",
+                    i);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    auto import(int32_t width, int32_t height, uint32_t format, uint32_t flags) const -> EGLImageKHR
+    {
+        if (flags & (Flags::interlaced | Flags::bottom_first))
+        {
+            BOOST_THROW_EXCEPTION((std::runtime_error{"Interlaced buffers are not supported"}));
+        }
+
+        static EGLint const plane_attributes[max_planes][5] = {
+            {
+                EGL_DMA_BUF_PLANE0_FD_EXT,
+                EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+                EGL_DMA_BUF_PLANE0_PITCH_EXT,
+                EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+                EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT
+            },
+            {
+                EGL_DMA_BUF_PLANE1_FD_EXT,
+                EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+                EGL_DMA_BUF_PLANE1_PITCH_EXT,
+                EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+                EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT
+            },
+            {
+                EGL_DMA_BUF_PLANE2_FD_EXT,
+                EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+                EGL_DMA_BUF_PLANE2_PITCH_EXT,
+                EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+                EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT
+            },
+            {
+                EGL_DMA_BUF_PLANE3_FD_EXT,
+                EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+                EGL_DMA_BUF_PLANE3_PITCH_EXT,
+                EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+                EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT
+            }
+        };
+
+        std::vector<EGLint> attributes{
+            EGL_WIDTH, width,
+            EGL_HEIGHT, height,
+            EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(format)};
+
+        for (size_t i = 0; i != planes.size() && planes[i]; ++i)
+        {
+            auto const& plane = *planes[i];
+
+            attributes.insert(attributes.end(), {
+                plane_attributes[i][0], static_cast<int>(plane.fd),
+                plane_attributes[i][1], static_cast<EGLint>(plane.offset),
+                plane_attributes[i][2], static_cast<EGLint>(plane.stride)});
+
+            if (plane.modifier != DRM_FORMAT_MOD_INVALID)
+            {
+                attributes.insert(attributes.end(), {
+                    plane_attributes[i][3], static_cast<EGLint>(plane.modifier & 0xFFFFFFFF),
+                    plane_attributes[i][4], static_cast<EGLint>(plane.modifier >> 32)});
+            }
+        }
+        attributes.push_back(EGL_NONE);
+
+        auto const image = egl_extensions->eglCreateImageKHR(
+            dpy,
+            EGL_NO_CONTEXT,
+            EGL_LINUX_DMA_BUF_EXT,
+            static_cast<EGLClientBuffer>(nullptr),
+            attributes.data());
+
+        if (image == EGL_NO_IMAGE_KHR)
+        {
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to import dmabufs as EGLImage"));
+        }
+
+        return image;
+    }
+
+    static auto layout_for(uint32_t flags) -> mg::gl::Texture::Layout
+    {
+        // dmabufs store the top row first unless y-inverted
+        return (flags & Flags::y_invert) ? mg::gl::Texture::Layout::GL : mg::gl::Texture::Layout::TopRowFirst;
+    }
+};
+}
+
+class mgm::LinuxDmaBufUnstable::Instance : public mw::LinuxDmabufV1
+{
+public:
+    Instance(
+        wl_resource* new_resource,
+        EGLDisplay dpy,
+        std::shared_ptr<mg::EGLExtensions> const& egl_extensions,
+        std::shared_ptr<DmaBufFormatDescriptors const> const& formats)
+        : LinuxDmabufV1{new_resource, Version<3>{}},
+          dpy{dpy},
+          egl_extensions{egl_extensions},
+          formats{formats}
+    {
+        send_formats();
+    }
+
+private:
+    EGLDisplay const dpy;
+    std::shared_ptr<mg::EGLExtensions> const egl_extensions;
+    std::shared_ptr<DmaBufFormatDescriptors const> const formats;
+
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    void create_params(wl_resource* params_id) override
+    {
+        new LinuxDmaBufParams{params_id, dpy, egl_extensions, formats};
+    }
+
+    void send_formats()
+    {
+        for (auto const& descriptor : formats->formats)
+        {
+            if (version_supports_modifier())
+            {
+                for (auto const modifier : descriptor.modifiers)
+                {
+                    send_modifier_event(
+                        descriptor.format,
+                        static_cast<uint32_t>(modifier >> 32),
+                        static_cast<uint32_t>(modifier & 0xFFFFFFFF));
+                }
+            }
+            else
+            {
+                send_format_event(descriptor.format);
+            }
+        }
+    }
+};
+
+mgm::LinuxDmaBufUnstable::LinuxDmaBufUnstable(
+    wl_display* display,
+    EGLDisplay dpy,
+    std::shared_ptr<EGLExtensions> const& egl_extensions)
+    : Global{display, Version<3>{}},
+      dpy{dpy},
+      egl_extensions{egl_extensions},
+      formats{
+          [dpy]()
+          {
+              auto const* extensions = eglQueryString(dpy, EGL_EXTENSIONS);
+              if (!extensions || !strstr(extensions, "EGL_EXT_image_dma_buf_import"))
+              {
+                  BOOST_THROW_EXCEPTION((std::runtime_error{"EGL implementation doesn't support EGL_EXT_image_dma_buf_import"}));
+              }
+              return std::make_shared<DmaBufFormatDescriptors>(dpy);
+          }()}
+{
+}
+
+mgm::LinuxDmaBufUnstable::~LinuxDmaBufUnstable() = default;
+
+void mgm::LinuxDmaBufUnstable::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource, dpy, egl_extensions, formats};
+}
+
+auto mgm::LinuxDmaBufUnstable::buffer_from_resource(
+    wl_resource* buffer,
+    std::function<void()>&& on_consumed,
+    std::function<void()>&& on_release,
+    std::shared_ptr<renderer::gl::Context> const& ctx,
+    std::shared_ptr<Executor> const& wayland_executor) -> std::shared_ptr<Buffer>
+{
+    if (auto const dmabuf = DmaBufBuffer::maybe_from(buffer))
+    {
+        return mg::wayland::buffer_from_image(
+            dmabuf->image,
+            dmabuf->size,
+            dmabuf->layout,
+            has_alpha(dmabuf->format) ? mir_pixel_format_argb_8888 : mir_pixel_format_xrgb_8888,
+            std::move(on_consumed),
+            std::move(on_release),
+            ctx,
+            *egl_extensions,
+            wayland_executor);
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_LINUX_DMABUF_H_
+#define MIR_GRAPHICS_MESA_LINUX_DMABUF_H_
+
+#include "linux-dmabuf-unstable-v1_wrapper.h"
+
+#include <EGL/egl.h>
+
+#include <functional>
+#include <memory>
+
+namespace mir
+{
+class Executor;
+
+namespace renderer
+{
+namespace gl
+{
+class Context;
+}
+}
+namespace graphics
+{
+class Buffer;
+struct EGLExtensions;
+
+namespace mesa
+{
+class DmaBufFormatDescriptors;
+
+/**
+ * The zwp_linux_dmabuf_v1 global: lets clients share dmabufs with us, which are imported as EGLImages
+ */
+class LinuxDmaBufUnstable : public wayland::LinuxDmabufV1::Global
+{
+public:
+    /// \throws std::runtime_error if the EGL implementation cannot import dmabufs
+    LinuxDmaBufUnstable(
+        wl_display* display,
+        EGLDisplay dpy,
+        std::shared_ptr<EGLExtensions> const& egl_extensions);
+    ~LinuxDmaBufUnstable();
+
+    /**
+     * The Buffer for a wl_buffer created through this global
+     *
+     * \note Must be called with a current EGL context
+     * \return  nullptr if buffer was not created through this global, in which case
+     *          on_consumed and on_release are left untouched
+     */
+    auto buffer_from_resource(
+        wl_resource* buffer,
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release,
+        std::shared_ptr<renderer::gl::Context> const& ctx,
+        std::shared_ptr<Executor> const& wayland_executor) -> std::shared_ptr<Buffer>;
+
+private:
+    class Instance;
+
+    void bind(wl_resource* new_resource) override;
+
+    EGLDisplay const dpy;
+    std::shared_ptr<EGLExtensions> const egl_extensions;
+    std::shared_ptr<DmaBufFormatDescriptors const> const formats;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_MESA_LINUX_DMABUF_H_
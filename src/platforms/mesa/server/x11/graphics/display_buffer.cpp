@@ -41,7 +41,7 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
                                     area{view_area},
                                     transform(1),
                                     egl{gl_config},
-                                    last_frame{f},
+                                    last_frame_{f},
                                     output_id{output_id},
                                     eglGetSyncValues{nullptr}
 {
@@ -126,12 +126,12 @@ void mgx::DisplayBuffer::swap_buffers()
         mg::Frame frame;
         frame.msc = msc;
         frame.ust = {CLOCK_MONOTONIC, ust_ns};
-        last_frame->store(frame);
+        last_frame_->store(frame);
         (void)sbc; // unused
     }
     else  // Extension not available? Fall back to a reasonable estimate:
     {
-        last_frame->increment_now();
+        last_frame_->increment_now();
     }
 
     /*
@@ -139,13 +139,18 @@ void mgx::DisplayBuffer::swap_buffers()
      * but this is best-effort. And besides, we don't want Mir reporting all
      * real vsyncs because that would mean the compositor never sleeps.
      */
-    report->report_vsync(output_id.as_value(), last_frame->load());
+    report->report_vsync(output_id.as_value(), last_frame_->load());
 }
 
 void mgx::DisplayBuffer::bind()
 {
 }
 
+mg::Frame mgx::DisplayBuffer::last_frame() const
+{
+    return last_frame_->load();
+}
+
 glm::mat2 mgx::DisplayBuffer::transformation() const
 {
     return transform;
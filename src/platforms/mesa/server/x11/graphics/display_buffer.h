@@ -72,6 +72,7 @@ public:
     std::chrono::milliseconds recommended_sleep() const override;
 
     glm::mat2 transformation() const override;
+    Frame last_frame() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
 private:
@@ -79,7 +80,7 @@ private:
     geometry::Rectangle area;
     glm::mat2 transform;
     helpers::EGLHelper egl;
-    std::shared_ptr<AtomicFrame> const last_frame;
+    std::shared_ptr<AtomicFrame> const last_frame_;
     DisplayConfigurationOutputId output_id;
 
     typedef EGLBoolean (EGLAPIENTRY EglGetSyncValuesCHROMIUM)
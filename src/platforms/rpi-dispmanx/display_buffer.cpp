@@ -115,6 +115,7 @@ void mg::rpi::DisplayBuffer::for_each_display_buffer(std::function<void(mg::Disp
 
 void mg::rpi::DisplayBuffer::post()
 {
+    last_frame_.increment_now();
 }
 
 std::chrono::milliseconds mg::rpi::DisplayBuffer::recommended_sleep() const
@@ -133,6 +134,10 @@ glm::mat2 mg::rpi::DisplayBuffer::transformation() const
 {
     return glm::mat2(1);
 }
+auto mg::rpi::DisplayBuffer::last_frame() const -> Frame
+{
+    return last_frame_.load();
+}
 mg::NativeDisplayBuffer* mg::rpi::DisplayBuffer::native_display_buffer()
 {
     return this;
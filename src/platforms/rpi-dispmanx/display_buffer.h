@@ -20,6 +20,7 @@
 #define MIR_DISPLAYBUFFER_H
 
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/atomic_frame.h"
 #include "mir/renderer/gl/render_target.h"
 #include "mir/graphics/display.h"
 
@@ -53,6 +54,7 @@ public:
     geometry::Rectangle view_area() const override;
     bool overlay(RenderableList const& renderlist) override;
     glm::mat2 transformation() const override;
+    Frame last_frame() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
     void make_current() override;
@@ -65,6 +67,7 @@ private:
     EGLDisplay const dpy;
     EGLContext const ctx;
     EGLSurface const surface;
+    AtomicFrame last_frame_;
 };
 }
 }
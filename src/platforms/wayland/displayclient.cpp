@@ -17,6 +17,7 @@
 
 #include "displayclient.h"
 #include "mir/graphics/egl_error.h"
+#include "mir/graphics/atomic_frame.h"
 #include <mir/graphics/pixel_format_utils.h>
 
 #include <wayland-client.h>
@@ -94,6 +95,8 @@ public:
 
     std::function<void(Output const&)> on_done;
 
+    AtomicFrame last_frame_;
+
     // DisplaySyncGroup implementation
     void for_each_display_buffer(std::function<void(DisplayBuffer&)> const& /*f*/) override;
     void post() override;
@@ -103,6 +106,7 @@ public:
     auto view_area() const -> geometry::Rectangle override;
     bool overlay(RenderableList const& renderlist) override;
     auto transformation() const -> glm::mat2 override;
+    auto last_frame() const -> Frame override;
     auto native_display_buffer() -> NativeDisplayBuffer* override;
 
     // RenderTarget implementation
@@ -299,6 +303,7 @@ void mgw::DisplayClient::Output::for_each_display_buffer(std::function<void(Disp
 
 void mgw::DisplayClient::Output::post()
 {
+    last_frame_.increment_now();
 }
 
 auto mgw::DisplayClient::Output::recommended_sleep() const -> std::chrono::milliseconds
@@ -321,6 +326,11 @@ auto mgw::DisplayClient::Output::transformation() const -> glm::mat2
     return glm::mat2{1};
 }
 
+auto mgw::DisplayClient::Output::last_frame() const -> Frame
+{
+    return last_frame_.load();
+}
+
 auto mgw::DisplayClient::Output::native_display_buffer() -> NativeDisplayBuffer*
 {
     return this;
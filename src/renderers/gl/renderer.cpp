@@ -38,10 +38,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <sstream>
 
 namespace mg = mir::graphics;
@@ -350,14 +353,15 @@ mrg::Renderer::Program::Program(GLuint program_id)
     alpha_uniform = glGetUniformLocation(id, "alpha");
 }
 
-mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer, Submission submission)
     : render_target(&display_buffer),
       clear_color{0.0f, 0.0f, 0.0f, 0.0f},
       default_program(family.add_program(vshader, default_fshader)),
       alpha_program(family.add_program(vshader, alpha_fshader)),
       program_factory{std::make_unique<ProgramFactory>()},
       texture_cache(mgl::DefaultProgramFactory().create_texture_cache()),
-      display_transform(1)
+      display_transform(1),
+      submission{submission}
 {
     eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
     EGLDisplay disp = eglGetCurrentDisplay();
@@ -414,13 +418,17 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
 mrg::Renderer::~Renderer()
 {
     render_target.ensure_current();
+
+    if (vertex_buffer)
+        glDeleteBuffers(1, &vertex_buffer);
 }
 
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
                                 mg::Renderable const& renderable) const
 {
-    primitives.resize(1);
-    primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
+    // Whatever is inside the opaque region can be drawn without blending
+    primitives.clear();
+    mgl::tessellate_renderable_by_opacity(primitives, renderable, geom::Displacement{0,0});
 }
 
 void mrg::Renderer::render(mg::RenderableList const& renderables) const
@@ -429,12 +437,51 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
 
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glClear(GL_COLOR_BUFFER_BIT);
 
     ++frameno;
-    for (auto const& r : renderables)
+    bool const batched = submission == Submission::batched;
+    if (batched)
+        record(renderables);
+
+    if (auto const areas = areas_to_repaint())
     {
-        draw(*r);
+        glEnable(GL_SCISSOR_TEST);
+        for (auto const& area : areas.value())
+        {
+            repaint_area = area;
+            scissor_to(area);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            if (batched)
+            {
+                submit(area);
+                continue;
+            }
+
+            for (auto const& r : renderables)
+            {
+                if (r->transformation() != glm::mat4(1) || r->screen_position().overlaps(area))
+                    draw(*r);
+            }
+        }
+        repaint_area = std::experimental::nullopt;
+        glDisable(GL_SCISSOR_TEST);
+    }
+    else
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        if (batched)
+        {
+            submit({});
+        }
+        else
+        {
+            for (auto const& r : renderables)
+            {
+                draw(*r);
+            }
+        }
     }
 
     render_target.swap_buffers();
@@ -447,64 +494,178 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         mir::log_debug("GL error: %d", gl_error);
 }
 
+auto mrg::Renderer::areas_to_repaint() const -> std::experimental::optional<std::vector<geom::Rectangle>>
+{
+    // Enough history for triple buffering (plus the frame being rendered)
+    auto const max_history = 3u;
+    // Beyond this the cost of repeated draw passes outweighs the saved fill
+    auto const max_areas = 4u;
+
+    auto frame_damage = damage ? damage.value() : geom::Rectangles{viewport};
+    damage = std::experimental::nullopt;
+
+    EGLint age = 0;
+    auto const surface = eglGetCurrentSurface(EGL_DRAW);
+    if (surface == EGL_NO_SURFACE ||
+        !eglQuerySurface(eglGetCurrentDisplay(), surface, EGL_BUFFER_AGE_EXT, &age))
+    {
+        age = 0;
+    }
+
+    // The back buffer is age frames old, so it is missing that many frames of damage
+    geom::Rectangles repaint{frame_damage};
+    bool const full_repaint = !viewport_is_unscaled || age <= 0 || unsigned(age - 1) > damage_history.size();
+    if (!full_repaint)
+    {
+        for (auto i = 0; i != age - 1; ++i)
+        {
+            for (auto const& rect : damage_history[i])
+                repaint.add(rect);
+        }
+    }
+
+    damage_history.push_front(std::move(frame_damage));
+    if (damage_history.size() > max_history)
+        damage_history.pop_back();
+
+    if (full_repaint)
+        return {};
+
+    std::vector<geom::Rectangle> areas;
+    long total_area = 0;
+    for (auto const& rect : repaint)
+    {
+        auto const area = rect.intersection_with(viewport);
+        if (area.size.width > geom::Width{0} && area.size.height > geom::Height{0})
+        {
+            areas.push_back(area);
+            total_area += long(area.size.width.as_int()) * area.size.height.as_int();
+        }
+    }
+
+    if (areas.size() > max_areas ||
+        total_area >= long(viewport.size.width.as_int()) * viewport.size.height.as_int())
+    {
+        geom::Rectangles coalesced;
+        for (auto const& area : areas)
+            coalesced.add(area);
+        areas = {coalesced.bounding_rectangle()};
+    }
+
+    if (areas.size() == 1 && areas.front() == viewport)
+        return {};
+
+    return areas;
+}
+
+void mrg::Renderer::scissor_to(geom::Rectangle const& area) const
+{
+    glScissor(
+        area.top_left.x.as_int() -
+            viewport.top_left.x.as_int(),
+        viewport.top_left.y.as_int() +
+            viewport.size.height.as_int() -
+            area.top_left.y.as_int() -
+            area.size.height.as_int(),
+        area.size.width.as_int(),
+        area.size.height.as_int()
+    );
+}
+
+auto mrg::Renderer::client_blend_for(mg::Renderable const& renderable) -> Blend
+{
+    // These renderable method names could be better (see LP: #1236224)
+    if (renderable.shaped())  // Client is RGBA:
+    {
+        return {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                GL_ONE, GL_ONE_MINUS_SRC_ALPHA, 1.0f};
+    }
+    else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
+    {
+        return {GL_ONE,  GL_ZERO,
+                GL_ZERO, GL_ONE, 1.0f};  // Avoid using src_alpha!
+    }
+    else
+    {   // Client is RGBX but we also have window translucency.
+        // The texture alpha channel is possibly uninitialized so we must be
+        // careful and avoid using SRC_ALPHA (LP: #1423462).
+        return {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
+                GL_ZERO, GL_ONE, renderable.alpha()};
+    }
+}
+
+auto mrg::Renderer::transform_for(
+    mg::Renderable const& renderable,
+    std::shared_ptr<mg::gl::Texture> const& texture) -> glm::mat4
+{
+    glm::mat4 transform = renderable.transformation();
+    if (texture && (texture->layout() == mg::gl::Texture::Layout::TopRowFirst))
+    {
+        // GL textures have (0,0) at bottom-left rather than top-left
+        // We have to invert this texture to get it the way up GL expects.
+        transform *= glm::mat4{
+            1.0, 0.0, 0.0, 0.0,
+            0.0, -1.0, 0.0, 0.0,
+            0.0, 0.0, 1.0, 0.0,
+            -1.0, 1.0, 0.0, 1.0
+        };
+    }
+    return transform;
+}
+
+auto mrg::Renderer::fallback_texture_for(mg::Renderable const& renderable) const -> std::shared_ptr<mgl::Texture>
+{
+    try
+    {
+        return texture_cache->load(renderable);
+    }
+    catch (std::exception const&)
+    {
+        report_exception();
+    }
+    return {nullptr};
+}
+
+auto mrg::Renderer::program_for(
+    std::shared_ptr<mg::gl::Texture> const& texture,
+    std::shared_ptr<mgl::Texture> const& surface_tex,
+    bool alpha) const -> Program const*
+{
+    if (texture)
+    {
+        auto const& family = static_cast<::Program const&>(texture->shader(*program_factory));
+        if (alpha)
+        {
+            return &family.alpha;
+        }
+        return &family.opaque;
+    }
+    else if(surface_tex)
+    {
+        if (alpha)
+        {
+            return &alpha_program;
+        }
+        return &default_program;
+    }
+    return nullptr;
+}
+
 void mrg::Renderer::draw(mg::Renderable const& renderable) const
 {
     auto const clip_area = renderable.clip_area();
     if (clip_area)
     {
         glEnable(GL_SCISSOR_TEST);
-        glScissor(
-            clip_area.value().top_left.x.as_int() -
-                viewport.top_left.x.as_int(),
-            viewport.top_left.y.as_int() +
-                viewport.size.height.as_int() -
-                clip_area.value().top_left.y.as_int() -
-                clip_area.value().size.height.as_int(),
-            clip_area.value().size.width.as_int(), 
-            clip_area.value().size.height.as_int()
-        );
+        if (repaint_area)
+            scissor_to(clip_area.value().intersection_with(repaint_area.value()));
+        else
+            scissor_to(clip_area.value());
     }
 
     auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
-    auto const surface_tex =
-        [this, &renderable, need_fallback = !static_cast<bool>(texture)]() -> std::shared_ptr<mir::gl::Texture>
-        {
-            if (need_fallback)
-            {
-                try
-                {
-                    return texture_cache->load(renderable);
-                }
-                catch (std::exception const&)
-                {
-                    report_exception();
-                }
-            }
-            return {nullptr};
-        }();
-
-    auto const* maybe_prog =
-        [this, &texture, &surface_tex](bool alpha) -> Program const*
-        {
-            if (texture)
-            {
-                auto const& family = static_cast<::Program const&>(texture->shader(*program_factory));
-                if (alpha)
-                {
-                    return &family.alpha;
-                }
-                return &family.opaque;
-            }
-            else if(surface_tex)
-            {
-                if (alpha)
-                {
-                    return &alpha_program;
-                }
-                return &default_program;
-            }
-            return nullptr;
-        }(renderable.alpha() < 1.0f);
+    auto const surface_tex = texture ? nullptr : fallback_texture_for(renderable);
+    auto const* maybe_prog = program_for(texture, surface_tex, renderable.alpha() < 1.0f);
 
     if (!maybe_prog)
     {
@@ -541,21 +702,8 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
                       rect.size.height.as_int() / 2.0f;
     glUniform2f(prog.centre_uniform, centrex, centrey);
 
-    glm::mat4 transform = renderable.transformation();
-    if (texture && (texture->layout() == mg::gl::Texture::Layout::TopRowFirst))
-    {
-        // GL textures have (0,0) at bottom-left rather than top-left
-        // We have to invert this texture to get it the way up GL expects.
-        transform *= glm::mat4{
-            1.0, 0.0, 0.0, 0.0,
-            0.0, -1.0, 0.0, 0.0,
-            0.0, 0.0, 1.0, 0.0,
-            -1.0, 1.0, 0.0, 1.0
-        };
-    }
-
     glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
-                       glm::value_ptr(transform));
+                       glm::value_ptr(transform_for(renderable, texture)));
 
     if (prog.alpha_uniform >= 0)
         glUniform1f(prog.alpha_uniform, renderable.alpha());
@@ -569,38 +717,18 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     // if we fail to load the texture, we need to carry on (part of lp:1629275)
     try
     {
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
-        {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
-        BlendSeparate client_blend;
-
-        // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
-        {
-            client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
-        }
-        else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
-        {
-            client_blend = {GL_ONE,  GL_ZERO,
-                            GL_ZERO, GL_ONE};  // Avoid using src_alpha!
-        }
-        else
-        {   // Client is RGBX but we also have window translucency.
-            // The texture alpha channel is possibly uninitialized so we must be
-            // careful and avoid using SRC_ALPHA (LP: #1423462).
-            client_blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
-                            GL_ZERO, GL_ONE};
-            glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
-        }
+        auto const client_blend = client_blend_for(renderable);
+        if (client_blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA)
+            glBlendColor(0.0f, 0.0f, 0.0f, client_blend.constant_alpha);
 
         for (auto const& p : primitives)
         {
-            BlendSeparate blend;
-
-            blend = client_blend;
+            Blend blend = client_blend;
+            if (p.opaque && renderable.alpha() == 1.0f)
+            {
+                blend = {GL_ONE,  GL_ZERO,
+                         GL_ZERO, GL_ONE, 1.0f};
+            }
             if (surface_tex)
             {
                 surface_tex->bind();
@@ -644,10 +772,283 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
 
     glDisableVertexAttribArray(prog.texcoord_attr);
     glDisableVertexAttribArray(prog.position_attr);
-    if (renderable.clip_area())
+    if (clip_area)
     {
-        glDisable(GL_SCISSOR_TEST);
+        if (repaint_area)
+            scissor_to(repaint_area.value());
+        else
+            glDisable(GL_SCISSOR_TEST);
+    }
+}
+
+namespace
+{
+/// Appends the primitive's vertices as independent triangles, so neighbouring primitives can share a draw
+void append_triangles(std::vector<mgl::Vertex>& vertices, mgl::Primitive const& primitive)
+{
+    auto const& v = primitive.vertices;
+    switch (primitive.type)
+    {
+    case GL_TRIANGLE_STRIP:
+        for (auto i = 2; i < primitive.nvertices; ++i)
+            vertices.insert(vertices.end(), {v[i-2], v[i-1], v[i]});
+        break;
+
+    case GL_TRIANGLE_FAN:
+        for (auto i = 2; i < primitive.nvertices; ++i)
+            vertices.insert(vertices.end(), {v[0], v[i-1], v[i]});
+        break;
+
+    default:
+        vertices.insert(vertices.end(), v, v + primitive.nvertices);
+        break;
+    }
+}
+}
+
+void mrg::Renderer::record(mg::RenderableList const& renderables) const
+{
+    batch_vertices.clear();
+    batch_commands.clear();
+
+    for (auto const& r : renderables)
+    {
+        auto const& renderable = *r;
+
+        auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
+        auto const surface_tex = texture ? nullptr : fallback_texture_for(renderable);
+        auto const* prog = program_for(texture, surface_tex, renderable.alpha() < 1.0f);
+
+        if (!prog)
+        {
+            mir::log_error("Buffer does not support GL rendering!");
+            continue;
+        }
+
+        auto const& rect = renderable.screen_position();
+        auto const transformed = renderable.transformation() != glm::mat4(1);
+
+        DrawCommand command;
+        command.program = prog;
+        command.texture = texture;
+        command.surface_tex = surface_tex;
+        command.transform = transform_for(renderable, texture);
+        // The centre only matters to a transformation, so leave it out of the
+        // state that stops untransformed renderables sharing a draw
+        command.centre = transformed ?
+            glm::vec2{rect.top_left.x.as_int() + rect.size.width.as_int() / 2.0f,
+                      rect.top_left.y.as_int() + rect.size.height.as_int() / 2.0f} :
+            glm::vec2{};
+        command.alpha = renderable.alpha();
+        command.clip = renderable.clip_area();
+        command.bounds = rect;
+        command.transformed = transformed;
+
+        auto const client_blend = client_blend_for(renderable);
+
+        primitives.clear();
+        tessellate(primitives, renderable);
+
+        for (auto const& p : primitives)
+        {
+            command.blend = client_blend;
+            if (p.opaque && renderable.alpha() == 1.0f)
+                command.blend = {GL_ONE, GL_ZERO, GL_ZERO, GL_ONE, 1.0f};
+
+            command.first = batch_vertices.size();
+            append_triangles(batch_vertices, p);
+            command.count = batch_vertices.size() - command.first;
+
+            if (!batch_commands.empty())
+            {
+                auto& last = batch_commands.back();
+                auto const same_state =
+                    last.program == command.program &&
+                    last.texture == command.texture &&
+                    last.surface_tex == command.surface_tex &&
+                    last.transform == command.transform &&
+                    last.centre.x == command.centre.x && last.centre.y == command.centre.y &&
+                    last.alpha == command.alpha &&
+                    last.blend.src_rgb == command.blend.src_rgb &&
+                    last.blend.dst_rgb == command.blend.dst_rgb &&
+                    last.blend.src_alpha == command.blend.src_alpha &&
+                    last.blend.dst_alpha == command.blend.dst_alpha &&
+                    last.blend.constant_alpha == command.blend.constant_alpha &&
+                    last.clip == command.clip &&
+                    last.first + last.count == command.first;
+
+                if (same_state)
+                {
+                    last.count += command.count;
+                    last.bounds = geom::Rectangles{last.bounds, command.bounds}.bounding_rectangle();
+                    last.transformed = last.transformed || command.transformed;
+                    continue;
+                }
+            }
+
+            batch_commands.push_back(command);
+        }
     }
+
+    if (batch_vertices.empty())
+        return;
+
+    if (!vertex_buffer)
+        glGenBuffers(1, &vertex_buffer);
+
+    // Respecifying the whole store lets the driver hand us fresh memory
+    // rather than wait for the GPU to finish with the previous frame's
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, batch_vertices.size() * sizeof(mgl::Vertex),
+                 batch_vertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void mrg::Renderer::submit(std::experimental::optional<geom::Rectangle> const& area) const
+{
+    if (batch_commands.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glActiveTexture(GL_TEXTURE0);
+
+    Program const* current_program = nullptr;
+    DrawCommand const* previous = nullptr;
+    std::experimental::optional<geom::Rectangle> current_clip;
+    bool blending = false;
+
+    for (auto const& command : batch_commands)
+    {
+        if (area && !command.transformed && !command.bounds.overlaps(area.value()))
+            continue;
+
+        auto const& prog = *command.program;
+        bool const new_program = &prog != current_program;
+
+        if (new_program)
+        {
+            if (current_program)
+            {
+                glDisableVertexAttribArray(current_program->texcoord_attr);
+                glDisableVertexAttribArray(current_program->position_attr);
+            }
+
+            current_program = &prog;
+            glUseProgram(prog.id);
+            if (prog.last_used_frameno != frameno)
+            {   // Avoid reloading the screen-global uniforms on every renderable
+                prog.last_used_frameno = frameno;
+                for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
+                {
+                    if (prog.tex_uniforms[i] != -1)
+                    {
+                        glUniform1i(prog.tex_uniforms[i], i);
+                    }
+                }
+                glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
+                                   glm::value_ptr(display_transform));
+                glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
+                                   glm::value_ptr(screen_to_gl_coords));
+            }
+
+            glEnableVertexAttribArray(prog.position_attr);
+            glEnableVertexAttribArray(prog.texcoord_attr);
+            glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT, GL_FALSE, sizeof(mgl::Vertex),
+                                  reinterpret_cast<void const*>(offsetof(mgl::Vertex, position)));
+            glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT, GL_FALSE, sizeof(mgl::Vertex),
+                                  reinterpret_cast<void const*>(offsetof(mgl::Vertex, texcoord)));
+        }
+
+        // Only tell GL about state that differs from the previous draw
+        if (new_program || previous->centre.x != command.centre.x || previous->centre.y != command.centre.y)
+            glUniform2f(prog.centre_uniform, command.centre.x, command.centre.y);
+
+        if (new_program || previous->transform != command.transform)
+            glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE, glm::value_ptr(command.transform));
+
+        if (prog.alpha_uniform >= 0 && (new_program || previous->alpha != command.alpha))
+            glUniform1f(prog.alpha_uniform, command.alpha);
+
+        if (command.clip != current_clip)
+        {
+            current_clip = command.clip;
+            if (current_clip)
+            {
+                glEnable(GL_SCISSOR_TEST);
+                scissor_to(area ? current_clip.value().intersection_with(area.value()) : current_clip.value());
+            }
+            else if (area)
+            {
+                scissor_to(area.value());
+            }
+            else
+            {
+                glDisable(GL_SCISSOR_TEST);
+            }
+        }
+
+        auto const& blend = command.blend;
+        if (blend.dst_rgb == GL_ZERO)
+        {
+            if (blending || !previous)
+                glDisable(GL_BLEND);
+            blending = false;
+        }
+        else
+        {
+            if (!blending)
+                glEnable(GL_BLEND);
+            blending = true;
+            glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
+                                blend.src_alpha, blend.dst_alpha);
+            if (blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA)
+                glBlendColor(0.0f, 0.0f, 0.0f, blend.constant_alpha);
+        }
+
+        // if we fail to load the texture, we need to carry on (part of lp:1629275)
+        try
+        {
+            if (!previous ||
+                previous->texture != command.texture ||
+                previous->surface_tex != command.surface_tex)
+            {
+                if (command.surface_tex)
+                    command.surface_tex->bind();
+                else
+                    command.texture->bind();
+            }
+
+            glDrawArrays(GL_TRIANGLES, command.first, command.count);
+
+            if (command.texture)
+            {
+                // We're done with the texture for now
+                command.texture->add_syncpoint();
+            }
+        }
+        catch (std::exception const&)
+        {
+            report_exception();
+        }
+
+        previous = &command;
+    }
+
+    if (current_program)
+    {
+        glDisableVertexAttribArray(current_program->texcoord_attr);
+        glDisableVertexAttribArray(current_program->position_attr);
+    }
+
+    if (current_clip)
+    {
+        if (area)
+            scissor_to(area.value());
+        else
+            glDisable(GL_SCISSOR_TEST);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
@@ -726,7 +1127,20 @@ void mrg::Renderer::update_gl_viewport()
         GLint offset_y = (buf_height - reduced_height) / 2;
 
         glViewport(offset_x, offset_y, reduced_width, reduced_height);
+
+        viewport_is_unscaled =
+            display_transform == glm::mat4(1) &&
+            offset_x == 0 && offset_y == 0 &&
+            reduced_width == viewport.size.width.as_int() &&
+            reduced_height == viewport.size.height.as_int();
+    }
+    else
+    {
+        viewport_is_unscaled = false;
     }
+
+    // Whatever was in the back buffers no longer lines up with the viewport
+    damage_history.clear();
 }
 
 void mrg::Renderer::set_output_transform(glm::mat2 const& t)
@@ -739,8 +1153,14 @@ void mrg::Renderer::set_output_transform(glm::mat2 const& t)
     }
 }
 
+void mrg::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    this->damage = damage;
+}
+
 void mrg::Renderer::suspend()
 {
     texture_cache->invalidate();
+    damage_history.clear();
 }
 
@@ -23,20 +23,27 @@
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
 #include <mir/graphics/buffer_id.h>
 #include <mir/graphics/renderable.h>
 #include <mir/gl/primitive.h>
 #include "mir/renderer/gl/render_target.h"
 
 #include MIR_SERVER_GL_H
+#include <deque>
+#include <experimental/optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace mir
 {
-namespace gl { class TextureCache; }
-namespace graphics { class DisplayBuffer; }
+namespace gl { class TextureCache; class Texture; }
+namespace graphics
+{
+class DisplayBuffer;
+namespace gl { class Texture; }
+}
 namespace renderer
 {
 namespace gl
@@ -59,12 +66,23 @@ private:
 class Renderer : public renderer::Renderer
 {
 public:
-    Renderer(graphics::DisplayBuffer& display_buffer);
+    /// How the renderables of a frame are handed to GL
+    enum class Submission
+    {
+        /// Each primitive is drawn on its own from client-side vertex arrays
+        immediate,
+        /// The whole frame is streamed into one vertex buffer and runs of
+        /// primitives sharing GL state are drawn together
+        batched
+    };
+
+    Renderer(graphics::DisplayBuffer& display_buffer, Submission submission = Submission::immediate);
     virtual ~Renderer();
 
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
     void render(graphics::RenderableList const&) const override;
 
     // This is called _without_ a GL context:
@@ -95,7 +113,9 @@ private:
 protected:
     /**
      * tessellate defines the list of triangles that will be used to render
-     * the surface. By default it just returns 4 vertices for a rectangle.
+     * the surface. By default it just returns 4 vertices for a rectangle
+     * (or, if the renderable has an opaque region, one rectangle per piece
+     * inside or outside it, with the inside pieces marked opaque).
      * However you can override its behaviour to tessellate more finely and
      * deform freely for effects like wobbly windows.
      *
@@ -126,8 +146,56 @@ protected:
     virtual void draw(graphics::Renderable const& renderable) const;
 
 private:
+    /// Arguments for glBlendFuncSeparate(); a dst_rgb of GL_ZERO means blending is disabled
+    struct Blend
+    {
+        GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
+        GLfloat constant_alpha;
+    };
+
+    /// A run of triangles in the frame's vertex buffer that can be drawn with one call
+    struct DrawCommand
+    {
+        Program const* program;
+        std::shared_ptr<graphics::gl::Texture> texture;
+        std::shared_ptr<mir::gl::Texture> surface_tex;
+        glm::mat4 transform;
+        glm::vec2 centre;
+        GLfloat alpha;
+        Blend blend;
+        std::experimental::optional<geometry::Rectangle> clip;
+        geometry::Rectangle bounds;
+        bool transformed;
+        GLint first;
+        GLsizei count;
+    };
+
+    static auto client_blend_for(graphics::Renderable const& renderable) -> Blend;
+    static auto transform_for(
+        graphics::Renderable const& renderable,
+        std::shared_ptr<graphics::gl::Texture> const& texture) -> glm::mat4;
+
+    auto fallback_texture_for(graphics::Renderable const& renderable) const -> std::shared_ptr<mir::gl::Texture>;
+    auto program_for(
+        std::shared_ptr<graphics::gl::Texture> const& texture,
+        std::shared_ptr<mir::gl::Texture> const& surface_tex,
+        bool alpha) const -> Program const*;
+
+    /// Tessellates every renderable into the frame's vertex buffer
+    void record(graphics::RenderableList const& renderables) const;
+    /// Draws the recorded commands, or just those that touch area
+    void submit(std::experimental::optional<geometry::Rectangle> const& area) const;
+
     void update_gl_viewport();
 
+    /**
+     * The parts of the viewport that need repainting, taking into account
+     * the age of the buffer we are about to render into. Returns nothing if
+     * the whole viewport needs repainting.
+     */
+    auto areas_to_repaint() const -> std::experimental::optional<std::vector<geometry::Rectangle>>;
+    void scissor_to(geometry::Rectangle const& area) const;
+
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
     std::unique_ptr<mir::gl::TextureCache> const texture_cache;
@@ -135,6 +203,17 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+
+    Submission const submission;
+    GLuint mutable vertex_buffer = 0;
+    std::vector<mir::gl::Vertex> mutable batch_vertices;
+    std::vector<DrawCommand> mutable batch_commands;
+
+    // Screen coordinates map 1:1 onto the framebuffer, so we can scissor
+    bool viewport_is_unscaled = false;
+    std::experimental::optional<geometry::Rectangles> mutable damage;
+    std::deque<geometry::Rectangles> mutable damage_history;
+    std::experimental::optional<geometry::Rectangle> mutable repaint_area;
 };
 
 }
@@ -22,9 +22,14 @@
 
 namespace mrg = mir::renderer::gl;
 
+mrg::RendererFactory::RendererFactory(Renderer::Submission submission)
+    : submission{submission}
+{
+}
+
 std::unique_ptr<mir::renderer::Renderer>
 mrg::RendererFactory::create_renderer_for(
     graphics::DisplayBuffer& display_buffer)
 {
-    return std::make_unique<Renderer>(display_buffer);
+    return std::make_unique<Renderer>(display_buffer, submission);
 }
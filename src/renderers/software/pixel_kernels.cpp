@@ -0,0 +1,426 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pixel_kernels.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define MIR_SOFTWARE_RENDERER_X86 1
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+uint32_t const alpha_mask = 0xff000000;
+
+// Rounds x/255 for x in [0, 255·255], without a division
+inline uint32_t div255(uint32_t x)
+{
+    auto const t = x + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline uint32_t scale(uint32_t pixel, unsigned alpha)
+{
+    if (alpha == 255)
+        return pixel;
+
+    uint32_t result = 0;
+    for (int shift = 0; shift != 32; shift += 8)
+        result |= div255(((pixel >> shift) & 0xff) * alpha) << shift;
+    return result;
+}
+
+inline uint32_t over(uint32_t src, uint32_t dst)
+{
+    auto const inverse = 255 - (src >> 24);
+
+    uint32_t result = 0;
+    for (int shift = 0; shift != 32; shift += 8)
+    {
+        auto const channel = ((src >> shift) & 0xff) + div255(((dst >> shift) & 0xff) * inverse);
+        result |= std::min(channel, 255u) << shift;
+    }
+    return result;
+}
+
+void blend_scalar(uint32_t* dst, uint32_t const* src, int count, unsigned alpha)
+{
+    for (int i = 0; i != count; ++i)
+        dst[i] = over(scale(src[i], alpha), dst[i]);
+}
+
+void blend_opaque_scalar(uint32_t* dst, uint32_t const* src, int count, unsigned alpha)
+{
+    for (int i = 0; i != count; ++i)
+        dst[i] = over(scale(src[i] | alpha_mask, alpha), dst[i]);
+}
+
+void fill(uint32_t* dst, int count, uint32_t value)
+{
+    // Compilers vectorise this as well as anything we would write by hand
+    std::fill_n(dst, count, value);
+}
+
+void reverse_scalar(uint32_t* dst, uint32_t const* src, int count)
+{
+    for (int i = 0; i != count; ++i)
+        dst[i] = src[count - 1 - i];
+}
+
+void transpose_scalar(
+    uint32_t* dst, ptrdiff_t dst_stride,
+    uint32_t const* src, ptrdiff_t src_stride,
+    int width, int height)
+{
+    for (int y = 0; y != height; ++y)
+        for (int x = 0; x != width; ++x)
+            dst[x*dst_stride + y] = src[y*src_stride + x];
+}
+
+#if defined(MIR_SOFTWARE_RENDERER_X86)
+inline __m128i div255_epu16(__m128i x)
+{
+    auto const t = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// Four pixels of over(scale(src, alpha), dst), alpha being broadcast to every 16-bit lane
+inline __m128i over_sse2(__m128i src, __m128i dst, __m128i alpha, bool scale_src)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const max = _mm_set1_epi16(255);
+
+    auto src_lo = _mm_unpacklo_epi8(src, zero);
+    auto src_hi = _mm_unpackhi_epi8(src, zero);
+    if (scale_src)
+    {
+        src_lo = div255_epu16(_mm_mullo_epi16(src_lo, alpha));
+        src_hi = div255_epu16(_mm_mullo_epi16(src_hi, alpha));
+    }
+
+    auto const broadcast_alpha = [](__m128i pixels)
+        {
+            return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        };
+    auto const inverse_lo = _mm_sub_epi16(max, broadcast_alpha(src_lo));
+    auto const inverse_hi = _mm_sub_epi16(max, broadcast_alpha(src_hi));
+
+    auto const dst_lo = div255_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inverse_lo));
+    auto const dst_hi = div255_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inverse_hi));
+
+    return _mm_adds_epu8(_mm_packus_epi16(src_lo, src_hi), _mm_packus_epi16(dst_lo, dst_hi));
+}
+
+template<bool opaque>
+void blend_sse2(uint32_t* dst, uint32_t const* src, int count, unsigned alpha)
+{
+    auto const mask = _mm_set1_epi32(alpha_mask);
+    auto const zero = _mm_setzero_si128();
+    auto const alpha16 = _mm_set1_epi16(alpha);
+    bool const scale_src = alpha != 255;
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        if (opaque)
+            s = _mm_or_si128(s, mask);
+
+        // Most pixels of most windows are either fully opaque or fully transparent
+        if (!scale_src && _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, mask), mask)) == 0xffff)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff)
+            continue;
+
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), over_sse2(s, d, alpha16, scale_src));
+    }
+
+    if (opaque)
+        blend_opaque_scalar(dst + i, src + i, count - i, alpha);
+    else
+        blend_scalar(dst + i, src + i, count - i, alpha);
+}
+
+void reverse_sse2(uint32_t* dst, uint32_t const* src, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + count - 4 - i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+
+    for (; i < count; ++i)
+        dst[i] = src[count - 1 - i];
+}
+
+void transpose_sse2(
+    uint32_t* dst, ptrdiff_t dst_stride,
+    uint32_t const* src, ptrdiff_t src_stride,
+    int width, int height)
+{
+    int y = 0;
+    for (; y + 4 <= height; y += 4)
+    {
+        auto const row = [&](int n) { return src + (y + n)*src_stride; };
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            auto const r0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row(0) + x));
+            auto const r1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row(1) + x));
+            auto const r2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row(2) + x));
+            auto const r3 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row(3) + x));
+
+            auto const t0 = _mm_unpacklo_epi32(r0, r1);
+            auto const t1 = _mm_unpacklo_epi32(r2, r3);
+            auto const t2 = _mm_unpackhi_epi32(r0, r1);
+            auto const t3 = _mm_unpackhi_epi32(r2, r3);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + 0)*dst_stride + y), _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + 1)*dst_stride + y), _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + 2)*dst_stride + y), _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + 3)*dst_stride + y), _mm_unpackhi_epi64(t2, t3));
+        }
+
+        for (; x < width; ++x)
+            for (int n = 0; n != 4; ++n)
+                dst[x*dst_stride + y + n] = row(n)[x];
+    }
+
+    transpose_scalar(dst + y, dst_stride, src + y*src_stride, src_stride, width, height - y);
+}
+
+#define MIR_AVX2 __attribute__((target("avx2")))
+
+MIR_AVX2 inline __m256i div255_epu16_avx2(__m256i x)
+{
+    auto const t = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+MIR_AVX2 inline __m256i broadcast_alpha_avx2(__m256i pixels)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+// As over_sse2(), on eight pixels. Unpacking and packing both work within
+// 128-bit lanes, so pixels come back out in the order they went in.
+MIR_AVX2 inline __m256i over_avx2(__m256i src, __m256i dst, __m256i alpha, bool scale_src)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const max = _mm256_set1_epi16(255);
+
+    auto src_lo = _mm256_unpacklo_epi8(src, zero);
+    auto src_hi = _mm256_unpackhi_epi8(src, zero);
+    if (scale_src)
+    {
+        src_lo = div255_epu16_avx2(_mm256_mullo_epi16(src_lo, alpha));
+        src_hi = div255_epu16_avx2(_mm256_mullo_epi16(src_hi, alpha));
+    }
+
+    auto const inverse_lo = _mm256_sub_epi16(max, broadcast_alpha_avx2(src_lo));
+    auto const inverse_hi = _mm256_sub_epi16(max, broadcast_alpha_avx2(src_hi));
+
+    auto const dst_lo = div255_epu16_avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), inverse_lo));
+    auto const dst_hi = div255_epu16_avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), inverse_hi));
+
+    return _mm256_adds_epu8(_mm256_packus_epi16(src_lo, src_hi), _mm256_packus_epi16(dst_lo, dst_hi));
+}
+
+template<bool opaque>
+MIR_AVX2 void blend_avx2(uint32_t* dst, uint32_t const* src, int count, unsigned alpha)
+{
+    auto const mask = _mm256_set1_epi32(alpha_mask);
+    auto const zero = _mm256_setzero_si256();
+    auto const alpha16 = _mm256_set1_epi16(alpha);
+    bool const scale_src = alpha != 255;
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        if (opaque)
+            s = _mm256_or_si256(s, mask);
+
+        if (!scale_src && _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, mask), mask)) == -1)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+            continue;
+        }
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+            continue;
+
+        auto const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), over_avx2(s, d, alpha16, scale_src));
+    }
+
+    blend_sse2<opaque>(dst + i, src + i, count - i, alpha);
+}
+
+MIR_AVX2 void reverse_avx2(uint32_t* dst, uint32_t const* src, int count)
+{
+    auto const reversed = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + count - 8 - i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(v, reversed));
+    }
+
+    reverse_sse2(dst + i, src, count - i);
+}
+
+#undef MIR_AVX2
+#endif
+
+#if defined(__ARM_NEON)
+// Rounds x/255 exactly as div255() does: (x + ((x + 128) >> 8) + 128) >> 8
+inline uint8x8_t div255_neon(uint16x8_t x)
+{
+    return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+}
+
+template<bool opaque>
+void blend_neon(uint32_t* dst, uint32_t const* src, int count, unsigned alpha)
+{
+    auto const alpha8 = vdup_n_u8(alpha);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // De-interleaved into planes of B, G, R and A
+        auto s = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        if (opaque)
+            s.val[3] = vdup_n_u8(255);
+
+        if (alpha != 255)
+        {
+            for (int c = 0; c != 4; ++c)
+                s.val[c] = div255_neon(vmull_u8(s.val[c], alpha8));
+        }
+
+        auto const inverse = vmvn_u8(s.val[3]);
+        auto d = vld4_u8(reinterpret_cast<uint8_t const*>(dst + i));
+        for (int c = 0; c != 4; ++c)
+            d.val[c] = vqadd_u8(s.val[c], div255_neon(vmull_u8(d.val[c], inverse)));
+
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+
+    if (opaque)
+        blend_opaque_scalar(dst + i, src + i, count - i, alpha);
+    else
+        blend_scalar(dst + i, src + i, count - i, alpha);
+}
+
+void reverse_neon(uint32_t* dst, uint32_t const* src, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const v = vrev64q_u32(vld1q_u32(src + count - 4 - i));
+        vst1q_u32(dst + i, vcombine_u32(vget_high_u32(v), vget_low_u32(v)));
+    }
+
+    for (; i < count; ++i)
+        dst[i] = src[count - 1 - i];
+}
+
+void transpose_neon(
+    uint32_t* dst, ptrdiff_t dst_stride,
+    uint32_t const* src, ptrdiff_t src_stride,
+    int width, int height)
+{
+    int y = 0;
+    for (; y + 4 <= height; y += 4)
+    {
+        auto const row = [&](int n) { return src + (y + n)*src_stride; };
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            auto const t01 = vtrnq_u32(vld1q_u32(row(0) + x), vld1q_u32(row(1) + x));
+            auto const t23 = vtrnq_u32(vld1q_u32(row(2) + x), vld1q_u32(row(3) + x));
+
+            vst1q_u32(dst + (x + 0)*dst_stride + y, vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])));
+            vst1q_u32(dst + (x + 1)*dst_stride + y, vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])));
+            vst1q_u32(dst + (x + 2)*dst_stride + y, vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+            vst1q_u32(dst + (x + 3)*dst_stride + y, vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+        }
+
+        for (; x < width; ++x)
+            for (int n = 0; n != 4; ++n)
+                dst[x*dst_stride + y + n] = row(n)[x];
+    }
+
+    transpose_scalar(dst + y, dst_stride, src + y*src_stride, src_stride, width, height - y);
+}
+#endif
+
+mrs::PixelKernels const scalar{"scalar", blend_scalar, blend_opaque_scalar, fill, reverse_scalar, transpose_scalar};
+
+#if defined(MIR_SOFTWARE_RENDERER_X86)
+mrs::PixelKernels const sse2{"sse2", blend_sse2<false>, blend_sse2<true>, fill, reverse_sse2, transpose_sse2};
+// A 4×4 SSE2 tile already transposes at memory speed
+mrs::PixelKernels const avx2{"avx2", blend_avx2<false>, blend_avx2<true>, fill, reverse_avx2, transpose_sse2};
+#endif
+
+#if defined(__ARM_NEON)
+mrs::PixelKernels const neon{"neon", blend_neon<false>, blend_neon<true>, fill, reverse_neon, transpose_neon};
+#endif
+}
+
+auto mrs::scalar_kernels() -> PixelKernels const&
+{
+    return scalar;
+}
+
+auto mrs::supported_kernels() -> std::vector<PixelKernels const*>
+{
+    std::vector<PixelKernels const*> result{&scalar};
+
+#if defined(MIR_SOFTWARE_RENDERER_X86)
+    result.push_back(&sse2);
+    if (__builtin_cpu_supports("avx2"))
+        result.push_back(&avx2);
+#endif
+
+#if defined(__ARM_NEON)
+    result.push_back(&neon);
+#endif
+
+    return result;
+}
+
+auto mrs::best_kernels() -> PixelKernels const&
+{
+    static auto const& best = *supported_kernels().back();
+    return best;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_PIXEL_KERNELS_H_
+#define MIR_RENDERER_SOFTWARE_PIXEL_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * Span operations on 32-bit premultiplied ARGB pixels.
+ *
+ * There is an implementation per instruction set; all of them produce
+ * exactly the same results as the scalar one.
+ */
+struct PixelKernels
+{
+    char const* name;
+
+    /// dst = src·alpha + dst·(1 - src.a·alpha), alpha in [0, 255]
+    void (*blend)(uint32_t* dst, uint32_t const* src, int count, unsigned alpha);
+    /// As blend(), treating every src pixel as opaque (for XRGB sources)
+    void (*blend_opaque)(uint32_t* dst, uint32_t const* src, int count, unsigned alpha);
+    /// dst[i] = value
+    void (*fill)(uint32_t* dst, int count, uint32_t value);
+    /// dst[i] = src[count - 1 - i]
+    void (*reverse)(uint32_t* dst, uint32_t const* src, int count);
+    /// dst[x·dst_stride + y] = src[y·src_stride + x]; strides are in pixels and may be negative
+    void (*transpose)(
+        uint32_t* dst, ptrdiff_t dst_stride,
+        uint32_t const* src, ptrdiff_t src_stride,
+        int width, int height);
+};
+
+auto scalar_kernels() -> PixelKernels const&;
+
+/// Every implementation the running CPU supports, fastest last
+auto supported_kernels() -> std::vector<PixelKernels const*>;
+
+/// The fastest implementation the running CPU supports
+auto best_kernels() -> PixelKernels const&;
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SOFTWARE_PIXEL_KERNELS_H_ */
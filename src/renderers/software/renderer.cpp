@@ -0,0 +1,332 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer.h"
+#include "mir/geometry/displacement.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace mrs = mir::renderer::software;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+uint32_t const clear_colour = 0xff000000;
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width <= geom::Width{0} || rect.size.height <= geom::Height{0};
+}
+
+mrs::RenderTarget& render_target_of(mg::DisplayBuffer& display_buffer)
+{
+    auto const target = dynamic_cast<mrs::RenderTarget*>(display_buffer.native_display_buffer());
+    if (!target)
+        BOOST_THROW_EXCEPTION(std::logic_error("Display buffer does not support software rendering"));
+    return *target;
+}
+}
+
+mrs::Renderer::Renderer(mg::DisplayBuffer& display_buffer)
+    : Renderer(display_buffer, best_kernels())
+{
+}
+
+mrs::Renderer::Renderer(mg::DisplayBuffer& display_buffer, PixelKernels const& kernels)
+    : target(render_target_of(display_buffer)),
+      kernels(kernels)
+{
+    mir::log_info("Software renderer using %s pixel kernels", kernels.name);
+    update_transform();
+    set_viewport(display_buffer.view_area());
+}
+
+mrs::Renderer::~Renderer() = default;
+
+void mrs::Renderer::set_viewport(geom::Rectangle const& rect)
+{
+    if (rect == viewport)
+        return;
+
+    viewport = rect;
+    frame.assign(
+        std::max(0, rect.size.width.as_int()) * std::max(0, rect.size.height.as_int()),
+        clear_colour);
+    update_transform();
+    full_repaint = true;
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& t)
+{
+    if (t == output_transform)
+        return;
+
+    output_transform = t;
+    update_transform();
+    full_repaint = true;
+}
+
+void mrs::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    this->damage = damage;
+}
+
+void mrs::Renderer::suspend()
+{
+    // Whatever the target shows by the next frame may not be what we last drew
+    full_repaint = true;
+}
+
+void mrs::Renderer::update_transform()
+{
+    // Column-major, so t[column][row]
+    int const xx = std::lround(output_transform[0][0]);
+    int const xy = std::lround(output_transform[1][0]);
+    int const yx = std::lround(output_transform[0][1]);
+    int const yy = std::lround(output_transform[1][1]);
+
+    auto const unit = [](int n) { return n == -1 || n == 1; };
+    bool const rotation_or_reflection =
+        (xy == 0 && yx == 0 && unit(xx) && unit(yy)) ||
+        (xx == 0 && yy == 0 && unit(xy) && unit(yx));
+
+    if (!rotation_or_reflection)
+    {
+        mir::log_warning("Software renderer only supports rotating and reflecting outputs; ignoring output transform");
+        transform = Transform{1, 0, 0, 0, 1, 0};
+        return;
+    }
+
+    auto const last_x = viewport.size.width.as_int() - 1;
+    auto const last_y = viewport.size.height.as_int() - 1;
+
+    // Place the corner that lands furthest up and left at the target origin
+    transform = Transform{
+        xx, xy, -(std::min(0, xx*last_x) + std::min(0, xy*last_y)),
+        yx, yy, -(std::min(0, yx*last_x) + std::min(0, yy*last_y))};
+}
+
+auto mrs::Renderer::areas_to_repaint() const -> std::vector<geom::Rectangle>
+{
+    auto const frame_damage = damage;
+    damage = std::experimental::nullopt;
+
+    if (full_repaint || !frame_damage)
+    {
+        full_repaint = false;
+        return {viewport};
+    }
+
+    std::vector<geom::Rectangle> areas;
+    for (auto const& rect : frame_damage.value())
+    {
+        auto const area = rect.intersection_with(viewport);
+        if (!is_empty(area))
+            areas.push_back(area);
+    }
+
+    // Every renderable is blended into all the areas at once, so they must not overlap
+    for (auto i = areas.begin(); i != areas.end(); ++i)
+    {
+        for (auto j = i + 1; j != areas.end(); ++j)
+        {
+            if (i->overlaps(*j))
+            {
+                geom::Rectangles coalesced;
+                for (auto const& area : areas)
+                    coalesced.add(area);
+                return {coalesced.bounding_rectangle()};
+            }
+        }
+    }
+
+    return areas;
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    if (is_empty(viewport))
+        return;
+
+    auto const areas = areas_to_repaint();
+    auto const frame_width = viewport.size.width.as_int();
+
+    for (auto const& area : areas)
+    {
+        auto const width = area.size.width.as_int();
+        for (auto y = area.top().as_int(); y != area.bottom().as_int(); ++y)
+        {
+            auto const row = (y - viewport.top().as_int()) * frame_width;
+            kernels.fill(&frame[row + area.left().as_int() - viewport.left().as_int()], width, clear_colour);
+        }
+    }
+
+    for (auto const& renderable : renderables)
+        draw(*renderable, areas);
+
+    present(areas);
+}
+
+void mrs::Renderer::draw(mg::Renderable const& renderable, std::vector<geom::Rectangle> const& areas) const
+{
+    auto const buffer = renderable.buffer();
+    if (!buffer)
+        return;
+
+    // Buffers without CPU-accessible pixels (e.g. GPU-only dmabufs) can't be drawn
+    auto const pixel_source = dynamic_cast<PixelSource*>(buffer->native_buffer_base());
+    if (!pixel_source)
+        return;
+
+    auto const format = buffer->pixel_format();
+    if (format != mir_pixel_format_argb_8888 && format != mir_pixel_format_xrgb_8888)
+        return;
+
+    auto const alpha = static_cast<unsigned>(std::lround(std::min(std::max(renderable.alpha(), 0.0f), 1.0f) * 255));
+    if (alpha == 0)
+        return;
+
+    auto const position = renderable.screen_position();
+    auto bounds = position.intersection_with(viewport);
+    if (auto const clip = renderable.clip_area())
+        bounds = bounds.intersection_with(clip.value());
+    if (is_empty(bounds))
+        return;
+
+    auto const blend = format == mir_pixel_format_xrgb_8888 || !renderable.shaped() ?
+        kernels.blend_opaque : kernels.blend;
+
+    auto const buffer_width = int64_t{buffer->size().width.as_int()};
+    auto const buffer_height = int64_t{buffer->size().height.as_int()};
+    auto const position_width = position.size.width.as_int();
+    auto const position_height = position.size.height.as_int();
+    bool const unscaled = buffer_width == position_width && buffer_height == position_height;
+    auto const frame_width = viewport.size.width.as_int();
+
+    pixel_source->read([&](unsigned char const* pixels)
+        {
+            auto const stride = pixel_source->stride().as_int();
+
+            for (auto const& area : areas)
+            {
+                auto const target_area = area.intersection_with(bounds);
+                if (is_empty(target_area))
+                    continue;
+
+                auto const left = target_area.left().as_int();
+                auto const width = target_area.size.width.as_int();
+
+                for (auto y = target_area.top().as_int(); y != target_area.bottom().as_int(); ++y)
+                {
+                    auto const source_y = (y - position.top().as_int()) * buffer_height / position_height;
+                    auto const source_row = reinterpret_cast<uint32_t const*>(pixels + source_y*stride);
+                    auto const dest = &frame[
+                        (y - viewport.top().as_int()) * frame_width + left - viewport.left().as_int()];
+
+                    if (unscaled)
+                    {
+                        blend(dest, source_row + (left - position.left().as_int()), width, alpha);
+                    }
+                    else
+                    {
+                        scaled_row.resize(width);
+                        for (int x = 0; x != width; ++x)
+                            scaled_row[x] = source_row[(left + x - position.left().as_int()) * buffer_width / position_width];
+                        blend(dest, scaled_row.data(), width, alpha);
+                    }
+                }
+            }
+        });
+}
+
+void mrs::Renderer::present(std::vector<geom::Rectangle> const& areas) const
+{
+    auto const frame_width = viewport.size.width.as_int();
+    auto const target_size = target.size();
+    auto const t = transform;
+
+    if (target_size.width <= geom::Width{0} || target_size.height <= geom::Height{0})
+        return;
+
+    // The part of the viewport that lands on the target (the inverse of a
+    // rotation or reflection is its transpose)
+    auto const to_viewport = [&](int px, int py)
+        {
+            return geom::Point{t.xx*(px - t.x0) + t.yx*(py - t.y0), t.xy*(px - t.x0) + t.yy*(py - t.y0)};
+        };
+    auto const first = to_viewport(0, 0);
+    auto const last = to_viewport(target_size.width.as_int() - 1, target_size.height.as_int() - 1);
+    geom::Rectangle const visible{
+        {std::min(first.x, last.x), std::min(first.y, last.y)},
+        {std::abs(last.x.as_int() - first.x.as_int()) + 1, std::abs(last.y.as_int() - first.y.as_int()) + 1}};
+
+    target.write([&](unsigned char* pixels, geom::Stride stride)
+        {
+            auto const base = reinterpret_cast<uint32_t*>(pixels);
+            auto const pitch = stride.as_int() / static_cast<int>(sizeof(uint32_t));
+
+            for (auto const& area : areas)
+            {
+                auto const local = geom::Rectangle{area.top_left - as_displacement(viewport.top_left), area.size}
+                    .intersection_with(visible);
+                if (is_empty(local))
+                    continue;
+
+                auto const x = local.left().as_int();
+                auto const y = local.top().as_int();
+                auto const width = local.size.width.as_int();
+                auto const height = local.size.height.as_int();
+                auto const source = frame.data() + y*frame_width + x;
+
+                if (t.yx == 0)
+                {
+                    // Rows stay rows, though they may be flipped or reversed
+                    for (int row = 0; row != height; ++row)
+                    {
+                        auto const dest_row = base + (t.yy*(y + row) + t.y0)*pitch;
+                        if (t.xx == 1)
+                            std::memcpy(dest_row + x + t.x0, source + row*frame_width, width*sizeof(uint32_t));
+                        else
+                            kernels.reverse(dest_row + t.x0 - (x + width - 1), source + row*frame_width, width);
+                    }
+                }
+                else
+                {
+                    // Rows become columns; walk the rows backwards if they land right to left
+                    auto const dest = base + (t.yx*x + t.y0)*pitch +
+                        (t.xy == 1 ? y + t.x0 : t.x0 - (y + height - 1));
+                    auto const first_row = t.xy == 1 ? source : source + (height - 1)*frame_width;
+                    kernels.transpose(dest, t.yx*pitch, first_row, t.xy*frame_width, width, height);
+                }
+            }
+        });
+
+    target.swap_buffers();
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_RENDERER_H_
+#define MIR_RENDERER_SOFTWARE_RENDERER_H_
+
+#include "pixel_kernels.h"
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayBuffer;
+}
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+
+/**
+ * Composites on the CPU into a software RenderTarget.
+ *
+ * Frames are composed in a shadow buffer in scene coordinates, so only
+ * damaged areas are repainted and then copied (rotated or reflected by the
+ * output transform) to the target. Buffers are scaled nearest-neighbour;
+ * renderable transformations are not supported and are drawn untransformed.
+ * Only mir_pixel_format_argb_8888 and mir_pixel_format_xrgb_8888 buffers
+ * exposing a PixelSource are drawn.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    explicit Renderer(graphics::DisplayBuffer& display_buffer);
+    Renderer(graphics::DisplayBuffer& display_buffer, PixelKernels const& kernels);
+    ~Renderer();
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const& transform) override;
+    void set_damage(geometry::Rectangles const& damage) override;
+    void render(graphics::RenderableList const& renderables) const override;
+    void suspend() override;
+
+private:
+    /// Maps a viewport-relative (x, y) to target pixel (xx·x + xy·y + x0, yx·x + yy·y + y0)
+    struct Transform
+    {
+        int xx, xy, x0;
+        int yx, yy, y0;
+    };
+
+    auto areas_to_repaint() const -> std::vector<geometry::Rectangle>;
+    void draw(graphics::Renderable const& renderable, std::vector<geometry::Rectangle> const& areas) const;
+    void present(std::vector<geometry::Rectangle> const& areas) const;
+    void update_transform();
+
+    RenderTarget& target;
+    PixelKernels const& kernels;
+
+    geometry::Rectangle viewport;
+    glm::mat2 output_transform{1};
+    Transform transform;
+
+    std::vector<uint32_t> mutable frame;
+    std::vector<uint32_t> mutable scaled_row;
+    std::experimental::optional<geometry::Rectangles> mutable damage;
+    bool mutable full_repaint{true};
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SOFTWARE_RENDERER_H_ */
@@ -0,0 +1,41 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer_factory.h"
+#include "renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/log.h"
+
+namespace mrs = mir::renderer::software;
+
+mrs::RendererFactory::RendererFactory(std::shared_ptr<renderer::RendererFactory> const& fallback)
+    : fallback{fallback}
+{
+}
+
+std::unique_ptr<mir::renderer::Renderer>
+mrs::RendererFactory::create_renderer_for(
+    graphics::DisplayBuffer& display_buffer)
+{
+    if (dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer()))
+        return std::make_unique<Renderer>(display_buffer);
+
+    mir::log_warning("Display buffer does not support software rendering, using the fallback renderer");
+    return fallback->create_renderer_for(display_buffer);
+}
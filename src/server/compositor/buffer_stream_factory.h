@@ -34,10 +34,12 @@ class GraphicBufferAllocator;
 namespace compositor
 {
 
+class CompositorReport;
+
 class BufferStreamFactory : public scene::BufferStreamFactory
 {
 public:
-    BufferStreamFactory();
+    BufferStreamFactory(std::shared_ptr<CompositorReport> const& report);
 
     virtual ~BufferStreamFactory() {}
 
@@ -46,6 +48,9 @@ public:
         graphics::BufferProperties const& buffer_properties) override;
     virtual std::shared_ptr<BufferStream> create_buffer_stream(
         graphics::BufferProperties const&) override;
+
+private:
+    std::shared_ptr<CompositorReport> const report;
 };
 
 }
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "damage_tracker.h"
+#include "mir/graphics/buffer.h"
+#include "mir/geometry/displacement.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+glm::mat4 const identity(1);
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width <= geom::Width{0} || rect.size.height <= geom::Height{0};
+}
+
+/// Maps a rectangle in buffer coordinates to the (possibly scaled) screen area showing the buffer
+auto buffer_to_screen(geom::Rectangle const& rect, geom::Size const& buffer_size, geom::Rectangle const& screen)
+    -> geom::Rectangle
+{
+    if (buffer_size == screen.size)
+        return {screen.top_left + as_displacement(rect.top_left), rect.size};
+
+    auto const scale_x = double(screen.size.width.as_int()) / buffer_size.width.as_int();
+    auto const scale_y = double(screen.size.height.as_int()) / buffer_size.height.as_int();
+
+    auto const left = int(std::floor(rect.top_left.x.as_int() * scale_x));
+    auto const top = int(std::floor(rect.top_left.y.as_int() * scale_y));
+    auto const right = int(std::ceil(rect.right().as_int() * scale_x));
+    auto const bottom = int(std::ceil(rect.bottom().as_int() * scale_y));
+
+    return {screen.top_left + geom::Displacement{left, top}, geom::Size{right - left, bottom - top}};
+}
+}
+
+auto mc::DamageTracker::state_of(mg::Renderable const& renderable) -> RenderableState
+{
+    std::experimental::optional<mg::BufferID> buffer_id;
+    if (auto const buffer = renderable.buffer())
+        buffer_id = buffer->id();
+
+    return {
+        renderable.id(),
+        buffer_id,
+        renderable.screen_position(),
+        renderable.clip_area(),
+        renderable.alpha(),
+        renderable.transformation(),
+        renderable.shaped()};
+}
+
+auto mc::DamageTracker::damage_for(mg::RenderableList const& renderables, geom::Rectangle const& view_area)
+    -> geom::Rectangles
+{
+    std::vector<RenderableState> this_frame;
+    this_frame.reserve(renderables.size());
+    for (auto const& renderable : renderables)
+        this_frame.push_back(state_of(*renderable));
+
+    geom::Rectangles damage;
+
+    if (!last_view_area || last_view_area.value() != view_area)
+    {
+        damage.add(view_area);
+    }
+    else
+    {
+        auto const add_damage = [&](RenderableState const& state)
+            {
+                if (state.transformation != identity)
+                {
+                    // We don't know where a transformed renderable ends up
+                    damage.add(view_area);
+                    return;
+                }
+
+                auto area = state.screen_position.intersection_with(view_area);
+                if (state.clip_area)
+                    area = area.intersection_with(state.clip_area.value());
+
+                if (!is_empty(area))
+                    damage.add(area);
+            };
+
+        std::vector<bool> still_present(last_frame.size(), false);
+        long topmost_previous_index = -1;
+
+        for (auto i = 0u; i != this_frame.size(); ++i)
+        {
+            auto const& current = this_frame[i];
+
+            auto const previous = std::find_if(
+                begin(last_frame), end(last_frame),
+                [&current](RenderableState const& state) { return state.id == current.id; });
+
+            if (previous == end(last_frame))
+            {
+                add_damage(current);
+                continue;
+            }
+
+            auto const previous_index = previous - begin(last_frame);
+            still_present[previous_index] = true;
+
+            bool const moved =
+                previous->screen_position != current.screen_position ||
+                previous->clip_area != current.clip_area ||
+                previous->transformation != current.transformation;
+
+            if (moved)
+            {
+                add_damage(*previous);
+                add_damage(current);
+            }
+            else if (previous->alpha != current.alpha ||
+                     previous->shaped != current.shaped)
+            {
+                add_damage(current);
+            }
+            else if (previous->buffer_id != current.buffer_id)
+            {
+                auto const& renderable = *renderables[i];
+                auto const buffer = renderable.buffer();
+                auto const buffer_damage = (previous->buffer_id && buffer) ?
+                    renderable.damage_since(previous->buffer_id.value()) :
+                    std::experimental::nullopt;
+
+                if (buffer_damage && current.transformation == identity && !is_empty({{}, buffer->size()}))
+                {
+                    for (auto const& rect : buffer_damage.value())
+                    {
+                        auto changed = current;
+                        changed.screen_position = buffer_to_screen(rect, buffer->size(), current.screen_position)
+                            .intersection_with(current.screen_position);
+                        add_damage(changed);
+                    }
+                }
+                else
+                {
+                    add_damage(current);
+                }
+            }
+            else if (previous_index < topmost_previous_index)
+            {
+                // Restacked above something that used to be above it
+                add_damage(current);
+            }
+
+            topmost_previous_index = std::max(topmost_previous_index, long(previous_index));
+        }
+
+        for (auto i = 0u; i != last_frame.size(); ++i)
+        {
+            if (!still_present[i])
+                add_damage(last_frame[i]);
+        }
+    }
+
+    last_frame = std::move(this_frame);
+    last_view_area = view_area;
+
+    return damage;
+}
+
+void mc::DamageTracker::reset()
+{
+    last_frame.clear();
+    last_view_area = std::experimental::nullopt;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+#define MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/renderable.h"
+
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Works out which parts of an output changed between consecutive frames.
+ *
+ * One DamageTracker is used per DisplayBufferCompositor: it remembers what
+ * was rendered last time and compares that with the next RenderableList.
+ */
+class DamageTracker
+{
+public:
+    DamageTracker() = default;
+
+    /**
+     * Returns the area of view_area that needs repainting for renderables
+     * to appear on screen, relative to the previous call.
+     */
+    auto damage_for(graphics::RenderableList const& renderables, geometry::Rectangle const& view_area)
+        -> geometry::Rectangles;
+
+    /// The next frame will be reported as fully damaged
+    void reset();
+
+private:
+    struct RenderableState
+    {
+        graphics::Renderable::ID id;
+        std::experimental::optional<graphics::BufferID> buffer_id;
+        geometry::Rectangle screen_position;
+        std::experimental::optional<geometry::Rectangle> clip_area;
+        float alpha;
+        glm::mat4 transformation;
+        bool shaped;
+    };
+
+    static auto state_of(graphics::Renderable const& renderable) -> RenderableState;
+
+    std::vector<RenderableState> last_frame;
+    std::experimental::optional<geometry::Rectangle> last_view_area;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_DAMAGE_TRACKER_H_ */
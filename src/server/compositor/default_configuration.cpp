@@ -22,7 +22,9 @@
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
+#include "presentation_observer_multiplexer.h"
 #include "gl/renderer_factory.h"
+#include "software/renderer_factory.h"
 #include "compositing_screencast.h"
 #include "mir/main_loop.h"
 
@@ -39,9 +41,9 @@ std::shared_ptr<ms::BufferStreamFactory>
 mir::DefaultServerConfiguration::the_buffer_stream_factory()
 {
     return buffer_stream_factory(
-        []()
+        [this]()
         {
-            return std::make_shared<mc::BufferStreamFactory>();
+            return std::make_shared<mc::BufferStreamFactory>(the_compositor_report());
         });
 }
 
@@ -77,18 +79,49 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_scene(),
                 the_display_buffer_compositor_factory(),
                 the_shell(),
+                the_presentation_observer(),
                 the_compositor_report(),
                 composite_delay,
                 !the_options()->is_set(options::host_socket_opt));
         });
 }
 
+std::shared_ptr<mir::ObserverRegistrar<mc::PresentationObserver>>
+mir::DefaultServerConfiguration::the_presentation_observer_registrar()
+{
+    return presentation_observer_multiplexer(
+        [default_executor = the_main_loop()]
+        {
+            return std::make_shared<mc::PresentationObserverMultiplexer>(default_executor);
+        });
+}
+
+std::shared_ptr<mc::PresentationObserver>
+mir::DefaultServerConfiguration::the_presentation_observer()
+{
+    return presentation_observer_multiplexer(
+        [default_executor = the_main_loop()]
+        {
+            return std::make_shared<mc::PresentationObserverMultiplexer>(default_executor);
+        });
+}
+
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]()
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            auto const submission = the_options()->get<bool>(options::gl_batch_draws_opt) ?
+                mir::renderer::gl::Renderer::Submission::batched :
+                mir::renderer::gl::Renderer::Submission::immediate;
+
+            auto const gl_factory = std::make_shared<mir::renderer::gl::RendererFactory>(submission);
+
+            if (the_options()->get<std::string>(options::renderer_opt) == "software")
+                return std::shared_ptr<mir::renderer::RendererFactory>{
+                    std::make_shared<mir::renderer::software::RendererFactory>(gl_factory)};
+
+            return std::shared_ptr<mir::renderer::RendererFactory>{gl_factory};
         });
 }
 
@@ -76,11 +76,13 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+        damage_tracker.reset();
     }
     else
     {
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
+        renderer->set_damage(damage_tracker.damage_for(renderable_list, view_area));
         renderer->render(renderable_list);
 
         report->renderables_in_frame(this, renderable_list);
@@ -17,11 +17,13 @@
  */
 
 #include "multi_threaded_compositor.h"
+#include "repaint_scheduler.h"
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/compositor/display_listener.h"
+#include "mir/compositor/presentation_observer.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/compositor_report.h"
 #include "mir/scene/legacy_scene_change_notification.h"
@@ -56,6 +58,7 @@ public:
         mg::DisplaySyncGroup& group,
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
+        std::shared_ptr<PresentationObserver> const& presentation_observer,
         std::chrono::milliseconds fixed_composite_delay,
         std::shared_ptr<CompositorReport> const& report) :
         compositor_factory{db_compositor_factory},
@@ -65,6 +68,7 @@ public:
         frames_scheduled{0},
         force_sleep{fixed_composite_delay},
         display_listener{display_listener},
+        presentation_observer{presentation_observer},
         report{report},
         started_future{started.get_future()}
     {
@@ -135,12 +139,46 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
+                    /*
+                     * When the outputs report their frame timing, start as late
+                     * before the next vblank as recent frames say is safe. This
+                     * minimises the latency between snapshotting the scene and
+                     * the result being shown.
+                     */
+                    auto const adaptive_delay = force_sleep < std::chrono::milliseconds::zero() ?
+                        repaint_scheduler.delay_before_repaint() : std::experimental::nullopt;
+                    if (adaptive_delay)
+                        std::this_thread::sleep_for(adaptive_delay.value());
+
+                    repaint_scheduler.repaint_starting();
+
                     for (auto& tuple : compositors)
                     {
                         auto& compositor = std::get<1>(tuple);
+                        auto const render_start = std::chrono::steady_clock::now();
                         compositor->composite(scene->scene_elements_for(compositor.get()));
+                        repaint_scheduler.rendered(
+                            std::get<0>(tuple),
+                            std::chrono::steady_clock::now() - render_start);
                     }
+
+                    auto const post_start = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
                     group.post();
+                    repaint_scheduler.posted(post_start, mir::time::PosixTimestamp::now(CLOCK_MONOTONIC));
+
+                    for (auto& tuple : compositors)
+                    {
+                        auto const& buffer = *std::get<0>(tuple);
+                        auto const frame = buffer.last_frame();
+
+                        auto const comp_id = std::get<1>(tuple).get();
+
+                        presentation_observer->frame_presented(buffer.view_area(), frame);
+                        report->presented_frame(comp_id, frame);
+
+                        if (repaint_scheduler.presented(&buffer, frame))
+                            report->missed_frame(comp_id);
+                    }
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
@@ -148,10 +186,13 @@ public:
                      * beneficial to sleep for most of the next frame. This reduces
                      * the latency between snapshotting the scene and post()
                      * completing by almost a whole frame.
+                     *
+                     * Only needed when there's no frame timing to schedule from.
                      */
-                    auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
-                                 force_sleep : group.recommended_sleep();
-                    std::this_thread::sleep_for(delay);
+                    if (force_sleep >= std::chrono::milliseconds::zero())
+                        std::this_thread::sleep_for(force_sleep);
+                    else if (!repaint_scheduler.delay_before_repaint())
+                        std::this_thread::sleep_for(group.recommended_sleep());
 
                     lock.lock();
 
@@ -240,7 +281,9 @@ private:
     std::mutex run_mutex;
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
+    std::shared_ptr<PresentationObserver> const presentation_observer;
     std::shared_ptr<CompositorReport> const report;
+    RepaintScheduler repaint_scheduler;
     std::promise<void> started;
     std::future<void> started_future;
     bool not_posted_yet = true;
@@ -254,6 +297,7 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<mc::Scene> const& scene,
     std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
     std::shared_ptr<DisplayListener> const& display_listener,
+    std::shared_ptr<PresentationObserver> const& presentation_observer,
     std::shared_ptr<CompositorReport> const& compositor_report,
     std::chrono::milliseconds fixed_composite_delay,
     bool compose_on_start)
@@ -261,6 +305,7 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
       scene{scene},
       display_buffer_compositor_factory{db_compositor_factory},
       display_listener{display_listener},
+      presentation_observer{presentation_observer},
       report{compositor_report},
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
@@ -368,7 +413,7 @@ void mc::MultiThreadedCompositor::create_compositing_threads()
     {
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
             display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            presentation_observer, fixed_composite_delay, report);
 
         futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
         thread_functors.push_back(std::move(thread_functor));
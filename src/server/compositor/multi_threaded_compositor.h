@@ -46,6 +46,7 @@ namespace compositor
 
 class DisplayBufferCompositorFactory;
 class DisplayListener;
+class PresentationObserver;
 class CompositingFunctor;
 class Scene;
 class CompositorReport;
@@ -66,6 +67,7 @@ public:
         std::shared_ptr<Scene> const& scene,
         std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
         std::shared_ptr<DisplayListener> const& display_listener,
+        std::shared_ptr<PresentationObserver> const& presentation_observer,
         std::shared_ptr<CompositorReport> const& compositor_report,
         std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
         bool compose_on_start);
@@ -82,6 +84,7 @@ private:
     std::shared_ptr<Scene> const scene;
     std::shared_ptr<DisplayBufferCompositorFactory> const display_buffer_compositor_factory;
     std::shared_ptr<DisplayListener> const display_listener;
+    std::shared_ptr<PresentationObserver> const presentation_observer;
     std::shared_ptr<CompositorReport> const report;
 
     std::vector<std::unique_ptr<CompositingFunctor>> thread_functors;
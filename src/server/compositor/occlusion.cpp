@@ -20,8 +20,7 @@
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
-
-#include <vector>
+#include "region.h"
 
 using namespace mir::geometry;
 using namespace mir::graphics;
@@ -32,7 +31,7 @@ namespace
 bool renderable_is_occluded(
     Renderable const& renderable, 
     Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+    Region& coverage)
 {
     static glm::mat4 const identity(1);
     static Rectangle const empty{};
@@ -41,24 +40,29 @@ bool renderable_is_occluded(
         return false;  // Weirdly transformed. Assume never occluded.
 
     auto const& window = renderable.screen_position();
-    auto const& clipped_window = window.intersection_with(area);
+    auto clipped_window = window.intersection_with(area);
+    if (auto const clip_area = renderable.clip_area())
+        clipped_window = clipped_window.intersection_with(clip_area.value());
 
     if (clipped_window == empty)
         return true;  // Not in the area; definitely occluded.
 
-    bool occluded = false;
-    for (auto const& r : coverage)
+    // Covered by the union of everything opaque above it, not necessarily by any one window
+    bool const occluded = coverage.contains(clipped_window);
+
+    if (!occluded && renderable.alpha() == 1.0f)
     {
-        if (r.contains(clipped_window))
+        if (!renderable.shaped())
+        {
+            coverage.add(clipped_window);
+        }
+        else
         {
-            occluded = true;
-            break;
+            for (auto const& opaque : renderable.opaque_region())
+                coverage.add(opaque.intersection_with(clipped_window));
         }
     }
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
-
     return occluded;
 }
 }
@@ -68,7 +72,7 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
     Rectangle const& area)
 {
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    Region coverage;
 
     auto it = elements.rbegin();
     while (it != elements.rend())
@@ -0,0 +1,37 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_observer_multiplexer.h"
+
+#include "mir/geometry/rectangle.h"
+#include "mir/graphics/frame.h"
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+mc::PresentationObserverMultiplexer::PresentationObserverMultiplexer(
+    std::shared_ptr<Executor> const& default_executor)
+    : ObserverMultiplexer(*default_executor),
+      executor{default_executor}
+{
+}
+
+void mc::PresentationObserverMultiplexer::frame_presented(
+    geometry::Rectangle const& view_area,
+    mg::Frame const& frame)
+{
+    for_each_observer(&mc::PresentationObserver::frame_presented, view_area, frame);
+}
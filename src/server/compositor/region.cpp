@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "region.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace geom = mir::geometry;
+
+namespace
+{
+using Span = std::pair<int, int>;
+
+/// Merges span into sorted, disjoint spans, joining any it overlaps or touches
+auto with_span(std::vector<Span> const& spans, Span span) -> std::vector<Span>
+{
+    std::vector<Span> result;
+    result.reserve(spans.size() + 1);
+
+    auto s = spans.begin();
+    for (; s != spans.end() && s->second < span.first; ++s)
+        result.push_back(*s);
+
+    for (; s != spans.end() && s->first <= span.second; ++s)
+    {
+        span.first = std::min(span.first, s->first);
+        span.second = std::max(span.second, s->second);
+    }
+
+    result.push_back(span);
+    result.insert(result.end(), s, spans.end());
+
+    return result;
+}
+}
+
+void mc::Region::add(geom::Rectangle const& rect)
+{
+    auto const left = rect.left().as_int();
+    auto const right = rect.right().as_int();
+    auto const top = rect.top().as_int();
+    auto const bottom = rect.bottom().as_int();
+
+    if (left >= right || top >= bottom)
+        return;
+
+    // Every existing band edge and both edges of rect: between consecutive
+    // edges, coverage is constant and is the old band's spans plus rect's.
+    std::vector<int> edges{top, bottom};
+    edges.reserve(2 * bands.size() + 2);
+    for (auto const& band : bands)
+    {
+        edges.push_back(band.top);
+        edges.push_back(band.bottom);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<Band> result;
+    result.reserve(bands.size() + 2);
+
+    auto band = bands.begin();
+    for (auto edge = edges.begin(); std::next(edge) != edges.end(); ++edge)
+    {
+        auto const band_top = *edge;
+        auto const band_bottom = *std::next(edge);
+
+        while (band != bands.end() && band->bottom <= band_top)
+            ++band;
+
+        std::vector<Span> spans;
+        if (band != bands.end() && band->top <= band_top)
+            spans = band->spans;
+
+        if (top <= band_top && band_bottom <= bottom)
+            spans = with_span(spans, {left, right});
+
+        if (spans.empty())
+            continue;
+
+        // Keep the representation canonical by joining identical neighbouring bands
+        if (!result.empty() && result.back().bottom == band_top && result.back().spans == spans)
+            result.back().bottom = band_bottom;
+        else
+            result.push_back({band_top, band_bottom, std::move(spans)});
+    }
+
+    bands = std::move(result);
+}
+
+bool mc::Region::contains(geom::Rectangle const& rect) const
+{
+    auto const left = rect.left().as_int();
+    auto const right = rect.right().as_int();
+    auto const top = rect.top().as_int();
+    auto const bottom = rect.bottom().as_int();
+
+    if (left >= right || top >= bottom)
+        return true;
+
+    auto covered_to = top;
+    for (auto const& band : bands)
+    {
+        if (band.bottom <= covered_to)
+            continue;
+
+        if (band.top > covered_to)
+            return false;
+
+        auto const covers_row = std::any_of(
+            band.spans.begin(), band.spans.end(),
+            [left, right](Span const& span) { return span.first <= left && right <= span.second; });
+
+        if (!covers_row)
+            return false;
+
+        covered_to = band.bottom;
+        if (covered_to >= bottom)
+            return true;
+    }
+
+    return false;
+}
+
+bool mc::Region::is_empty() const
+{
+    return bands.empty();
+}
+
+auto mc::Region::rectangles() const -> std::vector<geom::Rectangle>
+{
+    std::vector<geom::Rectangle> result;
+
+    for (auto const& band : bands)
+    {
+        for (auto const& span : band.spans)
+        {
+            result.push_back({
+                {span.first, band.top},
+                {span.second - span.first, band.bottom - band.top}});
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_REGION_H_
+#define MIR_COMPOSITOR_REGION_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * An area made up of any number of rectangles.
+ *
+ * The area is stored as horizontal bands (in the same way as pixman and X11
+ * regions), each band holding the sorted, disjoint spans covered within it.
+ * This keeps the representation canonical, so containment tests don't depend
+ * on how the area was built up.
+ */
+class Region
+{
+public:
+    Region() = default;
+
+    void add(geometry::Rectangle const& rect);
+
+    /// True if every point of rect lies within the region (trivially so for empty rects)
+    bool contains(geometry::Rectangle const& rect) const;
+
+    bool is_empty() const;
+
+    /// The region as a minimal set of non-overlapping rectangles, top to bottom, left to right
+    auto rectangles() const -> std::vector<geometry::Rectangle>;
+
+private:
+    using Span = std::pair<int, int>; ///< [left, right)
+
+    struct Band
+    {
+        int top;
+        int bottom;
+        std::vector<Span> spans;
+    };
+
+    std::vector<Band> bands;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_REGION_H_ */
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "repaint_scheduler.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+using namespace std::chrono_literals;
+using std::chrono::nanoseconds;
+
+namespace
+{
+nanoseconds const initial_margin{1ms};
+nanoseconds const min_margin{500us};
+
+// Anything slower isn't a refresh cycle: e.g. the gap left by an idle output that only counts flips
+nanoseconds const max_refresh_interval{1s};
+}
+
+void mc::RepaintScheduler::RecentSamples::add(nanoseconds sample)
+{
+    samples[next] = sample;
+    next = (next + 1) % samples.size();
+    count = std::min(count + 1, samples.size());
+}
+
+auto mc::RepaintScheduler::RecentSamples::min() const -> nanoseconds
+{
+    return count ? *std::min_element(samples.begin(), samples.begin() + count) : nanoseconds::zero();
+}
+
+auto mc::RepaintScheduler::RecentSamples::max() const -> nanoseconds
+{
+    return count ? *std::max_element(samples.begin(), samples.begin() + count) : nanoseconds::zero();
+}
+
+mc::RepaintScheduler::RepaintScheduler(Clock const& clock)
+    : clock{clock},
+      margin{initial_margin}
+{
+}
+
+auto mc::RepaintScheduler::delay_before_repaint() const -> std::experimental::optional<nanoseconds>
+{
+    if (outputs.empty())
+        return {};
+
+    auto const budget = work_estimate() + margin;
+
+    // Outputs in a sync group are posted together, so the earliest deadline wins
+    std::experimental::optional<nanoseconds> delay;
+    for (auto const& output : outputs)
+    {
+        auto const vblank = next_vblank(output, budget);
+        if (!vblank)
+            return {};
+
+        auto const start = vblank->time - budget;
+        auto const until_start = std::max(start - clock(start.clock_id), nanoseconds::zero());
+        if (!delay || until_start < delay.value())
+            delay = until_start;
+    }
+
+    return delay;
+}
+
+void mc::RepaintScheduler::repaint_starting()
+{
+    // A post() that returned on a vblank measured the wait for it, not the work
+    if (last_post && !last_post_waited_for_vblank)
+        post_times.add(last_post->second - last_post->first);
+    last_post = std::experimental::nullopt;
+
+    auto const work = work_estimate();
+    for (auto& output : outputs)
+    {
+        auto const vblank = next_vblank(output, work);
+        output.target_msc = vblank ? vblank->msc : 0;
+    }
+}
+
+void mc::RepaintScheduler::rendered(OutputId output, nanoseconds duration)
+{
+    output_for(output).render_times.add(duration);
+}
+
+void mc::RepaintScheduler::posted(time::PosixTimestamp const& start, time::PosixTimestamp const& finish)
+{
+    last_post = std::make_pair(start, finish);
+    last_post_waited_for_vblank = false;
+}
+
+auto mc::RepaintScheduler::presented(OutputId id, mg::Frame const& frame) -> bool
+{
+    auto& output = output_for(id);
+
+    auto const new_frame = frame.msc > output.last.msc;
+    auto const comparable = frame.ust.clock_id == output.last.ust.clock_id;
+
+    if (new_frame && comparable && output.last.msc > 0)
+    {
+        auto const interval = (frame.ust - output.last.ust) / (frame.msc - output.last.msc);
+        if (interval > nanoseconds::zero() && interval <= max_refresh_interval)
+            output.refresh_intervals.add(interval);
+    }
+
+    if (new_frame && last_post &&
+        frame.ust.clock_id == last_post->first.clock_id &&
+        last_post->first <= frame.ust && frame.ust <= last_post->second)
+    {
+        last_post_waited_for_vblank = true;
+    }
+
+    auto missed = false;
+    if (new_frame && output.target_msc > 0)
+    {
+        missed = frame.msc > output.target_msc;
+
+        if (missed)
+        {
+            auto const max_margin = std::max(output.refresh_intervals.min() / 2, min_margin);
+            margin = std::min(margin * 2, max_margin);
+        }
+        else
+        {
+            margin = std::max(margin - margin / 64, min_margin);
+        }
+    }
+
+    output.target_msc = 0;
+    output.last = frame;
+
+    return missed;
+}
+
+auto mc::RepaintScheduler::output_for(OutputId id) -> Output&
+{
+    auto const existing = std::find_if(
+        outputs.begin(),
+        outputs.end(),
+        [id](Output const& output) { return output.id == id; });
+
+    if (existing != outputs.end())
+        return *existing;
+
+    outputs.push_back(Output{id, {}, {}, {}, 0});
+    return outputs.back();
+}
+
+auto mc::RepaintScheduler::next_vblank(Output const& output, nanoseconds lead) const
+    -> std::experimental::optional<Vblank>
+{
+    if (output.last.msc <= 0 || output.refresh_intervals.empty())
+        return {};
+
+    auto const interval = output.refresh_intervals.min();
+    auto const earliest = clock(output.last.ust.clock_id) + lead;
+
+    int64_t cycles = 1;
+    if (earliest > output.last.ust)
+        cycles = std::max<int64_t>(cycles, (earliest - output.last.ust + interval - 1ns) / interval);
+
+    return Vblank{output.last.ust + cycles * interval, output.last.msc + cycles};
+}
+
+auto mc::RepaintScheduler::work_estimate() const -> nanoseconds
+{
+    // Outputs are rendered one after another on the group's thread
+    auto work = post_times.max();
+    for (auto const& output : outputs)
+        work += output.render_times.max();
+
+    return work;
+}
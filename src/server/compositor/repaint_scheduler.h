@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_REPAINT_SCHEDULER_H_
+#define MIR_COMPOSITOR_REPAINT_SCHEDULER_H_
+
+#include "mir/graphics/frame.h"
+
+#include <array>
+#include <chrono>
+#include <experimental/optional>
+#include <functional>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Decides when a display sync group should start its next repaint.
+ *
+ * The outputs' frames (DisplayBuffer::last_frame()) give the refresh interval and the phase of
+ * the vblank, and the time taken to render and post recent frames gives the work to fit in
+ * before it. Repainting starts as late as that allows, so the scene is sampled as close as
+ * possible to being shown. A repaint that misses the vblank it was aiming for widens the
+ * safety margin; repaints that make it narrow the margin again.
+ *
+ * One RepaintScheduler is used per DisplaySyncGroup, on that group's compositor thread.
+ */
+class RepaintScheduler
+{
+public:
+    using Clock = std::function<time::PosixTimestamp(clockid_t)>;
+    using OutputId = void const*;
+
+    explicit RepaintScheduler(Clock const& clock = &time::PosixTimestamp::now);
+
+    /**
+     * How long to wait before starting the next repaint.
+     *
+     * \return  nullopt if some output's frames don't support a prediction (e.g. it has never
+     *          presented, or doesn't count frames)
+     */
+    auto delay_before_repaint() const -> std::experimental::optional<std::chrono::nanoseconds>;
+
+    /// A repaint starts now: notes which vblank each output should make
+    void repaint_starting();
+
+    /// Compositing output for the current repaint took duration
+    void rendered(OutputId output, std::chrono::nanoseconds duration);
+
+    /// The group's post() for the current repaint ran from start to finish
+    void posted(time::PosixTimestamp const& start, time::PosixTimestamp const& finish);
+
+    /**
+     * Records output's frame after the group's post().
+     *
+     * \return  true if the repaint was shown later than the vblank it should have made
+     */
+    auto presented(OutputId output, graphics::Frame const& frame) -> bool;
+
+private:
+    /// The last few samples of something: estimates are taken from the extremes, not an average
+    class RecentSamples
+    {
+    public:
+        void add(std::chrono::nanoseconds sample);
+        auto empty() const -> bool { return count == 0; }
+        auto min() const -> std::chrono::nanoseconds;
+        auto max() const -> std::chrono::nanoseconds;
+
+    private:
+        std::array<std::chrono::nanoseconds, 16> samples;
+        size_t count{0};
+        size_t next{0};
+    };
+
+    struct Output
+    {
+        OutputId id;
+        graphics::Frame last;               ///< as of the latest post
+        RecentSamples refresh_intervals;
+        RecentSamples render_times;
+        int64_t target_msc{0};              ///< the vblank the current repaint should make; 0 if unknown
+    };
+
+    struct Vblank
+    {
+        time::PosixTimestamp time;
+        int64_t msc;
+    };
+
+    Clock const clock;
+    std::vector<Output> outputs;
+    RecentSamples post_times;
+    std::experimental::optional<std::pair<time::PosixTimestamp, time::PosixTimestamp>> last_post;
+    bool last_post_waited_for_vblank{false};
+    std::chrono::nanoseconds margin;
+
+    auto output_for(OutputId id) -> Output&;
+
+    /// The first vblank of output at least lead from now, if output's timing is known
+    auto next_vblank(Output const& output, std::chrono::nanoseconds lead) const -> std::experimental::optional<Vblank>;
+
+    /// Expected time to render every output and post them
+    auto work_estimate() const -> std::chrono::nanoseconds;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_REPAINT_SCHEDULER_H_ */
@@ -173,6 +173,7 @@ void mc::ScreencastDisplayBuffer::swap_buffers()
 
         ready_queue.schedule(current_buffer);
         current_buffer = nullptr;
+        last_frame_.increment_now();
     }
 }
 
@@ -192,6 +193,11 @@ glm::mat2 mc::ScreencastDisplayBuffer::transformation() const
     return transform;
 }
 
+mg::Frame mc::ScreencastDisplayBuffer::last_frame() const
+{
+    return last_frame_.load();
+}
+
 mg::NativeDisplayBuffer* mc::ScreencastDisplayBuffer::native_display_buffer()
 {
     return this;
@@ -20,6 +20,7 @@
 #define MIR_COMPOSITOR_SCREENCAST_DISPLAY_BUFFER_H_
 
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/atomic_frame.h"
 #include "mir/renderer/gl/render_target.h"
 
 #include MIR_SERVER_GL_H
@@ -114,6 +115,8 @@ public:
 
     glm::mat2 transformation() const override;
 
+    graphics::Frame last_frame() const override;
+
     NativeDisplayBuffer* native_display_buffer() override;
 
     geometry::Size renderbuffer_size();
@@ -138,6 +141,7 @@ private:
     detail::GLResource<glDeleteFramebuffers> fbo;
 
     geometry::Size current_size;
+    graphics::AtomicFrame last_frame_;
 };
 
 }
@@ -21,7 +21,9 @@
 #include "queueing_schedule.h"
 #include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
+#include "mir/compositor/compositor_report.h"
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
@@ -29,26 +31,45 @@ namespace mg = mir::graphics;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
+namespace
+{
+// Enough to cover every buffer a compositor can be holding or have queued
+auto const max_damage_history = 8u;
+}
+
 enum class mc::Stream::ScheduleMode {
     Queueing,
     Dropping
 };
 
 mc::Stream::Stream(
-    geom::Size size, MirPixelFormat pf) :
+    geom::Size size, MirPixelFormat pf, std::shared_ptr<CompositorReport> const& report) :
     schedule_mode(ScheduleMode::Queueing),
     schedule(std::make_shared<mc::QueueingSchedule>()),
     arbiter(std::make_shared<mc::MultiMonitorArbiter>(schedule)),
     latest_buffer_size(size),
     pf(pf),
     first_frame_posted(false),
-    frame_callback{[](auto){}}
+    frame_callback{[](auto){}},
+    report{report}
 {
 }
 
 mc::Stream::~Stream() = default;
 
 void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    submit(buffer, std::experimental::nullopt);
+}
+
+void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangles const& damage)
+{
+    submit(buffer, damage);
+}
+
+void mc::Stream::submit(
+    std::shared_ptr<mg::Buffer> const& buffer,
+    std::experimental::optional<geom::Rectangles> const& damage)
 {
     if (!buffer)
         BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
@@ -57,9 +78,27 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
         std::lock_guard<decltype(mutex)> lk(mutex);
         first_frame_posted = true;
         pf = buffer->pixel_format();
+
+        // A resubmitted buffer makes earlier history ambiguous, and a resized
+        // buffer has nothing in common with its predecessor
+        auto const resubmitted = std::any_of(
+            damage_history.begin(), damage_history.end(),
+            [id = buffer->id()](SubmittedDamage const& entry) { return entry.id == id; });
+        if (resubmitted)
+            damage_history.clear();
+
+        bool const resized = latest_buffer_size != buffer->size();
+        damage_history.push_back({buffer->id(), resized ? std::experimental::nullopt : damage});
+        if (damage_history.size() > max_damage_history)
+            damage_history.pop_front();
+
         latest_buffer_size = buffer->size();
         schedule->schedule(buffer);
     }
+
+    // Renderables of this stream are identified by it as a BufferStream
+    report->submitted_buffer(static_cast<BufferStream const*>(this), buffer->id());
+
     {
         std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
         frame_callback(buffer->size());
@@ -165,3 +204,34 @@ void mc::Stream::set_scale(float scale)
     std::lock_guard<decltype(mutex)> lk(mutex);
     scale_ = scale;
 }
+
+auto mc::Stream::damage_between(mg::BufferID previous, mg::BufferID current) const
+    -> std::experimental::optional<geom::Rectangles>
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+
+    auto const find = [this](mg::BufferID id)
+        {
+            return std::find_if(
+                damage_history.rbegin(), damage_history.rend(),
+                [id](SubmittedDamage const& entry) { return entry.id == id; });
+        };
+
+    auto const newer = find(current);
+    auto const older = find(previous);
+
+    if (newer == damage_history.rend() || older == damage_history.rend() || older < newer)
+        return {};
+
+    geom::Rectangles damage;
+    for (auto entry = newer; entry != older; ++entry)
+    {
+        if (!entry->damage)
+            return {};
+
+        for (auto const& rect : entry->damage.value())
+            damage.add(rect);
+    }
+
+    return damage;
+}
@@ -26,6 +26,7 @@
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
 #include "multi_monitor_arbiter.h"
+#include <deque>
 #include <mutex>
 #include <memory>
 #include <set>
@@ -36,13 +37,17 @@ namespace frontend { class ClientBuffers; }
 namespace compositor
 {
 class Schedule;
+class CompositorReport;
 class Stream : public BufferStream
 {
 public:
-    Stream(geometry::Size sz, MirPixelFormat format);
+    Stream(geometry::Size sz, MirPixelFormat format, std::shared_ptr<CompositorReport> const& report);
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void set_frame_posted_callback(
@@ -56,10 +61,21 @@ public:
     void drop_old_buffers() override;
     bool has_submitted_buffer() const override;
     void set_scale(float scale) override;
+    auto damage_between(graphics::BufferID previous, graphics::BufferID current) const
+        -> std::experimental::optional<geometry::Rectangles> override;
 
 private:
     enum class ScheduleMode;
     void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    void submit(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        std::experimental::optional<geometry::Rectangles> const& damage);
+
+    struct SubmittedDamage
+    {
+        graphics::BufferID id;
+        std::experimental::optional<geometry::Rectangles> damage; ///< Relative to the previous submission
+    };
 
     std::mutex mutable mutex;
     ScheduleMode schedule_mode;
@@ -69,9 +85,12 @@ private:
     float scale_{1.0f};
     MirPixelFormat pf;
     bool first_frame_posted;
+    std::deque<SubmittedDamage> damage_history;
 
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
+
+    std::shared_ptr<CompositorReport> const report;
 };
 }
 }
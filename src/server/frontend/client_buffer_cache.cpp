@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_buffer_cache.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir_toolkit/common.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+
+mf::ClientBufferCache::ClientBufferCache(size_t limit, ms::BufferMemoryPolicy policy)
+    : limit{limit},
+      policy{policy}
+{
+}
+
+void mf::ClientBufferCache::insert(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    auto const bytes = estimated_bytes(*buffer);
+
+    drop_released_buffers_not_in_use();
+
+    if (limit && usage_.bytes + bytes > limit)
+    {
+        if (policy == ms::BufferMemoryPolicy::evict_least_recently_used)
+            evict_to_fit(bytes);
+
+        if (usage_.bytes + bytes > limit)
+        {
+            ++usage_.rejected;
+            BOOST_THROW_EXCEPTION(std::runtime_error(
+                "Buffer of " + std::to_string(bytes) + " bytes would exceed the client's limit of " +
+                std::to_string(limit) + " bytes (" + std::to_string(usage_.bytes) + " in use)"));
+        }
+    }
+
+    auto const existing = index.find(buffer->id());
+    if (existing != index.end())
+        erase(existing->second);
+
+    entries.push_front({buffer, bytes, false});
+    index[buffer->id()] = entries.begin();
+    ++usage_.buffers;
+    usage_.bytes += bytes;
+}
+
+auto mf::ClientBufferCache::at(mg::BufferID id) -> std::shared_ptr<mg::Buffer>
+{
+    auto const found = index.find(id);
+    if (found == index.end())
+    {
+        BOOST_THROW_EXCEPTION(std::out_of_range(
+            "Buffer " + std::to_string(id.as_value()) + " is unknown (or was released)"));
+    }
+
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->buffer;
+}
+
+void mf::ClientBufferCache::release(mg::BufferID id)
+{
+    auto const found = index.find(id);
+    if (found == index.end())
+        return;
+
+    auto const entry = found->second;
+    index.erase(found);
+
+    // Anything else holding the buffer means it's in use by a stream, the compositor or a screencast
+    if (entry->buffer.use_count() == 1)
+        erase(entry);
+    else
+        entry->released = true;
+}
+
+auto mf::ClientBufferCache::usage() const -> ms::BufferMemoryUsage
+{
+    return usage_;
+}
+
+auto mf::ClientBufferCache::estimated_bytes(mg::Buffer const& buffer) -> size_t
+{
+    auto const size = buffer.size();
+    return size_t(size.width.as_uint32_t()) * size.height.as_uint32_t() * MIR_BYTES_PER_PIXEL(buffer.pixel_format());
+}
+
+/// Forgets an entry (which must not be in the index)
+void mf::ClientBufferCache::erase(Entries::iterator entry)
+{
+    --usage_.buffers;
+    usage_.bytes -= entry->bytes;
+    entries.erase(entry);
+}
+
+void mf::ClientBufferCache::drop_released_buffers_not_in_use()
+{
+    for (auto entry = entries.begin(); entry != entries.end();)
+    {
+        auto const current = entry++;
+        if (current->released && current->buffer.use_count() == 1)
+            erase(current);
+    }
+}
+
+void mf::ClientBufferCache::evict_to_fit(size_t bytes)
+{
+    // Decide what to evict before evicting anything: if we'd need to reject anyway there's no
+    // point forgetting buffers that are still taking up memory
+    std::vector<Entries::iterator> victims;
+    auto remaining = usage_.bytes;
+
+    for (auto entry = entries.end(); entry != entries.begin() && remaining + bytes > limit;)
+    {
+        --entry;
+
+        // The client may submit any buffer it hasn't released
+        if (entry->released)
+        {
+            victims.push_back(entry);
+            remaining -= entry->bytes;
+        }
+    }
+
+    if (remaining + bytes > limit)
+        return;
+
+    for (auto const& victim : victims)
+    {
+        erase(victim);
+        ++usage_.evicted;
+    }
+}
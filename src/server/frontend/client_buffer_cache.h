@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_BUFFER_CACHE_H_
+#define MIR_FRONTEND_CLIENT_BUFFER_CACHE_H_
+
+#include "mir/graphics/buffer_id.h"
+#include "mir/scene/buffer_memory_accounting.h"
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+}
+namespace frontend
+{
+
+/**
+ * The buffers allocated for a client, held to a memory limit
+ *
+ * A buffer the client still holds may be submitted at any time, and mirclient clients can't be
+ * told a buffer has gone, so only buffers the client has released are ever dropped. Until the
+ * server has finished with a released buffer (it may still be on screen) its memory is counted.
+ */
+class ClientBufferCache
+{
+public:
+    /// \param limit    the bytes of buffers the client may hold (zero for no limit)
+    ClientBufferCache(size_t limit, scene::BufferMemoryPolicy policy);
+
+    /**
+     * Adds buffer, first evicting released buffers to make room if the policy allows
+     *
+     * Released buffers the server is still using (i.e. that are on screen or being captured)
+     * are evicted least recently used first: they stop counting against the limit, and are
+     * freed once the server has finished with them.
+     *
+     * \throws      std::runtime_error if the buffer would take the client over its limit
+     */
+    void insert(std::shared_ptr<graphics::Buffer> const& buffer);
+
+    /// Looks up a buffer, marking it as the most recently used
+    /// \throws std::out_of_range if id is unknown or has been released
+    auto at(graphics::BufferID id) -> std::shared_ptr<graphics::Buffer>;
+
+    /// The client has finished with a buffer; it is dropped once the server has too
+    void release(graphics::BufferID id);
+
+    auto usage() const -> scene::BufferMemoryUsage;
+
+    /// The memory a buffer is taken to use: the size of its pixels
+    static auto estimated_bytes(graphics::Buffer const& buffer) -> size_t;
+
+private:
+    ClientBufferCache(ClientBufferCache const&) = delete;
+    ClientBufferCache& operator=(ClientBufferCache const&) = delete;
+
+    struct Entry
+    {
+        std::shared_ptr<graphics::Buffer> buffer;
+        size_t bytes;
+        bool released;
+    };
+    using Entries = std::list<Entry>;
+
+    void erase(Entries::iterator entry);
+    void drop_released_buffers_not_in_use();
+    void evict_to_fit(size_t bytes);
+
+    size_t const limit;
+    scene::BufferMemoryPolicy const policy;
+
+    /// Most recently used first
+    Entries entries;
+    /// The entries the client hasn't released
+    std::unordered_map<graphics::BufferID, Entries::iterator> index;
+    scene::BufferMemoryUsage usage_;
+};
+}
+}
+
+#endif // MIR_FRONTEND_CLIENT_BUFFER_CACHE_H_
@@ -204,7 +204,8 @@ mir::DefaultServerConfiguration::new_ipc_factory(
                 the_application_not_responding_detector(),
                 the_cookie_authority(),
                 the_input_configuration_changer(),
-                the_extensions());
+                the_extensions(),
+                the_buffer_memory_accounting());
 }
 
 std::shared_ptr<mf::SessionMediatorObserver>
@@ -234,7 +234,8 @@ mf::DefaultIpcFactory::DefaultIpcFactory(
     std::shared_ptr<scene::ApplicationNotRespondingDetector> const& anr_detector,
     std::shared_ptr<mir::cookie::Authority> const& cookie_authority,
     std::shared_ptr<InputConfigurationChanger> const& input_changer,
-    std::vector<mir::ExtensionDescription> const& extensions) :
+    std::vector<mir::ExtensionDescription> const& extensions,
+    std::shared_ptr<scene::BufferMemoryAccounting> const& buffer_memory) :
     shell(shell),
     no_prompt_shell(std::make_shared<NoPromptShell>(shell)),
     sm_observer(sm_observer),
@@ -249,7 +250,8 @@ mf::DefaultIpcFactory::DefaultIpcFactory(
     anr_detector{anr_detector},
     cookie_authority(cookie_authority),
     input_changer(input_changer),
-    extensions(extensions)
+    extensions(extensions),
+    buffer_memory(buffer_memory)
 {
 }
 
@@ -339,5 +341,6 @@ std::shared_ptr<mf::detail::DisplayServer> mf::DefaultIpcFactory::make_mediator(
         input_changer,
         extensions,
         buffer_allocator,
+        buffer_memory,
         buffer_return_ipc_executor());
 }
@@ -27,6 +27,8 @@
 
 #include "mir_protobuf_wire.pb.h"
 
+#include <unordered_map>
+
 namespace mfd = mir::frontend::detail;
 
 namespace
@@ -187,6 +189,239 @@ void mfd::ProtobufMessageProcessor::client_pid(int pid)
     display_server->client_pid(pid);
 }
 
+auto mfd::ProtobufMessageProcessor::handler_for(std::string const& method_name) -> Handler
+{
+    // Built once, and looked up with a single hash of the method name
+    static std::unordered_map<std::string, Handler> const handlers{
+        {"connect",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::connect, invocation);
+                return true;
+            }},
+        {"create_surface",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::create_surface, invocation);
+                return true;
+            }},
+        {"submit_buffer",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const& side_channel_fds)
+            {
+                auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
+                request.mutable_buffer()->clear_fd();
+                for (auto& fd : side_channel_fds)
+                    request.mutable_buffer()->add_fd(fd);
+                invoke(self.shared_from_this(), self.display_server.get(), &DisplayServer::submit_buffer, invocation.id(), &request);
+                return true;
+            }},
+        {"allocate_buffers",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::allocate_buffers, invocation);
+                return true;
+            }},
+        {"release_buffers",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::release_buffers, invocation);
+                return true;
+            }},
+        {"release_surface",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::release_surface, invocation);
+                return true;
+            }},
+        {"platform_operation",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const& side_channel_fds)
+            {
+                auto request = parse_parameter<mir::protobuf::PlatformOperationMessage>(invocation);
+
+                request.clear_fd();
+                for (auto& fd : side_channel_fds)
+                    request.add_fd(fd);
+
+                invoke(self.shared_from_this(), self.display_server.get(), &DisplayServer::platform_operation,
+                       invocation.id(), &request);
+                return true;
+            }},
+        {"configure_display",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::configure_display, invocation);
+                return true;
+            }},
+        {"remove_session_configuration",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::remove_session_configuration, invocation);
+                return true;
+            }},
+        {"set_base_display_configuration",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::set_base_display_configuration, invocation);
+                return true;
+            }},
+        {"configure_surface",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::configure_surface, invocation);
+                return true;
+            }},
+        {"modify_surface",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::modify_surface, invocation);
+                return true;
+            }},
+        {"create_screencast",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::create_screencast, invocation);
+                return true;
+            }},
+        {"screencast_buffer",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::screencast_buffer, invocation);
+                return true;
+            }},
+        {"screencast_to_buffer",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::screencast_to_buffer, invocation);
+                return true;
+            }},
+        {"release_screencast",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::release_screencast, invocation);
+                return true;
+            }},
+        {"create_buffer_stream",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::create_buffer_stream, invocation);
+                return true;
+            }},
+        {"release_buffer_stream",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::release_buffer_stream, invocation);
+                return true;
+            }},
+        {"configure_cursor",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::configure_cursor, invocation);
+                return true;
+            }},
+        {"new_fds_for_prompt_providers",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::new_fds_for_prompt_providers, invocation);
+                return true;
+            }},
+        {"start_prompt_session",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::start_prompt_session, invocation);
+                return true;
+            }},
+        {"stop_prompt_session",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::stop_prompt_session, invocation);
+                return true;
+            }},
+        {"request_operation",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::request_operation, invocation);
+                return true;
+            }},
+        {"disconnect",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::disconnect, invocation);
+                return false;
+            }},
+        {"pong",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::pong, invocation);
+                return true;
+            }},
+        {"configure_buffer_stream",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &DisplayServer::configure_buffer_stream, invocation);
+                return true;
+            }},
+        {"translate_surface_to_screen",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                try
+                {
+                    auto debug_interface = dynamic_cast<mir::protobuf::DisplayServerDebug*>(self.display_server.get());
+                    invoke(&self, debug_interface, &mir::protobuf::DisplayServerDebug::translate_surface_to_screen, invocation);
+                }
+                catch (std::runtime_error const&)
+                {
+                    std::string message{"Server does not support the client debugging interface"};
+                    invoke(&self,
+                           &message,
+                           &mir::protobuf::DisplayServerDebug::translate_surface_to_screen,
+                           invocation);
+                    std::runtime_error err{"Client attempted to use unavailable debug interface"};
+                    self.report->exception_handled(self.display_server.get(), invocation.id(), err);
+                }
+                return true;
+            }},
+        {"request_persistent_surface_id",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::request_persistent_surface_id, invocation);
+                return true;
+            }},
+        {"preview_base_display_configuration",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::preview_base_display_configuration, invocation);
+                return true;
+            }},
+        {"confirm_base_display_configuration",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::confirm_base_display_configuration, invocation);
+                return true;
+            }},
+        {"cancel_base_display_configuration_preview",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::cancel_base_display_configuration_preview, invocation);
+                return true;
+            }},
+        {"apply_input_configuration",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::apply_input_configuration, invocation);
+                return true;
+            }},
+        {"set_base_input_configuration",
+            [](ProtobufMessageProcessor& self, Invocation const& invocation, std::vector<mir::Fd> const&)
+            {
+                invoke(&self, self.display_server.get(), &protobuf::DisplayServer::set_base_input_configuration, invocation);
+                return true;
+            }}
+    };
+
+    auto const handler = handlers.find(method_name);
+    return handler != handlers.end() ? handler->second : nullptr;
+}
+
 bool mfd::ProtobufMessageProcessor::dispatch(
     Invocation const& invocation,
     std::vector<mir::Fd> const& side_channel_fds)
@@ -197,165 +432,9 @@ bool mfd::ProtobufMessageProcessor::dispatch(
 
     try
     {
-        // TODO comparing strings in an if-else chain isn't efficient.
-        // It is probably possible to generate a Trie at compile time.
-        if ("connect" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::connect, invocation);
-        }
-        else if ("create_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_surface, invocation);
-        }
-        else if ("submit_buffer" == invocation.method_name())
-        {
-            auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
-            request.mutable_buffer()->clear_fd();
-            for (auto& fd : side_channel_fds)
-                request.mutable_buffer()->add_fd(fd);
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::submit_buffer, invocation.id(), &request);
-        }
-        else if ("allocate_buffers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::allocate_buffers, invocation);
-        }
-        else if ("release_buffers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_buffers, invocation);
-        }
-        else if ("release_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_surface, invocation);
-        }
-        else if ("platform_operation" == invocation.method_name())
-        {
-            auto request = parse_parameter<mir::protobuf::PlatformOperationMessage>(invocation);
-
-            request.clear_fd();
-            for (auto& fd : side_channel_fds)
-                request.add_fd(fd);
-
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::platform_operation,
-                   invocation.id(), &request);
-        }
-        else if ("configure_display" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_display, invocation);
-        }
-        else if ("remove_session_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::remove_session_configuration, invocation);
-        }
-        else if ("set_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::set_base_display_configuration, invocation);
-        }
-        else if ("configure_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_surface, invocation);
-        }
-        else if ("modify_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::modify_surface, invocation);
-        }
-        else if ("create_screencast" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_screencast, invocation);
-        }
-        else if ("screencast_buffer" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::screencast_buffer, invocation);
-        }
-        else if ("screencast_to_buffer" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::screencast_to_buffer, invocation);
-        }
-        else if ("release_screencast" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_screencast, invocation);
-        }
-        else if ("create_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_buffer_stream, invocation);
-        }
-        else if ("release_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_buffer_stream, invocation);
-        }
-        else if ("configure_cursor" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::configure_cursor, invocation);
-        }
-        else if ("new_fds_for_prompt_providers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::new_fds_for_prompt_providers, invocation);
-        }
-        else if ("start_prompt_session" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::start_prompt_session, invocation);
-        }
-        else if ("stop_prompt_session" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::stop_prompt_session, invocation);
-        }
-        else if ("request_operation" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::request_operation, invocation);
-        }
-        else if ("disconnect" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::disconnect, invocation);
-            result = false;
-        }
-        else if ("pong" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::pong, invocation);
-        }
-        else if ("configure_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_buffer_stream, invocation);
-        }
-        else if ("translate_surface_to_screen" == invocation.method_name())
-        {
-            try
-            {
-                auto debug_interface = dynamic_cast<mir::protobuf::DisplayServerDebug*>(display_server.get());
-                invoke(this, debug_interface, &mir::protobuf::DisplayServerDebug::translate_surface_to_screen, invocation);
-            }
-            catch (std::runtime_error const&)
-            {
-                std::string message{"Server does not support the client debugging interface"};
-                invoke(this,
-                       &message,
-                       &mir::protobuf::DisplayServerDebug::translate_surface_to_screen,
-                       invocation);
-                std::runtime_error err{"Client attempted to use unavailable debug interface"};
-                report->exception_handled(display_server.get(), invocation.id(), err);
-            }
-        }
-        else if ("request_persistent_surface_id" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::request_persistent_surface_id, invocation);
-        }
-        else if ("preview_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::preview_base_display_configuration, invocation);
-        }
-        else if ("confirm_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::confirm_base_display_configuration, invocation);
-        }
-        else if ("cancel_base_display_configuration_preview" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::cancel_base_display_configuration_preview, invocation);
-        }
-        else if ("apply_input_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::apply_input_configuration, invocation);
-        }
-        else if ("set_base_input_configuration" == invocation.method_name())
+        if (auto const handler = handler_for(invocation.method_name()))
         {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::set_base_input_configuration, invocation);
+            result = handler(*this, invocation, side_channel_fds);
         }
         else
         {
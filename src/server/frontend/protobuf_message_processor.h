@@ -25,6 +25,7 @@
 #include <google/protobuf/stubs/common.h>
 
 #include <memory>
+#include <string>
 
 namespace google { namespace protobuf { class MessageLite; } }
 namespace mir
@@ -64,6 +65,15 @@ public:
 private:
     bool dispatch(Invocation const& invocation, std::vector<mir::Fd> const& side_channel_fds) override;
 
+    /// Handles an invocation, returning false if the connection should be dropped
+    using Handler = bool (*)(
+        ProtobufMessageProcessor& self,
+        Invocation const& invocation,
+        std::vector<mir::Fd> const& side_channel_fds);
+
+    /// The handler for method_name, or nullptr if there isn't one
+    static auto handler_for(std::string const& method_name) -> Handler;
+
     std::shared_ptr<ProtobufMessageSender> const sender;
     std::shared_ptr<DisplayServer> const display_server;
     std::shared_ptr<MessageProcessorReport> const report;
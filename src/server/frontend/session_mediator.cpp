@@ -28,6 +28,7 @@
 #include "mir/scene/coordinate_translator.h"
 #include "mir/scene/application_not_responding_detector.h"
 #include "mir/scene/session.h"
+#include "mir/scene/buffer_memory_accounting.h"
 #include "mir/frontend/display_changer.h"
 #include "resource_cache.h"
 #include "mir_toolkit/common.h"
@@ -115,6 +116,7 @@ mf::SessionMediator::SessionMediator(
     std::shared_ptr<mf::InputConfigurationChanger> const& input_changer,
     std::vector<mir::ExtensionDescription> const& extensions,
     std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+    std::shared_ptr<ms::BufferMemoryAccounting> const& buffer_memory,
     mir::Executor& executor) :
     client_pid_(0),
     shell(shell),
@@ -135,6 +137,8 @@ mf::SessionMediator::SessionMediator(
     input_changer(input_changer),
     extensions(extensions),
     allocator{allocator},
+    buffer_memory{buffer_memory},
+    buffer_cache{buffer_memory->limit(), buffer_memory->policy()},
     executor{executor}
 {
 }
@@ -147,6 +151,9 @@ mf::SessionMediator::~SessionMediator() noexcept
         shell->close_session(mir_client_session);
     }
     destroy_screencast_sessions();
+
+    if (accounted_session)
+        buffer_memory->remove(accounted_session);
 }
 
 void mf::SessionMediator::client_pid(int pid)
@@ -166,6 +173,7 @@ void mf::SessionMediator::connect(
 
     weak_mir_client_session = mir_client_session;
     weak_scene_session = scene_session;
+    accounted_session = scene_session.get();
 
     connection_context.handle_client_connect(scene_session);
 
@@ -537,14 +545,18 @@ void mf::SessionMediator::allocate_buffers(
 
             if (request->has_id())
             {
-                auto const stream_id = mf::BufferStreamId{request->id().value()};
                 // We don't need the stream, but we *do* need to know it exists
-                auto stream = mir_client_session->buffer_stream(stream_id);
+                mir_client_session->buffer_stream(mf::BufferStreamId{request->id().value()});
+            }
+
+            buffer_cache.insert(buffer);
+
+            if (request->has_id())
+            {
+                auto const stream_id = mf::BufferStreamId{request->id().value()};
                 stream_associated_buffers.insert(std::make_pair(stream_id, buffer->id()));
             }
 
-            // TODO: Throw if insert fails (duplicate ID)?
-            buffer_cache.insert(std::make_pair(buffer->id(), buffer));
             event_sink->add_buffer(*buffer);
         }
         catch (std::exception const& err)
@@ -555,6 +567,7 @@ void mf::SessionMediator::allocate_buffers(
                 err.what());
         }
     }
+    buffer_cache_changed();
     done->Run();
 }
  
@@ -596,8 +609,9 @@ void mf::SessionMediator::release_buffers(
     }
     for (auto const& buffer_id : to_release)
     {
-        buffer_cache.erase(buffer_id);
+        buffer_cache.release(buffer_id);
     }
+    buffer_cache_changed();
    done->Run();
 }
 
@@ -647,6 +661,12 @@ void mf::SessionMediator::disconnect(
     weak_mir_client_session.reset();
     weak_scene_session.reset();
 
+    if (accounted_session)
+    {
+        buffer_memory->remove(accounted_session);
+        accounted_session = nullptr;
+    }
+
     done->Run();
 }
 
@@ -1046,9 +1066,10 @@ void mf::SessionMediator::release_buffer_stream(
     auto const associated_range = stream_associated_buffers.equal_range(id) ;
     for (auto match = associated_range.first; match != associated_range.second; ++match)
     {
-        buffer_cache.erase(match->second);
+        buffer_cache.release(match->second);
     }
     stream_associated_buffers.erase(id);
+    buffer_cache_changed();
 
     done->Run();
 }
@@ -1432,6 +1453,12 @@ mf::SessionMediator::unpack_and_sanitize_display_configuration(
     return config;
 }
 
+void mf::SessionMediator::buffer_cache_changed()
+{
+    if (accounted_session)
+        buffer_memory->update(accounted_session, buffer_cache.usage());
+}
+
 void mf::SessionMediator::destroy_screencast_sessions()
 {
     std::vector<ScreencastSessionId> ids_to_untrack;
@@ -21,6 +21,7 @@
 
 #include "display_server.h"
 #include "screencast_buffer_tracker.h"
+#include "client_buffer_cache.h"
 #include "protobuf_ipc_factory.h"
 
 #include "mir/extension_description.h"
@@ -61,6 +62,7 @@ namespace scene
 {
 class CoordinateTranslator;
 class ApplicationNotRespondingDetector;
+class BufferMemoryAccounting;
 class Session;
 }
 
@@ -131,6 +133,7 @@ public:
         std::shared_ptr<InputConfigurationChanger> const& input_changer,
         std::vector<mir::ExtensionDescription> const& extensions,
         std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        std::shared_ptr<scene::BufferMemoryAccounting> const& buffer_memory,
         mir::Executor& executor);
 
     ~SessionMediator() noexcept;
@@ -285,6 +288,8 @@ private:
 
     void destroy_screencast_sessions();
 
+    void buffer_cache_changed();
+
     pid_t client_pid_;
     std::shared_ptr<Shell> const shell;
     std::shared_ptr<graphics::PlatformIpcOperations> const ipc_operations;
@@ -305,9 +310,12 @@ private:
     std::shared_ptr<cookie::Authority> const cookie_authority;
     std::shared_ptr<InputConfigurationChanger> const input_changer;
     std::vector<mir::ExtensionDescription> const extensions;
-    std::unordered_map<graphics::BufferID, std::shared_ptr<graphics::Buffer>> buffer_cache;
-    std::unordered_multimap<BufferStreamId, graphics::BufferID> stream_associated_buffers;
     std::shared_ptr<graphics::GraphicBufferAllocator> const allocator;
+    std::shared_ptr<scene::BufferMemoryAccounting> const buffer_memory;
+    ClientBufferCache buffer_cache;
+    std::unordered_multimap<BufferStreamId, graphics::BufferID> stream_associated_buffers;
+    /// The session buffer_cache is accounted to (kept as we must remove it after the session has gone)
+    scene::Session const* accounted_session{nullptr};
     mir::Executor& executor;
 
     ScreencastBufferTracker screencast_buffer_tracker;
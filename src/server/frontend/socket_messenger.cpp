@@ -18,7 +18,6 @@
 
 #include "socket_messenger.h"
 #include "mir/frontend/client_constants.h"
-#include "mir/variable_length_array.h"
 #include "mir/fd_socket_transmission.h"
 #include "mir/raii.h"
 
@@ -26,14 +25,50 @@
 
 #include <errno.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <stdexcept>
+#include <system_error>
 
 namespace mf = mir::frontend;
 namespace mfd = mf::detail;
 namespace bs = boost::system;
 namespace ba = boost::asio;
 
+namespace
+{
+size_t const header_size{2};
+
+// A client that lets this much pile up in its queue isn't reading its socket
+size_t const max_pending_bytes{4*1024*1024};
+
+// fds travel on a byte of their own, which the client reads separately
+char const fd_carrier{'M'};
+
+/// Writes what the socket takes without blocking, returning the number of bytes written
+size_t send_nonblocking(
+    mir::Fd const& socket,
+    iovec* iov,
+    size_t iov_count,
+    std::vector<mir::Fd> const& fds)
+{
+    for (;;)
+    {
+        auto const sent = mir::send_with_fds(socket, iov, iov_count, fds, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (sent >= 0)
+            return sent;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+
+        if (errno != EINTR)
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to send message"));
+    }
+}
+}
+
 mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol::socket> const& socket)
     : socket(socket),
       socket_fd{IntOwnedFd{socket->native_handle()}}
@@ -42,7 +77,6 @@ mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol
     // is unresponsive. Also increase the send buffer size to 64KiB to allow
     // more leeway for transient client freezes.
     // See https://bugs.launchpad.net/mir/+bug/1350207
-    // TODO: Rework the messenger to support asynchronous sends
     socket->non_blocking(true);
     boost::asio::socket_base::send_buffer_size option(64*1024);
     socket->set_option(option);
@@ -73,24 +107,125 @@ mf::SessionCredentials mfd::SocketMessenger::client_creds()
 
 void mfd::SocketMessenger::send(char const* data, size_t length, FdSets const& fd_set)
 {
-    static size_t const header_size{2};
-    mir::VariableLengthArray<mf::serialization_buffer_size> whole_message{header_size + length};
+    unsigned char header[header_size];
+    header[0] = static_cast<unsigned char>((length >> 8) & 0xff);
+    header[1] = static_cast<unsigned char>((length >> 0) & 0xff);
+
+    std::lock_guard<std::mutex> lock{message_lock};
+
+    if (!pending.empty())
+    {
+        // Anything sent now has to wait its turn behind what is already queued
+        if (pending_bytes + header_size + length > max_pending_bytes)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Client is not reading messages"));
+
+        queue_locked(reinterpret_cast<char const*>(header), header_size, {});
+        pending.back().bytes.insert(pending.back().bytes.end(), data, data + length);
+        pending_bytes += length;
+
+        for (auto const& fds : fd_set)
+        {
+            if (!fds.empty())
+                queue_locked(&fd_carrier, 1, fds);
+        }
 
-    whole_message.data()[0] = static_cast<unsigned char>((length >> 8) & 0xff);
-    whole_message.data()[1] = static_cast<unsigned char>((length >> 0) & 0xff);
-    std::copy(data, data + length, whole_message.data() + header_size);
+        return;
+    }
 
-    std::unique_lock<std::mutex> lg(message_lock);
+    iovec iov[] = {{header, header_size}, {const_cast<char*>(data), length}};
+    auto const sent = send_nonblocking(socket_fd, iov, 2, {});
 
-    // TODO: This should be asynchronous, but we are not making sure
-    // that a potential call to send_fds is executed _after_ this
-    // function has completed (if it would be executed asynchronously.
-    // NOTE: we rely on this synchronous behavior as per the comment in
-    // mf::SessionMediator::create_surface
-    ba::write(*socket, ba::buffer(whole_message.data(), whole_message.size()));
+    if (sent < header_size + length)
+    {
+        if (sent < header_size)
+        {
+            queue_locked(reinterpret_cast<char const*>(header) + sent, header_size - sent, {});
+            pending.back().bytes.insert(pending.back().bytes.end(), data, data + length);
+            pending_bytes += length;
+        }
+        else
+        {
+            queue_locked(data + (sent - header_size), length - (sent - header_size), {});
+        }
+    }
 
     for (auto const& fds : fd_set)
-        mir::send_fds(socket_fd, fds);
+    {
+        if (fds.empty())
+            continue;
+
+        iovec carrier{const_cast<char*>(&fd_carrier), 1};
+        if (!pending.empty() || send_nonblocking(socket_fd, &carrier, 1, fds) == 0)
+            queue_locked(&fd_carrier, 1, fds);
+    }
+
+    if (!pending.empty())
+        wait_for_writable_locked();
+}
+
+void mfd::SocketMessenger::queue_locked(char const* data, size_t length, std::vector<Fd> const& fds)
+{
+    pending.push_back({{data, data + length}, fds, 0});
+    pending_bytes += length;
+}
+
+void mfd::SocketMessenger::flush_locked()
+{
+    while (!pending.empty())
+    {
+        auto& next = pending.front();
+
+        iovec iov{next.bytes.data() + next.offset, next.bytes.size() - next.offset};
+        auto const sent = send_nonblocking(socket_fd, &iov, 1, next.offset ? std::vector<Fd>{} : next.fds);
+
+        if (sent == 0)
+            break;
+
+        next.offset += sent;
+        pending_bytes -= sent;
+
+        if (next.offset == next.bytes.size())
+            pending.pop_front();
+    }
+}
+
+void mfd::SocketMessenger::wait_for_writable_locked()
+{
+    if (waiting_for_writable)
+        return;
+
+    waiting_for_writable = true;
+
+    std::weak_ptr<SocketMessenger> const weak_self{shared_from_this()};
+    socket->async_write_some(
+        ba::null_buffers(),
+        [weak_self](bs::error_code const& error, size_t)
+        {
+            auto const self = weak_self.lock();
+            if (!self)
+                return;
+
+            std::lock_guard<std::mutex> lock{self->message_lock};
+            self->waiting_for_writable = false;
+
+            try
+            {
+                if (error)
+                    BOOST_THROW_EXCEPTION(bs::system_error(error));
+
+                self->flush_locked();
+            }
+            catch (std::exception const&)
+            {
+                // The client has gone; the read side will notice and clean up
+                self->pending.clear();
+                self->pending_bytes = 0;
+                return;
+            }
+
+            if (!self->pending.empty())
+                self->wait_for_writable_locked();
+        });
 }
 
 void mfd::SocketMessenger::async_receive_msg(
@@ -21,7 +21,11 @@
 #include "message_sender.h"
 #include "message_receiver.h"
 #include "mir/frontend/session_credentials.h"
+
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace mir
 {
@@ -29,8 +33,17 @@ namespace frontend
 {
 namespace detail
 {
+/**
+ * Sends and receives messages on a client socket.
+ *
+ * send() never blocks: whatever the socket won't take immediately is queued,
+ * in order, and written out from the socket's io_service as the client drains
+ * its end. A message is queued complete with its fds, so anything sent after
+ * it (from any thread) reaches the client after it.
+ */
 class SocketMessenger : public MessageSender,
-                        public MessageReceiver
+                        public MessageReceiver,
+                        public std::enable_shared_from_this<SocketMessenger>
 {
 public:
     SocketMessenger(std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket);
@@ -48,10 +61,25 @@ private:
     void update_session_creds();
     SessionCredentials creator_creds() const;
 
+    /// Bytes (and the fds that go with the first of them) still to be written
+    struct PendingWrite
+    {
+        std::vector<char> bytes;
+        std::vector<Fd> fds;
+        size_t offset;
+    };
+
+    void queue_locked(char const* data, size_t length, std::vector<Fd> const& fds);
+    void flush_locked();
+    void wait_for_writable_locked();
+
     std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
     mir::Fd socket_fd;
 
     std::mutex message_lock;
+    std::deque<PendingWrite> pending;
+    size_t pending_bytes{0};
+    bool waiting_for_writable{false};
     SessionCredentials session_creds{0, 0, 0};
 };
 }
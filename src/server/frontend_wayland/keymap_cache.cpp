@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keymap_cache.h"
+
+#include "mir/anonymous_shm_file.h"
+#include "mir/input/keymap.h"
+
+#include <xkbcommon/xkbcommon.h>
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+namespace
+{
+int memfd_create(char const* name, unsigned int flags)
+{
+    return static_cast<int>(syscall(SYS_memfd_create, name, flags));
+}
+
+/// Returns an invalid Fd if the kernel can't seal a memfd
+auto sealed_file_containing(std::string const& text) -> mir::Fd
+{
+    mir::Fd fd{memfd_create("mir-keymap", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+    if (fd == mir::Fd::invalid)
+        return {};
+
+    auto data = text.c_str();
+    auto remaining = text.size() + 1;
+    while (remaining > 0)
+    {
+        auto const written = ::write(fd, data, remaining);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return {};
+
+        data += written;
+        remaining -= written;
+    }
+
+    // Every client gets this same file, so none of them may change it
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+        return {};
+
+    return fd;
+}
+
+auto text_of(std::shared_ptr<xkb_keymap> const& keymap) -> std::string
+{
+    std::unique_ptr<char, void(*)(void*)> const buffer{
+        xkb_keymap_get_as_string(keymap.get(), XKB_KEYMAP_FORMAT_TEXT_V1),
+        free};
+
+    if (!buffer)
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to serialize keymap"});
+
+    return buffer.get();
+}
+}
+
+mf::KeymapCache::CompiledKeymap::CompiledKeymap(std::shared_ptr<xkb_keymap> const& keymap)
+    : keymap{keymap},
+      text{text_of(keymap)},
+      sealed_fd{sealed_file_containing(text)}
+{
+}
+
+auto mf::KeymapCache::CompiledKeymap::fd() const -> Fd
+{
+    if (sealed_fd != Fd::invalid)
+        return sealed_fd;
+
+    AnonymousShmFile shm_buffer{size()};
+    memcpy(shm_buffer.base_ptr(), text.c_str(), size());
+
+    Fd copy{::dup(shm_buffer.fd())};
+    if (copy == Fd::invalid)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to dup keymap fd"}));
+    }
+    return copy;
+}
+
+auto mf::KeymapCache::CompiledKeymap::size() const -> size_t
+{
+    return text.size() + 1;
+}
+
+mf::KeymapCache::KeymapCache()
+    : context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref}
+{
+}
+
+mf::KeymapCache::~KeymapCache() = default;
+
+auto mf::KeymapCache::keymap_for(mi::Keymap const& names) -> std::shared_ptr<CompiledKeymap const>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    Key const key{names.model, names.layout, names.variant, names.options};
+
+    auto const existing = keymaps.find(key);
+    if (existing != keymaps.end())
+        return existing->second;
+
+    xkb_rule_names const rules = {
+        "evdev",
+        names.model.c_str(),
+        names.layout.c_str(),
+        names.variant.c_str(),
+        names.options.c_str()
+    };
+
+    auto const raw_keymap = xkb_keymap_new_from_names(context.get(), &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (!raw_keymap)
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to compile keymap"});
+
+    auto const compiled = std::make_shared<CompiledKeymap const>(
+        std::shared_ptr<xkb_keymap>{raw_keymap, &xkb_keymap_unref});
+
+    keymaps.emplace(key, compiled);
+    return compiled;
+}
+
+auto mf::KeymapCache::keymap_from_buffer(char const* buffer, size_t length) -> std::shared_ptr<xkb_keymap>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    return {
+        xkb_keymap_new_from_buffer(
+            context.get(),
+            buffer,
+            length,
+            XKB_KEYMAP_FORMAT_TEXT_V1,
+            XKB_KEYMAP_COMPILE_NO_FLAGS),
+        &xkb_keymap_unref};
+}
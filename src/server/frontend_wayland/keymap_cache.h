@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_KEYMAP_CACHE_H
+#define MIR_FRONTEND_KEYMAP_CACHE_H
+
+#include "mir/fd.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// from <xkbcommon/xkbcommon.h>
+struct xkb_keymap;
+struct xkb_context;
+
+namespace mir
+{
+namespace input
+{
+class Keymap;
+}
+namespace frontend
+{
+/// Compiles each distinct keymap once, for every wl_keyboard of every client to share
+class KeymapCache
+{
+public:
+    class CompiledKeymap
+    {
+    public:
+        CompiledKeymap(std::shared_ptr<xkb_keymap> const& keymap);
+
+        std::shared_ptr<xkb_keymap> const keymap;
+
+        /// An fd holding the keymap as XKB_KEYMAP_FORMAT_TEXT_V1, fit to send to a client.
+        /// Where the kernel supports it this is the same sealed read-only memfd each time,
+        /// otherwise a fresh copy.
+        auto fd() const -> Fd;
+
+        /// The size of the text (including its terminating NUL) in fd()
+        auto size() const -> size_t;
+
+    private:
+        std::string const text;
+        Fd const sealed_fd;
+    };
+
+    KeymapCache();
+    ~KeymapCache();
+
+    auto keymap_for(input::Keymap const& names) -> std::shared_ptr<CompiledKeymap const>;
+
+    /// Compiles a client-supplied keymap; these are not cached
+    auto keymap_from_buffer(char const* buffer, size_t length) -> std::shared_ptr<xkb_keymap>;
+
+private:
+    KeymapCache(KeymapCache const&) = delete;
+    KeymapCache& operator=(KeymapCache const&) = delete;
+
+    using Key = std::tuple<std::string, std::string, std::string, std::string>;
+
+    std::mutex mutex;
+    std::unique_ptr<xkb_context, void (*)(xkb_context *)> const context;
+    std::map<Key, std::shared_ptr<CompiledKeymap const>> keymaps;
+};
+}
+}
+
+#endif // MIR_FRONTEND_KEYMAP_CACHE_H
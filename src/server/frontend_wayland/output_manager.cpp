@@ -55,6 +55,8 @@ mf::Output::~Output()
 
 void mf::Output::handle_configuration_changed(mg::DisplayConfigurationOutput const& config)
 {
+    current_config = config;
+
     for (auto const& client : resource_map)
     {
         for (auto const& resource : client.second)
@@ -234,6 +236,17 @@ auto mf::OutputManager::output_for(graphics::DisplayConfigurationOutputId id) ->
         return std::experimental::nullopt;
 }
 
+auto mf::OutputManager::output_for(geometry::Rectangle const& extents) -> std::experimental::optional<Output*>
+{
+    for (auto const& output : outputs)
+    {
+        if (output.second->configuration().extents() == extents)
+            return output.second.get();
+    }
+
+    return std::experimental::nullopt;
+}
+
 void mf::OutputManager::create_output(mg::DisplayConfigurationOutput const& initial_config)
 {
     if (initial_config.used)
@@ -49,6 +49,8 @@ public:
 
     void for_each_output_resource_bound_by(wl_client* client, std::function<void(wl_resource*)> const& functor);
 
+    auto configuration() const -> graphics::DisplayConfigurationOutput const& { return current_config; }
+
 private:
     static void send_initial_config(wl_resource* client_resource, graphics::DisplayConfigurationOutput const& config);
 
@@ -75,6 +77,9 @@ public:
 
     auto output_for(graphics::DisplayConfigurationOutputId id) -> std::experimental::optional<Output*>;
 
+    /// The output whose extents are exactly \p extents, e.g. a display buffer's view_area()
+    auto output_for(geometry::Rectangle const& extents) -> std::experimental::optional<Output*>;
+
     auto display_config() const -> std::shared_ptr<MirDisplay> {return display_config_;}
 
 private:
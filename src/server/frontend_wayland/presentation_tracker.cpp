@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_tracker.h"
+
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+namespace
+{
+auto in_presentation_clock(mir::time::PosixTimestamp const& ust) -> mir::time::PosixTimestamp
+{
+    using mir::time::PosixTimestamp;
+
+    // Display buffers that have never posted report a zero timestamp
+    if (ust.nanoseconds == std::chrono::nanoseconds::zero())
+        return PosixTimestamp::now(mf::PresentationTracker::clock);
+
+    if (ust.clock_id == mf::PresentationTracker::clock)
+        return ust;
+
+    auto const age = PosixTimestamp::now(ust.clock_id) - ust;
+    return PosixTimestamp::now(mf::PresentationTracker::clock) - age;
+}
+}
+
+auto mf::is_shown(ms::Surface const& surface) -> bool
+{
+    return surface.visible() && surface.query(mir_window_attrib_visibility) != mir_window_visibility_occluded;
+}
+
+void mf::PresentationTracker::on_next_presentation(
+    std::weak_ptr<ms::Surface> const& surface,
+    Presented const& presented,
+    std::function<void()> const& discarded)
+{
+    awaiting.push_back({surface, presented, discarded});
+}
+
+void mf::PresentationTracker::frame_presented(geom::Rectangle const& view_area, mg::Frame const& frame)
+{
+    mg::Frame const presentation{frame.msc, in_presentation_clock(frame.ust)};
+
+    // Callbacks may queue more work, so take the current batch first
+    std::vector<Awaiting> ready;
+    auto const split = std::stable_partition(
+        awaiting.begin(),
+        awaiting.end(),
+        [&](Awaiting const& candidate)
+        {
+            auto const surface = candidate.surface.lock();
+            if (!surface)
+                return false;
+
+            return !is_shown(*surface) || !view_area.overlaps({surface->top_left(), surface->window_size()});
+        });
+
+    std::move(split, awaiting.end(), std::back_inserter(ready));
+    awaiting.erase(split, awaiting.end());
+
+    for (auto const& item : ready)
+    {
+        if (item.surface.expired())
+            item.discarded();
+        else
+            item.presented(view_area, presentation);
+    }
+}
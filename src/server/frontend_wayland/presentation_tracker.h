@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_PRESENTATION_TRACKER_H
+#define MIR_FRONTEND_PRESENTATION_TRACKER_H
+
+#include "mir/compositor/presentation_observer.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/graphics/frame.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+class Surface;
+}
+namespace frontend
+{
+/**
+ * Runs work once a surface has been shown on an output.
+ *
+ * Work waits for the next post of an output that overlaps the surface while the surface is
+ * neither hidden nor occluded; surfaces the user can't see are left waiting until they can.
+ * Must only be used on the Wayland thread (register it with the Wayland executor).
+ */
+class PresentationTracker : public compositor::PresentationObserver
+{
+public:
+    /// The clock domain of the timestamps handed to Presented
+    static clockid_t const clock = CLOCK_MONOTONIC;
+
+    /// \param view_area    the output's view area
+    /// \param frame        the output's frame, with ust in PresentationTracker::clock
+    using Presented = std::function<void(geometry::Rectangle const& view_area, graphics::Frame const& frame)>;
+
+    /// Calls presented after the next post showing surface, or discarded if the surface goes away first
+    void on_next_presentation(
+        std::weak_ptr<scene::Surface> const& surface,
+        Presented const& presented,
+        std::function<void()> const& discarded);
+
+    void frame_presented(geometry::Rectangle const& view_area, graphics::Frame const& frame) override;
+
+private:
+    struct Awaiting
+    {
+        std::weak_ptr<scene::Surface> surface;
+        Presented presented;
+        std::function<void()> discarded;
+    };
+
+    std::vector<Awaiting> awaiting;
+};
+
+/// Whether the user could currently see any of surface
+auto is_shown(scene::Surface const& surface) -> bool;
+}
+}
+
+#endif // MIR_FRONTEND_PRESENTATION_TRACKER_H
@@ -29,6 +29,8 @@
 
 #include "null_event_sink.h"
 #include "output_manager.h"
+#include "wp_presentation_time.h"
+#include "presentation_tracker.h"
 #include "wayland_executor.h"
 #include "wlshmbuffer.h"
 
@@ -40,6 +42,7 @@
 #include "mir/frontend/wayland.h"
 
 #include "mir/compositor/buffer_stream.h"
+#include "mir/observer_registrar.h"
 
 #include "mir/scene/surface_creation_parameters.h"
 #include "mir/shell/shell.h"
@@ -238,10 +241,12 @@ public:
     WlCompositor(
         struct wl_display* display,
         std::shared_ptr<mir::Executor> const& executor,
-        std::shared_ptr<mg::WaylandAllocator> const& allocator)
+        std::shared_ptr<mg::WaylandAllocator> const& allocator,
+        std::shared_ptr<PresentationTracker> const& presentation_tracker)
         : Global(display, Version<4>()),
           allocator{allocator},
-          executor{executor}
+          executor{executor},
+          presentation_tracker{presentation_tracker}
     {
     }
 
@@ -250,6 +255,7 @@ public:
 private:
     std::shared_ptr<mg::WaylandAllocator> const allocator;
     std::shared_ptr<mir::Executor> const executor;
+    std::shared_ptr<PresentationTracker> const presentation_tracker;
     std::map<std::pair<wl_client*, uint32_t>, std::vector<std::function<void(WlSurface*)>>> surface_callbacks;
 
     class Instance : wayland::Compositor
@@ -289,7 +295,11 @@ void WlCompositor::on_surface_created(wl_client* client, uint32_t id, std::funct
 
 void WlCompositor::Instance::create_surface(wl_resource* new_surface)
 {
-    auto const surface = new WlSurface{new_surface, compositor->executor, compositor->allocator};
+    auto const surface = new WlSurface{
+        new_surface,
+        compositor->executor,
+        compositor->allocator,
+        compositor->presentation_tracker};
     auto const key = std::make_pair(wl_resource_get_client(new_surface), wl_resource_get_id(new_surface));
     auto const callbacks = compositor->surface_callbacks.find(key);
     if (callbacks != compositor->surface_callbacks.end())
@@ -646,12 +656,15 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<mi::Seat> const& seat,
     std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
     std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
+    std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> const& presentation_observer_registrar,
     bool arw_socket,
     std::unique_ptr<WaylandExtensions> extensions_,
     WaylandProtocolExtensionFilter const& extension_filter)
     : display{wl_display_create(), &cleanup_display},
       pause_signal{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE)},
       executor{std::make_shared<WaylandExecutor>(wl_display_get_event_loop(display.get()))},
+      presentation_tracker{std::make_shared<PresentationTracker>()},
+      presentation_observer_registrar{presentation_observer_registrar},
       allocator{allocator_for_display(allocator, display.get(), executor)},
       shell{shell},
       extensions{std::move(extensions_)},
@@ -695,7 +708,8 @@ mf::WaylandConnector::WaylandConnector(
     compositor_global = std::make_unique<mf::WlCompositor>(
         display.get(),
         executor,
-        this->allocator);
+        this->allocator,
+        presentation_tracker);
     subcompositor_global = std::make_unique<mf::WlSubcompositor>(display.get());
     seat_global = std::make_unique<mf::WlSeat>(display.get(), input_hub, seat, executor);
     output_manager = std::make_unique<mf::OutputManager>(
@@ -704,6 +718,10 @@ mf::WaylandConnector::WaylandConnector(
         executor);
 
     data_device_manager_global = mf::create_data_device_manager(display.get());
+    presentation_global = std::make_unique<mf::WpPresentation>(
+        display.get(),
+        output_manager.get(),
+        presentation_tracker);
 
     extensions->init(display.get(), shell, seat_global.get(), output_manager.get());
 
@@ -742,10 +760,15 @@ mf::WaylandConnector::WaylandConnector(
     setup_new_client_handler(display.get(), shell, session_authorizer, &connect_handlers);
 
     pause_source = wl_event_loop_add_fd(wayland_loop, pause_signal, WL_EVENT_READABLE, &halt_eventloop, display.get());
+
+    // The tracker is only touched on the Wayland thread, so notifications are delivered there
+    presentation_observer_registrar->register_interest(presentation_tracker, *executor);
 }
 
 mf::WaylandConnector::~WaylandConnector()
 {
+    presentation_observer_registrar->unregister_interest(*presentation_tracker);
+
     if (dispatch_thread.joinable())
     {
         stop();
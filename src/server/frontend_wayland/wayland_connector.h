@@ -32,7 +32,13 @@
 namespace mir
 {
 class Executor;
+template<class Observer>
+class ObserverRegistrar;
 
+namespace compositor
+{
+class PresentationObserver;
+}
 namespace input
 {
 class InputDeviceHub;
@@ -62,10 +68,12 @@ class WlSubcompositor;
 class WlApplication;
 class WlSeat;
 class OutputManager;
+class PresentationTracker;
 class MirDisplay;
 class SessionAuthorizer;
 class DataDeviceManager;
 class WlSurface;
+class WpPresentation;
 
 class WaylandExtensions
 {
@@ -102,6 +110,7 @@ public:
         std::shared_ptr<input::Seat> const& seat,
         std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
+        std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> const& presentation_observer_registrar,
         bool arw_socket,
         std::unique_ptr<WaylandExtensions> extensions,
         WaylandProtocolExtensionFilter const& extension_filter);
@@ -138,6 +147,9 @@ private:
     std::unique_ptr<OutputManager> output_manager;
     std::unique_ptr<DataDeviceManager> data_device_manager_global;
     std::shared_ptr<Executor> const executor;
+    std::shared_ptr<PresentationTracker> const presentation_tracker;
+    std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> const presentation_observer_registrar;
+    std::unique_ptr<WpPresentation> presentation_global;
     std::shared_ptr<graphics::WaylandAllocator> const allocator;
     std::shared_ptr<shell::Shell> const shell;
     std::unique_ptr<WaylandExtensions> const extensions;
@@ -158,6 +158,7 @@ std::shared_ptr<mf::Connector>
                 the_seat(),
                 the_buffer_allocator(),
                 the_session_authorizer(),
+                the_presentation_observer_registrar(),
                 arw_socket,
                 configure_wayland_extensions(wayland_extensions, options->is_set(mo::x11_display_opt), wayland_extension_hooks),
                 wayland_extension_filter);
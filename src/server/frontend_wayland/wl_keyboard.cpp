@@ -18,6 +18,7 @@
 
 #include "wl_keyboard.h"
 
+#include "keymap_cache.h"
 #include "wayland_utils.h"
 #include "wl_surface.h"
 
@@ -38,12 +39,12 @@ namespace mi = mir::input;
 mf::WlKeyboard::WlKeyboard(
     wl_resource* new_resource,
     mir::input::Keymap const& initial_keymap,
+    std::shared_ptr<KeymapCache> const& keymap_cache,
     std::function<void(WlKeyboard*)> const& on_destroy,
     std::function<std::vector<uint32_t>()> const& acquire_current_keyboard_state)
     : Keyboard(new_resource, Version<6>()),
-      keymap{nullptr, &xkb_keymap_unref},
+      keymap_cache{keymap_cache},
       state{nullptr, &xkb_state_unref},
-      context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref},
       on_destroy{on_destroy},
       acquire_current_keyboard_state{acquire_current_keyboard_state}
 {
@@ -168,45 +169,20 @@ void mf::WlKeyboard::set_keymap(char const* const buffer, size_t length)
                       Fd{IntOwnedFd{shm_buffer.fd()}},
                       length);
 
-    keymap = decltype(keymap)(xkb_keymap_new_from_buffer(
-        context.get(),
-        buffer,
-        length,
-        XKB_KEYMAP_FORMAT_TEXT_V1,
-        XKB_KEYMAP_COMPILE_NO_FLAGS),
-        &xkb_keymap_unref);
+    keymap = keymap_cache->keymap_from_buffer(buffer, length);
 
     state = decltype(state)(xkb_state_new(keymap.get()), &xkb_state_unref);
 }
 
 void mf::WlKeyboard::set_keymap(mi::Keymap const& new_keymap)
 {
-    xkb_rule_names const names = {
-        "evdev",
-        new_keymap.model.c_str(),
-        new_keymap.layout.c_str(),
-        new_keymap.variant.c_str(),
-        new_keymap.options.c_str()
-    };
-    keymap = decltype(keymap){
-        xkb_keymap_new_from_names(
-            context.get(),
-            &names,
-            XKB_KEYMAP_COMPILE_NO_FLAGS),
-        &xkb_keymap_unref};
+    auto const compiled = keymap_cache->keymap_for(new_keymap);
+    keymap = compiled->keymap;
 
     // TODO: We might need to copy across the existing depressed keys?
     state = decltype(state)(xkb_state_new(keymap.get()), &xkb_state_unref);
 
-    std::unique_ptr<char, void(*)(void*)> buffer{xkb_keymap_get_as_string(keymap.get(), XKB_KEYMAP_FORMAT_TEXT_V1), free};
-    auto length = strlen(buffer.get());
-
-    mir::AnonymousShmFile shm_buffer{length};
-    memcpy(shm_buffer.base_ptr(), buffer.get(), length);
-
-    send_keymap_event(KeymapFormat::xkb_v1,
-                      Fd{IntOwnedFd{shm_buffer.fd()}},
-                      length);
+    send_keymap_event(KeymapFormat::xkb_v1, compiled->fd(), compiled->size());
 }
 
 void mf::WlKeyboard::update_modifier_state()
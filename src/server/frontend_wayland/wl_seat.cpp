@@ -23,6 +23,7 @@
 #include "wayland_utils.h"
 #include "wl_surface.h"
 #include "wl_keyboard.h"
+#include "keymap_cache.h"
 #include "wl_pointer.h"
 #include "wl_touch.h"
 
@@ -161,6 +162,7 @@ mf::WlSeat::WlSeat(
     std::shared_ptr<mir::Executor> const& executor)
     :   Global(display, Version<6>()),
         keymap{std::make_unique<input::Keymap>()},
+        keymap_cache{std::make_shared<KeymapCache>()},
         config_observer{
             std::make_shared<ConfigObserver>(
                 *keymap,
@@ -253,6 +255,7 @@ void mf::WlSeat::Instance::get_keyboard(wl_resource* new_keyboard)
         new WlKeyboard{
             new_keyboard,
             *seat->keymap,
+            seat->keymap_cache,
             [listeners = seat->keyboard_listeners, client = client](WlKeyboard* listener)
             {
                 listeners->unregister_listener(client, listener);
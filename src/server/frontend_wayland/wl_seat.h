@@ -46,6 +46,7 @@ namespace frontend
 class WlPointer;
 class WlKeyboard;
 class WlTouch;
+class KeymapCache;
 
 class WlSeat : public wayland::Seat::Global
 {
@@ -104,6 +105,7 @@ private:
     class Instance;
 
     std::unique_ptr<mir::input::Keymap> const keymap;
+    std::shared_ptr<KeymapCache> const keymap_cache;
     std::shared_ptr<ConfigObserver> const config_observer;
 
     // listener list are shared pointers so devices can keep them around long enough to remove themselves
@@ -24,12 +24,15 @@
 #include "wl_region.h"
 #include "wlshmbuffer.h"
 #include "deleted_for_resource.h"
+#include "wp_presentation_time.h"
+#include "presentation_tracker.h"
 
 #include "wayland_wrapper.h"
 
 #include "wayland_frontend.tp.h"
 
 #include "mir/graphics/buffer_properties.h"
+#include "mir/graphics/frame.h"
 #include "mir/scene/session.h"
 #include "mir/frontend/wayland.h"
 #include "mir/compositor/buffer_stream.h"
@@ -39,13 +42,59 @@
 #include "mir/log.h"
 
 #include <algorithm>
+#include <chrono>
 #include <boost/throw_exception.hpp>
 
 namespace mf = mir::frontend;
+namespace mg = mir::graphics;
 namespace geom = mir::geometry;
 namespace mw = mir::wayland;
 namespace msh = mir::shell;
 
+namespace
+{
+using FrameCallbacks = std::vector<std::shared_ptr<mf::WlSurfaceState::Callback>>;
+
+void send_done(FrameCallbacks const& callbacks, mir::time::PosixTimestamp const& time)
+{
+    // wl_callback.done wants milliseconds with an undefined base, so wrapping is fine
+    auto const msec = std::chrono::duration_cast<std::chrono::milliseconds>(time.nanoseconds).count();
+
+    for (auto const& frame : callbacks)
+    {
+        if (!*frame->destroyed)
+        {
+            frame->send_done_event(static_cast<uint32_t>(msec));
+            frame->destroy_wayland_object();
+        }
+    }
+}
+
+auto presentation_now() -> mir::time::PosixTimestamp
+{
+    return mir::time::PosixTimestamp::now(mf::PresentationTracker::clock);
+}
+
+/// Clients commonly damage (0, 0, INT32_MAX, INT32_MAX), so take care not to overflow
+auto damage_in_buffer(geom::Rectangle const& damage, int scale, geom::Size const& buffer_size)
+    -> geom::Rectangle
+{
+    auto const clamp = [](long long value, int max) { return int(std::max(0LL, std::min(value, (long long)max))); };
+
+    auto const width = buffer_size.width.as_int();
+    auto const height = buffer_size.height.as_int();
+    long long const left = damage.top_left.x.as_int();
+    long long const top = damage.top_left.y.as_int();
+    long long const right = left + damage.size.width.as_int();
+    long long const bottom = top + damage.size.height.as_int();
+
+    geom::Point const top_left{clamp(left * scale, width), clamp(top * scale, height)};
+    geom::Point const bottom_right{clamp(right * scale, width), clamp(bottom * scale, height)};
+
+    return {top_left, as_size(bottom_right - top_left)};
+}
+}
+
 mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
     : mw::Callback{new_resource, Version<1>()},
       destroyed{deleted_flag_for_resource(resource)}
@@ -66,10 +115,25 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_feedbacks.insert(end(presentation_feedbacks),
+                                  begin(source.presentation_feedbacks),
+                                  end(source.presentation_feedbacks));
+
+    surface_damage.insert(end(surface_damage),
+                          begin(source.surface_damage),
+                          end(source.surface_damage));
+
+    buffer_damage.insert(end(buffer_damage),
+                         begin(source.buffer_damage),
+                         end(source.buffer_damage));
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -78,18 +142,21 @@ bool mf::WlSurfaceState::surface_data_needs_refresh() const
 {
     return offset ||
            input_shape ||
+           opaque_region ||
            surface_data_invalidated;
 }
 
 mf::WlSurface::WlSurface(
     wl_resource* new_resource,
     std::shared_ptr<Executor> const& executor,
-    std::shared_ptr<graphics::WaylandAllocator> const& allocator)
+    std::shared_ptr<graphics::WaylandAllocator> const& allocator,
+    std::shared_ptr<PresentationTracker> const& presentation_tracker)
     : Surface(new_resource, Version<4>()),
         session{get_session(client)},
         stream{session->create_buffer_stream({{}, mir_pixel_format_invalid, graphics::BufferUsage::undefined})},
         allocator{allocator},
         executor{executor},
+        presentation_tracker{presentation_tracker},
         null_role{this},
         role{&null_role},
         destroyed{std::make_shared<bool>(false)}
@@ -110,6 +177,9 @@ mf::WlSurface::~WlSurface()
         listener.second();
     }
 
+    for (auto const& feedback : presentation_feedbacks)
+        feedback->superseded();
+
     role->destroy();
     session->destroy_buffer_stream(stream);
 }
@@ -189,7 +259,7 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
 {
     geometry::Displacement offset = parent_offset + offset_;
 
-    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}});
+    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}, opaque_region});
     geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
     if (input_shape)
     {
@@ -229,16 +299,42 @@ mf::WlSurface* mf::WlSurface::from(wl_resource* resource)
 
 void mf::WlSurface::send_frame_callbacks()
 {
-    for (auto const& frame : frame_callbacks)
+    send_done(frame_callbacks, presentation_now());
+    frame_callbacks.clear();
+}
+
+void mf::WlSurface::send_frame_callbacks_on_presentation()
+{
+    // Every consumed buffer gets here: only wait on the tracker if someone is waiting on us
+    if (frame_callbacks.empty())
+        return;
+
+    auto const surface = scene_surface();
+    if (!surface)
     {
-        if (!*frame->destroyed)
-        {
-            // TODO: argument should be a timestamp
-            frame->send_done_event(0);
-            frame->destroy_wayland_object();
-        }
+        // Nothing will show it, so don't keep the client waiting
+        send_frame_callbacks();
+        return;
     }
+
+    auto callbacks = std::make_shared<FrameCallbacks>(std::move(frame_callbacks));
     frame_callbacks.clear();
+
+    presentation_tracker->on_next_presentation(
+        surface.value(),
+        [callbacks](geom::Rectangle const&, mg::Frame const& frame) { send_done(*callbacks, frame.ust); },
+        [callbacks]() { send_done(*callbacks, presentation_now()); });
+}
+
+void mf::WlSurface::send_frame_callbacks_when_shown()
+{
+    // Clients drive their rendering from frame callbacks: pause those the user can't see. A surface without
+    // content can't be seen either, but its client may be waiting on the callback before drawing any.
+    auto const surface = scene_surface();
+    if (surface && buffer_size_ && !is_shown(*surface.value()))
+        send_frame_callbacks_on_presentation();
+    else
+        send_frame_callbacks();
 }
 
 void mf::WlSurface::destroy()
@@ -261,20 +357,14 @@ void mf::WlSurface::attach(std::experimental::optional<wl_resource*> const& buff
 
 void mf::WlSurface::damage(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    if (width > 0 && height > 0)
+        pending.surface_damage.push_back({{x, y}, {width, height}});
 }
 
 void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    if (width > 0 && height > 0)
+        pending.buffer_damage.push_back({{x, y}, {width, height}});
 }
 
 void mf::WlSurface::frame(wl_resource* new_callback)
@@ -282,10 +372,17 @@ void mf::WlSurface::frame(wl_resource* new_callback)
     pending.frame_callbacks.push_back(std::make_shared<WlSurfaceState::Callback>(new_callback));
 }
 
+void mf::WlSurface::add_presentation_feedback(std::shared_ptr<WpPresentationFeedback> const& feedback)
+{
+    pending.presentation_feedbacks.push_back(feedback);
+}
+
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    if (region)
+        pending.opaque_region = WlRegion::from(region.value())->rectangle_vector();
+    else
+        pending.opaque_region = std::vector<geom::Rectangle>{};
 }
 
 void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> const& region)
@@ -316,28 +413,53 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    if (state.opaque_region)
+        opaque_region = state.opaque_region.value();
+
     if (state.scale)
+    {
+        buffer_scale = state.scale.value();
         stream->set_scale(state.scale.value());
+    }
 
     if (state.buffer)
     {
         wl_resource * buffer = *state.buffer;
 
+        // Whatever the previous buffer was, it won't be presented after this
+        for (auto const& feedback : presentation_feedbacks)
+            feedback->superseded();
+        presentation_feedbacks = state.presentation_feedbacks;
+
         if (buffer == nullptr)
         {
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
             send_frame_callbacks();
+
+            for (auto const& feedback : presentation_feedbacks)
+                feedback->discard();
+            presentation_feedbacks.clear();
         }
         else
         {
-            auto const executor_send_frame_callbacks = [this, executor = executor, destroyed = destroyed]()
+            auto const executor_send_frame_callbacks =
+                [this, executor = executor, destroyed = destroyed, feedbacks = state.presentation_feedbacks]()
                 {
                     executor->spawn(run_unless(
                         destroyed,
-                        [this]()
+                        [this, feedbacks]()
                         {
-                            send_frame_callbacks();
+                            send_frame_callbacks_on_presentation();
+
+                            auto const surface = scene_surface();
+                            for (auto const& feedback : feedbacks)
+                            {
+                                if (surface)
+                                    feedback->consumed(surface.value());
+                                else
+                                    feedback->discard();
+                            }
                         }));
                 };
 
@@ -377,7 +499,18 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     mir_buffer->id().as_value());
             }
 
-            stream->submit_buffer(mir_buffer);
+            geom::Rectangles damage;
+            for (auto const& rect : state.surface_damage)
+                damage.add(damage_in_buffer(rect, buffer_scale, mir_buffer->size()));
+            for (auto const& rect : state.buffer_damage)
+                damage.add(damage_in_buffer(rect, 1, mir_buffer->size()));
+
+            // Some clients attach buffers without damage: treat those as entirely changed
+            if (damage.size())
+                stream->submit_buffer(mir_buffer, damage);
+            else
+                stream->submit_buffer(mir_buffer);
+
             auto const new_buffer_size = stream->stream_size();
 
             if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
@@ -390,7 +523,11 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
     else
     {
-        send_frame_callbacks();
+        send_frame_callbacks_when_shown();
+
+        // There is no new content to time the presentation of
+        for (auto const& feedback : state.presentation_feedbacks)
+            feedback->discard();
     }
 
     for (WlSubsurface* child: children)
@@ -410,6 +547,10 @@ void mf::WlSurface::commit()
     if (pending.input_shape && *pending.input_shape == input_shape)
         pending.input_shape = std::experimental::nullopt;
 
+    // Many clients set the same opaque region on every commit, don't update the scene for those
+    if (pending.opaque_region && *pending.opaque_region == opaque_region)
+        pending.opaque_region = std::experimental::nullopt;
+
     // order is important
     auto const state = std::move(pending);
     pending = WlSurfaceState();
@@ -58,6 +58,8 @@ namespace frontend
 {
 class WlSurface;
 class WlSubsurface;
+class WpPresentationFeedback;
+class PresentationTracker;
 
 struct WlSurfaceState
 {
@@ -83,7 +85,11 @@ struct WlSurfaceState
     std::experimental::optional<int> scale;
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    std::experimental::optional<std::vector<geometry::Rectangle>> opaque_region;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
+    std::vector<std::shared_ptr<WpPresentationFeedback>> presentation_feedbacks;
+    std::vector<geometry::Rectangle> surface_damage; ///< from wl_surface.damage, in surface coordinates
+    std::vector<geometry::Rectangle> buffer_damage;  ///< from wl_surface.damage_buffer, in buffer coordinates
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -119,7 +125,8 @@ public:
 
     WlSurface(wl_resource* new_resource,
               std::shared_ptr<mir::Executor> const& executor,
-              std::shared_ptr<mir::graphics::WaylandAllocator> const& allocator);
+              std::shared_ptr<mir::graphics::WaylandAllocator> const& allocator,
+              std::shared_ptr<PresentationTracker> const& presentation_tracker);
 
     ~WlSurface();
 
@@ -142,6 +149,7 @@ public:
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
     void commit(WlSurfaceState const& state);
+    void add_presentation_feedback(std::shared_ptr<WpPresentationFeedback> const& feedback);
     void add_destroy_listener(void const* key, std::function<void()> listener);
     void remove_destroy_listener(void const* key);
 
@@ -153,6 +161,7 @@ public:
 private:
     std::shared_ptr<mir::graphics::WaylandAllocator> const allocator;
     std::shared_ptr<mir::Executor> const executor;
+    std::shared_ptr<PresentationTracker> const presentation_tracker;
 
     NullWlSurfaceRole null_role;
     WlSurfaceRole* role;
@@ -161,12 +170,17 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    int buffer_scale{1};
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
+    std::vector<std::shared_ptr<WpPresentationFeedback>> presentation_feedbacks; ///< for the last committed buffer
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
+    std::vector<mir::geometry::Rectangle> opaque_region;
     std::map<void const*, std::function<void()>> destroy_listeners;
     std::shared_ptr<bool> const destroyed;
 
     void send_frame_callbacks();
+    void send_frame_callbacks_on_presentation();    ///< after the next post that shows the surface
+    void send_frame_callbacks_when_shown();         ///< now, or on presentation if the user can't see the surface
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
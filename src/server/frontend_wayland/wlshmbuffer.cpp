@@ -22,15 +22,18 @@
 #include "wayland_executor.h"
 
 #include <mir/log.h>
+#include <mir/graphics/gl_extensions_base.h>
 
 #include <wayland-server-protocol.h>
 
 #include MIR_SERVER_GL_H
 #include MIR_SERVER_GLEXT_H
+#include <EGL/egl.h>
 
 #include <boost/throw_exception.hpp>
 
 #include <cstring>
+#include <vector>
 
 namespace
 {
@@ -127,14 +130,49 @@ namespace mf = mir::frontend;
 namespace mg = mir::graphics;
 using namespace mir::geometry;
 
+namespace
+{
+class GLExtensions : public mg::GLExtensionsBase
+{
+public:
+    GLExtensions() :
+        mg::GLExtensionsBase{
+            reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS))}
+    {
+    }
+};
+
+bool unpack_subimage_supported()
+{
+#ifdef GL_UNPACK_ROW_LENGTH_EXT
+    // Parsing GL_EXTENSIONS is too slow to do per upload, and each compositor thread has its own context
+    thread_local EGLContext checked_context{EGL_NO_CONTEXT};
+    thread_local bool supported{false};
+
+    auto const context = eglGetCurrentContext();
+    if (context != checked_context)
+    {
+        supported = GLExtensions{}.support("GL_EXT_unpack_subimage");
+        checked_context = context;
+    }
+
+    return supported;
+#else
+    return false;
+#endif
+}
+}
+
 mf::WlShmBuffer::~WlShmBuffer()
 {
-    executor->spawn([wayland = wayland]()
+    // Only now is the client free to reuse the buffer: we no longer read from the pool
+    executor->spawn([wayland = std::move(wayland)]()
         {
             std::lock_guard <std::mutex> lock{wayland->mutex};
             if (wayland->resource) {
                 wl_resource_queue_event(wayland->resource.value(), WL_BUFFER_RELEASE);
             }
+            // The resources were moved into this task, so the pool is unreffed on the Wayland thread
         });
 }
 
@@ -220,14 +258,21 @@ void mf::WlShmBuffer::gl_bind_to_texture()
          */
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        read(
-            [this, format, type](unsigned char const *pixels)
+        auto const upload = [this, format, type](unsigned char const *pixels)
             {
                 auto const size = this->size();
                 glTexImage2D(GL_TEXTURE_2D, 0, format,
                              size.width.as_int(), size.height.as_int(),
                              0, format, type, pixels);
-            });
+            };
+
+        if (!read_in_place(upload))
+        {
+            // Don't leave whatever the texture held before: it isn't this buffer
+            std::vector<unsigned char> const blank(
+                size_.width.as_int() * size_.height.as_int() * MIR_BYTES_PER_PIXEL(format_));
+            upload(blank.data());
+        }
     }
 }
 
@@ -236,6 +281,77 @@ void mf::WlShmBuffer::bind()
     gl_bind_to_texture();
 }
 
+void mf::WlShmBuffer::bind_damage(Rectangles const& damage)
+{
+    GLenum format, type;
+
+    if (!get_gl_pixel_format(format_, format, type))
+        return;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(format_);
+    auto const stride = stride_.as_int();
+    bool const whole_rows_contiguous = stride == size_.width.as_int() * bytes_per_pixel;
+    bool const subimage_unpack = stride % bytes_per_pixel == 0 && unpack_subimage_supported();
+
+#ifdef GL_UNPACK_ROW_LENGTH_EXT
+    if (subimage_unpack)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride / bytes_per_pixel);
+#endif
+
+    bool const uploaded = read_in_place(
+        [&](unsigned char const* pixels)
+        {
+            for (auto const& rect : damage)
+            {
+                auto const area = rect.intersection_with({{}, size_});
+                auto const x = area.top_left.x.as_int();
+                auto const y = area.top_left.y.as_int();
+                auto const width = area.size.width.as_int();
+                auto const height = area.size.height.as_int();
+
+                if (width <= 0 || height <= 0)
+                    continue;
+
+                if (subimage_unpack)
+                {
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type,
+                                    pixels + y * stride + x * bytes_per_pixel);
+                }
+                else if (whole_rows_contiguous)
+                {
+                    // Without GL_EXT_unpack_subimage we can only skip whole rows
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, size_.width.as_int(), height, format, type,
+                                    pixels + y * stride);
+                }
+                else
+                {
+                    for (auto row = y; row != y + height; ++row)
+                    {
+                        glTexSubImage2D(GL_TEXTURE_2D, 0, x, row, width, 1, format, type,
+                                        pixels + row * stride + x * bytes_per_pixel);
+                    }
+                }
+            }
+        });
+
+#ifdef GL_UNPACK_ROW_LENGTH_EXT
+    if (subimage_unpack)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+#endif
+
+    // The texture still holds the previous buffer, which isn't what this one looks like
+    if (!uploaded)
+        gl_bind_to_texture();
+}
+
+bool mf::WlShmBuffer::contents_readable() const
+{
+    std::lock_guard <std::mutex> lock{wayland->mutex};
+    return static_cast<bool>(wayland->buffer);
+}
+
 void mf::WlShmBuffer::secure_for_render()
 {
 }
@@ -255,6 +371,11 @@ void mf::WlShmBuffer::write(unsigned char const *pixels, size_t size)
 }
 
 void mf::WlShmBuffer::read(std::function<void(unsigned char const *)> const &do_with_pixels)
+{
+    read_in_place(do_with_pixels);
+}
+
+bool mf::WlShmBuffer::read_in_place(std::function<void(unsigned char const *)> const& do_with_pixels)
 {
     std::lock_guard <std::mutex> lock{wayland->mutex};
     if (!consumed)
@@ -263,7 +384,16 @@ void mf::WlShmBuffer::read(std::function<void(unsigned char const *)> const &do_
         consumed = true;
     }
 
-    do_with_pixels(static_cast<unsigned char const *>(data.get()));
+    if (!wayland->buffer) {
+        // Without the wl_shm_buffer we can't guard against the client truncating the pool
+        log_warning("Attempt to read from WlShmBuffer after the wl_buffer has been destroyed");
+        return false;
+    }
+
+    wl_shm_buffer_begin_access(wayland->buffer.value());
+    do_with_pixels(data);
+    wl_shm_buffer_end_access(wayland->buffer.value());
+    return true;
 }
 
 Stride mf::WlShmBuffer::stride() const
@@ -273,10 +403,21 @@ Stride mf::WlShmBuffer::stride() const
 
 mf::WlShmBuffer::WaylandResources::WaylandResources(wl_resource *resource)
     : resource{resource},
-      buffer{shm_buffer_from_resource_checked(resource)}
+      buffer{shm_buffer_from_resource_checked(resource)},
+      pool{buffer.value()}
 {
 }
 
+mf::WlShmBuffer::ShmPoolRef::ShmPoolRef(wl_shm_buffer* buffer)
+    : pool{wl_shm_buffer_ref_pool(buffer)}
+{
+}
+
+mf::WlShmBuffer::ShmPoolRef::~ShmPoolRef()
+{
+    wl_shm_pool_unref(pool);
+}
+
 mf::WlShmBuffer::DestructionShim::DestructionShim(wl_resource* buffer_resource)
     : destruction_listener{{nullptr, nullptr}, &on_buffer_destroyed}
 {
@@ -294,7 +435,7 @@ mf::WlShmBuffer::WlShmBuffer(
         wl_shm_buffer_get_height(wayland->buffer.value())},
     stride_{wl_shm_buffer_get_stride(wayland->buffer.value())},
     format_{wl_format_to_mir_format(wl_shm_buffer_get_format(wayland->buffer.value()))},
-    data{std::make_unique<uint8_t[]>(size_.height.as_int() * stride_.as_int())},
+    data{static_cast<unsigned char const*>(wl_shm_buffer_get_data(wayland->buffer.value()))},
     consumed{false},
     on_consumed{std::move(on_consumed)},
     executor{executor}
@@ -310,10 +451,6 @@ mf::WlShmBuffer::WlShmBuffer(
         BOOST_THROW_EXCEPTION((
                                   std::runtime_error{"Buffer has invalid stride"}));
     }
-
-    wl_shm_buffer_begin_access(wayland->buffer.value());
-    std::memcpy(data.get(), wl_shm_buffer_get_data(wayland->buffer.value()), size_.height.as_int() * stride_.as_int());
-    wl_shm_buffer_end_access(wayland->buffer.value());
 }
 
 void mf::WlShmBuffer::on_buffer_destroyed(wl_listener *listener, void *)
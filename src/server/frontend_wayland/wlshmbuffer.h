@@ -22,6 +22,7 @@
 
 #include <mir/graphics/buffer_basic.h>
 #include <mir/renderer/gl/texture_source.h>
+#include <mir/renderer/gl/incremental_texture_source.h>
 #include <mir/renderer/sw/pixel_source.h>
 
 #include <wayland-server-core.h>
@@ -42,6 +43,7 @@ class WlShmBuffer :
     public graphics::BufferBasic,
     public graphics::NativeBufferBase,
     public renderer::gl::TextureSource,
+    public renderer::gl::IncrementalTextureSource,
     public renderer::software::PixelSource
 {
 public:
@@ -68,6 +70,10 @@ public:
 
     void bind() override;
 
+    void bind_damage(geometry::Rectangles const& damage) override;
+
+    bool contents_readable() const override;
+
     void secure_for_render() override;
 
     void write(unsigned char const *pixels, size_t size) override;
@@ -82,6 +88,23 @@ private:
 
     static void on_buffer_destroyed(wl_listener *listener, void *);
 
+    /// Calls do_with_pixels with the buffer's contents, unless the wl_buffer has gone
+    bool read_in_place(std::function<void(unsigned char const *)> const& do_with_pixels);
+
+    /// A reference on a wl_shm_pool, which keeps it mapped and makes libwayland defer any resize
+    class ShmPoolRef
+    {
+    public:
+        explicit ShmPoolRef(wl_shm_buffer* buffer);
+        ~ShmPoolRef();
+
+    private:
+        ShmPoolRef(ShmPoolRef const&) = delete;
+        ShmPoolRef& operator=(ShmPoolRef const&) = delete;
+
+        wl_shm_pool* const pool;
+    };
+
     struct WaylandResources
     {
         WaylandResources(wl_resource *resource);
@@ -89,6 +112,8 @@ private:
         std::mutex mutex;
         std::experimental::optional<wl_resource* const> resource;
         std::experimental::optional<wl_shm_buffer* const> buffer;
+        /// Held for as long as we might read from the pool; dropped on the Wayland thread
+        ShmPoolRef const pool;
     };
 
     struct DestructionShim
@@ -106,7 +131,8 @@ private:
     geometry::Stride const stride_;
     MirPixelFormat const format_;
 
-    std::unique_ptr<uint8_t[]> const data;
+    /// Points into the client's shm pool: pixels are read in place, not copied
+    unsigned char const* const data;
 
     bool consumed;
     std::function<void()> on_consumed;
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wp_presentation_time.h"
+
+#include "wl_surface.h"
+#include "output_manager.h"
+#include "presentation_tracker.h"
+#include "deleted_for_resource.h"
+
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+auto refresh_interval(mf::Output const* output) -> std::chrono::nanoseconds
+{
+    if (!output)
+        return std::chrono::nanoseconds::zero();
+
+    auto const& config = output->configuration();
+    if (config.current_mode_index >= config.modes.size())
+        return std::chrono::nanoseconds::zero();
+
+    auto const hz = config.modes[config.current_mode_index].vrefresh_hz;
+    if (hz <= 0)
+        return std::chrono::nanoseconds::zero();
+
+    return std::chrono::nanoseconds{static_cast<int64_t>(1e9 / hz)};
+}
+}
+
+namespace mir
+{
+namespace frontend
+{
+class WpPresentation::Instance : public wayland::Presentation
+{
+public:
+    Instance(
+        wl_resource* new_resource,
+        OutputManager* output_manager,
+        std::shared_ptr<PresentationTracker> const& tracker)
+        : Presentation{new_resource, Version<1>()},
+          output_manager{output_manager},
+          tracker{tracker}
+    {
+        send_clock_id_event(PresentationTracker::clock);
+    }
+
+private:
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    void feedback(wl_resource* surface, wl_resource* callback) override
+    {
+        WlSurface::from(surface)->add_presentation_feedback(
+            std::make_shared<WpPresentationFeedback>(callback, tracker, output_manager));
+    }
+
+    OutputManager* const output_manager;
+    std::shared_ptr<PresentationTracker> const tracker;
+};
+}
+}
+
+mf::WpPresentationFeedback::WpPresentationFeedback(
+    wl_resource* new_resource,
+    std::shared_ptr<PresentationTracker> const& tracker,
+    OutputManager* output_manager)
+    : PresentationFeedback{new_resource, Version<1>()},
+      destroyed{deleted_flag_for_resource(resource)},
+      tracker{tracker},
+      output_manager{output_manager}
+{
+}
+
+void mf::WpPresentationFeedback::consumed(std::weak_ptr<scene::Surface> const& surface)
+{
+    if (state != State::pending)
+        return;
+
+    if (auto const live_tracker = tracker.lock())
+    {
+        state = State::consumed;
+        auto const self = shared_from_this();
+        live_tracker->on_next_presentation(
+            surface,
+            [self](geom::Rectangle const& view_area, mg::Frame const& frame)
+            {
+                auto const output = self->output_manager->output_for(view_area);
+                self->presented(output ? output.value() : nullptr, frame);
+            },
+            [self]() { self->discard(); });
+    }
+    else
+    {
+        discard();
+    }
+}
+
+void mf::WpPresentationFeedback::superseded()
+{
+    if (state == State::pending)
+        discard();
+}
+
+void mf::WpPresentationFeedback::presented(Output* output, mg::Frame const& frame)
+{
+    if (state == State::done)
+        return;
+
+    state = State::done;
+
+    if (*destroyed)
+        return;
+
+    if (output)
+    {
+        output->for_each_output_resource_bound_by(
+            client,
+            [this](wl_resource* output_resource) { send_sync_output_event(output_resource); });
+    }
+
+    auto const timestamp = frame.ust.nanoseconds;
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timestamp);
+    auto const nanoseconds = timestamp - seconds;
+    auto const tv_sec = static_cast<uint64_t>(seconds.count());
+    auto const msc = static_cast<uint64_t>(frame.msc);
+
+    // Not every platform's Frame comes from the hardware (some count posts and timestamp them as they
+    // complete), so only claim what holds for all of them: presentation was synchronised to the display.
+    send_presented_event(
+        tv_sec >> 32, tv_sec & 0xffffffff,
+        nanoseconds.count(),
+        refresh_interval(output).count(),
+        msc >> 32, msc & 0xffffffff,
+        Kind::vsync);
+
+    destroy_wayland_object();
+}
+
+void mf::WpPresentationFeedback::discard()
+{
+    if (state == State::done)
+        return;
+
+    state = State::done;
+
+    if (*destroyed)
+        return;
+
+    send_discarded_event();
+    destroy_wayland_object();
+}
+
+mf::WpPresentation::WpPresentation(
+    wl_display* display,
+    OutputManager* output_manager,
+    std::shared_ptr<PresentationTracker> const& tracker)
+    : Global{display, Version<1>()},
+      output_manager{output_manager},
+      tracker{tracker}
+{
+}
+
+void mf::WpPresentation::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource, output_manager, tracker};
+}
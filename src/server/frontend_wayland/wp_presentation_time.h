@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_WP_PRESENTATION_TIME_H
+#define MIR_FRONTEND_WP_PRESENTATION_TIME_H
+
+#include "presentation-time_wrapper.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+struct Frame;
+}
+namespace scene
+{
+class Surface;
+}
+namespace frontend
+{
+class Output;
+class OutputManager;
+class PresentationTracker;
+
+class WpPresentationFeedback
+    : public wayland::PresentationFeedback,
+      public std::enable_shared_from_this<WpPresentationFeedback>
+{
+public:
+    WpPresentationFeedback(
+        wl_resource* new_resource,
+        std::shared_ptr<PresentationTracker> const& tracker,
+        OutputManager* output_manager);
+
+    /// The compositor has consumed the content update; it is presented with the next post of an output showing surface
+    void consumed(std::weak_ptr<scene::Surface> const& surface);
+
+    /// A later content update replaced this one: discards the feedback unless it has already been consumed
+    void superseded();
+
+    /// Sends sync_output (if output is known) and presented, then destroys the feedback
+    /// \param frame   the output's frame, with ust in PresentationTracker::clock
+    void presented(Output* output, graphics::Frame const& frame);
+
+    /// Sends discarded, then destroys the feedback
+    void discard();
+
+private:
+    enum class State
+    {
+        pending,
+        consumed,
+        done
+    };
+
+    std::shared_ptr<bool> const destroyed;
+    std::weak_ptr<PresentationTracker> const tracker;
+    OutputManager* const output_manager;
+    State state{State::pending};
+};
+
+class WpPresentation : public wayland::Presentation::Global
+{
+public:
+    WpPresentation(
+        wl_display* display,
+        OutputManager* output_manager,
+        std::shared_ptr<PresentationTracker> const& tracker);
+
+private:
+    class Instance;
+
+    void bind(wl_resource* new_resource) override;
+
+    OutputManager* const output_manager;
+    std::shared_ptr<PresentationTracker> const tracker;
+};
+}
+}
+
+#endif // MIR_FRONTEND_WP_PRESENTATION_TIME_H
@@ -109,6 +109,7 @@ void mgn::detail::DisplayBuffer::swap_buffers()
         //up in the host server, resulting a drop in nbuffers available to the client
         host_chain = nullptr;
     }
+    last_frame_.increment_now();
 }
 
 void mgn::detail::DisplayBuffer::bind()
@@ -173,6 +174,7 @@ bool mgn::detail::DisplayBuffer::overlay(RenderableList const& list)
         content = BackingContent::chain;
         host_surface->apply_spec(*spec);
     }
+    last_frame_.increment_now();
     return true;
 }
 
@@ -189,6 +191,11 @@ glm::mat2 mgn::detail::DisplayBuffer::transformation() const
     return glm::mat2(1);
 }
 
+mg::Frame mgn::detail::DisplayBuffer::last_frame() const
+{
+    return last_frame_.load();
+}
+
 mgn::detail::DisplayBuffer::~DisplayBuffer() noexcept
 {
     for(auto& b : submitted_buffers)
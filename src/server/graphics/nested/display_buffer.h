@@ -20,6 +20,7 @@
 #define MIR_GRAPHICS_NESTED_DETAIL_NESTED_OUTPUT_H_
 
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/atomic_frame.h"
 #include "mir/renderer/gl/render_target.h"
 #include "display.h"
 #include "host_surface.h"
@@ -61,6 +62,7 @@ public:
     void swap_buffers() override;
     void bind() override;
     glm::mat2 transformation() const override;
+    Frame last_frame() const override;
 
     bool overlay(RenderableList const& renderlist) override;
 
@@ -94,6 +96,7 @@ private:
     typedef std::tuple<MirBuffer*, MirPresentationChain*> SubmissionInfo;
     std::map<SubmissionInfo, std::shared_ptr<graphics::Buffer>> submitted_buffers;
     SubmissionInfo last_submitted { nullptr, nullptr };
+    AtomicFrame last_frame_;
 
     void release_buffer(MirBuffer* b, MirPresentationChain* c);
 };
@@ -19,6 +19,7 @@
 #include "display_buffer.h"
 #include "mir/graphics/gl_extensions_base.h"
 #include "mir/raii.h"
+#include "mir_toolkit/common.h"
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
@@ -147,7 +148,25 @@ void mgo::DisplayBuffer::release_current()
 
 void mgo::DisplayBuffer::swap_buffers()
 {
-    glFinish();
+    // Software frames are complete as soon as they're written
+    if (software_frame.empty())
+        glFinish();
+    last_frame_.increment_now();
+}
+
+geom::Size mgo::DisplayBuffer::size() const
+{
+    return area.size;
+}
+
+void mgo::DisplayBuffer::write(std::function<void(unsigned char* pixels, geom::Stride stride)> const& do_with_pixels)
+{
+    auto const stride = area.size.width.as_int() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888);
+
+    if (software_frame.empty())
+        software_frame.resize(stride * area.size.height.as_int());
+
+    do_with_pixels(software_frame.data(), geom::Stride{stride});
 }
 
 bool mgo::DisplayBuffer::overlay(RenderableList const&)
@@ -160,6 +179,11 @@ glm::mat2 mgo::DisplayBuffer::transformation() const
     return glm::mat2(1);
 }
 
+mg::Frame mgo::DisplayBuffer::last_frame() const
+{
+    return last_frame_.load();
+}
+
 mg::NativeDisplayBuffer* mgo::DisplayBuffer::native_display_buffer()
 {
     return this;
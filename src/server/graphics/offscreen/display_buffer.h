@@ -22,12 +22,16 @@
 #include "mir/graphics/surfaceless_egl_context.h"
 
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/atomic_frame.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/rectangle.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 
 #include <EGL/egl.h>
 
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -57,9 +61,16 @@ private:
 
 }
 
+/**
+ * An output that isn't shown anywhere.
+ *
+ * It can be drawn with GL, into a framebuffer object, or by the software
+ * renderer, into a frame in memory.
+ */
 class DisplayBuffer : public graphics::DisplayBuffer,
                       public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+                      public renderer::gl::RenderTarget,
+                      public renderer::software::RenderTarget
 {
 public:
     DisplayBuffer(SurfacelessEGLContext egl_context,
@@ -68,15 +79,23 @@ public:
     geometry::Rectangle view_area() const override;
     bool overlay(RenderableList const& renderlist) override;
     glm::mat2 transformation() const override;
+    Frame last_frame() const override;
     NativeDisplayBuffer* native_display_buffer() override;
     void make_current() override;
     void bind() override;
     void release_current() override;
     void swap_buffers() override;
+
+    geometry::Size size() const override;
+    void write(std::function<void(unsigned char* pixels, geometry::Stride stride)> const& do_with_pixels) override;
+
 private:
     SurfacelessEGLContext const egl_context;
     detail::GLFramebufferObject const fbo;
     geometry::Rectangle const area;
+    AtomicFrame last_frame_;
+    /// Only allocated once something draws with the software renderer
+    std::vector<unsigned char> software_frame;
 };
 
 }
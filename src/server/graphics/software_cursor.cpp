@@ -107,6 +107,16 @@ public:
         return true;
     }
 
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
+    std::experimental::optional<geom::Rectangles> damage_since(mg::BufferID) const override
+    {
+        return {};
+    }
+
     void move_to(geom::Point new_position)
     {
         std::lock_guard<std::mutex> lock{position_mutex};
@@ -93,6 +93,16 @@ public:
         return true;
     }
 
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
+    std::experimental::optional<geom::Rectangles> damage_since(mg::BufferID) const override
+    {
+        return {};
+    }
+
 // TouchspotRenderable    
     void move_center_to(geom::Point pos)
     {
@@ -23,8 +23,10 @@
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
 #include "null_report_factory.h"
+#include "metrics/compositor_report.h"
 
 #include "mir/abnormal_exit.h"
+#include "mir/main_loop.h"
 
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
@@ -66,7 +68,14 @@ auto mir::DefaultServerConfiguration::the_compositor_report() -> std::shared_ptr
     return compositor_report(
         [this]()->std::shared_ptr<mc::CompositorReport>
         {
-            return report_factory(options::compositor_report_opt)->create_compositor_report();
+            auto const report = report_factory(options::compositor_report_opt)->create_compositor_report();
+
+            auto const options = the_options();
+            if (!options->is_set(options::compositor_metrics_opt))
+                return report;
+
+            return std::make_shared<report::metrics::CompositorReport>(
+                report, *the_main_loop(), options->get<std::string>(options::compositor_metrics_opt));
         });
 }
 
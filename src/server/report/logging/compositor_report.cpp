@@ -102,13 +102,15 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
         long avg_render_time_usec = dn ? dr / dn : 0;
         long avg_latency_usec = dn ? dl / dn : 0;
         long dt_msec = dt / 1000L;
+        long missed = nmissed - last_reported_missed;
 
-        char msg[128];
+        char msg[160];
         snprintf(msg, sizeof msg, "Display %p averaged %ld.%03ld FPS, "
                  "%ld.%03ld ms/frame, "
                  "latency %ld.%03ld ms, "
                  "%ld frames over %ld.%03ld sec, "
-                 "%ld%% bypassed",
+                 "%ld%% bypassed, "
+                 "%ld missed",
                  id,
                  frames_per_1000sec / 1000,
                  frames_per_1000sec % 1000,
@@ -119,7 +121,8 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  dn,
                  dt_msec / 1000,
                  dt_msec % 1000,
-                 bypass_percent
+                 bypass_percent,
+                 missed
                  );
 
         logger.log(ml::Severity::informational, msg, component);
@@ -130,6 +133,7 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
     last_reported_latency_sum = latency_sum;
     last_reported_nframes = nframes;
     last_reported_bypassed = nbypassed;
+    last_reported_missed = nmissed;
 }
 
 void mrl::CompositorReport::finished_frame(SubCompositorId id)
@@ -166,6 +170,20 @@ void mrl::CompositorReport::finished_frame(SubCompositorId id)
     inst.prev_bypassed = inst.bypassed;
 }
 
+void mrl::CompositorReport::missed_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++instance[id].nmissed;
+}
+
+void mrl::CompositorReport::presented_frame(SubCompositorId, mir::graphics::Frame const&)
+{
+}
+
+void mrl::CompositorReport::submitted_buffer(StreamId, mir::graphics::BufferID)
+{
+}
+
 void mrl::CompositorReport::started()
 {
     logger->log(ml::Severity::informational, "Started", component);
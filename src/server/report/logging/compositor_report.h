@@ -47,6 +47,9 @@ public:
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
     void finished_frame(SubCompositorId id) override;
+    void missed_frame(SubCompositorId id) override;
+    void presented_frame(SubCompositorId id, graphics::Frame const& frame) override;
+    void submitted_buffer(StreamId stream, graphics::BufferID buffer) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
@@ -67,6 +70,7 @@ private:
         TimePoint latency_sum;
         long nframes = 0;
         long nbypassed = 0;
+        long nmissed = 0;
         bool bypassed = true;
         bool prev_bypassed = false;
 
@@ -75,6 +79,7 @@ private:
         TimePoint last_reported_latency_sum;
         long last_reported_nframes = 0;
         long last_reported_bypassed = 0;
+        long last_reported_missed = 0;
 
         void log(mir::logging::Logger& logger, SubCompositorId id);
     };
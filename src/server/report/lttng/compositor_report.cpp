@@ -62,3 +62,18 @@ void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
 }
+
+void mir::report::lttng::CompositorReport::missed_frame(SubCompositorId id)
+{
+    mir_tracepoint(mir_server_compositor, missed_frame, id);
+}
+
+void mir::report::lttng::CompositorReport::presented_frame(SubCompositorId id, graphics::Frame const& frame)
+{
+    mir_tracepoint(mir_server_compositor, presented_frame, id, frame.msc, frame.ust.nanoseconds.count());
+}
+
+void mir::report::lttng::CompositorReport::submitted_buffer(StreamId stream, graphics::BufferID buffer)
+{
+    mir_tracepoint(mir_server_compositor, submitted_buffer, stream, buffer.as_value());
+}
@@ -80,6 +80,34 @@ TRACEPOINT_EVENT_INSTANCE(
     TP_ARGS(void const*, id)
 )
 
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    subcompositor_event,
+    missed_frame,
+    TP_ARGS(void const*, id)
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    presented_frame,
+    TP_ARGS(void const*, id, int64_t, msc, int64_t, ust_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int64_t, msc, msc)
+        ctf_integer(int64_t, ust_ns, ust_ns)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    submitted_buffer,
+    TP_ARGS(void const*, stream, uint32_t, buffer_id),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, stream, (uintptr_t)(stream))
+        ctf_integer(uint32_t, buffer_id, buffer_id)
+    )
+)
+
 TRACEPOINT_EVENT(
     mir_server_compositor,
     buffers_in_frame,
@@ -0,0 +1,414 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_report.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/renderable.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <tuple>
+
+namespace mrm = mir::report::metrics;
+namespace mg = mir::graphics;
+
+using namespace std::chrono;
+
+namespace
+{
+/// Streams that neither commit nor are shown for this long are dropped from the metrics
+auto const stream_expiry = duration_cast<microseconds>(seconds{10}).count();
+auto const export_interval = seconds{1};
+
+std::atomic<uint64_t> next_instance{1};
+
+auto pack(uint32_t buffer, int64_t usec) -> uint64_t
+{
+    return uint64_t{buffer} << 32 | static_cast<uint32_t>(usec);
+}
+
+/// Time from the (low 32 bits of) usec since to now: valid for intervals up to ~71 minutes
+auto since(uint32_t usec, int64_t now) -> microseconds
+{
+    return microseconds{static_cast<uint32_t>(static_cast<uint32_t>(now) - usec)};
+}
+
+void write_histogram(std::ostream& out, mrm::Histogram const& histogram)
+{
+    auto const snapshot = histogram.snapshot();
+
+    out << "{\"count\":" << snapshot.count << ",\"total\":" << snapshot.total_usec << ",\"buckets\":[";
+    for (size_t i = 0; i != snapshot.buckets.size(); ++i)
+        out << (i ? "," : "") << snapshot.buckets[i];
+    out << "]}";
+}
+}
+
+mrm::CompositorReport::CompositorReport(
+    std::shared_ptr<mir::compositor::CompositorReport> const& next,
+    Clock const& clock) :
+    next{next},
+    clock{clock},
+    instance{next_instance.fetch_add(1, std::memory_order_relaxed)}
+{
+}
+
+mrm::CompositorReport::CompositorReport(
+    std::shared_ptr<mir::compositor::CompositorReport> const& next,
+    time::AlarmFactory& alarm_factory,
+    std::string const& path) :
+    CompositorReport{next}
+{
+    export_alarm = alarm_factory.create_alarm(
+        [this, path]
+        {
+            auto const tmp_path = path + ".tmp";
+            std::ofstream out{tmp_path, std::ios::trunc};
+            write_json(out);
+            out.close();
+
+            // Leave the last complete export in place rather than replace it with a partial one
+            if (out)
+                std::rename(tmp_path.c_str(), path.c_str());
+
+            export_alarm->reschedule_in(export_interval);
+        });
+
+    export_alarm->reschedule_in(export_interval);
+}
+
+mrm::CompositorReport::~CompositorReport()
+{
+    export_alarm.reset();
+}
+
+auto mrm::CompositorReport::now_usec() const -> int64_t
+{
+    return usec_of(clock());
+}
+
+auto mrm::CompositorReport::usec_of(time::PosixTimestamp const& t) const -> int64_t
+{
+    auto const reference = clock();
+    auto const in_clock_domain = t.clock_id == reference.clock_id ?
+        t : reference + (t - time::PosixTimestamp::now(t.clock_id));
+
+    return duration_cast<microseconds>(in_clock_domain.nanoseconds).count();
+}
+
+auto mrm::CompositorReport::find_or_add_output(SubCompositorId id) -> std::shared_ptr<Output>
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    auto& output = outputs[id];
+    if (!output)
+        output = std::make_shared<Output>();
+    return output;
+}
+
+auto mrm::CompositorReport::output_for(SubCompositorId id) -> Output&
+{
+    // Each compositor thread reports on the same output every frame
+    struct Cached
+    {
+        uint64_t report;
+        SubCompositorId id;
+        std::shared_ptr<Output> output;
+    };
+    thread_local Cached cached{0, nullptr, nullptr};
+
+    if (cached.report != instance || cached.id != id)
+        cached = {instance, id, find_or_add_output(id)};
+
+    return *cached.output;
+}
+
+auto mrm::CompositorReport::Stream::commit_time_of(uint32_t buffer, uint32_t& usec) const -> bool
+{
+    auto const newest = next_commit.load(std::memory_order_acquire);
+
+    for (unsigned i = 0; i != recent_commits.size(); ++i)
+    {
+        auto const commit = recent_commits[(newest - 1 - i) % recent_commits.size()].load(std::memory_order_relaxed);
+        if (commit >> 32 == buffer)
+        {
+            usec = static_cast<uint32_t>(commit);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void mrm::CompositorReport::added_display(int width, int height, int x, int y, SubCompositorId id)
+{
+    {
+        auto const output = find_or_add_output(id);
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        output->area = {{x, y}, {width, height}};
+    }
+
+    next->added_display(width, height, x, y, id);
+}
+
+void mrm::CompositorReport::began_frame(SubCompositorId id)
+{
+    auto& output = output_for(id);
+    output.frame_start = clock();
+    output.rendered = false;
+    output.newly_shown.clear();
+
+    next->began_frame(id);
+}
+
+void mrm::CompositorReport::renderables_in_frame(SubCompositorId id, mg::RenderableList const& renderables)
+{
+    auto& output = output_for(id);
+    auto const now = now_usec();
+
+    // Start over when the streams change, or when renderables that have gone outnumber those shown
+    auto const generation = streams_generation.load(std::memory_order_acquire);
+    if (output.known_generation != generation || output.known_streams.size() > 2 * renderables.size() + 8)
+    {
+        output.known_streams.clear();
+        output.known_generation = generation;
+    }
+
+    std::vector<std::pair<std::shared_ptr<Stream>, uint32_t>> shown;
+    std::vector<mg::Renderable const*> unknown;
+    for (auto const& renderable : renderables)
+    {
+        auto const known = output.known_streams.find(renderable->id());
+        if (known == output.known_streams.end())
+            unknown.push_back(renderable.get());
+        else if (known->second && renderable->buffer())
+            shown.emplace_back(known->second, renderable->buffer()->id().as_value());
+    }
+
+    if (!unknown.empty())
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        for (auto const renderable : unknown)
+        {
+            auto const stream = streams.find(renderable->id());
+            auto const found = stream != streams.end() ? stream->second : nullptr;
+
+            output.known_streams[renderable->id()] = found;
+            if (found && renderable->buffer())
+                shown.emplace_back(found, renderable->buffer()->id().as_value());
+        }
+    }
+
+    for (auto const& entry : shown)
+    {
+        auto& stream = *entry.first;
+        auto const buffer = entry.second;
+
+        // On any other output, or a repeat on this one, the buffer has already been counted
+        if (stream.last_shown.exchange(buffer, std::memory_order_relaxed) == buffer)
+            continue;
+
+        stream.shown.fetch_add(1, std::memory_order_relaxed);
+        stream.last_active_usec.store(now, std::memory_order_relaxed);
+
+        uint32_t committed_usec;
+        if (stream.commit_time_of(buffer, committed_usec))
+        {
+            stream.commit_to_composite.add(since(committed_usec, now));
+            output.newly_shown.emplace_back(entry.first, committed_usec);
+        }
+    }
+
+    next->renderables_in_frame(id, renderables);
+}
+
+void mrm::CompositorReport::rendered_frame(SubCompositorId id)
+{
+    auto& output = output_for(id);
+    output.rendered = true;
+    output.render_time.add(duration_cast<microseconds>(clock() - output.frame_start));
+
+    next->rendered_frame(id);
+}
+
+void mrm::CompositorReport::finished_frame(SubCompositorId id)
+{
+    auto& output = output_for(id);
+    output.frames.fetch_add(1, std::memory_order_relaxed);
+    if (!output.rendered)
+        output.bypassed.fetch_add(1, std::memory_order_relaxed);
+
+    next->finished_frame(id);
+}
+
+void mrm::CompositorReport::missed_frame(SubCompositorId id)
+{
+    output_for(id).missed.fetch_add(1, std::memory_order_relaxed);
+    next->missed_frame(id);
+}
+
+void mrm::CompositorReport::presented_frame(SubCompositorId id, mg::Frame const& frame)
+{
+    auto& output = output_for(id);
+
+    // Platforms that can't time their frames report zero; a repeated MSC is a frame already counted
+    if (frame.ust.nanoseconds.count() != 0 && (frame.msc == 0 || frame.msc != output.last_presented_msc))
+    {
+        auto const presented = usec_of(frame.ust);
+
+        output.composite_to_present.add(microseconds{presented - usec_of(output.frame_start)});
+        for (auto const& entry : output.newly_shown)
+            entry.first->commit_to_present.add(since(entry.second, presented));
+    }
+
+    output.last_presented_msc = frame.msc;
+    output.newly_shown.clear();
+
+    next->presented_frame(id, frame);
+}
+
+void mrm::CompositorReport::submitted_buffer(StreamId stream_id, mg::BufferID buffer)
+{
+    auto const now = now_usec();
+
+    std::shared_ptr<Stream> stream;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        auto& entry = streams[stream_id];
+        if (!entry)
+        {
+            entry = std::make_shared<Stream>();
+            streams_generation.fetch_add(1, std::memory_order_release);
+        }
+        stream = entry;
+    }
+
+    auto const slot = stream->next_commit.load(std::memory_order_relaxed);
+    stream->recent_commits[slot % stream->recent_commits.size()].store(
+        pack(buffer.as_value(), now), std::memory_order_relaxed);
+    stream->next_commit.store(slot + 1, std::memory_order_release);
+
+    stream->committed.fetch_add(1, std::memory_order_relaxed);
+    stream->last_active_usec.store(now, std::memory_order_relaxed);
+
+    next->submitted_buffer(stream_id, buffer);
+}
+
+void mrm::CompositorReport::started()
+{
+    next->started();
+}
+
+void mrm::CompositorReport::stopped()
+{
+    next->stopped();
+}
+
+void mrm::CompositorReport::scheduled()
+{
+    next->scheduled();
+}
+
+void mrm::CompositorReport::write_json(std::ostream& out)
+{
+    auto const now = now_usec();
+
+    // Take what we need under the lock, but don't hold it (and the compositor threads) while writing
+    std::vector<std::tuple<SubCompositorId, geometry::Rectangle, std::shared_ptr<Output>>> current_outputs;
+    std::vector<std::pair<StreamId, std::shared_ptr<Stream>>> current_streams;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        for (auto const& entry : outputs)
+            current_outputs.emplace_back(entry.first, entry.second->area, entry.second);
+
+        auto const before = streams.size();
+        for (auto i = streams.begin(); i != streams.end();)
+        {
+            if (now - i->second->last_active_usec.load(std::memory_order_relaxed) > stream_expiry)
+            {
+                i = streams.erase(i);
+            }
+            else
+            {
+                current_streams.emplace_back(*i);
+                ++i;
+            }
+        }
+
+        if (streams.size() != before)
+            streams_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    out << "{\"version\":1,\"timestamp_usec\":" << now << ",\"histogram_buckets_usec\":[";
+    for (size_t i = 0; i != Histogram::bucket_count; ++i)
+        out << (i ? "," : "") << Histogram::bucket_limit_usec(i);
+    out << "],\n\"outputs\":[";
+
+    bool first = true;
+    for (auto const& entry : current_outputs)
+    {
+        auto const& area = std::get<1>(entry);
+        auto const& output = *std::get<2>(entry);
+
+        out << (first ? "\n" : ",\n")
+            << "{\"id\":\"" << std::get<0>(entry) << "\""
+            << ",\"geometry\":{\"x\":" << area.top_left.x.as_int()
+            << ",\"y\":" << area.top_left.y.as_int()
+            << ",\"width\":" << area.size.width.as_int()
+            << ",\"height\":" << area.size.height.as_int() << "}"
+            << ",\"frames\":" << output.frames.load(std::memory_order_relaxed)
+            << ",\"bypassed\":" << output.bypassed.load(std::memory_order_relaxed)
+            << ",\"missed\":" << output.missed.load(std::memory_order_relaxed)
+            << ",\"render_usec\":";
+        write_histogram(out, output.render_time);
+        out << ",\"composite_to_present_usec\":";
+        write_histogram(out, output.composite_to_present);
+        out << "}";
+
+        first = false;
+    }
+
+    out << "],\n\"surfaces\":[";
+
+    first = true;
+    for (auto const& entry : current_streams)
+    {
+        auto const& stream = *entry.second;
+
+        auto const committed = stream.committed.load(std::memory_order_relaxed);
+        auto const shown = stream.shown.load(std::memory_order_relaxed);
+
+        out << (first ? "\n" : ",\n")
+            << "{\"id\":\"" << entry.first << "\""
+            << ",\"committed\":" << committed
+            << ",\"shown\":" << shown
+            << ",\"dropped\":" << (committed > shown ? committed - shown : 0)
+            << ",\"commit_to_composite_usec\":";
+        write_histogram(out, stream.commit_to_composite);
+        out << ",\"commit_to_present_usec\":";
+        write_histogram(out, stream.commit_to_present);
+        out << "}";
+
+        first = false;
+    }
+
+    out << "]}\n";
+}
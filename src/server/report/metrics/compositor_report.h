@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+#define MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+
+#include "histogram.h"
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/geometry/rectangle.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+}
+namespace report
+{
+namespace metrics
+{
+
+/**
+ * Collects frame timing metrics while passing every call on to another CompositorReport.
+ *
+ * For each output: frames composited, bypassed and missed, render time, and time from the
+ * start of compositing to the frame being presented. For each surface (buffer stream):
+ * buffers committed, shown and dropped, and the time from commit to the buffer first being
+ * composited and to it being presented.
+ *
+ * Counters are atomics updated without locking, so the compositor threads never wait on
+ * write_json(). A mutex is only taken to add or look up outputs and streams; each compositor
+ * thread remembers its output and the streams it has seen, so a steady frame takes no lock.
+ */
+class CompositorReport : public mir::compositor::CompositorReport
+{
+public:
+    using Clock = std::function<time::PosixTimestamp()>;
+
+    CompositorReport(
+        std::shared_ptr<mir::compositor::CompositorReport> const& next,
+        Clock const& clock = []{ return time::PosixTimestamp::now(CLOCK_MONOTONIC); });
+
+    /// Also rewrites path with the current metrics every second (via a temporary file and rename)
+    CompositorReport(
+        std::shared_ptr<mir::compositor::CompositorReport> const& next,
+        time::AlarmFactory& alarm_factory,
+        std::string const& path);
+
+    ~CompositorReport();
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override;
+    void began_frame(SubCompositorId id) override;
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void rendered_frame(SubCompositorId id) override;
+    void finished_frame(SubCompositorId id) override;
+    void missed_frame(SubCompositorId id) override;
+    void presented_frame(SubCompositorId id, graphics::Frame const& frame) override;
+    void submitted_buffer(StreamId stream, graphics::BufferID buffer) override;
+    void started() override;
+    void stopped() override;
+    void scheduled() override;
+
+    /// Writes the metrics collected so far as a JSON object
+    void write_json(std::ostream& out);
+
+private:
+    /// A stream's recent commits, packed as (buffer id << 32 | low 32 bits of commit time in usec)
+    using Commit = uint64_t;
+
+    struct Stream
+    {
+        std::array<std::atomic<Commit>, 8> recent_commits{};
+        std::atomic<unsigned> next_commit{0};
+        std::atomic<uint32_t> last_shown{0};
+        std::atomic<uint64_t> committed{0};
+        std::atomic<uint64_t> shown{0};
+        std::atomic<int64_t> last_active_usec{0};
+        Histogram commit_to_composite;
+        Histogram commit_to_present;
+
+        /// The commit time (low 32 bits of usec) of buffer, if it's still in recent_commits
+        auto commit_time_of(uint32_t buffer, uint32_t& usec) const -> bool;
+    };
+
+    struct Output
+    {
+        geometry::Rectangle area;
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bypassed{0};
+        std::atomic<uint64_t> missed{0};
+        Histogram render_time;
+        Histogram composite_to_present;
+
+        // Only touched on the output's compositor thread
+        time::PosixTimestamp frame_start;
+        bool rendered{false};
+        int64_t last_presented_msc{0};
+        std::vector<std::pair<std::shared_ptr<Stream>, uint32_t>> newly_shown;
+        /// The streams (or nullptr for renderables without one) as of streams_generation known_generation
+        std::unordered_map<StreamId, std::shared_ptr<Stream>> known_streams;
+        uint64_t known_generation{0};
+    };
+
+    std::shared_ptr<mir::compositor::CompositorReport> const next;
+    Clock const clock;
+    /// Distinguishes this report in its compositor threads' caches
+    uint64_t const instance;
+
+    std::mutex mutex;
+    std::unordered_map<SubCompositorId, std::shared_ptr<Output>> outputs;
+    std::unordered_map<StreamId, std::shared_ptr<Stream>> streams;
+    /// Changes (under mutex) whenever streams gains or loses an entry
+    std::atomic<uint64_t> streams_generation{1};
+
+    std::unique_ptr<time::Alarm> export_alarm;
+
+    auto now_usec() const -> int64_t;
+    /// t converted to clock's time domain, in usec
+    auto usec_of(time::PosixTimestamp const& t) const -> int64_t;
+    /// The output id reports on, cached for the calling (compositor) thread
+    auto output_for(SubCompositorId id) -> Output&;
+    auto find_or_add_output(SubCompositorId id) -> std::shared_ptr<Output>;
+};
+
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_ */
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_HISTOGRAM_H_
+#define MIR_REPORT_METRICS_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+
+/**
+ * A latency histogram that can be added to from any thread without locking.
+ *
+ * Bucket i counts samples below 2^i microseconds (and at least 2^(i-1)); the last bucket
+ * also takes everything longer. Counts only ever grow: consumers take the difference
+ * between two snapshots to get the distribution over an interval.
+ */
+class Histogram
+{
+public:
+    static size_t const bucket_count = 24;
+
+    struct Snapshot
+    {
+        std::array<uint64_t, bucket_count> buckets{};
+        uint64_t count{0};
+        uint64_t total_usec{0};
+    };
+
+    /// The exclusive upper bound of bucket i, in microseconds
+    static constexpr auto bucket_limit_usec(size_t i) -> uint64_t
+    {
+        return uint64_t{1} << i;
+    }
+
+    void add(std::chrono::microseconds sample)
+    {
+        uint64_t const usec = sample.count() > 0 ? sample.count() : 0;
+
+        size_t bucket = 0;
+        while (bucket < bucket_count - 1 && usec >= bucket_limit_usec(bucket))
+            ++bucket;
+
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        total_usec.fetch_add(usec, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Counts are read individually, so a snapshot taken during add() may be off by that sample
+    auto snapshot() const -> Snapshot
+    {
+        Snapshot result;
+        for (size_t i = 0; i != bucket_count; ++i)
+            result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        result.count = count.load(std::memory_order_relaxed);
+        result.total_usec = total_usec.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_usec{0};
+};
+
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_HISTOGRAM_H_ */
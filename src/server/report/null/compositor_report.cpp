@@ -40,6 +40,18 @@ void mrn::CompositorReport::finished_frame(SubCompositorId)
 {
 }
 
+void mrn::CompositorReport::missed_frame(SubCompositorId)
+{
+}
+
+void mrn::CompositorReport::presented_frame(SubCompositorId, mir::graphics::Frame const&)
+{
+}
+
+void mrn::CompositorReport::submitted_buffer(StreamId, mir::graphics::BufferID)
+{
+}
+
 void mrn::CompositorReport::started()
 {
 }
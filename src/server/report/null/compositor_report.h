@@ -36,6 +36,9 @@ public:
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
     void finished_frame(SubCompositorId id) override;
+    void missed_frame(SubCompositorId id) override;
+    void presented_frame(SubCompositorId id, graphics::Frame const& frame) override;
+    void submitted_buffer(StreamId stream, graphics::BufferID buffer) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
@@ -26,6 +26,7 @@
 #include "mir/graphics/cursor_image.h"
 #include "mir/graphics/pixel_format_utils.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/renderer/sw/pixel_source.h"
 
 #include "mir/scene/scene_report.h"
@@ -171,6 +172,12 @@ void ms::SurfaceObservers::application_id_set_to(Surface const* surf, std::strin
                  { observer->application_id_set_to(surf, application_id); });
 }
 
+void ms::SurfaceObservers::input_region_set_to(Surface const* surf, std::vector<geometry::Rectangle> const& region)
+{
+    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                 { observer->input_region_set_to(surf, region); });
+}
+
 ms::BasicSurface::ProofOfMutexLock::ProofOfMutexLock(std::unique_lock<std::mutex> const& lock)
 {
     if (!lock.owns_lock())
@@ -366,8 +373,11 @@ std::shared_ptr<mf::BufferStream> ms::BasicSurface::primary_buffer_stream() cons
 
 void ms::BasicSurface::set_input_region(std::vector<geom::Rectangle> const& input_rectangles)
 {
-    std::lock_guard<std::mutex> lock(guard);
-    custom_input_rectangles = input_rectangles;
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        custom_input_rectangles = input_rectangles;
+    }
+    observers->input_region_set_to(this, input_rectangles);
 }
 
 void ms::BasicSurface::resize(geom::Size const& desired_size)
@@ -420,18 +430,40 @@ bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
         auto const input_rect = geom::Rectangle{content_top_left(lock), content_size(lock)};
         return input_rect.contains(point);
     }
-    else
+
+    // A custom input region isn't clipped to the surface: Wayland subsurfaces
+    // outside their parent take input through their parent's region
+    auto local_point = as_point(point - content_top_left(lock));
+    for (auto const& rectangle : custom_input_rectangles)
     {
-        auto local_point = as_point(point - content_top_left(lock));
-        for (auto const& rectangle : custom_input_rectangles)
-        {
-            if (rectangle.contains(local_point))
-                return true;
-        }
+        if (rectangle.contains(local_point))
+            return true;
     }
     return false;
 }
 
+geom::Rectangle ms::BasicSurface::input_area_bounds() const
+{
+    std::lock_guard<std::mutex> lock(guard);
+
+    if (custom_input_rectangles.empty())
+        return geom::Rectangle{content_top_left(lock), content_size(lock)};
+
+    // Empty rectangles (e.g. the one that disables input) don't add to the area
+    geom::Rectangles region;
+    for (auto const& rectangle : custom_input_rectangles)
+    {
+        if (rectangle.size.width > geom::Width{0} && rectangle.size.height > geom::Height{0})
+            region.add(rectangle);
+    }
+
+    if (region.size() == 0)
+        return {};
+
+    auto const bounds = region.bounding_rectangle();
+    return {content_top_left(lock) + as_displacement(bounds.top_left), bounds.size};
+}
+
 void ms::BasicSurface::set_alpha(float alpha)
 {
     {
@@ -821,6 +853,7 @@ public:
         std::experimental::optional<geom::Rectangle> const& clip_area,
         glm::mat4 const& transform,
         float alpha,
+        geom::Rectangles const& opaque_region,
         mg::Renderable::ID id)
     : underlying_buffer_stream{stream},
       compositor_id{compositor_id},
@@ -828,6 +861,7 @@ public:
       screen_position_(position),
       clip_area_(clip_area),
       transformation_(transform),
+      opaque_region_(opaque_region),
       id_(id)
     {
     }
@@ -863,8 +897,14 @@ public:
     bool shaped() const override
     { return mg::contains_alpha(underlying_buffer_stream->pixel_format()); }
 
+    geom::Rectangles opaque_region() const override
+    { return opaque_region_; }
+
     mg::Renderable::ID id() const override
     { return id_; }
+
+    std::experimental::optional<geom::Rectangles> damage_since(mg::BufferID previous) const override
+    { return underlying_buffer_stream->damage_between(previous, buffer()->id()); }
 private:
     std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
@@ -873,8 +913,23 @@ private:
     geom::Rectangle const screen_position_;
     std::experimental::optional<geom::Rectangle> const clip_area_;
     glm::mat4 const transformation_;
+    geom::Rectangles const opaque_region_;
     mg::Renderable::ID const id_;
 };
+
+auto opaque_region_on_screen(std::vector<geom::Rectangle> const& opaque_region, geom::Rectangle const& position)
+    -> geom::Rectangles
+{
+    geom::Rectangles result;
+    for (auto const& rect : opaque_region)
+    {
+        auto const on_screen = geom::Rectangle{position.top_left + as_displacement(rect.top_left), rect.size}
+            .intersection_with(position);
+        if (on_screen.size.width > geom::Width{0} && on_screen.size.height > geom::Height{0})
+            result.add(on_screen);
+    }
+    return result;
+}
 }
 
 int ms::BasicSurface::buffers_ready_for_compositor(void const* id) const
@@ -954,11 +1009,15 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
+            geom::Rectangle const position{content_top_left_ + info.displacement, std::move(size)};
+
             list.emplace_back(std::make_shared<SurfaceSnapshot>(
                 info.stream, id,
-                geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
+                position,
                 clip_area_,
-                transformation_matrix, surface_alpha, info.stream.get()));
+                transformation_matrix, surface_alpha,
+                opaque_region_on_screen(info.opaque_region, position),
+                info.stream.get()));
         }
     }
     return list;
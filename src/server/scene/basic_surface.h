@@ -101,6 +101,7 @@ public:
     geometry::Point top_left() const override;
     geometry::Rectangle input_bounds() const override;
     bool input_area_contains(geometry::Point const& point) const override;
+    geometry::Rectangle input_area_bounds() const override;
     void consume(MirEvent const* event) override;
     void set_alpha(float alpha) override;
     void set_orientation(MirOrientation orientation) override;
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/scene/buffer_memory_accounting.h"
+
+namespace ms = mir::scene;
+
+ms::BufferMemoryAccounting::BufferMemoryAccounting(size_t limit, BufferMemoryPolicy policy)
+    : limit_{limit},
+      policy_{policy}
+{
+}
+
+auto ms::BufferMemoryAccounting::limit() const -> size_t
+{
+    return limit_;
+}
+
+auto ms::BufferMemoryAccounting::policy() const -> BufferMemoryPolicy
+{
+    return policy_;
+}
+
+auto ms::BufferMemoryAccounting::usage_of(Session const* session) const -> BufferMemoryUsage
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    auto const found = usage.find(session);
+    return found != usage.end() ? found->second : BufferMemoryUsage{};
+}
+
+void ms::BufferMemoryAccounting::for_each(
+    std::function<void(Session const*, BufferMemoryUsage const&)> const& f) const
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    for (auto const& entry : usage)
+        f(entry.first, entry.second);
+}
+
+void ms::BufferMemoryAccounting::update(Session const* session, BufferMemoryUsage const& session_usage)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    usage[session] = session_usage;
+}
+
+void ms::BufferMemoryAccounting::remove(Session const* session)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    usage.erase(session);
+}
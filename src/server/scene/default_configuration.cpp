@@ -26,6 +26,7 @@
 #include "mir/abnormal_exit.h"
 #include "mir/scene/session.h"
 #include "mir/scene/session_container.h"
+#include "mir/scene/buffer_memory_accounting.h"
 #include "mir/shell/display_configuration_controller.h"
 
 #include "broadcasting_session_event_sink.h"
@@ -242,6 +243,42 @@ mir::DefaultServerConfiguration::the_coordinate_translator()
         });
 }
 
+auto mir::DefaultServerConfiguration::the_buffer_memory_accounting()
+-> std::shared_ptr<ms::BufferMemoryAccounting>
+{
+    return buffer_memory_accounting(
+        [this]()
+        {
+            auto const options = the_options();
+            auto const limit_mb = options->get<int>(options::client_buffer_memory_limit_opt);
+            auto const policy_name = options->get<std::string>(options::client_buffer_memory_policy_opt);
+
+            if (limit_mb < 0)
+            {
+                BOOST_THROW_EXCEPTION(mir::AbnormalExit(
+                    std::string{"Invalid "} + options::client_buffer_memory_limit_opt + ": " +
+                    std::to_string(limit_mb)));
+            }
+
+            ms::BufferMemoryPolicy policy;
+            if (policy_name == "evict")
+            {
+                policy = ms::BufferMemoryPolicy::evict_least_recently_used;
+            }
+            else if (policy_name == "reject")
+            {
+                policy = ms::BufferMemoryPolicy::reject;
+            }
+            else
+            {
+                BOOST_THROW_EXCEPTION(mir::AbnormalExit(
+                    std::string{"Invalid "} + options::client_buffer_memory_policy_opt + ": " + policy_name));
+            }
+
+            return std::make_shared<ms::BufferMemoryAccounting>(size_t(limit_mb) * 1024 * 1024, policy);
+        });
+}
+
 auto mir::DefaultServerConfiguration::the_application_not_responding_detector()
 -> std::shared_ptr<scene::ApplicationNotRespondingDetector>
 {
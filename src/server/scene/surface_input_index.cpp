@@ -0,0 +1,202 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "surface_input_index.h"
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+namespace
+{
+int const cell_size = 256;
+
+// A surface covering more cells than this (e.g. a fullscreen surface on a very
+// large virtual desktop) is checked on every query instead of being bucketed
+int const max_cells_per_surface = 256;
+
+int cell_of(int coordinate)
+{
+    // Round towards negative infinity so cells are the same size either side of 0
+    return coordinate >= 0 ? coordinate / cell_size : -((-coordinate - 1) / cell_size) - 1;
+}
+
+uint64_t key_of(int cell_x, int cell_y)
+{
+    return (uint64_t{static_cast<uint32_t>(cell_x)} << 32) | static_cast<uint32_t>(cell_y);
+}
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width <= geom::Width{0} || rect.size.height <= geom::Height{0};
+}
+
+template<typename Functor>
+void for_each_cell(geom::Rectangle const& rect, Functor const& f)
+{
+    auto const first_x = cell_of(rect.left().as_int());
+    auto const last_x = cell_of(rect.right().as_int() - 1);
+    auto const first_y = cell_of(rect.top().as_int());
+    auto const last_y = cell_of(rect.bottom().as_int() - 1);
+
+    for (auto x = first_x; x <= last_x; ++x)
+        for (auto y = first_y; y <= last_y; ++y)
+            f(key_of(x, y));
+}
+
+bool spans_too_many_cells(geom::Rectangle const& rect)
+{
+    auto const columns = int64_t{cell_of(rect.right().as_int() - 1)} - cell_of(rect.left().as_int()) + 1;
+    auto const rows = int64_t{cell_of(rect.bottom().as_int() - 1)} - cell_of(rect.top().as_int()) + 1;
+    return columns * rows > max_cells_per_surface;
+}
+
+void erase_from(std::vector<ms::Surface const*>& surfaces, ms::Surface const* surface)
+{
+    surfaces.erase(std::remove(surfaces.begin(), surfaces.end(), surface), surfaces.end());
+}
+}
+
+void ms::SurfaceInputIndex::add(std::shared_ptr<Surface> const& surface)
+{
+    std::lock_guard<std::mutex> lock{guard};
+
+    if (entries.count(surface.get()))
+        return;
+
+    auto& entry = entries[surface.get()];
+    entry.surface = surface;
+    entry.rank = 0;
+    insert_locked(entry);
+}
+
+void ms::SurfaceInputIndex::remove(Surface const* surface)
+{
+    std::lock_guard<std::mutex> lock{guard};
+
+    auto const entry = entries.find(surface);
+    if (entry == entries.end())
+        return;
+
+    erase_locked(surface, entry->second);
+    entries.erase(entry);
+}
+
+void ms::SurfaceInputIndex::update(Surface const* surface)
+{
+    std::lock_guard<std::mutex> lock{guard};
+
+    auto const entry = entries.find(surface);
+    if (entry == entries.end())
+        return;
+
+    erase_locked(surface, entry->second);
+    insert_locked(entry->second);
+}
+
+void ms::SurfaceInputIndex::restack(std::vector<std::vector<std::shared_ptr<Surface>>> const& layers)
+{
+    std::lock_guard<std::mutex> lock{guard};
+
+    unsigned int rank = 0;
+    for (auto const& layer : layers)
+    {
+        for (auto const& surface : layer)
+        {
+            auto const entry = entries.find(surface.get());
+            if (entry != entries.end())
+                entry->second.rank = rank++;
+        }
+    }
+}
+
+auto ms::SurfaceInputIndex::candidates_at(geom::Point point) const -> std::vector<std::shared_ptr<Surface>>
+{
+    std::vector<Entry const*> hits;
+
+    std::lock_guard<std::mutex> lock{guard};
+
+    auto const add_hits = [&](std::vector<Surface const*> const& surfaces)
+        {
+            for (auto const surface : surfaces)
+            {
+                auto const& entry = entries.at(surface);
+                if (entry.bounds.contains(point))
+                    hits.push_back(&entry);
+            }
+        };
+
+    auto const cell = cells.find(key_of(cell_of(point.x.as_int()), cell_of(point.y.as_int())));
+    if (cell != cells.end())
+        add_hits(cell->second);
+    add_hits(oversized);
+
+    std::sort(
+        hits.begin(), hits.end(),
+        [](Entry const* lhs, Entry const* rhs) { return lhs->rank > rhs->rank; });
+
+    std::vector<std::shared_ptr<Surface>> result;
+    result.reserve(hits.size());
+    for (auto const hit : hits)
+        result.push_back(hit->surface);
+
+    return result;
+}
+
+void ms::SurfaceInputIndex::insert_locked(Entry& entry)
+{
+    auto const surface = entry.surface.get();
+
+    entry.bounds = entry.surface->input_area_bounds();
+    entry.oversized = false;
+
+    if (is_empty(entry.bounds))
+        return;
+
+    if (spans_too_many_cells(entry.bounds))
+    {
+        entry.oversized = true;
+        oversized.push_back(surface);
+        return;
+    }
+
+    for_each_cell(entry.bounds, [&](CellKey key) { cells[key].push_back(surface); });
+}
+
+void ms::SurfaceInputIndex::erase_locked(Surface const* surface, Entry const& entry)
+{
+    if (is_empty(entry.bounds))
+        return;
+
+    if (entry.oversized)
+    {
+        erase_from(oversized, surface);
+        return;
+    }
+
+    for_each_cell(entry.bounds, [&](CellKey key)
+        {
+            auto const cell = cells.find(key);
+            if (cell == cells.end())
+                return;
+
+            erase_from(cell->second, surface);
+            if (cell->second.empty())
+                cells.erase(cell);
+        });
+}
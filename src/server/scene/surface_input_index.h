@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SURFACE_INPUT_INDEX_H_
+#define MIR_SCENE_SURFACE_INPUT_INDEX_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+class Surface;
+
+/**
+ * Finds the surfaces whose input area may contain a point without walking the
+ * whole scene.
+ *
+ * Surfaces are bucketed into a uniform grid of cells by the bounds of their
+ * input area (Surface::input_area_bounds()). The owner keeps the index up to
+ * date by calling update() whenever a surface's position, size or input region
+ * may have changed and restack() whenever the stacking order changes.
+ */
+class SurfaceInputIndex
+{
+public:
+    SurfaceInputIndex() = default;
+
+    void add(std::shared_ptr<Surface> const& surface);
+    void remove(Surface const* surface);
+
+    /// Re-reads the input area bounds of surface (ignored if surface isn't in the index)
+    void update(Surface const* surface);
+
+    /// Sets the stacking order from surfaces grouped by depth layer, each layer bottom to top
+    void restack(std::vector<std::vector<std::shared_ptr<Surface>>> const& layers);
+
+    /// Surfaces whose input area bounds contain point, topmost first
+    auto candidates_at(geometry::Point point) const -> std::vector<std::shared_ptr<Surface>>;
+
+private:
+    SurfaceInputIndex(SurfaceInputIndex const&) = delete;
+    SurfaceInputIndex& operator=(SurfaceInputIndex const&) = delete;
+
+    using CellKey = uint64_t;
+
+    struct Entry
+    {
+        std::shared_ptr<Surface> surface;
+        geometry::Rectangle bounds;
+        unsigned int rank;
+        bool oversized;
+    };
+
+    void insert_locked(Entry& entry);
+    void erase_locked(Surface const* surface, Entry const& entry);
+
+    std::mutex mutable guard;
+    std::unordered_map<Surface const*, Entry> entries;
+    std::unordered_map<CellKey, std::vector<Surface const*>> cells;
+    std::vector<Surface const*> oversized; ///< Surfaces spanning too many cells to bucket
+};
+}
+}
+
+#endif /* MIR_SCENE_SURFACE_INPUT_INDEX_H_ */
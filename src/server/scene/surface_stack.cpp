@@ -33,6 +33,7 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <new>
 #include <stdexcept>
 
 namespace ms = mir::scene;
@@ -41,21 +42,123 @@ namespace mg = mir::graphics;
 namespace mi = mir::input;
 namespace geom = mir::geometry;
 
+/**
+ * Keeps the memory of a compositor's scene elements once the compositor has
+ * released them, so that the next frame's elements need not touch the heap.
+ * Blocks are kept by size as a SceneElementSequence mixes element types.
+ */
+class ms::SceneElementStorage
+{
+public:
+    SceneElementStorage() = default;
+
+    ~SceneElementStorage()
+    {
+        for (auto const& blocks : free_blocks)
+        {
+            for (auto const block : blocks.second)
+                ::operator delete(block);
+        }
+    }
+
+    void* allocate(std::size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock{guard};
+            auto const blocks = free_blocks.find(size);
+            if (blocks != free_blocks.end() && !blocks->second.empty())
+            {
+                auto const block = blocks->second.back();
+                blocks->second.pop_back();
+                return block;
+            }
+        }
+
+        return ::operator new(size);
+    }
+
+    void deallocate(void* block, std::size_t size) noexcept
+    {
+        try
+        {
+            std::lock_guard<std::mutex> lock{guard};
+            free_blocks[size].push_back(block);
+        }
+        catch (...)
+        {
+            ::operator delete(block);
+        }
+    }
+
+    /// Used to size the next frame's SceneElementSequence up front
+    std::atomic<std::size_t> last_frame_size{0};
+
+private:
+    SceneElementStorage(SceneElementStorage const&) = delete;
+    SceneElementStorage& operator=(SceneElementStorage const&) = delete;
+
+    std::mutex guard;
+    std::map<std::size_t, std::vector<void*>> free_blocks;
+};
+
 namespace
 {
 
+/**
+ * Allocates from a SceneElementStorage. Each element's shared_ptr control block
+ * holds a copy, so the storage outlives any element still held by a compositor.
+ */
+template<typename T>
+struct RecyclingAllocator
+{
+    using value_type = T;
+
+    explicit RecyclingAllocator(std::shared_ptr<ms::SceneElementStorage> const& storage)
+        : storage{storage}
+    {
+    }
+
+    template<typename U>
+    RecyclingAllocator(RecyclingAllocator<U> const& other)
+        : storage{other.storage}
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(storage->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        storage->deallocate(p, n * sizeof(T));
+    }
+
+    std::shared_ptr<ms::SceneElementStorage> storage;
+};
+
+template<typename T, typename U>
+bool operator==(RecyclingAllocator<T> const& lhs, RecyclingAllocator<U> const& rhs)
+{
+    return lhs.storage == rhs.storage;
+}
+
+template<typename T, typename U>
+bool operator!=(RecyclingAllocator<T> const& lhs, RecyclingAllocator<U> const& rhs)
+{
+    return !(lhs == rhs);
+}
+
 class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
-        std::shared_ptr<mg::Renderable> const& renderable,
+        std::shared_ptr<mg::Renderable> renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
-        : renderable_{renderable},
+        : renderable_{std::move(renderable)},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -78,7 +181,6 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -109,12 +211,13 @@ private:
 };
 
 /**
- * A SurfaceDepthLayerObserver must not outlive the SurfaceStack it was created for
+ * A SurfaceStackObserver must not outlive the SurfaceStack it was created for
  */
-struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
+struct SurfaceStackObserver : ms::NullSurfaceObserver
 {
-    SurfaceDepthLayerObserver(ms::SurfaceStack* stack)
-        : stack{stack}
+    SurfaceStackObserver(ms::SurfaceStack* stack, ms::SurfaceInputIndex* input_index)
+        : stack{stack},
+          input_index{input_index}
     {
     }
 
@@ -124,8 +227,29 @@ struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
         stack->raise(surface);
     }
 
+    void moved_to(ms::Surface const* surface, geom::Point const& /*top_left*/) override
+    {
+        input_index->update(surface);
+    }
+
+    void window_resized_to(ms::Surface const* surface, geom::Size const& /*window_size*/) override
+    {
+        input_index->update(surface);
+    }
+
+    void content_resized_to(ms::Surface const* surface, geom::Size const& /*content_size*/) override
+    {
+        input_index->update(surface);
+    }
+
+    void input_region_set_to(ms::Surface const* surface, std::vector<geom::Rectangle> const& /*region*/) override
+    {
+        input_index->update(surface);
+    }
+
 private:
     ms::SurfaceStack* stack;
+    ms::SurfaceInputIndex* input_index;
 };
 
 }
@@ -134,7 +258,7 @@ ms::SurfaceStack::SurfaceStack(
     std::shared_ptr<SceneReport> const& report) :
     report{report},
     scene_changed{false},
-    surface_observer{std::make_shared<SurfaceDepthLayerObserver>(this)}
+    surface_observer{std::make_shared<SurfaceStackObserver>(this, &input_index)}
 {
 }
 
@@ -143,32 +267,36 @@ ms::SurfaceStack::~SurfaceStack() noexcept(true)
     RecursiveWriteLock lg(guard);
     for (auto const& layer : surface_layers)
     {
-        for (auto const& surface : layer)
+        for (auto const& stacked : layer)
         {
-            surface->remove_observer(surface_observer);
+            stacked.surface->remove_observer(surface_observer);
         }
     }
 }
 
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
+    auto const storage = element_storage_for(id);
+    RecyclingAllocator<mc::SceneElement> const allocator{storage};
+
     RecursiveReadLock lg(guard);
 
     scene_changed = false;
     mc::SceneElementSequence elements;
+    elements.reserve(storage->last_frame_size);
     for (auto const& layer : surface_layers)
     {
-        for (auto const& surface : layer)
+        for (auto const& stacked : layer)
         {
-            if (surface->visible())
+            if (stacked.surface->visible())
             {
-                for (auto& renderable : surface->generate_renderables(id))
+                for (auto& renderable : stacked.surface->generate_renderables(id))
                 {
                     elements.emplace_back(
-                        std::make_shared<SurfaceSceneElement>(
-                            surface->name(),
-                            renderable,
-                            rendering_trackers[surface.get()],
+                        std::allocate_shared<SurfaceSceneElement>(
+                            allocator,
+                            std::move(renderable),
+                            stacked.tracker,
                             id));
                 }
             }
@@ -176,8 +304,10 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
     }
     for (auto const& renderable : overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        elements.emplace_back(std::allocate_shared<OverlaySceneElement>(allocator, renderable));
     }
+
+    storage->last_frame_size = elements.size();
     return elements;
 }
 
@@ -188,17 +318,16 @@ int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
     int result = scene_changed ? 1 : 0;
     for (auto const& layer : surface_layers)
     {
-        for (auto const& surface : layer)
+        for (auto const& stacked : layer)
         {
-            if (surface->visible())
+            if (stacked.surface->visible())
             {
-                auto const tracker = rendering_trackers.find(surface.get());
-                if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
+                if (stacked.tracker->is_exposed_in(id))
                 {
                     // Note that we ask the surface and not a Renderable.
                     // This is because we don't want to waste time and resources
                     // on a snapshot till we're sure we need it...
-                    int ready = surface->buffers_ready_for_compositor(id);
+                    int ready = stacked.surface->buffers_ready_for_compositor(id);
                     if (ready > result)
                         result = ready;
                 }
@@ -219,11 +348,16 @@ void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 
 void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    {
+        RecursiveWriteLock lg(guard);
 
-    registered_compositors.erase(cid);
+        registered_compositors.erase(cid);
 
-    update_rendering_tracker_compositors();
+        update_rendering_tracker_compositors();
+    }
+
+    std::lock_guard<std::mutex> lock{element_storage_guard};
+    element_storage.erase(cid);
 }
 
 void ms::SurfaceStack::add_input_visualization(
@@ -268,9 +402,10 @@ void ms::SurfaceStack::add_surface(
 {
     {
         RecursiveWriteLock lg(guard);
-        insert_surface_at_top_of_depth_layer(surface);
-        create_rendering_tracker_for(surface);
+        insert_surface_at_top_of_depth_layer({surface, create_rendering_tracker_for(surface)});
         surface->add_observer(surface_observer);
+        input_index.add(surface);
+        restack_input_index();
     }
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface);
@@ -288,13 +423,16 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
 
         for (auto& layer : surface_layers)
         {
-            auto const surface = std::find(layer.begin(), layer.end(), keep_alive);
+            auto const surface = std::find_if(
+                layer.begin(),
+                layer.end(),
+                [&](StackedSurface const& i) { return i.surface == keep_alive; });
 
             if (surface != layer.end())
             {
                 layer.erase(surface);
-                rendering_trackers.erase(keep_alive.get());
                 keep_alive->remove_observer(surface_observer);
+                input_index.remove(keep_alive.get());
                 found_surface = true;
                 break;
             }
@@ -309,47 +447,35 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     // TODO: error logging when surface not found
 }
 
-namespace
-{
-template <typename Container>
-struct InReverse {
-    Container& container;
-    auto begin() -> decltype(container.rbegin()) { return container.rbegin(); }
-    auto end() -> decltype(container.rend()) { return container.rend(); }
-};
-
-template <typename Container>
-InReverse<Container> in_reverse(Container& container) { return InReverse<Container>{container}; }
-}
-
 auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
 -> std::shared_ptr<Surface>
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& layer : in_reverse(surface_layers))
+    // TODO There's a lack of clarity about how the input area will
+    // TODO be maintained and whether this test will detect clicks on
+    // TODO decorations (it should) as these may be outside the area
+    // TODO known to the client.  But it works for now.
+    for (auto const& surface : input_index.candidates_at(cursor))
     {
-        for (auto const& surface : in_reverse(layer))
-        {
-            // TODO There's a lack of clarity about how the input area will
-            // TODO be maintained and whether this test will detect clicks on
-            // TODO decorations (it should) as these may be outside the area
-            // TODO known to the client.  But it works for now.
-            if (surface->input_area_contains(cursor))
-                    return surface;
-        }
+        if (surface->input_area_contains(cursor))
+            return surface;
     }
 
     return {};
 }
 
+auto ms::SurfaceStack::input_surface_at(geometry::Point point) -> std::shared_ptr<mi::Surface>
+{
+    return surface_at(point);
+}
+
 void ms::SurfaceStack::for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback)
 {
     RecursiveReadLock lg(guard);
     for (auto const& layer : surface_layers)
     {
-        for (auto const& surface : layer)
+        for (auto const& stacked : layer)
         {
-            callback(surface);
+            callback(stacked.surface);
         }
     }
 }
@@ -367,14 +493,15 @@ void ms::SurfaceStack::raise(Surface const* surface)
                 layer.end(),
                 [surface](auto const& i)
                     {
-                        return surface == i.get();
+                        return surface == i.surface.get();
                     });
 
             if (p != layer.end())
             {
-                std::shared_ptr<Surface> surface_shared = *p;
+                auto const stacked = *p;
                 layer.erase(p);
-                insert_surface_at_top_of_depth_layer(surface_shared);
+                insert_surface_at_top_of_depth_layer(stacked);
+                restack_input_index();
                 surfaces_reordered = true;
                 break;
             }
@@ -404,52 +531,88 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
             // Put all the surfaces to raise at the end of the list (preserving order)
             auto split = std::stable_partition(
                 begin(layer), end(layer),
-                [&](std::weak_ptr<Surface> const& s) { return !ss.count(s); });
+                [&](StackedSurface const& s) { return !ss.count(s.surface); });
 
             // Make a new vector with only the surfaces to raise
-            auto to_raise = std::vector<std::shared_ptr<Surface>>{split, layer.end()};
+            auto to_raise = std::vector<StackedSurface>{split, layer.end()};
 
             // Chop off the surfaces we are moving from the old vector (they are now only in to_raise)
             layer.erase(split, layer.end());
 
             // One by one insert to_raise surfaces into the surfaces vector at the correct position
             // It is important that to_raise is still in the original order
-            for (auto const& surface : to_raise)
-                insert_surface_at_top_of_depth_layer(surface);
+            for (auto const& stacked : to_raise)
+                insert_surface_at_top_of_depth_layer(stacked);
 
             // Only set surfaces_reordered if the end result is different than before
-            if (old_layer != layer)
+            auto const same_surface = [](StackedSurface const& lhs, StackedSurface const& rhs)
+                {
+                    return lhs.surface == rhs.surface;
+                };
+            if (!std::equal(old_layer.begin(), old_layer.end(), layer.begin(), layer.end(), same_surface))
                 surfaces_reordered = true;
         }
+
+        if (surfaces_reordered)
+            restack_input_index();
     }
 
     if (surfaces_reordered)
         observers.surfaces_reordered();
 }
 
-void ms::SurfaceStack::create_rendering_tracker_for(std::shared_ptr<Surface> const& surface)
+auto ms::SurfaceStack::create_rendering_tracker_for(std::shared_ptr<Surface> const& surface)
+-> std::shared_ptr<RenderingTracker>
 {
     auto const tracker = std::make_shared<RenderingTracker>(surface);
 
-    RecursiveWriteLock ul(guard);
+    RecursiveReadLock ul(guard);
     tracker->active_compositors(registered_compositors);
-    rendering_trackers[surface.get()] = tracker;
+    return tracker;
 }
 
 void ms::SurfaceStack::update_rendering_tracker_compositors()
 {
     RecursiveReadLock ul(guard);
 
-    for (auto const& pair : rendering_trackers)
-        pair.second->active_compositors(registered_compositors);
+    for (auto const& layer : surface_layers)
+    {
+        for (auto const& stacked : layer)
+            stacked.tracker->active_compositors(registered_compositors);
+    }
 }
 
-void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface)
+void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(StackedSurface const& stacked)
 {
-    unsigned int depth_index = mir_depth_layer_get_index(surface->depth_layer());
+    unsigned int depth_index = mir_depth_layer_get_index(stacked.surface->depth_layer());
     if (surface_layers.size() <= depth_index)
         surface_layers.resize(depth_index + 1);
-    surface_layers[depth_index].push_back(surface);
+    surface_layers[depth_index].push_back(stacked);
+}
+
+void ms::SurfaceStack::restack_input_index()
+{
+    std::vector<std::vector<std::shared_ptr<Surface>>> layers;
+    layers.reserve(surface_layers.size());
+    for (auto const& layer : surface_layers)
+    {
+        layers.emplace_back();
+        layers.back().reserve(layer.size());
+        for (auto const& stacked : layer)
+            layers.back().push_back(stacked.surface);
+    }
+
+    input_index.restack(layers);
+}
+
+auto ms::SurfaceStack::element_storage_for(mc::CompositorID id) -> std::shared_ptr<SceneElementStorage>
+{
+    std::lock_guard<std::mutex> lock{element_storage_guard};
+
+    auto& storage = element_storage[id];
+    if (!storage)
+        storage = std::make_shared<SceneElementStorage>();
+    return storage;
 }
 
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
@@ -460,9 +623,9 @@ void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observe
     RecursiveReadLock lk(guard);
     for (auto const& layer : surface_layers)
     {
-        for (auto const& surface : layer)
+        for (auto const& stacked : layer)
         {
-            observer->surface_exists(surface);
+            observer->surface_exists(stacked.surface);
         }
     }
 }
@@ -30,6 +30,8 @@
 #include "mir/basic_observers.h"
 #include "mir/scene/surface_observer.h"
 
+#include "surface_input_index.h"
+
 #include <atomic>
 #include <map>
 #include <memory>
@@ -50,6 +52,7 @@ namespace scene
 class BasicSurface;
 class SceneReport;
 class RenderingTracker;
+class SceneElementStorage;
 
 class Observers : public Observer, BasicObservers<Observer>
 {
@@ -85,6 +88,7 @@ public:
 
     // From Scene
     void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) override;
+    auto input_surface_at(geometry::Point point) -> std::shared_ptr<input::Surface> override;
 
     virtual void remove_surface(std::weak_ptr<Surface> const& surface) override;
 
@@ -110,24 +114,36 @@ public:
 private:
     SurfaceStack(const SurfaceStack&) = delete;
     SurfaceStack& operator=(const SurfaceStack&) = delete;
-    void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
+    struct StackedSurface
+    {
+        std::shared_ptr<Surface> surface;
+        std::shared_ptr<RenderingTracker> tracker;
+    };
+
+    auto create_rendering_tracker_for(std::shared_ptr<Surface> const&) -> std::shared_ptr<RenderingTracker>;
     void update_rendering_tracker_compositors();
-    void insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface);
+    void insert_surface_at_top_of_depth_layer(StackedSurface const& stacked);
+    void restack_input_index();
+    auto element_storage_for(compositor::CompositorID id) -> std::shared_ptr<SceneElementStorage>;
 
     RecursiveReadWriteMutex mutable guard;
 
     std::shared_ptr<SceneReport> const report;
 
     /**
-     * All surfaces managed by this class
+     * All surfaces managed by this class, each with its RenderingTracker
      *
      * Each depth layer is mapped to an index of the outer vector by mir_depth_layer_to_index()
      * The outer vector starts out empty, and is expanded as needed to contain the highest layer encountered
      * The inner vectors contain the list of surfaces on each layer (bottom to top)
      */
-    std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
-    std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
+    std::vector<std::vector<StackedSurface>> surface_layers;
     std::set<compositor::CompositorID> registered_compositors;
+
+    /// Recycled memory for each compositor's scene elements (guarded by element_storage_guard, not guard)
+    std::mutex element_storage_guard;
+    std::map<compositor::CompositorID, std::shared_ptr<SceneElementStorage>> element_storage;
+    SurfaceInputIndex input_index;
     
     std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
@@ -137,7 +137,8 @@ struct TemporaryCompositeEventFilter : public mi::CompositeEventFilter
     MACRO(the_persistent_surface_store)\
     MACRO(the_display_configuration_observer_registrar)\
     MACRO(the_seat_observer_registrar)\
-    MACRO(the_session_mediator_observer_registrar)
+    MACRO(the_session_mediator_observer_registrar)\
+    MACRO(the_buffer_memory_accounting)
 
 #define MIR_SERVER_BUILDER(name)\
     std::function<std::result_of<decltype(&mir::DefaultServerConfiguration::the_##name)(mir::DefaultServerConfiguration*)>::type()> name##_builder;
@@ -0,0 +1,119 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from presentation-time.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_PRESENTATION_TIME_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_PRESENTATION_TIME_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class Presentation;
+class PresentationFeedback;
+
+class Presentation : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_presentation";
+
+    static Presentation* from(struct wl_resource*);
+
+    Presentation(struct wl_resource* resource, Version<1>);
+    virtual ~Presentation() = default;
+
+    void send_clock_id_event(uint32_t clk_id) const;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const invalid_timestamp = 0;
+        static uint32_t const invalid_flag = 1;
+    };
+
+    struct Opcode
+    {
+        static uint32_t const clock_id = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_presentation) = 0;
+        friend Presentation::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void feedback(struct wl_resource* surface, struct wl_resource* callback) = 0;
+};
+
+class PresentationFeedback : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_presentation_feedback";
+
+    static PresentationFeedback* from(struct wl_resource*);
+
+    PresentationFeedback(struct wl_resource* resource, Version<1>);
+    virtual ~PresentationFeedback() = default;
+
+    void send_sync_output_event(struct wl_resource* output) const;
+    void send_presented_event(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags) const;
+    void send_discarded_event() const;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Kind
+    {
+        static uint32_t const vsync = 0x1;
+        static uint32_t const hw_clock = 0x2;
+        static uint32_t const hw_completion = 0x4;
+        static uint32_t const zero_copy = 0x8;
+    };
+
+    struct Opcode
+    {
+        static uint32_t const sync_output = 0;
+        static uint32_t const presented = 1;
+        static uint32_t const discarded = 2;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_PRESENTATION_TIME_XML_WRAPPER
@@ -43,6 +43,12 @@ public:
                  void(compositor::CompositorReport::SubCompositorId));
     MOCK_METHOD1(finished_frame,
                  void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD1(missed_frame,
+                 void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD2(presented_frame,
+                 void(compositor::CompositorReport::SubCompositorId, graphics::Frame const&));
+    MOCK_METHOD2(submitted_buffer,
+                 void(compositor::CompositorReport::StreamId, graphics::BufferID));
     MOCK_METHOD0(started, void());
     MOCK_METHOD0(stopped, void());
     MOCK_METHOD0(scheduled, void());
@@ -25,6 +25,7 @@
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include <map>
 #include <unordered_map>
 
 namespace mir
@@ -56,6 +57,9 @@ public:
                        std::vector<uint32_t>& possible_encoder_ids,
                        geometry::Size const& physical_size,
                        drmModeSubPixel subpixel_arrangement = DRM_MODE_SUBPIXEL_UNKNOWN);
+    /// Adds a plane of type (DRM_PLANE_TYPE_*) with a zpos above the planes already added,
+    /// currently attached to crtc_id (or none)
+    void add_plane(uint32_t plane_id, uint32_t possible_crtcs_mask, uint64_t type, uint32_t crtc_id = 0);
 
     void prepare();
     void reset();
@@ -63,6 +67,10 @@ public:
     drmModeCrtc* find_crtc(uint32_t id);
     drmModeEncoder* find_encoder(uint32_t id);
     drmModeConnector* find_connector(uint32_t id);
+    drmModePlane* find_plane(uint32_t id);
+    /// nullptr if there are no planes (as if the kernel doesn't support them)
+    drmModePlaneRes* plane_resources_ptr();
+    drmModeObjectProperties* plane_properties_ptr(uint32_t plane_id);
 
     enum ModePreference {NormalMode, PreferredMode};
     static drmModeModeInfo create_mode(uint16_t hdisplay, uint16_t vdisplay,
@@ -85,6 +93,18 @@ private:
     std::vector<drmModeModeInfo> modes;
     std::vector<drmModeModeInfo> modes_empty;
     std::vector<uint32_t> connector_encoder_ids;
+
+    struct PlaneProperties
+    {
+        std::vector<uint32_t> ids;
+        std::vector<uint64_t> values;
+        drmModeObjectProperties properties;
+    };
+
+    drmModePlaneRes plane_resources;
+    std::vector<drmModePlane> planes;
+    std::vector<uint32_t> plane_ids;
+    std::map<uint32_t, PlaneProperties> plane_properties;
 };
 
 class MockDRM
@@ -165,6 +185,14 @@ public:
 
     MOCK_METHOD1(drmCheckModesettingSupported, int(char const*));
 
+    MOCK_METHOD4(drmModeAtomicCommit, int(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data));
+
+    /// The id of the named plane property (FB_ID, CRTC_ID, etc.) on the fake planes
+    static uint32_t plane_property_id(char const* name);
+
+    /// The values an atomic request sets, keyed by object id and property id
+    static std::map<std::pair<uint32_t, uint32_t>, uint64_t> atomic_properties(drmModeAtomicReqPtr request);
+
     void add_crtc(
         char const* device,
         uint32_t id,
@@ -184,6 +212,12 @@ public:
         std::vector<uint32_t>& possible_encoder_ids,
         geometry::Size const& physical_size,
         drmModeSubPixel subpixel_arrangement = DRM_MODE_SUBPIXEL_UNKNOWN);
+    void add_plane(
+        char const* device,
+        uint32_t plane_id,
+        uint32_t possible_crtcs_mask,
+        uint64_t type,
+        uint32_t crtc_id = 0);
 
     void prepare(char const* device);
     void reset(char const* device);
@@ -65,6 +65,10 @@ public:
     {
         if (b) ++nready;
     }
+    void submit_buffer(std::shared_ptr<graphics::Buffer> const& b, geometry::Rectangles const&) override
+    {
+        submit_buffer(b);
+    }
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& fn) override
     {
         fn(*stub_compositor_buffer);
@@ -73,6 +77,11 @@ public:
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const&) override {}
     bool has_submitted_buffer() const override { return true; }
     void set_scale(float) override {}
+    auto damage_between(graphics::BufferID, graphics::BufferID) const
+        -> std::experimental::optional<geometry::Rectangles> override
+    {
+        return {};
+    }
 
     std::shared_ptr<graphics::Buffer> stub_compositor_buffer;
     int nready = 0;
@@ -94,6 +94,14 @@ public:
     {
         return 1;
     }
+    geometry::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+    std::experimental::optional<geometry::Rectangles> damage_since(graphics::BufferID) const override
+    {
+        return {};
+    }
 
 private:
     std::shared_ptr<graphics::Buffer> make_stub_buffer(geometry::Rectangle const& rect)
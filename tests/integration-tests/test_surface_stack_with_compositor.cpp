@@ -17,6 +17,7 @@
  */
 
 #include "mir/compositor/display_listener.h"
+#include "mir/compositor/presentation_observer.h"
 #include "mir/renderer/renderer_factory.h"
 #include "mir/scene/surface_creation_parameters.h"
 #include "src/server/report/null_report_factory.h"
@@ -119,11 +120,16 @@ struct StubDisplayListener : mc::DisplayListener
     virtual void remove_display(geom::Rectangle const& /*area*/) override {}
 };
 
+struct StubPresentationObserver : mc::PresentationObserver
+{
+    void frame_presented(geom::Rectangle const& /*view_area*/, mg::Frame const& /*frame*/) override {}
+};
+
 struct SurfaceStackCompositor : public Test
 {
     SurfaceStackCompositor() :
         timeout{std::chrono::system_clock::now() + std::chrono::seconds(5)},
-        stream(std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888 )),
+        stream(std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888, mr::null_compositor_report())),
         mock_buffer_stream(std::make_shared<NiceMock<mtd::MockBufferStream>>()),
         streams({ { stream, {0,0}, {} } }),
         stub_surface{std::make_shared<ms::BasicSurface>(
@@ -154,6 +160,7 @@ struct SurfaceStackCompositor : public Test
     CountingDisplaySyncGroup stub_secondary_db;
     StubDisplay stub_display{stub_primary_db, stub_secondary_db};
     StubDisplayListener stub_display_listener;
+    StubPresentationObserver stub_presentation_observer;
     mc::DefaultDisplayBufferCompositorFactory dbc_factory{
         mt::fake_shared(renderer_factory),
         null_comp_report};
@@ -170,6 +177,7 @@ TEST_F(SurfaceStackCompositor, composes_on_start_if_told_to_in_constructor)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, true);
     mt_compositor.start();
 
@@ -184,6 +192,7 @@ TEST_F(SurfaceStackCompositor, does_not_composes_on_start_if_told_not_to_in_cons
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
     mt_compositor.start();
 
@@ -198,6 +207,7 @@ TEST_F(SurfaceStackCompositor, swapping_a_surface_that_has_been_added_triggers_a
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
     mt_compositor.start();
 
@@ -224,6 +234,7 @@ TEST_F(SurfaceStackCompositor, compositor_runs_until_all_surfaces_buffers_are_co
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
     mt_compositor.start();
 
@@ -254,6 +265,7 @@ TEST_F(SurfaceStackCompositor, bypassed_compositor_runs_until_all_surfaces_buffe
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
     mt_compositor.start();
 
@@ -272,6 +284,7 @@ TEST_F(SurfaceStackCompositor, an_empty_scene_retriggers)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
     mt_compositor.start();
 
@@ -297,6 +310,7 @@ TEST_F(SurfaceStackCompositor, moving_a_surface_triggers_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
 
     mt_compositor.start();
@@ -316,6 +330,7 @@ TEST_F(SurfaceStackCompositor, removing_a_surface_triggers_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
 
     mt_compositor.start();
@@ -335,6 +350,7 @@ TEST_F(SurfaceStackCompositor, buffer_updates_trigger_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
+        mt::fake_shared(stub_presentation_observer),
         null_comp_report, default_delay, false);
 
     mt_compositor.start();
@@ -22,6 +22,7 @@
 #include "mir/geometry/size.h"
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <stdexcept>
 #include <unistd.h>
 #include <dlfcn.h>
@@ -34,8 +35,51 @@ namespace geom = mir::geometry;
 namespace
 {
 mtd::MockDRM* global_mock = nullptr;
+
+/* The properties every fake plane has, in the order of their ids */
+char const* const plane_property_names[] = {
+    "type",
+    "FB_ID", "CRTC_ID",
+    "SRC_X", "SRC_Y", "SRC_W", "SRC_H",
+    "CRTC_X", "CRTC_Y", "CRTC_W", "CRTC_H",
+    "zpos"};
+uint32_t const first_plane_property_id{1000};
+size_t const plane_property_count{sizeof(plane_property_names)/sizeof(plane_property_names[0])};
+
+drmModePropertyRes* fake_plane_property(uint32_t id)
+{
+    static auto const properties =
+        []()
+        {
+            std::vector<drmModePropertyRes> properties(plane_property_count);
+            for (auto i = 0u; i != plane_property_count; ++i)
+            {
+                properties[i].prop_id = first_plane_property_id + i;
+                strncpy(properties[i].name, plane_property_names[i], DRM_PROP_NAME_LEN);
+            }
+            return properties;
+        }();
+
+    if (id < first_plane_property_id || id >= first_plane_property_id + plane_property_count)
+        return nullptr;
+
+    return const_cast<drmModePropertyRes*>(&properties[id - first_plane_property_id]);
+}
 }
 
+/* The atomic request is opaque to libdrm users, so the mock is free to define it */
+struct _drmModeAtomicReq
+{
+    struct Item
+    {
+        uint32_t object_id;
+        uint32_t property_id;
+        uint64_t value;
+    };
+
+    std::vector<Item> items;
+};
+
 mtd::FakeDRMResources::FakeDRMResources()
     : pipe_fds{-1, -1}
 {
@@ -115,6 +159,19 @@ void mtd::FakeDRMResources::prepare()
     for (auto const& connector: connectors)
         connector_ids.push_back(connector.connector_id);
     resources.connectors = connector_ids.data();
+
+    plane_resources.count_planes = planes.size();
+    for (auto const& plane: planes)
+        plane_ids.push_back(plane.plane_id);
+    plane_resources.planes = plane_ids.data();
+
+    for (auto& entry : plane_properties)
+    {
+        auto& props = entry.second;
+        props.properties.count_props = props.ids.size();
+        props.properties.props = props.ids.data();
+        props.properties.prop_values = props.values.data();
+    }
 }
 
 void mtd::FakeDRMResources::reset()
@@ -128,6 +185,11 @@ void mtd::FakeDRMResources::reset()
     crtc_ids.clear();
     encoder_ids.clear();
     connector_ids.clear();
+
+    plane_resources = drmModePlaneRes();
+    planes.clear();
+    plane_ids.clear();
+    plane_properties.clear();
 }
 
 void mtd::FakeDRMResources::add_crtc(uint32_t id, drmModeModeInfo mode)
@@ -178,6 +240,28 @@ void mtd::FakeDRMResources::add_connector(uint32_t connector_id,
     connectors.push_back(connector);
 }
 
+void mtd::FakeDRMResources::add_plane(uint32_t plane_id, uint32_t possible_crtcs_mask, uint64_t type, uint32_t crtc_id)
+{
+    drmModePlane plane = drmModePlane();
+
+    plane.plane_id = plane_id;
+    plane.possible_crtcs = possible_crtcs_mask;
+    plane.crtc_id = crtc_id;
+
+    auto& props = plane_properties[plane_id];
+    for (auto i = 0u; i != plane_property_count; ++i)
+    {
+        props.ids.push_back(first_plane_property_id + i);
+        props.values.push_back(0);
+    }
+    props.values[0] = type;
+    props.values[2] = crtc_id;
+    props.values[plane_property_count - 1] = planes.size();
+    props.properties = drmModeObjectProperties();
+
+    planes.push_back(plane);
+}
+
 drmModeCrtc* mtd::FakeDRMResources::find_crtc(uint32_t id)
 {
     for (auto& crtc : crtcs)
@@ -209,6 +293,27 @@ drmModeConnector* mtd::FakeDRMResources::find_connector(uint32_t id)
 }
 
 
+drmModePlane* mtd::FakeDRMResources::find_plane(uint32_t id)
+{
+    for (auto& plane : planes)
+    {
+        if (plane.plane_id == id)
+            return &plane;
+    }
+    return nullptr;
+}
+
+drmModePlaneRes* mtd::FakeDRMResources::plane_resources_ptr()
+{
+    return planes.empty() ? nullptr : &plane_resources;
+}
+
+drmModeObjectProperties* mtd::FakeDRMResources::plane_properties_ptr(uint32_t plane_id)
+{
+    auto const found = plane_properties.find(plane_id);
+    return found != plane_properties.end() ? &found->second.properties : nullptr;
+}
+
 drmModeModeInfo mtd::FakeDRMResources::create_mode(uint16_t hdisplay, uint16_t vdisplay,
                                                    uint32_t clock, uint16_t htotal,
                                                    uint16_t vtotal,
@@ -304,8 +409,39 @@ mtd::MockDRM::MockDRM()
                     return fd_to_drm.at(fd).find_connector(connector_id);
                 }));
 
+    ON_CALL(*this, drmModeGetPlaneResources(_))
+        .WillByDefault(
+            Invoke(
+                [this](int fd) -> drmModePlaneRes*
+                {
+                    auto const drm = fd_to_drm.find(fd);
+                    return drm != fd_to_drm.end() ? drm->second.plane_resources_ptr() : nullptr;
+                }));
+
+    ON_CALL(*this, drmModeGetPlane(_, _))
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t plane_id)
+                {
+                    return fd_to_drm.at(fd).find_plane(plane_id);
+                }));
+
     ON_CALL(*this, drmModeObjectGetProperties(_, _, _))
-        .WillByDefault(Return(&empty_object_props));
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t id, uint32_t type)
+                {
+                    auto const drm = fd_to_drm.find(fd);
+                    if (type == DRM_MODE_OBJECT_PLANE && drm != fd_to_drm.end())
+                    {
+                        if (auto const props = drm->second.plane_properties_ptr(id))
+                            return props;
+                    }
+                    return &empty_object_props;
+                }));
+
+    ON_CALL(*this, drmModeGetProperty(_, _))
+        .WillByDefault(WithArg<1>(Invoke(&fake_plane_property)));
 
     ON_CALL(*this, drmSetInterfaceVersion(_, _))
         .WillByDefault(
@@ -380,6 +516,38 @@ void mtd::MockDRM::add_encoder(
     fake_drms[device].add_encoder(encoder_id, crtc_id, possible_crtcs_mask);
 }
 
+void mtd::MockDRM::add_plane(
+    char const* device,
+    uint32_t plane_id,
+    uint32_t possible_crtcs_mask,
+    uint64_t type,
+    uint32_t crtc_id)
+{
+    fake_drms[device].add_plane(plane_id, possible_crtcs_mask, type, crtc_id);
+}
+
+uint32_t mtd::MockDRM::plane_property_id(char const* name)
+{
+    auto const found = std::find_if(
+        std::begin(plane_property_names),
+        std::end(plane_property_names),
+        [name](char const* candidate) { return strcmp(candidate, name) == 0; });
+
+    if (found == std::end(plane_property_names))
+        BOOST_THROW_EXCEPTION(std::logic_error{std::string{"No fake plane property named "} + name});
+
+    return first_plane_property_id + (found - std::begin(plane_property_names));
+}
+
+auto mtd::MockDRM::atomic_properties(drmModeAtomicReqPtr request)
+    -> std::map<std::pair<uint32_t, uint32_t>, uint64_t>
+{
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> properties;
+    for (auto const& item : request->items)
+        properties[{item.object_id, item.property_id}] = item.value;
+    return properties;
+}
+
 void mtd::MockDRM::prepare(char const *device)
 {
     fake_drms[device].prepare();
@@ -535,6 +703,30 @@ drmModeCrtcPtr drmModeGetCrtc(int fd, uint32_t crtcId)
     return global_mock->drmModeGetCrtc(fd, crtcId);
 }
 
+drmModeAtomicReqPtr drmModeAtomicAlloc()
+{
+    return new _drmModeAtomicReq;
+}
+
+void drmModeAtomicFree(drmModeAtomicReqPtr req)
+{
+    delete req;
+}
+
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_id, uint64_t value)
+{
+    if (!req)
+        return -EINVAL;
+
+    req->items.push_back({object_id, property_id, value});
+    return req->items.size();
+}
+
+int drmModeAtomicCommit(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data)
+{
+    return global_mock->drmModeAtomicCommit(fd, req, flags, user_data);
+}
+
 int drmModeSetCrtc(int fd, uint32_t crtcId, uint32_t bufferId,
                    uint32_t x, uint32_t y, uint32_t *connectors, int count,
                    drmModeModeInfoPtr mode)
@@ -61,6 +61,18 @@ EGLBoolean extension_eglQueryWaylandBufferWL(
     EGLDisplay dpy,
     struct wl_resource *buffer,
     EGLint attribute, EGLint *value);
+EGLBoolean extension_eglQueryDmaBufFormatsEXT(
+    EGLDisplay dpy,
+    EGLint max_formats,
+    EGLint* formats,
+    EGLint* num_formats);
+EGLBoolean extension_eglQueryDmaBufModifiersEXT(
+    EGLDisplay dpy,
+    EGLint format,
+    EGLint max_modifiers,
+    EGLuint64KHR* modifiers,
+    EGLBoolean* external_only,
+    EGLint* num_modifiers);
 EGLDisplay extension_eglGetPlatformDisplayEXT(
     EGLenum platform,
     void *native_display,
@@ -186,6 +198,10 @@ mtd::MockEGL::MockEGL()
         .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&extension_eglBindWaylandDisplayWL)));
     ON_CALL(*this, eglGetProcAddress(StrEq("eglUnbindWaylandDisplayWL")))
         .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&extension_eglUnbindWaylandDisplayWL)));
+    ON_CALL(*this, eglGetProcAddress(StrEq("eglQueryDmaBufFormatsEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&extension_eglQueryDmaBufFormatsEXT)));
+    ON_CALL(*this, eglGetProcAddress(StrEq("eglQueryDmaBufModifiersEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&extension_eglQueryDmaBufModifiersEXT)));
     ON_CALL(*this, eglGetProcAddress(StrEq("eglGetPlatformDisplayEXT")))
         .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&extension_eglGetPlatformDisplayEXT)));
     ON_CALL(*this, eglGetProcAddress(StrEq("eglCreatePlatformWindowSurfaceEXT")))
@@ -503,6 +519,30 @@ EGLBoolean extension_eglQueryWaylandBufferWL(
         dpy, buffer, attribute, value);
 }
 
+EGLBoolean extension_eglQueryDmaBufFormatsEXT(
+    EGLDisplay dpy,
+    EGLint max_formats,
+    EGLint* formats,
+    EGLint* num_formats)
+{
+    CHECK_GLOBAL_MOCK(EGLBoolean);
+    return global_mock_egl->eglQueryDmaBufFormatsEXT(
+        dpy, max_formats, formats, num_formats);
+}
+
+EGLBoolean extension_eglQueryDmaBufModifiersEXT(
+    EGLDisplay dpy,
+    EGLint format,
+    EGLint max_modifiers,
+    EGLuint64KHR* modifiers,
+    EGLBoolean* external_only,
+    EGLint* num_modifiers)
+{
+    CHECK_GLOBAL_MOCK(EGLBoolean);
+    return global_mock_egl->eglQueryDmaBufModifiersEXT(
+        dpy, format, max_modifiers, modifiers, external_only, num_modifiers);
+}
+
 
 EGLDisplay extension_eglGetPlatformDisplayEXT(
     EGLenum platform,
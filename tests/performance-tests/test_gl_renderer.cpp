@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headless: GL and EGL are stubbed out, so this measures the renderer's own
+// CPU cost per frame and the number of draw calls it makes, not GPU time.
+
+#include "src/renderers/gl/renderer.h"
+#include "mir/geometry/displacement.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/stub_gl_buffer.h"
+#include "mir/test/doubles/stub_gl_display_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <iostream>
+
+#include <time.h>
+
+namespace mg = mir::graphics;
+namespace mrg = mir::renderer::gl;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+int const window_count = 40;
+int const frame_count = 200;
+geom::Rectangle const screen{{0, 0}, {1920, 1080}};
+
+std::chrono::nanoseconds thread_cpu_time()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+struct GLRendererPerformance : Test
+{
+    GLRendererPerformance()
+    {
+        ON_CALL(mock_gl, glCreateShader(_)).WillByDefault(Return(1));
+        ON_CALL(mock_gl, glCreateProgram()).WillByDefault(Return(1));
+        ON_CALL(mock_gl, glDrawArrays(_, _, _)).WillByDefault(InvokeWithoutArgs([this] { ++draw_calls; }));
+
+        // Client-decorated windows: a translucent shadow around an opaque body
+        for (int i = 0; i != window_count; ++i)
+        {
+            geom::Rectangle const window{{(i * 41) % 1280, (i * 23) % 600}, {640, 480}};
+            auto const renderable = std::make_shared<mtd::FakeRenderable>(window, 1.0f, false);
+            renderable->set_buffer(std::make_shared<mtd::StubGLBuffer>());
+            geom::Rectangle const body{
+                window.top_left + geom::Displacement{16, 16},
+                geom::Size{window.size.width.as_int() - 32, window.size.height.as_int() - 32}};
+            renderable->set_opaque_region(geom::Rectangles{body});
+            renderables.push_back(renderable);
+        }
+
+        // Software cursor
+        auto const cursor = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{960, 540}, {24, 24}}, 1.0f, false);
+        cursor->set_buffer(std::make_shared<mtd::StubGLBuffer>());
+        renderables.push_back(cursor);
+    }
+
+    void measure(mrg::Renderer::Submission submission, char const* name)
+    {
+        mrg::Renderer renderer{display_buffer, submission};
+
+        draw_calls = 0;
+        auto const start = thread_cpu_time();
+
+        for (int frame = 0; frame != frame_count; ++frame)
+            renderer.render(renderables);
+
+        auto const cpu_time = thread_cpu_time() - start;
+
+        auto const draws_per_frame = draw_calls / frame_count;
+        auto const us_per_frame =
+            std::chrono::duration<double, std::micro>(cpu_time).count() / frame_count;
+
+        std::cout << name << ": " << renderables.size() << " renderables, "
+                  << draws_per_frame << " draw calls/frame, "
+                  << us_per_frame << " us CPU/frame" << std::endl;
+
+        RecordProperty(std::string{name} + "_draw_calls_per_frame", draws_per_frame);
+        RecordProperty(std::string{name} + "_cpu_ns_per_frame", static_cast<int>(us_per_frame * 1000));
+
+        results.push_back(draws_per_frame);
+    }
+
+    NiceMock<mtd::MockGL> mock_gl;
+    NiceMock<mtd::MockEGL> mock_egl;
+    mtd::StubGLDisplayBuffer display_buffer{screen};
+    mg::RenderableList renderables;
+    int draw_calls{0};
+    std::vector<int> results;
+};
+}
+
+TEST_F(GLRendererPerformance, batched_submission_makes_fewer_draw_calls)
+{
+    measure(mrg::Renderer::Submission::immediate, "immediate");
+    measure(mrg::Renderer::Submission::batched, "batched");
+
+    EXPECT_THAT(results[1], Lt(results[0]));
+}
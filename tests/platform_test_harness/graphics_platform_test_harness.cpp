@@ -496,6 +496,16 @@ void basic_software_buffer_drawing(
             return mg::contains_alpha(buffer_->pixel_format());
         }
 
+        auto opaque_region() const -> mir::geometry::Rectangles override
+        {
+            return {};
+        }
+
+        auto damage_since(mg::BufferID) const -> std::experimental::optional<mir::geometry::Rectangles> override
+        {
+            return {};
+        }
+
         auto clip_area() const -> std::experimental::optional<mir::geometry::Rectangle> override
         {
             return std::experimental::optional<mir::geometry::Rectangle>{};
@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/damage_tracker.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+struct DamageTracker : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {1920, 1080}};
+    geom::Rectangle const left_area{{0, 0}, {960, 1080}};
+    geom::Rectangle const right_area{{960, 0}, {960, 1080}};
+
+    std::shared_ptr<mtd::FakeRenderable> const left{std::make_shared<mtd::FakeRenderable>(left_area)};
+    std::shared_ptr<mtd::FakeRenderable> const right{std::make_shared<mtd::FakeRenderable>(right_area)};
+
+    mc::DamageTracker tracker;
+};
+}
+
+TEST_F(DamageTracker, first_frame_is_fully_damaged)
+{
+    EXPECT_THAT(tracker.damage_for({left, right}, view_area), Eq(geom::Rectangles{view_area}));
+}
+
+TEST_F(DamageTracker, unchanged_frame_has_no_damage)
+{
+    tracker.damage_for({left, right}, view_area);
+
+    EXPECT_THAT(tracker.damage_for({left, right}, view_area), Eq(geom::Rectangles{}));
+}
+
+TEST_F(DamageTracker, new_buffer_damages_renderable)
+{
+    tracker.damage_for({left, right}, view_area);
+
+    right->set_buffer(std::make_shared<mtd::StubBuffer>());
+
+    EXPECT_THAT(tracker.damage_for({left, right}, view_area), Eq(geom::Rectangles{right_area}));
+}
+
+TEST_F(DamageTracker, new_buffer_damages_only_what_the_client_damaged)
+{
+    tracker.damage_for({left, right}, view_area);
+
+    right->set_buffer(std::make_shared<mtd::StubBuffer>(right_area.size));
+    right->set_damage(geom::Rectangles{{{10, 20}, {30, 40}}});
+
+    EXPECT_THAT(
+        tracker.damage_for({left, right}, view_area),
+        Eq(geom::Rectangles{{{970, 20}, {30, 40}}}));
+}
+
+TEST_F(DamageTracker, client_damage_is_scaled_to_screen)
+{
+    tracker.damage_for({left, right}, view_area);
+
+    geom::Size const double_size{right_area.size.width.as_int() * 2, right_area.size.height.as_int() * 2};
+    right->set_buffer(std::make_shared<mtd::StubBuffer>(double_size));
+    right->set_damage(geom::Rectangles{{{10, 20}, {30, 40}}});
+
+    EXPECT_THAT(
+        tracker.damage_for({left, right}, view_area),
+        Eq(geom::Rectangles{{{965, 10}, {15, 20}}}));
+}
+
+TEST_F(DamageTracker, added_renderable_is_damaged)
+{
+    tracker.damage_for({left}, view_area);
+
+    EXPECT_THAT(tracker.damage_for({left, right}, view_area), Eq(geom::Rectangles{right_area}));
+}
+
+TEST_F(DamageTracker, removed_renderable_is_damaged)
+{
+    tracker.damage_for({left, right}, view_area);
+
+    EXPECT_THAT(tracker.damage_for({right}, view_area), Eq(geom::Rectangles{left_area}));
+}
+
+TEST_F(DamageTracker, raised_renderable_is_damaged)
+{
+    tracker.damage_for({left, right}, view_area);
+
+    EXPECT_THAT(tracker.damage_for({right, left}, view_area), Eq(geom::Rectangles{left_area}));
+}
+
+TEST_F(DamageTracker, damage_is_clipped_to_view_area)
+{
+    auto const straddling = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{1900, 1000}, {100, 100}});
+
+    tracker.damage_for({left}, view_area);
+
+    EXPECT_THAT(
+        tracker.damage_for({left, straddling}, view_area),
+        Eq(geom::Rectangles{geom::Rectangle{{1900, 1000}, {20, 80}}}));
+}
+
+TEST_F(DamageTracker, renderable_outside_view_area_causes_no_damage)
+{
+    auto const elsewhere = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{1920, 0}, {100, 100}});
+
+    tracker.damage_for({left}, view_area);
+
+    EXPECT_THAT(tracker.damage_for({left, elsewhere}, view_area), Eq(geom::Rectangles{}));
+}
+
+TEST_F(DamageTracker, view_area_change_is_fully_damaged)
+{
+    geom::Rectangle const new_view_area{{0, 0}, {1280, 1024}};
+
+    tracker.damage_for({left, right}, view_area);
+
+    EXPECT_THAT(tracker.damage_for({left, right}, new_view_area), Eq(geom::Rectangles{new_view_area}));
+}
+
+TEST_F(DamageTracker, frame_after_reset_is_fully_damaged)
+{
+    tracker.damage_for({left, right}, view_area);
+    tracker.reset();
+
+    EXPECT_THAT(tracker.damage_for({left, right}, view_area), Eq(geom::Rectangles{view_area}));
+}
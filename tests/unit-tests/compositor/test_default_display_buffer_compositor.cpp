@@ -210,6 +210,61 @@ TEST_F(DefaultDisplayBufferCompositor, calls_renderer_in_sequence)
     }));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, damages_whole_screen_for_first_frame)
+{
+    using namespace testing;
+    InSequence seq;
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{screen})));
+    EXPECT_CALL(mock_renderer, render(_));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_only_changed_renderables)
+{
+    using namespace testing;
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+
+    InSequence seq;
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{small->screen_position()})));
+    EXPECT_CALL(mock_renderer, render(_));
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_whole_screen_after_overlay)
+{
+    using namespace testing;
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    EXPECT_CALL(display_buffer, overlay(_))
+        .WillOnce(Return(true))
+        .WillRepeatedly(Return(false));
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{screen})));
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, rotates_viewport)
 {   // Regression test for LP: #1643488
     using namespace testing;
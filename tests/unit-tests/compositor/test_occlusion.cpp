@@ -202,3 +202,82 @@ TEST_F(OcclusionFilterTest,
     EXPECT_THAT(renderables_from(occlusions), ElementsAre(partially_onscreen));
     EXPECT_THAT(renderables_from(elements), ElementsAre(covering));
 }
+
+TEST_F(OcclusionFilterTest, window_covered_by_several_windows_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 1920, 1200);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 960, 1200);
+    auto const top_right = std::make_shared<mtd::FakeRenderable>(960, 0, 960, 600);
+    auto const bottom_right = std::make_shared<mtd::FakeRenderable>(960, 600, 960, 600);
+    auto elements = scene_elements_from({bottom, left, top_right, bottom_right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, top_right, bottom_right));
+}
+
+TEST_F(OcclusionFilterTest, window_not_occluded_through_gap_between_windows)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 1920, 1200);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 950, 1200);
+    auto const right = std::make_shared<mtd::FakeRenderable>(960, 0, 960, 1200);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, left, right));
+}
+
+TEST_F(OcclusionFilterTest, clipped_window_only_occludes_within_its_clip_area)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(10, 10, 10, 10);
+    auto const top = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 100);
+    top->set_clip_area(Rectangle{{0, 0}, {15, 100}});
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
+
+TEST_F(OcclusionFilterTest, opaque_region_of_shaped_window_occludes)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(20, 20, 10, 10);
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{0, 0}, {100, 100}}, 1.0f, false);
+    top->set_opaque_region(Rectangles{{{10, 10}, {80, 80}}});
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(top));
+}
+
+TEST_F(OcclusionFilterTest, window_outside_opaque_region_of_shaped_window_not_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(5, 5, 10, 10);
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{0, 0}, {100, 100}}, 1.0f, false);
+    top->set_opaque_region(Rectangles{{{10, 10}, {80, 80}}});
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
+
+TEST_F(OcclusionFilterTest, opaque_region_of_translucent_window_occludes_nothing)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(20, 20, 10, 10);
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{0, 0}, {100, 100}}, 0.5f, false);
+    top->set_opaque_region(Rectangles{{{10, 10}, {80, 80}}});
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
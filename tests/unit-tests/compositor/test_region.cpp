@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/region.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mc = mir::compositor;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+TEST(Region, is_initially_empty)
+{
+    mc::Region const region;
+
+    EXPECT_TRUE(region.is_empty());
+    EXPECT_THAT(region.rectangles(), IsEmpty());
+}
+
+TEST(Region, ignores_empty_rectangles)
+{
+    mc::Region region;
+
+    region.add({{10, 10}, {0, 10}});
+    region.add({{10, 10}, {10, 0}});
+
+    EXPECT_TRUE(region.is_empty());
+}
+
+TEST(Region, contains_what_was_added)
+{
+    geom::Rectangle const rect{{10, 20}, {30, 40}};
+    mc::Region region;
+
+    region.add(rect);
+
+    EXPECT_FALSE(region.is_empty());
+    EXPECT_TRUE(region.contains(rect));
+    EXPECT_TRUE(region.contains({{15, 25}, {10, 10}}));
+    EXPECT_FALSE(region.contains({{9, 20}, {30, 40}}));
+    EXPECT_FALSE(region.contains({{10, 21}, {30, 40}}));
+}
+
+TEST(Region, contains_rectangle_spanning_side_by_side_rectangles)
+{
+    mc::Region region;
+
+    region.add({{0, 0}, {50, 100}});
+    region.add({{50, 0}, {50, 100}});
+
+    EXPECT_TRUE(region.contains({{25, 25}, {50, 50}}));
+    EXPECT_THAT(region.rectangles(), ElementsAre(geom::Rectangle{{0, 0}, {100, 100}}));
+}
+
+TEST(Region, contains_rectangle_spanning_stacked_rectangles)
+{
+    mc::Region region;
+
+    region.add({{0, 0}, {100, 50}});
+    region.add({{0, 50}, {100, 50}});
+
+    EXPECT_TRUE(region.contains({{25, 25}, {50, 50}}));
+    EXPECT_THAT(region.rectangles(), ElementsAre(geom::Rectangle{{0, 0}, {100, 100}}));
+}
+
+TEST(Region, does_not_contain_rectangle_over_a_gap)
+{
+    mc::Region region;
+
+    region.add({{0, 0}, {50, 100}});
+    region.add({{51, 0}, {49, 100}});
+
+    EXPECT_FALSE(region.contains({{25, 25}, {50, 50}}));
+
+    region.add({{0, 0}, {100, 50}});
+    region.add({{0, 60}, {100, 40}});
+
+    EXPECT_FALSE(region.contains({{25, 25}, {50, 50}}));
+}
+
+TEST(Region, splits_overlapping_rectangles_into_bands)
+{
+    mc::Region region;
+
+    region.add({{0, 0}, {20, 20}});
+    region.add({{10, 10}, {20, 20}});
+
+    EXPECT_THAT(region.rectangles(), ElementsAre(
+        geom::Rectangle{{0, 0}, {20, 10}},
+        geom::Rectangle{{0, 10}, {30, 10}},
+        geom::Rectangle{{10, 20}, {20, 10}}));
+}
+
+TEST(Region, keeps_disjoint_spans_within_a_band)
+{
+    mc::Region region;
+
+    region.add({{40, 0}, {10, 10}});
+    region.add({{0, 0}, {10, 10}});
+    region.add({{20, 0}, {10, 10}});
+
+    EXPECT_THAT(region.rectangles(), ElementsAre(
+        geom::Rectangle{{0, 0}, {10, 10}},
+        geom::Rectangle{{20, 0}, {10, 10}},
+        geom::Rectangle{{40, 0}, {10, 10}}));
+
+    region.add({{5, 0}, {20, 10}});
+
+    EXPECT_THAT(region.rectangles(), ElementsAre(
+        geom::Rectangle{{0, 0}, {30, 10}},
+        geom::Rectangle{{40, 0}, {10, 10}}));
+}
+
+TEST(Region, representation_does_not_depend_on_order_of_addition)
+{
+    std::vector<geom::Rectangle> const rects{
+        {{0, 0}, {100, 30}},
+        {{0, 30}, {40, 70}},
+        {{60, 30}, {40, 70}},
+        {{40, 80}, {20, 20}},
+        {{30, 20}, {40, 20}}};
+
+    mc::Region forwards;
+    for (auto const& rect : rects)
+        forwards.add(rect);
+
+    mc::Region backwards;
+    for (auto rect = rects.rbegin(); rect != rects.rend(); ++rect)
+        backwards.add(*rect);
+
+    EXPECT_THAT(forwards.rectangles(), Eq(backwards.rectangles()));
+}
+
+TEST(Region, contains_empty_rectangles)
+{
+    mc::Region const region;
+
+    EXPECT_TRUE(region.contains({{10, 10}, {0, 0}}));
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/repaint_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+using namespace testing;
+using namespace std::chrono_literals;
+using std::chrono::nanoseconds;
+using mir::time::PosixTimestamp;
+
+namespace
+{
+struct RepaintScheduler : Test
+{
+    nanoseconds const refresh_interval{16666667};
+    nanoseconds const render_time{4ms};
+    mc::RepaintScheduler::OutputId const output{"My Screen"};
+
+    nanoseconds now{1000s};
+    mg::Frame last_frame;
+
+    mc::RepaintScheduler scheduler{[this](clockid_t clock) { return PosixTimestamp{clock, now}; }};
+
+    auto vblank(int cycles) const -> mg::Frame
+    {
+        mg::Frame frame;
+        frame.msc = last_frame.msc + cycles;
+        frame.ust = PosixTimestamp{CLOCK_MONOTONIC, last_frame.ust.nanoseconds + cycles * refresh_interval};
+        return frame;
+    }
+
+    /// Repaints from now, with post() waiting for the frame to be shown (like KMS); returns whether it missed
+    auto repaint(int cycles_until_shown = 1) -> bool
+    {
+        scheduler.repaint_starting();
+        now += render_time;
+        scheduler.rendered(output, render_time);
+
+        auto const frame = vblank(cycles_until_shown);
+        auto const post_start = PosixTimestamp{CLOCK_MONOTONIC, now};
+        now = frame.ust.nanoseconds;
+        scheduler.posted(post_start, PosixTimestamp{CLOCK_MONOTONIC, now});
+
+        last_frame = frame;
+        return scheduler.presented(output, frame);
+    }
+
+    /// Waits as the scheduler suggests, then repaints
+    auto scheduled_repaint(int cycles_until_shown = 1) -> bool
+    {
+        now += scheduler.delay_before_repaint().value();
+        return repaint(cycles_until_shown);
+    }
+
+    void SetUp() override
+    {
+        last_frame.msc = 1;
+        last_frame.ust = PosixTimestamp{CLOCK_MONOTONIC, now};
+        scheduler.presented(output, last_frame);
+
+        // Give the scheduler a refresh interval to work from
+        repaint();
+    }
+};
+}
+
+TEST_F(RepaintScheduler, has_no_opinion_before_anything_is_presented)
+{
+    mc::RepaintScheduler fresh;
+
+    EXPECT_FALSE(fresh.delay_before_repaint());
+}
+
+TEST_F(RepaintScheduler, has_no_opinion_on_outputs_that_dont_count_frames)
+{
+    mc::RepaintScheduler fresh;
+
+    for (int i = 0; i != 3; ++i)
+    {
+        fresh.repaint_starting();
+        fresh.rendered(output, render_time);
+        fresh.presented(output, mg::Frame{});
+    }
+
+    EXPECT_FALSE(fresh.delay_before_repaint());
+}
+
+TEST_F(RepaintScheduler, starts_repainting_as_late_as_the_work_allows)
+{
+    for (int i = 0; i != 3; ++i)
+        EXPECT_FALSE(repaint());
+
+    auto const delay = scheduler.delay_before_repaint();
+
+    ASSERT_TRUE(delay);
+    EXPECT_THAT(delay.value(), Lt(refresh_interval - render_time));
+    EXPECT_THAT(delay.value(), Gt(refresh_interval - render_time - 2ms));
+}
+
+TEST_F(RepaintScheduler, does_not_count_waiting_for_vblank_as_work)
+{
+    for (int i = 0; i != 3; ++i)
+        repaint();
+
+    // Every post() above ran until the vblank, but that's not time needed before the next one
+    EXPECT_THAT(scheduler.delay_before_repaint().value(), Gt(refresh_interval / 2));
+}
+
+TEST_F(RepaintScheduler, reports_a_missed_vblank)
+{
+    for (int i = 0; i != 3; ++i)
+        EXPECT_FALSE(scheduled_repaint());
+
+    EXPECT_TRUE(scheduled_repaint(2));
+}
+
+TEST_F(RepaintScheduler, starts_earlier_after_a_miss)
+{
+    for (int i = 0; i != 3; ++i)
+        scheduled_repaint();
+
+    auto const before_miss = scheduler.delay_before_repaint().value();
+    scheduled_repaint(2);
+
+    EXPECT_THAT(scheduler.delay_before_repaint().value(), Lt(before_miss));
+}
+
+TEST_F(RepaintScheduler, keeps_to_the_vblank_phase_after_idling)
+{
+    for (int i = 0; i != 3; ++i)
+        repaint();
+
+    auto const since_vblank = 3ms;
+    now += 10 * refresh_interval + since_vblank;
+
+    EXPECT_THAT(scheduler.delay_before_repaint().value(), Lt(refresh_interval - since_vblank - render_time));
+    EXPECT_THAT(scheduler.delay_before_repaint().value(), Gt(refresh_interval - since_vblank - render_time - 2ms));
+}
@@ -19,8 +19,10 @@
 #include "mir/test/doubles/stub_buffer.h"
 #include "mir/test/doubles/stub_buffer_allocator.h"
 #include "mir/test/doubles/mock_event_sink.h"
+#include "mir/test/doubles/mock_compositor_report.h"
 #include "mir/test/fake_shared.h"
 #include "src/server/compositor/stream.h"
+#include "src/server/report/null_report_factory.h"
 #include "mir/scene/null_surface_observer.h"
 
 #include <gmock/gmock.h>
@@ -33,6 +35,7 @@ namespace mtd = mir::test::doubles;
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace geom = mir::geometry;
+namespace mr = mir::report;
 namespace
 {
 struct Stream : Test
@@ -51,7 +54,7 @@ struct Stream : Test
     std::vector<std::shared_ptr<mg::Buffer>> buffers;
     MirPixelFormat construction_format{mir_pixel_format_rgb_565};
     mc::Stream stream{
-        initial_size, construction_format};
+        initial_size, construction_format, mr::null_compositor_report()};
 };
 }
 
@@ -241,3 +244,69 @@ TEST_F(Stream, stream_remembers_scale_when_buffer_added)
     stream.submit_buffer(buffers[0]);
     ASSERT_THAT(stream.stream_size(), Eq(initial_size / 2));
 }
+
+TEST_F(Stream, reports_damage_submitted_with_buffer)
+{
+    geom::Rectangle const damage{{1, 0}, {2, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], geom::Rectangles{damage});
+
+    EXPECT_THAT(stream.damage_between(buffers[0]->id(), buffers[1]->id()), Eq(geom::Rectangles{damage}));
+}
+
+TEST_F(Stream, accumulates_damage_of_skipped_buffers)
+{
+    geom::Rectangle const first_damage{{1, 0}, {2, 1}};
+    geom::Rectangle const second_damage{{10, 1}, {4, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], geom::Rectangles{first_damage});
+    stream.submit_buffer(buffers[2], geom::Rectangles{second_damage});
+
+    EXPECT_THAT(
+        stream.damage_between(buffers[0]->id(), buffers[2]->id()),
+        Eq(geom::Rectangles{first_damage, second_damage}));
+}
+
+TEST_F(Stream, damage_is_unknown_if_any_buffer_was_submitted_without_damage)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1]);
+    stream.submit_buffer(buffers[2], geom::Rectangles{{{1, 0}, {2, 1}}});
+
+    EXPECT_FALSE(stream.damage_between(buffers[0]->id(), buffers[2]->id()));
+}
+
+TEST_F(Stream, damage_is_unknown_for_buffers_not_submitted)
+{
+    mtd::StubBuffer other_buffer{initial_size};
+
+    stream.submit_buffer(buffers[0], geom::Rectangles{{{1, 0}, {2, 1}}});
+
+    EXPECT_FALSE(stream.damage_between(other_buffer.id(), buffers[0]->id()));
+}
+
+TEST_F(Stream, damage_is_unknown_across_a_resize)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(
+        std::make_shared<mtd::StubBuffer>(geom::Size{88, 4}),
+        geom::Rectangles{{{1, 0}, {2, 1}}});
+    stream.submit_buffer(buffers[1], geom::Rectangles{{{1, 0}, {2, 1}}});
+
+    EXPECT_FALSE(stream.damage_between(buffers[0]->id(), buffers[1]->id()));
+}
+
+TEST_F(Stream, reports_submitted_buffers_against_its_renderable_id)
+{
+    auto const report = std::make_shared<NiceMock<mtd::MockCompositorReport>>();
+    mc::Stream reporting_stream{initial_size, construction_format, report};
+    mc::BufferStream const& as_buffer_stream = reporting_stream;
+
+    EXPECT_CALL(*report, submitted_buffer(&as_buffer_stream, buffers[0]->id()));
+    EXPECT_CALL(*report, submitted_buffer(&as_buffer_stream, buffers[1]->id()));
+
+    reporting_stream.submit_buffer(buffers[0]);
+    reporting_stream.submit_buffer(buffers[1]);
+}
@@ -490,3 +490,79 @@ TEST(MultiplexingDispatchableTest, automatic_removals_are_threadsafe)
     
     dispatchee->trigger();
 }
+
+TEST(MultiplexingDispatchableTest, rejects_invalid_batch_sizes)
+{
+    EXPECT_THROW(md::MultiplexingDispatchable(0), std::logic_error);
+    EXPECT_THROW(md::MultiplexingDispatchable(md::MultiplexingDispatchable::max_batched_events + 1), std::logic_error);
+}
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_handles_all_ready_dispatchees_in_one_call)
+{
+    int const dispatchee_count{5};
+    int dispatched{0};
+
+    md::MultiplexingDispatchable dispatcher(8);
+    for (int i = 0; i < dispatchee_count; ++i)
+    {
+        auto dispatchee = std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; });
+        dispatcher.add_watch(dispatchee);
+        dispatchee->trigger();
+    }
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, testing::Eq(dispatchee_count));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_rearms_sequential_dispatchees)
+{
+    int a_dispatched{0};
+    auto dispatchee_a = std::make_shared<mt::TestDispatchable>([&a_dispatched]() { ++a_dispatched; });
+    int b_dispatched{0};
+    auto dispatchee_b = std::make_shared<mt::TestDispatchable>([&b_dispatched]() { ++b_dispatched; });
+
+    md::MultiplexingDispatchable dispatcher(8);
+    dispatcher.add_watch(dispatchee_a);
+    dispatcher.add_watch(dispatchee_b);
+
+    dispatchee_a->trigger();
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+    dispatchee_b->trigger();
+
+    dispatcher.dispatch(md::FdEvent::readable);
+    EXPECT_THAT(a_dispatched, testing::Eq(1));
+    EXPECT_THAT(b_dispatched, testing::Eq(1));
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+    EXPECT_THAT(a_dispatched, testing::Eq(2));
+    EXPECT_THAT(b_dispatched, testing::Eq(2));
+}
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_rearms_rest_of_batch_when_dispatch_throws)
+{
+    auto throwing_dispatchee = std::make_shared<mt::TestDispatchable>(
+        [](md::FdEvents) -> bool { throw std::runtime_error{"Out of cheese"}; });
+    bool dispatched{false};
+    auto dispatchee = std::make_shared<mt::TestDispatchable>([&dispatched]() { dispatched = true; });
+
+    md::MultiplexingDispatchable dispatcher(8);
+    dispatcher.add_watch(throwing_dispatchee);
+    dispatcher.add_watch(dispatchee);
+
+    throwing_dispatchee->trigger();
+    dispatchee->trigger();
+    dispatchee->trigger();
+
+    EXPECT_THROW(dispatcher.dispatch(md::FdEvent::readable), std::runtime_error);
+
+    dispatched = false;
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_TRUE(dispatched);
+}
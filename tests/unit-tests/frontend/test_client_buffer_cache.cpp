@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend/client_buffer_cache.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+size_t const buffer_bytes = 100 * 100 * 4;
+
+auto a_buffer() -> std::shared_ptr<mg::Buffer>
+{
+    return std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{geom::Size{100, 100}, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+}
+}
+
+TEST(ClientBufferCache, accounts_for_buffers_inserted_and_released)
+{
+    mf::ClientBufferCache cache{0, ms::BufferMemoryPolicy::reject};
+
+    auto const first = a_buffer();
+    auto second = a_buffer();
+    auto const second_id = second->id();
+
+    cache.insert(first);
+    cache.insert(second);
+    second.reset();
+
+    EXPECT_THAT(cache.usage().buffers, Eq(2u));
+    EXPECT_THAT(cache.usage().bytes, Eq(2 * buffer_bytes));
+
+    cache.release(second_id);
+
+    EXPECT_THAT(cache.usage().buffers, Eq(1u));
+    EXPECT_THAT(cache.usage().bytes, Eq(buffer_bytes));
+    EXPECT_THROW(cache.at(second_id), std::out_of_range);
+    EXPECT_THAT(cache.at(first->id()), Eq(first));
+}
+
+TEST(ClientBufferCache, released_buffer_counts_until_the_server_has_finished_with_it)
+{
+    mf::ClientBufferCache cache{0, ms::BufferMemoryPolicy::reject};
+    auto on_screen = a_buffer();
+
+    cache.insert(on_screen);
+    cache.release(on_screen->id());
+
+    EXPECT_THROW(cache.at(on_screen->id()), std::out_of_range);
+    EXPECT_THAT(cache.usage().buffers, Eq(1u));
+
+    on_screen.reset();
+    cache.insert(a_buffer());
+
+    EXPECT_THAT(cache.usage().buffers, Eq(1u));
+    EXPECT_THAT(cache.usage().bytes, Eq(buffer_bytes));
+    EXPECT_THAT(cache.usage().evicted, Eq(0u));
+}
+
+TEST(ClientBufferCache, zero_limit_is_unlimited)
+{
+    mf::ClientBufferCache cache{0, ms::BufferMemoryPolicy::reject};
+
+    for (auto i = 0; i != 100; ++i)
+        EXPECT_NO_THROW(cache.insert(a_buffer()));
+
+    EXPECT_THAT(cache.usage().bytes, Eq(100 * buffer_bytes));
+    EXPECT_THAT(cache.usage().rejected, Eq(0u));
+}
+
+TEST(ClientBufferCache, reject_policy_refuses_buffers_over_the_limit)
+{
+    mf::ClientBufferCache cache{2 * buffer_bytes, ms::BufferMemoryPolicy::reject};
+    cache.insert(a_buffer());
+    cache.insert(a_buffer());
+
+    EXPECT_THROW(cache.insert(a_buffer()), std::runtime_error);
+    EXPECT_THAT(cache.usage().buffers, Eq(2u));
+    EXPECT_THAT(cache.usage().rejected, Eq(1u));
+    EXPECT_THAT(cache.usage().evicted, Eq(0u));
+}
+
+TEST(ClientBufferCache, reject_policy_counts_released_buffers_the_server_is_using)
+{
+    mf::ClientBufferCache cache{2 * buffer_bytes, ms::BufferMemoryPolicy::reject};
+    auto const on_screen = a_buffer();
+
+    cache.insert(on_screen);
+    cache.insert(a_buffer());
+    cache.release(on_screen->id());
+
+    EXPECT_THROW(cache.insert(a_buffer()), std::runtime_error);
+    EXPECT_THAT(cache.usage().evicted, Eq(0u));
+}
+
+TEST(ClientBufferCache, evict_policy_never_drops_buffers_the_client_holds)
+{
+    mf::ClientBufferCache cache{2 * buffer_bytes, ms::BufferMemoryPolicy::evict_least_recently_used};
+    auto first = a_buffer();
+    auto second = a_buffer();
+    auto const first_id = first->id();
+    auto const second_id = second->id();
+
+    cache.insert(first);
+    cache.insert(second);
+
+    // Leave the cache holding the only references: the client could still submit either
+    first.reset();
+    second.reset();
+
+    EXPECT_THROW(cache.insert(a_buffer()), std::runtime_error);
+    EXPECT_NO_THROW(cache.at(first_id));
+    EXPECT_NO_THROW(cache.at(second_id));
+    EXPECT_THAT(cache.usage().evicted, Eq(0u));
+    EXPECT_THAT(cache.usage().rejected, Eq(1u));
+}
+
+TEST(ClientBufferCache, evict_policy_drops_least_recently_used_released_buffer)
+{
+    mf::ClientBufferCache cache{3 * buffer_bytes, ms::BufferMemoryPolicy::evict_least_recently_used};
+    auto const older = a_buffer();
+    auto const newer = a_buffer();
+    auto const held = a_buffer();
+
+    cache.insert(older);
+    cache.insert(newer);
+    cache.insert(held);
+    cache.at(newer->id());
+    cache.release(older->id());
+    cache.release(newer->id());
+
+    EXPECT_NO_THROW(cache.insert(a_buffer()));
+    EXPECT_THAT(cache.usage().buffers, Eq(3u));
+    EXPECT_THAT(cache.usage().evicted, Eq(1u));
+
+    EXPECT_NO_THROW(cache.insert(a_buffer()));
+    EXPECT_THAT(cache.usage().buffers, Eq(3u));
+    EXPECT_THAT(cache.usage().evicted, Eq(2u));
+    EXPECT_THAT(cache.at(held->id()), Eq(held));
+}
+
+TEST(ClientBufferCache, evict_policy_rejects_without_evicting_if_not_enough_can_be_freed)
+{
+    mf::ClientBufferCache cache{2 * buffer_bytes, ms::BufferMemoryPolicy::evict_least_recently_used};
+    auto const held = a_buffer();
+    auto const released = a_buffer();
+
+    cache.insert(held);
+    cache.insert(released);
+    cache.release(released->id());
+
+    auto const big = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{geom::Size{200, 100}, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+
+    EXPECT_THROW(cache.insert(big), std::runtime_error);
+    EXPECT_THAT(cache.usage().buffers, Eq(2u));
+    EXPECT_THAT(cache.usage().evicted, Eq(0u));
+    EXPECT_THAT(cache.usage().rejected, Eq(1u));
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend/session_mediator.h"
+#include "src/server/frontend/resource_cache.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/frontend/connection_context.h"
+#include "mir/frontend/mir_client_session.h"
+#include "mir/frontend/shell.h"
+#include "mir/scene/buffer_memory_accounting.h"
+#include "mir/cookie/authority.h"
+#include "mir/input/mir_input_config.h"
+#include "mir/optional_value.h"
+
+#include "mir/test/doubles/explicit_executor.h"
+#include "mir/test/doubles/mock_buffer_stream.h"
+#include "mir/test/doubles/mock_event_sink.h"
+#include "mir/test/doubles/mock_event_sink_factory.h"
+#include "mir/test/doubles/mock_input_config_changer.h"
+#include "mir/test/doubles/mock_platform_ipc_operations.h"
+#include "mir/test/doubles/null_application_not_responding_detector.h"
+#include "mir/test/doubles/null_display_changer.h"
+#include "mir/test/doubles/null_message_sender.h"
+#include "mir/test/doubles/null_screencast.h"
+#include "mir/test/doubles/stub_buffer_allocator.h"
+#include "mir/test/doubles/stub_mir_client_session.h"
+#include "mir/test/doubles/stub_session.h"
+
+#include "mir_protobuf.pb.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+int const buffer_width = 100;
+int const buffer_height = 100;
+size_t const buffer_bytes = buffer_width * buffer_height * 4;
+
+struct NullClosure : google::protobuf::Closure
+{
+    void Run() override {}
+};
+
+struct StreamingSession : mtd::StubMirClientSession
+{
+    auto buffer_stream(mf::BufferStreamId) const -> std::shared_ptr<mir::compositor::BufferStream> override
+    {
+        return stream;
+    }
+
+    std::shared_ptr<NiceMock<mtd::MockBufferStream>> const stream{std::make_shared<NiceMock<mtd::MockBufferStream>>()};
+};
+
+/// Opens a single session with a single stream
+struct StubFrontendShell : mf::Shell
+{
+    auto open_session(pid_t, std::string const&, std::shared_ptr<mf::EventSink> const&)
+        -> std::shared_ptr<mf::MirClientSession> override
+    {
+        return mir_client_session;
+    }
+
+    void close_session(std::shared_ptr<mf::MirClientSession> const&) override {}
+
+    auto scene_session_for(std::shared_ptr<mf::MirClientSession> const&) -> std::shared_ptr<ms::Session> override
+    {
+        return scene_session;
+    }
+
+    auto start_prompt_session_for(std::shared_ptr<ms::Session> const&, ms::PromptSessionCreationParameters const&)
+        -> std::shared_ptr<mf::PromptSession> override
+    {
+        return nullptr;
+    }
+
+    void add_prompt_provider_for(std::shared_ptr<mf::PromptSession> const&, std::shared_ptr<ms::Session> const&) override {}
+    void stop_prompt_session(std::shared_ptr<mf::PromptSession> const&) override {}
+
+    auto create_surface(
+        std::shared_ptr<mf::MirClientSession> const&,
+        ms::SurfaceCreationParameters const&,
+        std::shared_ptr<mf::EventSink> const&) -> mf::SurfaceId override
+    {
+        return {};
+    }
+
+    void modify_surface(
+        std::shared_ptr<mf::MirClientSession> const&,
+        mf::SurfaceId,
+        mir::shell::SurfaceSpecification const&) override {}
+    void destroy_surface(std::shared_ptr<mf::MirClientSession> const&, mf::SurfaceId) override {}
+
+    auto persistent_id_for(std::shared_ptr<mf::MirClientSession> const&, mf::SurfaceId) -> std::string override
+    {
+        return {};
+    }
+
+    auto surface_for_id(std::string const&) -> std::shared_ptr<ms::Surface> override
+    {
+        return nullptr;
+    }
+
+    int set_surface_attribute(std::shared_ptr<mf::MirClientSession> const&, mf::SurfaceId, MirWindowAttrib, int value) override
+    {
+        return value;
+    }
+
+    int get_surface_attribute(std::shared_ptr<mf::MirClientSession> const&, mf::SurfaceId, MirWindowAttrib) override
+    {
+        return 0;
+    }
+
+    void request_operation(
+        std::shared_ptr<mf::MirClientSession> const&,
+        mf::SurfaceId, uint64_t,
+        UserRequest,
+        mir::optional_value<uint32_t>) override {}
+
+    std::shared_ptr<StreamingSession> const mir_client_session{std::make_shared<StreamingSession>()};
+    std::shared_ptr<ms::Session> const scene_session{std::make_shared<mtd::StubSession>()};
+};
+
+struct SessionMediator : Test
+{
+    SessionMediator()
+    {
+        ON_CALL(*sink, add_buffer(_)).WillByDefault(Invoke(
+            [this](mg::Buffer& buffer) { allocated.push_back(buffer.id()); }));
+
+        mir::protobuf::ConnectParameters parameters;
+        parameters.set_application_name("client");
+        mir::protobuf::Connection connection;
+        mediator.connect(&parameters, &connection, &done);
+    }
+
+    ~SessionMediator()
+    {
+        executor.execute();
+    }
+
+    void allocate(int count)
+    {
+        mir::protobuf::BufferAllocation request;
+        for (auto i = 0; i != count; ++i)
+        {
+            auto const buffer = request.add_buffer_requests();
+            buffer->set_width(buffer_width);
+            buffer->set_height(buffer_height);
+            buffer->set_pixel_format(mir_pixel_format_argb_8888);
+            buffer->set_buffer_usage(static_cast<int>(mg::BufferUsage::software));
+        }
+        mediator.allocate_buffers(&request, nullptr, &done);
+    }
+
+    void release(mg::BufferID id)
+    {
+        mir::protobuf::BufferRelease request;
+        request.add_buffers()->set_buffer_id(id.as_value());
+        mediator.release_buffers(&request, nullptr, &done);
+    }
+
+    void submit(mg::BufferID id)
+    {
+        mir::protobuf::BufferRequest request;
+        request.mutable_id()->set_value(0);
+        request.mutable_buffer()->set_buffer_id(id.as_value());
+        mediator.submit_buffer(&request, nullptr, &done);
+    }
+
+    auto usage() const -> ms::BufferMemoryUsage
+    {
+        return buffer_memory->usage_of(shell->scene_session.get());
+    }
+
+    NullClosure done;
+    std::shared_ptr<StubFrontendShell> const shell{std::make_shared<StubFrontendShell>()};
+    std::shared_ptr<mtd::MockEventSinkFactory> const sink_factory{std::make_shared<mtd::MockEventSinkFactory>()};
+    std::shared_ptr<mtd::MockEventSink> const sink{sink_factory->the_mock_sink()};
+    std::shared_ptr<NiceMock<mtd::MockInputConfigurationChanger>> const input_changer{
+        std::make_shared<NiceMock<mtd::MockInputConfigurationChanger>>()};
+    std::shared_ptr<ms::BufferMemoryAccounting> const buffer_memory{std::make_shared<ms::BufferMemoryAccounting>(
+        2 * buffer_bytes, ms::BufferMemoryPolicy::evict_least_recently_used)};
+    mtd::ExplicitExectutor executor;
+    std::vector<mg::BufferID> allocated;
+
+    mf::SessionMediator mediator{
+        shell,
+        std::make_shared<NiceMock<mtd::MockPlatformIpcOperations>>(),
+        std::make_shared<mtd::NullDisplayChanger>(),
+        {},
+        mir::report::null_session_mediator_report(),
+        sink_factory,
+        std::make_shared<mtd::NullMessageSender>(),
+        std::make_shared<mf::ResourceCache>(),
+        std::make_shared<mtd::NullScreencast>(),
+        mf::ConnectionContext{nullptr},
+        nullptr,
+        nullptr,
+        std::make_shared<mtd::NullANRDetector>(),
+        mir::cookie::Authority::create(),
+        input_changer,
+        {},
+        std::make_shared<mtd::StubBufferAllocator>(),
+        buffer_memory,
+        executor};
+};
+}
+
+TEST_F(SessionMediator, allocation_over_the_limit_is_refused_rather_than_dropping_buffers_the_client_holds)
+{
+    EXPECT_CALL(*sink, error_buffer(_, _, _)).Times(1);
+
+    allocate(3);
+
+    ASSERT_THAT(allocated.size(), Eq(2u));
+    EXPECT_NO_THROW(submit(allocated[0]));
+    EXPECT_NO_THROW(submit(allocated[1]));
+    EXPECT_THAT(usage().evicted, Eq(0u));
+    EXPECT_THAT(usage().rejected, Eq(1u));
+}
+
+TEST_F(SessionMediator, buffers_released_by_the_client_make_room)
+{
+    EXPECT_CALL(*sink, error_buffer(_, _, _)).Times(0);
+
+    allocate(2);
+    ASSERT_THAT(allocated.size(), Eq(2u));
+    release(allocated[0]);
+    allocate(1);
+
+    ASSERT_THAT(allocated.size(), Eq(3u));
+    EXPECT_THROW(submit(allocated[0]), std::out_of_range);
+    EXPECT_NO_THROW(submit(allocated[1]));
+    EXPECT_NO_THROW(submit(allocated[2]));
+    EXPECT_THAT(usage().buffers, Eq(2u));
+}
+
+TEST_F(SessionMediator, released_buffer_still_on_screen_is_evicted_to_make_room)
+{
+    std::shared_ptr<mg::Buffer> on_screen;
+    ON_CALL(*shell->mir_client_session->stream, submit_buffer(_))
+        .WillByDefault(SaveArg<0>(&on_screen));
+    EXPECT_CALL(*sink, error_buffer(_, _, _)).Times(0);
+
+    allocate(2);
+    ASSERT_THAT(allocated.size(), Eq(2u));
+    submit(allocated[0]);
+    release(allocated[0]);
+
+    EXPECT_THAT(usage().buffers, Eq(2u));
+
+    allocate(1);
+
+    EXPECT_THAT(allocated.size(), Eq(3u));
+    EXPECT_THAT(usage().buffers, Eq(2u));
+    EXPECT_THAT(usage().evicted, Eq(1u));
+}
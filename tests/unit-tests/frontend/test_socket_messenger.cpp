@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend/socket_messenger.h"
+#include "mir/fd_socket_transmission.h"
+
+#include <boost/asio.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace ba = boost::asio;
+
+using namespace testing;
+
+namespace
+{
+// As big as a message gets: the length has to fit in the two byte header
+size_t const big_message{60000};
+
+struct SocketMessenger : Test
+{
+    SocketMessenger()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+            throw std::system_error(errno, std::system_category(), "Failed to create socket pair");
+
+        client = mir::Fd{fds[1]};
+        messenger = std::make_shared<mfd::SocketMessenger>(
+            std::make_shared<ba::local::stream_protocol::socket>(io, ba::local::stream_protocol(), fds[0]));
+    }
+
+    ~SocketMessenger()
+    {
+        if (io_thread.joinable())
+            io_thread.join();
+    }
+
+    /// Flushes whatever the messenger queued, as the client reads it
+    void write_out_queue()
+    {
+        io_thread = std::thread{[this] { io.run(); }};
+    }
+
+    std::vector<char> message_of(size_t length, char fill)
+    {
+        return std::vector<char>(length, fill);
+    }
+
+    /// Reads a message (which must carry no fds) as a client would
+    std::vector<char> receive_message()
+    {
+        unsigned char header[2];
+        std::vector<mir::Fd> no_fds;
+        mir::receive_data(client, header, sizeof header, no_fds);
+
+        std::vector<char> message((header[0] << 8) | header[1]);
+        if (!message.empty())
+            mir::receive_data(client, message.data(), message.size(), no_fds);
+        return message;
+    }
+
+    std::vector<mir::Fd> receive_fds(size_t count)
+    {
+        char carrier;
+        std::vector<mir::Fd> fds(count);
+        mir::receive_data(client, &carrier, 1, fds);
+        return fds;
+    }
+
+    static bool same_file(mir::Fd const& lhs, mir::Fd const& rhs)
+    {
+        struct stat lhs_stat, rhs_stat;
+        fstat(lhs, &lhs_stat);
+        fstat(rhs, &rhs_stat);
+        return lhs_stat.st_dev == rhs_stat.st_dev && lhs_stat.st_ino == rhs_stat.st_ino;
+    }
+
+    ba::io_service io;
+    mir::Fd client;
+    std::shared_ptr<mfd::SocketMessenger> messenger;
+    std::thread io_thread;
+};
+}
+
+TEST_F(SocketMessenger, sends_message_with_header)
+{
+    auto const message = message_of(100, 'a');
+
+    messenger->send(message.data(), message.size(), {});
+
+    EXPECT_THAT(receive_message(), Eq(message));
+}
+
+TEST_F(SocketMessenger, does_not_block_when_the_socket_buffer_is_full)
+{
+    auto const message = message_of(big_message, 'a');
+
+    // Far more than the socket buffers hold, with nothing reading
+    for (auto i = 0; i != 40; ++i)
+        messenger->send(message.data(), message.size(), {});
+
+    write_out_queue();
+
+    for (auto i = 0; i != 40; ++i)
+        ASSERT_THAT(receive_message(), Eq(message)) << "message " << i;
+}
+
+TEST_F(SocketMessenger, keeps_messages_and_fds_in_order_across_partial_writes)
+{
+    auto const filler = message_of(big_message, 'f');
+    auto const with_fds = message_of(10, 'w');
+    auto const after = message_of(20, 'x');
+    mir::Fd const fd{::dup(STDOUT_FILENO)};
+
+    // Fill the socket so the rest is written from the queue in pieces
+    for (auto i = 0; i != 10; ++i)
+        messenger->send(filler.data(), filler.size(), {});
+    messenger->send(with_fds.data(), with_fds.size(), {{fd}});
+    messenger->send(after.data(), after.size(), {});
+
+    write_out_queue();
+
+    for (auto i = 0; i != 10; ++i)
+        ASSERT_THAT(receive_message(), Eq(filler)) << "message " << i;
+
+    // receive_message() throws if fds arrive with the payload rather than after it
+    EXPECT_THAT(receive_message(), Eq(with_fds));
+    auto const received = receive_fds(1);
+    EXPECT_TRUE(same_file(received[0], fd));
+    EXPECT_THAT(receive_message(), Eq(after));
+}
+
+TEST_F(SocketMessenger, sends_each_fd_set_after_the_message)
+{
+    auto const message = message_of(10, 'm');
+    mir::Fd const first{::dup(STDOUT_FILENO)};
+    mir::Fd const second{::dup(STDERR_FILENO)};
+    mir::Fd const third{::dup(STDIN_FILENO)};
+
+    messenger->send(message.data(), message.size(), {{first, second}, {third}});
+
+    EXPECT_THAT(receive_message(), Eq(message));
+
+    auto const first_set = receive_fds(2);
+    EXPECT_TRUE(same_file(first_set[0], first));
+    EXPECT_TRUE(same_file(first_set[1], second));
+
+    auto const second_set = receive_fds(1);
+    EXPECT_TRUE(same_file(second_set[0], third));
+}
+
+TEST_F(SocketMessenger, throws_when_the_client_lets_too_much_queue_up)
+{
+    auto const message = message_of(big_message, 'a');
+
+    // Over 4MiB, more than the socket buffers could ever hold
+    EXPECT_THROW(
+        {
+            for (auto i = 0; i != 100; ++i)
+                messenger->send(message.data(), message.size(), {});
+        },
+        std::runtime_error);
+}
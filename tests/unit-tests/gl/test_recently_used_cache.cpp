@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/gl/recently_used_cache.h"
+#include "mir/renderer/gl/incremental_texture_source.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/mock_gl_buffer.h"
+#include "mir/test/doubles/mock_gl.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mgl = mir::gl;
+namespace mg = mir::graphics;
+namespace mrgl = mir::renderer::gl;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+struct MockIncrementalGLBuffer : mtd::MockGLBuffer, mrgl::IncrementalTextureSource
+{
+    MockIncrementalGLBuffer(geom::Size size, mg::BufferID id)
+        : MockGLBuffer{size, geom::Stride{size.width.as_int() * 4}, mir_pixel_format_argb_8888}
+    {
+        ON_CALL(*this, id()).WillByDefault(Return(id));
+        ON_CALL(*this, contents_readable()).WillByDefault(Return(true));
+    }
+
+    MOCK_METHOD1(bind_damage, void(geom::Rectangles const&));
+    MOCK_CONST_METHOD0(contents_readable, bool());
+};
+
+struct RecentlyUsedCache : Test
+{
+    geom::Size const size{640, 480};
+    geom::Rectangles const damage{{{10, 20}, {30, 40}}};
+
+    std::shared_ptr<MockIncrementalGLBuffer> const first_buffer{
+        std::make_shared<NiceMock<MockIncrementalGLBuffer>>(size, mg::BufferID{1})};
+    std::shared_ptr<MockIncrementalGLBuffer> const second_buffer{
+        std::make_shared<NiceMock<MockIncrementalGLBuffer>>(size, mg::BufferID{2})};
+    mtd::FakeRenderable renderable{{{0, 0}, size}};
+
+    NiceMock<mtd::MockGL> mock_gl;
+    mgl::RecentlyUsedCache cache;
+};
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_of_first_buffer)
+{
+    renderable.set_buffer(first_buffer);
+    renderable.set_damage(damage);
+
+    EXPECT_CALL(*first_buffer, bind());
+    EXPECT_CALL(*first_buffer, bind_damage(_)).Times(0);
+
+    cache.load(renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_only_damage_of_same_sized_buffer)
+{
+    renderable.set_buffer(first_buffer);
+    cache.load(renderable);
+
+    renderable.set_buffer(second_buffer);
+    renderable.set_damage(damage);
+
+    EXPECT_CALL(*second_buffer, bind()).Times(0);
+    EXPECT_CALL(*second_buffer, bind_damage(Eq(damage)));
+
+    cache.load(renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_when_damage_is_unknown)
+{
+    renderable.set_buffer(first_buffer);
+    cache.load(renderable);
+
+    renderable.set_buffer(second_buffer);
+    renderable.set_damage({});
+
+    EXPECT_CALL(*second_buffer, bind());
+    EXPECT_CALL(*second_buffer, bind_damage(_)).Times(0);
+
+    cache.load(renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_when_size_changes)
+{
+    auto const resized_buffer =
+        std::make_shared<NiceMock<MockIncrementalGLBuffer>>(geom::Size{800, 600}, mg::BufferID{3});
+
+    renderable.set_buffer(first_buffer);
+    cache.load(renderable);
+
+    renderable.set_buffer(resized_buffer);
+    renderable.set_damage(damage);
+
+    EXPECT_CALL(*resized_buffer, bind());
+    EXPECT_CALL(*resized_buffer, bind_damage(_)).Times(0);
+
+    cache.load(renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_after_invalidation)
+{
+    renderable.set_buffer(first_buffer);
+    cache.load(renderable);
+    cache.invalidate();
+
+    renderable.set_buffer(second_buffer);
+    renderable.set_damage(damage);
+
+    EXPECT_CALL(*second_buffer, bind());
+    EXPECT_CALL(*second_buffer, bind_damage(_)).Times(0);
+
+    cache.load(renderable);
+}
+
+TEST_F(RecentlyUsedCache, does_not_reupload_unchanged_buffer)
+{
+    renderable.set_buffer(first_buffer);
+    cache.load(renderable);
+
+    EXPECT_CALL(*first_buffer, bind()).Times(0);
+    EXPECT_CALL(*first_buffer, bind_damage(_)).Times(0);
+
+    cache.load(renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_after_one_whose_contents_were_lost)
+{
+    ON_CALL(*first_buffer, contents_readable()).WillByDefault(Return(false));
+    renderable.set_buffer(first_buffer);
+    cache.load(renderable);
+
+    renderable.set_buffer(second_buffer);
+    renderable.set_damage(damage);
+
+    EXPECT_CALL(*second_buffer, bind());
+    EXPECT_CALL(*second_buffer, bind_damage(_)).Times(0);
+
+    cache.load(renderable);
+}
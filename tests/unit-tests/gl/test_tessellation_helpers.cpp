@@ -147,3 +147,69 @@ TEST_F(Tessellation, tex_coords_0_or_1_when_transformed)
     mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {x, y});
     expect_tex_coords_1_or_0(primitive);
 }
+
+TEST_F(Tessellation, without_opaque_region_is_a_single_translucent_rectangle)
+{
+    std::vector<mgl::Primitive> primitives;
+    mgl::tessellate_renderable_by_opacity(primitives, renderable, {});
+
+    ASSERT_THAT(primitives.size(), Eq(1u));
+    EXPECT_THAT(bounding_box(primitives[0]), Eq(BoundingBox::from(rect)));
+    EXPECT_FALSE(primitives[0].opaque);
+}
+
+TEST_F(Tessellation, entirely_opaque_region_is_a_single_opaque_rectangle)
+{
+    ON_CALL(renderable, opaque_region())
+        .WillByDefault(Return(geom::Rectangles{rect}));
+
+    std::vector<mgl::Primitive> primitives;
+    mgl::tessellate_renderable_by_opacity(primitives, renderable, {});
+
+    ASSERT_THAT(primitives.size(), Eq(1u));
+    EXPECT_THAT(bounding_box(primitives[0]), Eq(BoundingBox::from(rect)));
+    EXPECT_TRUE(primitives[0].opaque);
+    expect_tex_coords_1_or_0(primitives[0]);
+}
+
+TEST_F(Tessellation, opaque_region_is_split_from_translucent_border)
+{
+    geom::Rectangle const inner{{6, 10}, {6, 12}};
+    ON_CALL(renderable, opaque_region())
+        .WillByDefault(Return(geom::Rectangles{inner}));
+
+    std::vector<mgl::Primitive> primitives;
+    mgl::tessellate_renderable_by_opacity(primitives, renderable, {});
+
+    std::vector<BoundingBox> opaque_boxes;
+    float translucent_area{0};
+    for (auto const& primitive : primitives)
+    {
+        auto const box = bounding_box(primitive);
+        if (primitive.opaque)
+            opaque_boxes.push_back(box);
+        else
+            translucent_area += (box.right - box.left) * (box.bottom - box.top);
+    }
+
+    EXPECT_THAT(opaque_boxes, ElementsAre(BoundingBox::from(inner)));
+    EXPECT_THAT(translucent_area, Eq(10 * 20 - 6 * 12));
+}
+
+TEST_F(Tessellation, opaque_pieces_sample_matching_part_of_texture)
+{
+    geom::Rectangle const right_half{{9, 6}, {5, 20}};
+    ON_CALL(renderable, opaque_region())
+        .WillByDefault(Return(geom::Rectangles{right_half}));
+
+    std::vector<mgl::Primitive> primitives;
+    mgl::tessellate_renderable_by_opacity(primitives, renderable, {});
+
+    ASSERT_THAT(primitives.size(), Eq(2u));
+    auto const& opaque = primitives[0].opaque ? primitives[0] : primitives[1];
+    for (int i = 0; i < opaque.nvertices; i++)
+    {
+        EXPECT_THAT(opaque.vertices[i].texcoord[0], AnyOf(Eq(0.5f), Eq(1.0f)));
+        EXPECT_THAT(opaque.vertices[i].texcoord[1], AnyOf(Eq(0.0f), Eq(1.0f)));
+    }
+}
@@ -3,6 +3,9 @@
 #include "src/server/graphics/offscreen/display.h"
 #include "mir/graphics/default_display_configuration_policy.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
+#include "src/renderers/software/renderer.h"
+#include "src/renderers/software/renderer_factory.h"
 #include "src/server/report/null_report_factory.h"
 
 #include "mir/test/doubles/mock_egl.h"
@@ -19,6 +22,7 @@ namespace mgo=mir::graphics::offscreen;
 namespace mtd=mir::test::doubles;
 namespace mr = mir::report;
 namespace mt = mir::test;
+namespace mrs = mir::renderer::software;
 
 namespace
 {
@@ -173,3 +177,69 @@ TEST_F(OffscreenDisplayTest, restores_previous_state_on_fbo_setup_failure)
             mr::null_display_report());
     }, std::runtime_error);
 }
+
+TEST_F(OffscreenDisplayTest, display_buffers_are_software_render_targets)
+{
+    using namespace ::testing;
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+
+    int count = 0;
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            ++count;
+            auto const target = dynamic_cast<mrs::RenderTarget*>(db.native_display_buffer());
+            ASSERT_THAT(target, NotNull());
+            EXPECT_THAT(target->size(), Eq(db.view_area().size));
+
+            target->write([&](unsigned char* pixels, mir::geometry::Stride stride)
+                {
+                    EXPECT_THAT(stride.as_int(), Eq(4 * db.view_area().size.width.as_int()));
+                    pixels[0] = 0x42;
+                });
+            target->swap_buffers();
+
+            // The software renderer relies on the previous frame still being there
+            target->write([&](unsigned char* pixels, mir::geometry::Stride)
+                {
+                    EXPECT_THAT(pixels[0], Eq(0x42));
+                });
+        });
+    });
+
+    EXPECT_TRUE(count);
+}
+
+TEST_F(OffscreenDisplayTest, software_renderer_draws_to_display_buffers)
+{
+    using namespace ::testing;
+
+    struct FailingFactory : mir::renderer::RendererFactory
+    {
+        std::unique_ptr<mir::renderer::Renderer> create_renderer_for(mg::DisplayBuffer&) override
+        {
+            ADD_FAILURE() << "Software renderer fell back";
+            return nullptr;
+        }
+    };
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+    mrs::RendererFactory factory{std::make_shared<FailingFactory>()};
+
+    int count = 0;
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            ++count;
+            auto const renderer = factory.create_renderer_for(db);
+            EXPECT_THAT(dynamic_cast<mrs::Renderer*>(renderer.get()), NotNull());
+        });
+    });
+
+    EXPECT_TRUE(count);
+}
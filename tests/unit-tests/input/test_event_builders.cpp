@@ -283,3 +283,39 @@ TEST_F(InputEventBuilder, when_deserialized_input_device_state_event_has_supplie
         EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 2, i), Eq(pressed_keys[i]));
     }
 }
+
+TEST_F(InputEventBuilder, cloned_pointer_event_has_same_properties)
+{
+    auto const x_axis_value = 3.9f, y_axis_value = 7.4f;
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers,
+        mir_pointer_action_motion, mir_pointer_button_primary, x_axis_value, y_axis_value,
+        0.0f, 0.0f, 0.0f, 0.0f);
+
+    auto const clone = mev::clone_event(*ev);
+    mev::transform_positions(*ev, {1, 1});
+
+    auto const pev = mir_input_event_get_pointer_event(mir_event_get_input_event(clone.get()));
+    EXPECT_THAT(mir_pointer_event_action(pev), Eq(mir_pointer_action_motion));
+    EXPECT_TRUE(mir_pointer_event_button_state(pev, mir_pointer_button_primary));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_x), Eq(x_axis_value));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_y), Eq(y_axis_value));
+}
+
+TEST_F(InputEventBuilder, cloned_event_larger_than_inline_storage_has_same_properties)
+{
+    std::vector<uint32_t> const pressed_keys(1000, KEY_Q);
+    auto ev = mev::make_event(timestamp,
+                              mir_pointer_button_primary,
+                              mir_input_event_modifier_none,
+                              0.0f,
+                              0.0f,
+                              {mev::InputDeviceState{MirInputDeviceId{3}, pressed_keys, 0}});
+
+    auto const clone = mev::clone_event(*ev);
+    ev.reset();
+
+    auto ids_event = mir_event_get_input_device_state_event(clone.get());
+    ASSERT_THAT(mir_input_device_state_event_device_count(ids_event), Eq(1));
+    ASSERT_THAT(mir_input_device_state_event_device_pressed_keys_count(ids_event, 0), Eq(pressed_keys.size()));
+    EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 0, 999), Eq(uint32_t{KEY_Q}));
+}
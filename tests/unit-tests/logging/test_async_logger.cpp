@@ -0,0 +1,242 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/log.h"
+#include "mir/test/signal.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ml = mir::logging;
+namespace mt = mir::test;
+using namespace testing;
+
+namespace
+{
+struct LoggedMessage
+{
+    ml::Severity severity;
+    std::string text;
+    std::string component;
+    std::thread::id thread;
+
+    bool operator==(LoggedMessage const& that) const
+    {
+        return severity == that.severity && text == that.text && component == that.component;
+    }
+};
+
+void PrintTo(LoggedMessage const& message, std::ostream* os)
+{
+    *os << "{" << static_cast<int>(message.severity) << ", \"" << message.text << "\", \"" << message.component << "\"}";
+}
+
+class RecordingLogger : public ml::Logger
+{
+public:
+    void log(ml::Severity severity, std::string const& message, std::string const& component) override
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            messages.push_back({severity, message, component, std::this_thread::get_id()});
+        }
+
+        if (block)
+        {
+            blocked.raise();
+            unblock.wait_for(std::chrono::seconds{3});
+        }
+    }
+
+    auto recorded() -> std::vector<LoggedMessage>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return messages;
+    }
+
+    std::atomic<bool> block{false};
+    mt::Signal blocked;
+    mt::Signal unblock;
+
+private:
+    std::mutex mutex;
+    std::vector<LoggedMessage> messages;
+};
+
+struct AsyncLogger : Test
+{
+    std::shared_ptr<RecordingLogger> const next{std::make_shared<RecordingLogger>()};
+};
+
+auto info(std::string const& text, std::string const& component = "test") -> LoggedMessage
+{
+    return {ml::Severity::informational, text, component, {}};
+}
+}
+
+TEST_F(AsyncLogger, passes_messages_on_in_the_order_logged)
+{
+    ml::AsyncLogger logger{next};
+
+    logger.log(ml::Severity::informational, "one", "test");
+    logger.log("test", ml::Severity::informational, "%s", "two");
+    logger.log(ml::Severity::informational, "three", "other");
+    logger.flush();
+
+    EXPECT_THAT(next->recorded(), ElementsAre(info("one"), info("two"), info("three", "other")));
+}
+
+TEST_F(AsyncLogger, passes_messages_on_from_a_thread_of_its_own)
+{
+    ml::AsyncLogger logger{next};
+
+    logger.log(ml::Severity::informational, "message", "test");
+    logger.flush();
+
+    ASSERT_THAT(next->recorded(), SizeIs(1));
+    EXPECT_THAT(next->recorded()[0].thread, Ne(std::this_thread::get_id()));
+}
+
+TEST_F(AsyncLogger, formats_long_messages_in_full)
+{
+    ml::AsyncLogger logger{next};
+    std::string const long_text(3000, 'x');
+
+    logger.log("test", ml::Severity::informational, "%s", long_text.c_str());
+    logger.log(ml::Severity::informational, long_text, "test");
+    logger.flush();
+
+    EXPECT_THAT(next->recorded(), ElementsAre(info(long_text), info(long_text)));
+}
+
+TEST_F(AsyncLogger, writes_waiting_messages_when_destroyed)
+{
+    {
+        ml::AsyncLogger logger{next};
+        for (auto i = 0; i != 10; ++i)
+            logger.log(ml::Severity::informational, std::to_string(i), "test");
+    }
+
+    EXPECT_THAT(next->recorded(), SizeIs(10));
+}
+
+TEST_F(AsyncLogger, critical_messages_are_written_before_log_returns)
+{
+    ml::AsyncLogger logger{next};
+
+    logger.log(ml::Severity::informational, "before", "test");
+    logger.log(ml::Severity::critical, "critical", "test");
+
+    EXPECT_THAT(
+        next->recorded(),
+        ElementsAre(info("before"), LoggedMessage{ml::Severity::critical, "critical", "test", {}}));
+}
+
+TEST_F(AsyncLogger, drops_and_reports_messages_rather_than_waiting_for_the_writer)
+{
+    ml::AsyncLogger logger{next, 4};
+
+    next->block = true;
+    logger.log(ml::Severity::informational, "blocking", "test");
+    ASSERT_TRUE(next->blocked.wait_for(std::chrono::seconds{3}));
+
+    // "blocking" still has its entry until it's written, leaving room for three
+    for (auto i = 0; i != 10; ++i)
+        logger.log(ml::Severity::informational, std::to_string(i), "test");
+
+    EXPECT_THAT(logger.dropped(), Eq(7u));
+
+    next->block = false;
+    next->unblock.raise();
+    logger.flush();
+
+    auto const recorded = next->recorded();
+    EXPECT_THAT(recorded, SizeIs(5));
+    EXPECT_THAT(recorded.back().severity, Eq(ml::Severity::warning));
+    EXPECT_THAT(recorded.back().text, HasSubstr("7 log messages dropped"));
+}
+
+TEST_F(AsyncLogger, delivers_every_message_from_every_thread)
+{
+    auto const thread_count = 4;
+    auto const messages_per_thread = 100;
+
+    ml::AsyncLogger logger{next, messages_per_thread};
+
+    std::vector<std::thread> threads;
+    for (auto t = 0; t != thread_count; ++t)
+    {
+        threads.emplace_back(
+            [&logger, t]
+            {
+                for (auto i = 0; i != messages_per_thread; ++i)
+                    logger.log("test", ml::Severity::informational, "%d:%d", t, i);
+            });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    logger.flush();
+
+    auto const recorded = next->recorded();
+    ASSERT_THAT(recorded, SizeIs(thread_count * messages_per_thread));
+
+    // Each thread's messages are in the order it logged them
+    std::vector<int> next_expected(thread_count, 0);
+    for (auto const& message : recorded)
+    {
+        int t, i;
+        ASSERT_THAT(sscanf(message.text.c_str(), "%d:%d", &t, &i), Eq(2));
+        EXPECT_THAT(i, Eq(next_expected[t]++));
+    }
+}
+
+TEST_F(AsyncLogger, mir_log_uses_installed_async_logger)
+{
+    auto const logger = std::make_shared<ml::AsyncLogger>(next);
+    ml::set_logger(logger);
+
+    mir::log(ml::Severity::informational, "test", "%s %d", "formatted", 42);
+    ml::log(ml::Severity::informational, "unformatted", "test");
+    logger->flush();
+
+    EXPECT_THAT(next->recorded(), ElementsAre(info("formatted 42"), info("unformatted")));
+
+    ml::set_logger(std::make_shared<RecordingLogger>());
+}
+
+TEST_F(AsyncLogger, replaced_logger_is_released)
+{
+    std::weak_ptr<ml::AsyncLogger> weak_logger;
+    {
+        auto const logger = std::make_shared<ml::AsyncLogger>(next);
+        weak_logger = logger;
+        ml::set_logger(logger);
+    }
+
+    mir::log(ml::Severity::informational, "test", "message");
+    ml::set_logger(std::make_shared<RecordingLogger>());
+
+    EXPECT_TRUE(weak_logger.expired());
+    EXPECT_THAT(next->recorded(), ElementsAre(info("message")));
+}
@@ -189,3 +189,24 @@ TEST_F(LoggingCompositorReport, bypass_has_no_render_time)
 
     report.stopped();
 }
+
+TEST_F(LoggingCompositorReport, counts_missed_frames_per_interval)
+{
+    const void* const id = "My Screen";
+
+    report.started();
+
+    for (int f = 0; f < 3; ++f)
+    {
+        report.began_frame(id);
+        report.rendered_frame(id);
+        if (f != 1)
+            report.missed_frame(id);
+        report.finished_frame(id);
+        clock->advance_by(chrono::microseconds(12345678));
+    }
+    EXPECT_TRUE(recorder->last_message_contains("1 missed"))
+        << recorder->last_message();
+
+    report.stopped();
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/metrics/compositor_report.h"
+#include "mir/test/doubles/mock_compositor_report.h"
+#include "mir/test/doubles/stub_renderable.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+namespace mg = mir::graphics;
+namespace mrm = mir::report::metrics;
+namespace mtd = mir::test::doubles;
+namespace mt = mir::time;
+
+using namespace testing;
+using namespace std::chrono;
+
+namespace
+{
+struct MetricsCompositorReport : Test
+{
+    void advance(microseconds delta)
+    {
+        now = now + delta;
+    }
+
+    auto json() -> std::string
+    {
+        std::ostringstream out;
+        report.write_json(out);
+        return out.str();
+    }
+
+    /// One composited frame on display showing renderable, presented present_after the start
+    void frame(microseconds render_time, microseconds present_after)
+    {
+        auto const start = now;
+        report.began_frame(display);
+        advance(render_time);
+        report.renderables_in_frame(display, {renderable});
+        report.rendered_frame(display);
+        report.finished_frame(display);
+        report.presented_frame(display, mg::Frame{++msc, start + present_after});
+    }
+
+    mt::PosixTimestamp now{CLOCK_MONOTONIC, seconds{1000}};
+    int64_t msc{0};
+    std::shared_ptr<NiceMock<mtd::MockCompositorReport>> const next{
+        std::make_shared<NiceMock<mtd::MockCompositorReport>>()};
+    mrm::CompositorReport report{next, [this]{ return now; }};
+
+    int const display_tag{0};
+    mir::compositor::CompositorReport::SubCompositorId const display{&display_tag};
+    std::shared_ptr<mtd::StubRenderable> const renderable{std::make_shared<mtd::StubRenderable>()};
+    mir::compositor::CompositorReport::StreamId const stream{renderable->id()};
+};
+}
+
+TEST_F(MetricsCompositorReport, forwards_everything_to_the_next_report)
+{
+    InSequence seq;
+    EXPECT_CALL(*next, added_display(640, 480, 0, 0, display));
+    EXPECT_CALL(*next, submitted_buffer(stream, renderable->buffer()->id()));
+    EXPECT_CALL(*next, began_frame(display));
+    EXPECT_CALL(*next, renderables_in_frame(display, _));
+    EXPECT_CALL(*next, rendered_frame(display));
+    EXPECT_CALL(*next, finished_frame(display));
+    EXPECT_CALL(*next, presented_frame(display, _));
+    EXPECT_CALL(*next, missed_frame(display));
+
+    report.added_display(640, 480, 0, 0, display);
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    frame(microseconds{100}, microseconds{16000});
+    report.missed_frame(display);
+}
+
+TEST_F(MetricsCompositorReport, counts_frames_bypasses_and_misses_per_output)
+{
+    report.added_display(640, 480, 10, 20, display);
+
+    frame(microseconds{100}, microseconds{16000});
+    frame(microseconds{100}, microseconds{16000});
+    report.began_frame(display);
+    report.renderables_in_frame(display, {renderable});
+    report.finished_frame(display);
+    report.missed_frame(display);
+
+    auto const out = json();
+    EXPECT_THAT(out, HasSubstr(R"("geometry":{"x":10,"y":20,"width":640,"height":480})"));
+    EXPECT_THAT(out, HasSubstr(R"("frames":3,"bypassed":1,"missed":1)"));
+}
+
+TEST_F(MetricsCompositorReport, buckets_render_and_present_times)
+{
+    frame(microseconds{3}, microseconds{16000});
+
+    // 3us is in the [2, 4) bucket; 16ms in [8192, 16384)
+    auto const out = json();
+    EXPECT_THAT(out, HasSubstr(
+        R"("render_usec":{"count":1,"total":3,"buckets":[0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]})"));
+    EXPECT_THAT(out, HasSubstr(
+        R"("composite_to_present_usec":{"count":1,"total":16000,"buckets":[0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0]})"));
+}
+
+TEST_F(MetricsCompositorReport, measures_commit_to_composite_and_present_per_surface)
+{
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    advance(microseconds{1000});
+    frame(microseconds{500}, microseconds{4000});
+
+    auto const out = json();
+    EXPECT_THAT(out, HasSubstr(R"("committed":1,"shown":1,"dropped":0)"));
+    EXPECT_THAT(out, HasSubstr(R"("commit_to_composite_usec":{"count":1,"total":1500,)"));
+    EXPECT_THAT(out, HasSubstr(R"("commit_to_present_usec":{"count":1,"total":5000,)"));
+}
+
+TEST_F(MetricsCompositorReport, counts_a_buffer_once_however_often_it_is_composited)
+{
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    frame(microseconds{100}, microseconds{16000});
+    frame(microseconds{100}, microseconds{16000});
+    frame(microseconds{100}, microseconds{16000});
+
+    auto const out = json();
+    EXPECT_THAT(out, HasSubstr(R"("committed":1,"shown":1,"dropped":0)"));
+    EXPECT_THAT(out, HasSubstr(R"("commit_to_present_usec":{"count":1,)"));
+}
+
+TEST_F(MetricsCompositorReport, counts_buffers_replaced_before_being_shown_as_dropped)
+{
+    auto const superseded = std::make_shared<mtd::StubBuffer>();
+
+    report.submitted_buffer(stream, superseded->id());
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    frame(microseconds{100}, microseconds{16000});
+
+    EXPECT_THAT(json(), HasSubstr(R"("committed":2,"shown":1,"dropped":1)"));
+}
+
+TEST_F(MetricsCompositorReport, ignores_frames_without_presentation_timing)
+{
+    report.began_frame(display);
+    report.finished_frame(display);
+    report.presented_frame(display, mg::Frame{});
+
+    EXPECT_THAT(json(), HasSubstr(R"("composite_to_present_usec":{"count":0,)"));
+}
+
+TEST_F(MetricsCompositorReport, forgets_surfaces_that_have_been_idle)
+{
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    EXPECT_THAT(json(), HasSubstr(R"("committed":1)"));
+
+    advance(seconds{11});
+
+    EXPECT_THAT(json(), Not(HasSubstr(R"("committed")")));
+}
+
+TEST_F(MetricsCompositorReport, measures_surfaces_that_commit_after_first_being_composited)
+{
+    frame(microseconds{100}, microseconds{16000});
+
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    frame(microseconds{100}, microseconds{16000});
+
+    EXPECT_THAT(json(), HasSubstr(R"("committed":1,"shown":1,"dropped":0)"));
+}
+
+TEST_F(MetricsCompositorReport, measures_surfaces_that_return_after_being_forgotten)
+{
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    frame(microseconds{100}, microseconds{16000});
+
+    advance(seconds{11});
+    json();
+
+    report.submitted_buffer(stream, renderable->buffer()->id());
+    frame(microseconds{100}, microseconds{16000});
+
+    EXPECT_THAT(json(), HasSubstr(R"("committed":1,"shown":1,"dropped":0)"));
+}
+
+TEST_F(MetricsCompositorReport, keeps_reports_on_the_same_thread_apart)
+{
+    mrm::CompositorReport other{next, [this]{ return now; }};
+    other.began_frame(display);
+    other.finished_frame(display);
+
+    frame(microseconds{100}, microseconds{16000});
+    frame(microseconds{100}, microseconds{16000});
+
+    EXPECT_THAT(json(), HasSubstr(R"("frames":2,)"));
+    std::ostringstream other_json;
+    other.write_json(other_json);
+    EXPECT_THAT(other_json.str(), HasSubstr(R"("frames":1,)"));
+}
@@ -59,6 +59,15 @@ struct MockKMSOutput : public graphics::mesa::KMSOutput
     MOCK_METHOD1(schedule_page_flip_thunk, bool(graphics::mesa::FBHandle const*));
     MOCK_METHOD0(wait_for_page_flip, void());
 
+    MOCK_CONST_METHOD0(max_layers, size_t());
+    MOCK_METHOD1(can_show, bool(std::vector<graphics::mesa::PlaneLayer> const&));
+
+    bool schedule_page_flip(std::vector<graphics::mesa::PlaneLayer> const& layers) override
+    {
+        return schedule_layers_page_flip(layers);
+    }
+    MOCK_METHOD1(schedule_layers_page_flip, bool(std::vector<graphics::mesa::PlaneLayer> const&));
+
     MOCK_CONST_METHOD0(last_frame, graphics::Frame());
 
     MOCK_METHOD1(set_cursor, bool(gbm_bo*));
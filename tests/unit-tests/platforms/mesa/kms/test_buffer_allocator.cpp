@@ -32,6 +32,7 @@
 #include "mir/test/doubles/mock_gl.h"
 #include "mir/test/doubles/null_gl_config.h"
 #include "mir/test/doubles/null_display_configuration_policy.h"
+#include "mir/test/doubles/explicit_executor.h"
 #include "mir_test_framework/udev_environment.h"
 
 #include <cstdlib>
@@ -43,6 +44,7 @@
 #include <gmock/gmock.h>
 
 #include <gbm.h>
+#include <wayland-server-core.h>
 
 namespace mg = mir::graphics;
 namespace mgm = mir::graphics::mesa;
@@ -346,3 +348,40 @@ TEST_F(MesaBufferAllocatorTest, screencast_can_create_buffer)
                                  mg::BufferUsage::hardware});
     });
 }
+
+TEST_F(MesaBufferAllocatorTest, binds_display_without_dmabuf_modifier_support)
+{
+    using namespace testing;
+
+    ON_CALL(mock_egl, eglBindWaylandDisplayWL(_,_))
+        .WillByDefault(Return(EGL_TRUE));
+
+    EXPECT_CALL(mock_egl, eglQueryDmaBufFormatsEXT(_,_,_,_)).Times(0);
+
+    auto const wl_display = wl_display_create();
+    EXPECT_NO_THROW(allocator->bind_display(wl_display, std::make_shared<mtd::ExplicitExectutor>()));
+    wl_display_destroy(wl_display);
+}
+
+TEST_F(MesaBufferAllocatorTest, queries_dmabuf_formats_when_modifiers_are_supported)
+{
+    using namespace testing;
+
+    ON_CALL(mock_egl, eglQueryString(_,EGL_EXTENSIONS))
+        .WillByDefault(Return(
+            "EGL_KHR_image "
+            "EGL_KHR_image_base "
+            "EGL_EXT_image_dma_buf_import "
+            "EGL_EXT_image_dma_buf_import_modifiers "
+            "EGL_WL_bind_wayland_display"));
+    ON_CALL(mock_egl, eglBindWaylandDisplayWL(_,_))
+        .WillByDefault(Return(EGL_TRUE));
+
+    EXPECT_CALL(mock_egl, eglQueryDmaBufFormatsEXT(_,_,_,_))
+        .Times(AtLeast(1))
+        .WillRepeatedly(DoAll(SetArgPointee<3>(0), Return(EGL_TRUE)));
+
+    auto const wl_display = wl_display_create();
+    EXPECT_NO_THROW(allocator->bind_display(wl_display, std::make_shared<mtd::ExplicitExectutor>()));
+    wl_display_destroy(wl_display);
+}
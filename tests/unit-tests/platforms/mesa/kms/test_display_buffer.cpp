@@ -503,3 +503,158 @@ TEST_F(MesaDisplayBufferTest, buffer_requiring_migration_is_ineligable_for_bypas
 
     EXPECT_FALSE(db.overlay(bypassable_list));
 }
+
+class MesaDisplayBufferPlanesTest : public MesaDisplayBufferTest
+{
+public:
+    MesaDisplayBufferPlanesTest()
+        : window_buffer{std::make_shared<NiceMock<MockBuffer>>()},
+          window_gbm_native_buffer{std::make_shared<StubGBMNativeBuffer>(window_area.size)},
+          window{std::make_shared<FakeRenderable>(window_area)}
+    {
+        ON_CALL(*window_buffer, size())
+            .WillByDefault(Return(window_area.size));
+        ON_CALL(*window_buffer, native_buffer_handle())
+            .WillByDefault(Return(window_gbm_native_buffer));
+        window->set_buffer(window_buffer);
+
+        ON_CALL(*mock_kms_output, max_layers())
+            .WillByDefault(Return(2));
+        ON_CALL(*mock_kms_output, can_show(_))
+            .WillByDefault(Return(true));
+        ON_CALL(*mock_kms_output, schedule_layers_page_flip(_))
+            .WillByDefault(Return(true));
+    }
+
+    /// Composites frames until the renderables have been steady long enough to try the planes
+    bool overlay_when_steady(graphics::mesa::DisplayBuffer& db, graphics::RenderableList const& list)
+    {
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            if (db.overlay(list))
+                return true;
+            db.post();
+        }
+        return false;
+    }
+
+    geometry::Rectangle const window_area{{22, 44}, {20, 10}};
+    std::shared_ptr<MockBuffer> const window_buffer;
+    std::shared_ptr<mir::graphics::mesa::NativeBuffer> const window_gbm_native_buffer;
+    std::shared_ptr<FakeRenderable> const window;
+};
+
+TEST_F(MesaDisplayBufferPlanesTest, puts_surface_over_fullscreen_one_on_an_overlay_plane)
+{
+    graphics::RenderableList const list{fake_bypassable_renderable, window};
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ASSERT_TRUE(overlay_when_steady(db, list));
+
+    std::vector<PlaneLayer> flipped;
+    EXPECT_CALL(*mock_kms_output, schedule_layers_page_flip(_))
+        .WillOnce(DoAll(SaveArg<0>(&flipped), Return(true)));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    db.post();
+
+    ASSERT_THAT(flipped.size(), Eq(2u));
+    EXPECT_THAT(flipped[0].destination, Eq(geometry::Rectangle{{0, 0}, display_area.size}));
+    EXPECT_THAT(flipped[1].source, Eq(geometry::Rectangle{{0, 0}, window_area.size}));
+    EXPECT_THAT(flipped[1].destination, Eq(geometry::Rectangle{{10, 10}, window_area.size}));
+}
+
+TEST_F(MesaDisplayBufferPlanesTest, puts_scaled_fullscreen_surface_on_the_primary_plane)
+{
+    auto const low_resolution_buffer = std::make_shared<NiceMock<MockBuffer>>();
+    ON_CALL(*low_resolution_buffer, size())
+        .WillByDefault(Return(geometry::Size{28, 39}));
+    ON_CALL(*low_resolution_buffer, native_buffer_handle())
+        .WillByDefault(Return(stub_gbm_native_buffer));
+    fake_bypassable_renderable->set_buffer(low_resolution_buffer);
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ASSERT_TRUE(overlay_when_steady(db, bypassable_list));
+
+    std::vector<PlaneLayer> flipped;
+    EXPECT_CALL(*mock_kms_output, schedule_layers_page_flip(_))
+        .WillOnce(DoAll(SaveArg<0>(&flipped), Return(true)));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    db.post();
+
+    ASSERT_THAT(flipped.size(), Eq(1u));
+    EXPECT_THAT(flipped[0].source, Eq(geometry::Rectangle{{0, 0}, {28, 39}}));
+    EXPECT_THAT(flipped[0].destination, Eq(geometry::Rectangle{{0, 0}, display_area.size}));
+}
+
+TEST_F(MesaDisplayBufferPlanesTest, composites_layers_the_hardware_rejects)
+{
+    graphics::RenderableList const list{fake_bypassable_renderable, window};
+
+    EXPECT_CALL(*mock_kms_output, can_show(_))
+        .WillOnce(Return(false));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(overlay_when_steady(db, list));
+}
+
+TEST_F(MesaDisplayBufferPlanesTest, composites_more_surfaces_than_planes)
+{
+    auto const another_window = std::make_shared<FakeRenderable>(window_area);
+    another_window->set_buffer(window_buffer);
+    graphics::RenderableList const list{fake_bypassable_renderable, window, another_window};
+
+    EXPECT_CALL(*mock_kms_output, can_show(_))
+        .Times(0);
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(db.overlay(list));
+}
+
+TEST_F(MesaDisplayBufferPlanesTest, composites_translucent_surfaces)
+{
+    auto const translucent_window = std::make_shared<FakeRenderable>(window_area, 0.5f);
+    translucent_window->set_buffer(window_buffer);
+    graphics::RenderableList const list{fake_bypassable_renderable, translucent_window};
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(db.overlay(list));
+}
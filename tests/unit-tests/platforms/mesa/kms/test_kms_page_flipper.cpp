@@ -128,6 +128,49 @@ TEST_F(KMSPageFlipperTest, wait_for_flip_handles_drm_event)
     page_flipper.wait_for_flip(crtc_id);
 }
 
+TEST_F(KMSPageFlipperTest, atomic_flip_is_waited_for_as_a_page_flip)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const connector_id{345};
+    auto const request = reinterpret_cast<drmModeAtomicReq*>(0xa70111c);
+    void* user_data{nullptr};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, request,
+                                              DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, _))
+        .Times(1)
+        .WillOnce(DoAll(SaveArg<3>(&user_data), Return(0)));
+
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .Times(1)
+        .WillOnce(DoAll(InvokePageFlipHandler(&user_data), Return(0)));
+
+    EXPECT_TRUE(page_flipper.schedule_atomic_flip(crtc_id, request, connector_id));
+
+    /* Fake a DRM event */
+    mock_drm.generate_event_on(drm_device);
+
+    page_flipper.wait_for_flip(crtc_id);
+}
+
+TEST_F(KMSPageFlipperTest, failed_atomic_flip_is_not_pending)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const connector_id{345};
+    auto const request = reinterpret_cast<drmModeAtomicReq*>(0xa70111c);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, request, _, _))
+        .Times(2)
+        .WillOnce(Return(-EINVAL))
+        .WillOnce(Return(0));
+
+    EXPECT_FALSE(page_flipper.schedule_atomic_flip(crtc_id, request, connector_id));
+    EXPECT_TRUE(page_flipper.schedule_atomic_flip(crtc_id, request, connector_id));
+}
+
 TEST_F(KMSPageFlipperTest, wait_for_flip_reports_vsync)
 {
     using namespace testing;
@@ -0,0 +1,576 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/mesa/server/linux_dmabuf.h"
+
+#include "mir/anonymous_shm_file.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/egl_extensions.h"
+
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/null_gl_context.h"
+#include "mir/test/doubles/explicit_executor.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <drm_fourcc.h>
+#include <wayland-server.h>
+
+#include <array>
+#include <cstring>
+#include <map>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+namespace mgm = mir::graphics::mesa;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
+// zwp_linux_buffer_params_v1 errors and flags
+uint32_t const already_used = 0;
+uint32_t const plane_idx = 1;
+uint32_t const plane_set = 2;
+uint32_t const incomplete = 3;
+uint32_t const invalid_format = 4;
+uint32_t const invalid_dimensions = 5;
+uint32_t const out_of_bounds = 6;
+uint32_t const invalid_wl_buffer = 7;
+uint32_t const interlaced = 2;
+
+uint32_t const width = 64;
+uint32_t const height = 32;
+uint32_t const stride = width * 4;
+
+struct SentEvent
+{
+    std::string name;
+    std::vector<uint32_t> args;
+    std::vector<std::string> strings;
+};
+
+MATCHER_P(Named, name, "")
+{
+    return arg.name == name;
+}
+
+/// The bits of a Wayland client we need, speaking the wire protocol directly
+class WireClient
+{
+public:
+    explicit WireClient(int fd) : fd{fd} {}
+
+    /// Sends a request with a body of (already encoded) words, and fd (if any) alongside
+    void send(uint32_t object, uint16_t opcode, std::vector<uint32_t> body, int fd_to_send = -1)
+    {
+        body.insert(body.begin(), {object, static_cast<uint32_t>((body.size() + 2) * 4) << 16 | opcode});
+
+        iovec iov{body.data(), body.size() * sizeof(uint32_t)};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        char control[CMSG_SPACE(sizeof(int))] = {};
+        if (fd_to_send >= 0)
+        {
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof control;
+            auto const cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &fd_to_send, sizeof(int));
+        }
+
+        // The server disconnects clients once it has sent them an error
+        if (sendmsg(fd, &msg, MSG_NOSIGNAL) < 0 && errno != EPIPE)
+            throw std::system_error(errno, std::system_category(), "Failed to send request");
+    }
+
+    static void append_string(std::vector<uint32_t>& body, std::string const& string)
+    {
+        auto const length = string.size() + 1;
+        body.push_back(length);
+
+        std::vector<uint32_t> words((length + 3) / 4, 0);
+        memcpy(words.data(), string.c_str(), length);
+        body.insert(body.end(), words.begin(), words.end());
+    }
+
+    auto new_id() -> uint32_t
+    {
+        return next_id++;
+    }
+
+private:
+    int const fd;
+    uint32_t next_id{2};    // wl_display is 1
+};
+
+/// Forgets the client once the server disconnects it
+struct ClientDestroyed
+{
+    wl_listener destruction_listener;
+    wl_client** const client;
+
+    static void on_destroyed(wl_listener* listener, void*)
+    {
+        ClientDestroyed* me;
+        me = wl_container_of(listener, me, destruction_listener);
+        *me->client = nullptr;
+    }
+};
+
+static_assert(
+    std::is_standard_layout<ClientDestroyed>::value,
+    "ClientDestroyed must be Standard Layout for wl_container_of to be defined behaviour");
+
+auto socket_pair() -> std::array<int, 2>
+{
+    std::array<int, 2> fds;
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()))
+        throw std::system_error(errno, std::system_category(), "Failed to create socket pair");
+    return fds;
+}
+
+struct LinuxDmaBuf : Test
+{
+    LinuxDmaBuf()
+    {
+        wl_client_add_destroy_listener(client, &client_destroyed.destruction_listener);
+
+        mock_egl.provide_egl_extensions();
+        ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(mock_egl.fake_egl_display));
+
+        dmabuf = std::make_unique<mgm::LinuxDmaBufUnstable>(display, mock_egl.fake_egl_display, egl_extensions);
+        dmabuf_id = bind_dmabuf();
+    }
+
+    ~LinuxDmaBuf()
+    {
+        wl_protocol_logger_destroy(logger);
+        if (client)
+            wl_client_destroy(client);
+        dmabuf.reset();
+        close(client_end);
+    }
+
+    static void log_event(void* context, wl_protocol_logger_type type, wl_protocol_logger_message const* message)
+    {
+        if (type != WL_PROTOCOL_LOGGER_EVENT)
+            return;
+
+        SentEvent event{message->message->name, {}, {}};
+        auto arg = message->arguments;
+        for (auto signature = message->message->signature; *signature; ++signature)
+        {
+            switch (*signature)
+            {
+            case 'u':
+            case 'i':
+                event.args.push_back(arg++->u);
+                break;
+            case 's':
+                event.strings.push_back(arg->s ? arg->s : "");
+                ++arg;
+                break;
+            case 'o':
+            case 'n':
+            case 'a':
+            case 'f':
+            case 'h':
+                ++arg;
+                break;
+            default:    // Version and nullability markers
+                break;
+            }
+        }
+        static_cast<LinuxDmaBuf*>(context)->sent.push_back(event);
+    }
+
+    void dispatch()
+    {
+        wl_event_loop_dispatch(wl_display_get_event_loop(display), 0);
+    }
+
+    auto bind_dmabuf() -> uint32_t
+    {
+        auto const registry = wire.new_id();
+        wire.send(1, 1 /* wl_display.get_registry */, {registry});
+        dispatch();
+
+        for (auto const& event : sent)
+        {
+            if (event.name == "global" && event.strings == std::vector<std::string>{"zwp_linux_dmabuf_v1"})
+            {
+                auto const id = wire.new_id();
+                std::vector<uint32_t> body{event.args[0]};
+                WireClient::append_string(body, "zwp_linux_dmabuf_v1");
+                body.insert(body.end(), {3, id});
+                wire.send(registry, 0 /* wl_registry.bind */, body);
+                dispatch();
+                sent.clear();
+                return id;
+            }
+        }
+
+        throw std::logic_error{"zwp_linux_dmabuf_v1 global not advertised"};
+    }
+
+    auto create_params() -> uint32_t
+    {
+        auto const params = wire.new_id();
+        wire.send(dmabuf_id, 1 /* create_params */, {params});
+        dispatch();
+        return params;
+    }
+
+    void add(uint32_t params, int fd, uint32_t plane, uint64_t modifier = DRM_FORMAT_MOD_INVALID, uint32_t offset = 0)
+    {
+        wire.send(
+            params,
+            1 /* add */,
+            {plane, offset, stride, static_cast<uint32_t>(modifier >> 32), static_cast<uint32_t>(modifier)},
+            fd);
+        dispatch();
+    }
+
+    void create(uint32_t params, uint32_t format = DRM_FORMAT_ARGB8888, uint32_t flags = 0)
+    {
+        wire.send(params, 2 /* create */, {width, height, format, flags});
+        dispatch();
+    }
+
+    auto create_immed(uint32_t params, uint32_t format = DRM_FORMAT_ARGB8888, uint32_t flags = 0) -> uint32_t
+    {
+        auto const buffer = wire.new_id();
+        wire.send(params, 3 /* create_immed */, {buffer, width, height, format, flags});
+        dispatch();
+        return buffer;
+    }
+
+    /// The error codes the client has been sent
+    auto errors() const -> std::vector<uint32_t>
+    {
+        std::vector<uint32_t> codes;
+        for (auto const& event : sent)
+        {
+            if (event.name == "error")
+                codes.push_back(event.args[0]);
+        }
+        return codes;
+    }
+
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockGL> mock_gl;
+
+    std::unique_ptr<wl_display, decltype(&wl_display_destroy)> const owned_display{wl_display_create(), &wl_display_destroy};
+    wl_display* const display{owned_display.get()};
+    std::array<int, 2> const fds{socket_pair()};
+    int const client_end{fds[1]};
+    wl_client* client{wl_client_create(display, fds[0])};
+    wl_protocol_logger* const logger{wl_display_add_protocol_logger(display, &log_event, this)};
+    ClientDestroyed client_destroyed{{{}, &ClientDestroyed::on_destroyed}, &client};
+    WireClient wire{client_end};
+    std::vector<SentEvent> sent;
+
+    std::shared_ptr<mg::EGLExtensions> const egl_extensions{std::make_shared<mg::EGLExtensions>()};
+    std::unique_ptr<mgm::LinuxDmaBufUnstable> dmabuf;
+    uint32_t dmabuf_id;
+
+    mir::AnonymousShmFile const plane_data{stride * height};
+    mir::AnonymousShmFile const small_plane_data{stride};
+};
+}
+
+TEST_F(LinuxDmaBuf, create_sends_created_for_a_valid_buffer)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    create(params);
+
+    EXPECT_THAT(errors(), IsEmpty());
+    EXPECT_THAT(sent, ElementsAre(Named("created")));
+}
+
+TEST_F(LinuxDmaBuf, imports_every_plane_with_its_layout)
+{
+    EXPECT_CALL(mock_egl, eglCreateImageKHR(_, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, _, _))
+        .WillOnce(Invoke(
+            [this](EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const* attributes)
+            {
+                std::map<EGLint, EGLint> attribs;
+                for (; *attributes != EGL_NONE; attributes += 2)
+                    attribs[attributes[0]] = attributes[1];
+
+                EXPECT_THAT(attribs, IsSupersetOf({
+                    Pair(EGL_WIDTH, static_cast<EGLint>(width)),
+                    Pair(EGL_HEIGHT, static_cast<EGLint>(height)),
+                    Pair(EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(DRM_FORMAT_ARGB8888)),
+                    Pair(EGL_DMA_BUF_PLANE0_PITCH_EXT, static_cast<EGLint>(stride)),
+                    Pair(EGL_DMA_BUF_PLANE1_OFFSET_EXT, 16)}));
+                EXPECT_THAT(attribs, Not(Contains(Key(EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT))));
+
+                return mock_egl.fake_egl_image;
+            }));
+
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+    add(params, plane_data.fd(), 1, DRM_FORMAT_MOD_INVALID, 16);
+
+    create(params);
+
+    EXPECT_THAT(errors(), IsEmpty());
+}
+
+TEST_F(LinuxDmaBuf, add_after_create_is_already_used_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+    create(params);
+
+    add(params, plane_data.fd(), 1);
+
+    EXPECT_THAT(errors(), ElementsAre(already_used));
+}
+
+TEST_F(LinuxDmaBuf, second_create_is_already_used_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+    create(params);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(already_used));
+}
+
+TEST_F(LinuxDmaBuf, plane_index_beyond_the_maximum_is_plane_idx_error)
+{
+    auto const params = create_params();
+
+    add(params, plane_data.fd(), 4);
+
+    EXPECT_THAT(errors(), ElementsAre(plane_idx));
+}
+
+TEST_F(LinuxDmaBuf, setting_a_plane_twice_is_plane_set_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    add(params, plane_data.fd(), 0);
+
+    EXPECT_THAT(errors(), ElementsAre(plane_set));
+}
+
+TEST_F(LinuxDmaBuf, create_without_planes_is_incomplete_error)
+{
+    auto const params = create_params();
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(incomplete));
+}
+
+TEST_F(LinuxDmaBuf, create_without_plane_zero_is_incomplete_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 1);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(incomplete));
+}
+
+TEST_F(LinuxDmaBuf, create_with_a_gap_in_the_planes_is_incomplete_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+    add(params, plane_data.fd(), 2);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(incomplete));
+}
+
+TEST_F(LinuxDmaBuf, create_with_mixed_modifiers_is_invalid_format_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0, DRM_FORMAT_MOD_INVALID);
+    add(params, plane_data.fd(), 1, DRM_FORMAT_MOD_LINEAR);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(invalid_format));
+}
+
+TEST_F(LinuxDmaBuf, create_with_an_unsupported_format_is_invalid_format_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    create(params, DRM_FORMAT_NV12);
+
+    EXPECT_THAT(errors(), ElementsAre(invalid_format));
+}
+
+TEST_F(LinuxDmaBuf, explicit_modifier_without_modifier_support_is_invalid_format_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0, DRM_FORMAT_MOD_LINEAR);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(invalid_format));
+}
+
+TEST_F(LinuxDmaBuf, create_with_no_size_is_invalid_dimensions_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    wire.send(params, 2 /* create */, {0, height, DRM_FORMAT_ARGB8888, 0});
+    dispatch();
+
+    EXPECT_THAT(errors(), ElementsAre(invalid_dimensions));
+}
+
+TEST_F(LinuxDmaBuf, plane_larger_than_its_dmabuf_is_out_of_bounds_error)
+{
+    auto const params = create_params();
+    add(params, small_plane_data.fd(), 0);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(out_of_bounds));
+}
+
+TEST_F(LinuxDmaBuf, plane_offset_beyond_its_dmabuf_is_out_of_bounds_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+    add(params, small_plane_data.fd(), 1, DRM_FORMAT_MOD_INVALID, stride);
+
+    create(params);
+
+    EXPECT_THAT(errors(), ElementsAre(out_of_bounds));
+}
+
+TEST_F(LinuxDmaBuf, create_of_interlaced_buffer_sends_failed)
+{
+    EXPECT_CALL(mock_egl, eglCreateImageKHR(_, _, _, _, _)).Times(0);
+
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    create(params, DRM_FORMAT_ARGB8888, interlaced);
+
+    EXPECT_THAT(errors(), IsEmpty());
+    EXPECT_THAT(sent, ElementsAre(Named("failed")));
+}
+
+TEST_F(LinuxDmaBuf, create_sends_failed_when_egl_cannot_import)
+{
+    ON_CALL(mock_egl, eglCreateImageKHR(_, _, _, _, _)).WillByDefault(Return(EGL_NO_IMAGE_KHR));
+
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    create(params);
+
+    EXPECT_THAT(errors(), IsEmpty());
+    EXPECT_THAT(sent, ElementsAre(Named("failed")));
+}
+
+TEST_F(LinuxDmaBuf, create_immed_of_interlaced_buffer_is_invalid_wl_buffer_error)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    create_immed(params, DRM_FORMAT_ARGB8888, interlaced);
+
+    EXPECT_THAT(errors(), ElementsAre(invalid_wl_buffer));
+}
+
+TEST_F(LinuxDmaBuf, create_immed_is_invalid_wl_buffer_error_when_egl_cannot_import)
+{
+    ON_CALL(mock_egl, eglCreateImageKHR(_, _, _, _, _)).WillByDefault(Return(EGL_NO_IMAGE_KHR));
+
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+
+    create_immed(params);
+
+    EXPECT_THAT(errors(), ElementsAre(invalid_wl_buffer));
+}
+
+TEST_F(LinuxDmaBuf, buffer_from_resource_samples_the_imported_image)
+{
+    auto const params = create_params();
+    add(params, plane_data.fd(), 0);
+    auto const buffer_id = create_immed(params, DRM_FORMAT_XRGB8888);
+    ASSERT_THAT(errors(), IsEmpty());
+
+    EXPECT_CALL(mock_egl, glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, mock_egl.fake_egl_image));
+
+    auto const executor = std::make_shared<mtd::ExplicitExectutor>();
+    auto buffer = dmabuf->buffer_from_resource(
+        wl_client_get_object(client, buffer_id),
+        []{},
+        []{},
+        std::make_shared<mtd::NullGLContext>(),
+        executor);
+
+    ASSERT_THAT(buffer, NotNull());
+    EXPECT_THAT(buffer->size(), Eq(mir::geometry::Size{width, height}));
+    EXPECT_THAT(buffer->pixel_format(), Eq(mir_pixel_format_xrgb_8888));
+
+    EXPECT_CALL(mock_gl, glDeleteTextures(1, _));
+    buffer.reset();
+    executor->execute();
+}
+
+TEST_F(LinuxDmaBuf, buffer_from_resource_ignores_other_buffers)
+{
+    auto const other = wl_resource_create(client, &wl_buffer_interface, 1, 0);
+    bool released{false};
+
+    auto const buffer = dmabuf->buffer_from_resource(
+        other,
+        []{},
+        [&]{ released = true; },
+        std::make_shared<mtd::NullGLContext>(),
+        std::make_shared<mtd::ExplicitExectutor>());
+
+    EXPECT_THAT(buffer, IsNull());
+    EXPECT_FALSE(released);
+}
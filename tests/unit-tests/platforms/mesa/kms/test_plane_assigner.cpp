@@ -0,0 +1,320 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/mesa/server/kms/plane_assigner.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <set>
+
+namespace mg = mir::graphics;
+namespace mgm = mir::graphics::mesa;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+/// Planes as the hardware might have them, answering can_show()
+struct FakePlanes
+{
+    bool operator()(std::vector<mgm::PlaneLayer> const& layers)
+    {
+        ++tests;
+
+        if (layers.size() > count)
+            return false;
+
+        for (auto const& layer : layers)
+        {
+            if (!can_scale && layer.source.size != layer.destination.size)
+                return false;
+        }
+        return accept;
+    }
+
+    size_t count{3};
+    bool can_scale{true};
+    bool accept{true};
+    int tests{0};
+};
+
+struct PlaneAssignerTest : Test
+{
+    auto window(geom::Rectangle const& position, geom::Size const& buffer_size) -> std::shared_ptr<mtd::FakeRenderable>
+    {
+        auto const renderable = std::make_shared<mtd::FakeRenderable>(position);
+        renderable->set_buffer(std::make_shared<mtd::StubBuffer>(buffer_size));
+        return renderable;
+    }
+
+    auto window(geom::Rectangle const& position) -> std::shared_ptr<mtd::FakeRenderable>
+    {
+        return window(position, position.size);
+    }
+
+    auto fb_of(mg::Renderable const& renderable) -> mgm::FBHandle const*
+    {
+        return reinterpret_cast<mgm::FBHandle const*>(renderable.buffer().get());
+    }
+
+    auto assign(mg::RenderableList const& renderables) -> mgm::PlaneAssigner::Assignment
+    {
+        return assigner.assign(
+            renderables,
+            output,
+            planes.count,
+            [this](mg::Buffer& buffer) -> mgm::FBHandle const*
+            {
+                if (unscannable.count(&buffer))
+                    return nullptr;
+                return reinterpret_cast<mgm::FBHandle const*>(&buffer);
+            },
+            [this](std::vector<mgm::PlaneLayer> const& layers) { return planes(layers); });
+    }
+
+    /// Assign renderables for as many frames as a new scene takes to go on the planes
+    auto assign_steady(mg::RenderableList const& renderables) -> mgm::PlaneAssigner::Assignment
+    {
+        for (auto frame = 1u; frame < stable_frames; ++frame)
+            assign(renderables);
+        return assign(renderables);
+    }
+
+    geom::Rectangle const output{{1920, 0}, {1920, 1200}};
+    unsigned const stable_frames{3};
+    FakePlanes planes;
+    std::set<mg::Buffer const*> unscannable;
+    mgm::PlaneAssigner assigner{stable_frames};
+};
+}
+
+TEST_F(PlaneAssignerTest, fullscreen_window_goes_on_the_primary_plane)
+{
+    auto const fullscreen = window(output);
+
+    auto const assignment = assign_steady({fullscreen});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(1u));
+    EXPECT_THAT(assignment.layers[0].fb, Eq(fb_of(*fullscreen)));
+    EXPECT_THAT(assignment.layers[0].source, Eq(geom::Rectangle{{0, 0}, output.size}));
+    EXPECT_THAT(assignment.layers[0].destination, Eq(geom::Rectangle{{0, 0}, output.size}));
+    EXPECT_THAT(assignment.buffers, ElementsAre(fullscreen->buffer()));
+}
+
+TEST_F(PlaneAssignerTest, low_resolution_fullscreen_window_is_scaled_by_the_plane)
+{
+    auto const fullscreen = window(output, {960, 600});
+
+    auto const assignment = assign_steady({fullscreen});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(1u));
+    EXPECT_THAT(assignment.layers[0].source, Eq(geom::Rectangle{{0, 0}, {960, 600}}));
+    EXPECT_THAT(assignment.layers[0].destination, Eq(geom::Rectangle{{0, 0}, output.size}));
+}
+
+TEST_F(PlaneAssignerTest, windows_above_a_fullscreen_one_go_on_overlays)
+{
+    auto const fullscreen = window(output);
+    auto const dialog = window({{2020, 100}, {300, 200}});
+
+    auto const assignment = assign_steady({fullscreen, dialog});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(2u));
+    EXPECT_THAT(assignment.layers[0].fb, Eq(fb_of(*fullscreen)));
+    EXPECT_THAT(assignment.layers[1].fb, Eq(fb_of(*dialog)));
+    EXPECT_THAT(assignment.layers[1].destination, Eq(geom::Rectangle{{100, 100}, {300, 200}}));
+}
+
+TEST_F(PlaneAssignerTest, windows_hidden_by_a_fullscreen_one_need_no_plane)
+{
+    auto const hidden = window({{2020, 100}, {300, 200}});
+    auto const fullscreen = window(output);
+    auto const offscreen = window({{0, 0}, {300, 200}});
+
+    auto const assignment = assign_steady({hidden, fullscreen, offscreen});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(1u));
+    EXPECT_THAT(assignment.layers[0].fb, Eq(fb_of(*fullscreen)));
+}
+
+TEST_F(PlaneAssignerTest, window_not_covering_the_output_is_shown_on_black)
+{
+    auto const centred = window({{2240, 0}, {1280, 1200}}, {640, 600});
+
+    auto const assignment = assign_steady({centred});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(1u));
+    EXPECT_THAT(assignment.layers[0].source, Eq(geom::Rectangle{{0, 0}, {640, 600}}));
+    EXPECT_THAT(assignment.layers[0].destination, Eq(geom::Rectangle{{320, 0}, {1280, 1200}}));
+}
+
+TEST_F(PlaneAssignerTest, window_off_the_edge_of_the_output_is_clipped)
+{
+    auto const fullscreen = window(output);
+    auto const straddling = window({{1820, 0}, {200, 100}}, {100, 50});
+
+    auto const assignment = assign_steady({fullscreen, straddling});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(2u));
+    EXPECT_THAT(assignment.layers[1].source, Eq(geom::Rectangle{{50, 0}, {50, 50}}));
+    EXPECT_THAT(assignment.layers[1].destination, Eq(geom::Rectangle{{0, 0}, {100, 100}}));
+}
+
+TEST_F(PlaneAssignerTest, window_clip_area_is_respected)
+{
+    auto const fullscreen = window(output);
+    auto const clipped = window({{2020, 100}, {300, 200}});
+    clipped->set_clip_area(geom::Rectangle{{2020, 100}, {300, 100}});
+
+    auto const assignment = assign_steady({fullscreen, clipped});
+
+    ASSERT_THAT(assignment.layers.size(), Eq(2u));
+    EXPECT_THAT(assignment.layers[1].source, Eq(geom::Rectangle{{0, 0}, {300, 100}}));
+    EXPECT_THAT(assignment.layers[1].destination, Eq(geom::Rectangle{{100, 100}, {300, 100}}));
+}
+
+TEST_F(PlaneAssignerTest, shaped_window_can_go_on_an_overlay)
+{
+    auto const fullscreen = window(output);
+    auto const shaped = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{2020, 100}, {64, 64}}, 1.0f, false);
+    shaped->set_buffer(std::make_shared<mtd::StubBuffer>(geom::Size{64, 64}));
+
+    EXPECT_THAT(assign_steady({fullscreen, shaped}).layers.size(), Eq(2u));
+}
+
+TEST_F(PlaneAssignerTest, shaped_bottom_window_is_composited)
+{
+    auto const shaped = std::make_shared<mtd::FakeRenderable>(output, 1.0f, false);
+    shaped->set_buffer(std::make_shared<mtd::StubBuffer>(output.size));
+
+    EXPECT_THAT(assign_steady({shaped}).layers, IsEmpty());
+}
+
+TEST_F(PlaneAssignerTest, translucent_window_is_composited)
+{
+    auto const fullscreen = window(output);
+    auto const translucent = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{2020, 100}, {300, 200}}, 0.5f);
+    translucent->set_buffer(std::make_shared<mtd::StubBuffer>(geom::Size{300, 200}));
+
+    EXPECT_THAT(assign_steady({fullscreen, translucent}).layers, IsEmpty());
+}
+
+TEST_F(PlaneAssignerTest, more_windows_than_planes_are_composited)
+{
+    planes.count = 2;
+
+    auto const fullscreen = window(output);
+    auto const dialog = window({{2020, 100}, {300, 200}});
+    auto const tooltip = window({{2120, 200}, {30, 20}});
+
+    EXPECT_THAT(assign_steady({fullscreen, dialog, tooltip}).layers, IsEmpty());
+    EXPECT_THAT(planes.tests, Eq(0));
+}
+
+TEST_F(PlaneAssignerTest, window_that_cannot_be_scanned_out_is_composited)
+{
+    auto const fullscreen = window(output);
+    auto const software = window({{2020, 100}, {300, 200}});
+    unscannable.insert(software->buffer().get());
+
+    EXPECT_THAT(assign_steady({fullscreen, software}).layers, IsEmpty());
+}
+
+TEST_F(PlaneAssignerTest, layers_the_hardware_rejects_are_composited)
+{
+    planes.can_scale = false;
+
+    auto const fullscreen = window(output, {960, 600});
+
+    EXPECT_THAT(assign_steady({fullscreen}).layers, IsEmpty());
+    EXPECT_THAT(planes.tests, Eq(1));
+}
+
+TEST_F(PlaneAssignerTest, scene_must_be_steady_before_going_on_the_planes)
+{
+    mg::RenderableList const scene{window(output)};
+
+    for (auto frame = 1u; frame < stable_frames; ++frame)
+        EXPECT_THAT(assign(scene).layers, IsEmpty()) << "frame " << frame;
+
+    EXPECT_THAT(assign(scene).layers, Not(IsEmpty()));
+    EXPECT_THAT(planes.tests, Eq(1));
+}
+
+TEST_F(PlaneAssignerTest, changing_scene_restarts_the_wait)
+{
+    auto const fullscreen = window(output);
+    mg::RenderableList const scene{fullscreen};
+    mg::RenderableList const changed_scene{fullscreen, window({{2020, 100}, {300, 200}})};
+
+    for (auto frame = 1u; frame < stable_frames; ++frame)
+        assign(scene);
+
+    EXPECT_THAT(assign(changed_scene).layers, IsEmpty());
+    EXPECT_THAT(assign_steady(changed_scene).layers, Not(IsEmpty()));
+}
+
+TEST_F(PlaneAssignerTest, scene_on_the_planes_stays_there_as_it_changes)
+{
+    auto const fullscreen = window(output);
+    auto const dragged = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{2020, 100}, {300, 200}});
+    dragged->set_buffer(std::make_shared<mtd::StubBuffer>(geom::Size{300, 200}));
+    mg::RenderableList const scene{fullscreen, dragged};
+
+    ASSERT_THAT(assign_steady(scene).layers, Not(IsEmpty()));
+
+    auto const moved = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{2030, 110}, {300, 200}});
+    moved->set_buffer(dragged->buffer());
+
+    EXPECT_THAT(assign({fullscreen, moved}).layers, Not(IsEmpty()));
+}
+
+TEST_F(PlaneAssignerTest, scene_that_leaves_the_planes_must_be_steady_to_return)
+{
+    auto const fullscreen = window(output);
+    mg::RenderableList const scene{fullscreen};
+    mg::RenderableList const composited_scene{fullscreen, window({{2020, 100}, {300, 200}}, {1, 1})};
+    unscannable.insert(composited_scene.back()->buffer().get());
+
+    ASSERT_THAT(assign_steady(scene).layers, Not(IsEmpty()));
+    ASSERT_THAT(assign(composited_scene).layers, IsEmpty());
+
+    EXPECT_THAT(assign(scene).layers, IsEmpty());
+    EXPECT_THAT(assign_steady(scene).layers, Not(IsEmpty()));
+}
+
+TEST_F(PlaneAssignerTest, rejected_scene_is_not_retried_until_it_changes)
+{
+    planes.accept = false;
+
+    auto const fullscreen = window(output);
+    mg::RenderableList const scene{fullscreen};
+
+    for (auto frame = 0; frame != 10; ++frame)
+        EXPECT_THAT(assign(scene).layers, IsEmpty());
+    EXPECT_THAT(planes.tests, Eq(1));
+
+    planes.accept = true;
+    mg::RenderableList const changed_scene{fullscreen, window({{2020, 100}, {300, 200}})};
+
+    EXPECT_THAT(assign_steady(changed_scene).layers, Not(IsEmpty()));
+    EXPECT_THAT(planes.tests, Eq(2));
+}
@@ -46,6 +46,7 @@ class NullPageFlipper : public mgm::PageFlipper
 {
 public:
     bool schedule_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_atomic_flip(uint32_t,drmModeAtomicReq*,uint32_t) override { return true; }
     mg::Frame wait_for_flip(uint32_t) override { return {}; }
 };
 
@@ -53,6 +54,7 @@ class MockPageFlipper : public mgm::PageFlipper
 {
 public:
     MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_atomic_flip, bool(uint32_t,drmModeAtomicReq*,uint32_t));
     MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
 };
 
@@ -101,6 +103,109 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    /// A connected CRTC with planes of the given types (DRM_PLANE_TYPE_*), bottom first
+    void setup_outputs_connected_crtc_with_planes(std::vector<uint64_t> const& plane_types)
+    {
+        uint32_t const possible_crtcs_mask{0x1};
+
+        mock_drm.reset(drm_device);
+
+        mock_drm.add_crtc(
+            drm_device,
+            crtc_ids[0],
+            modes[0]);
+        mock_drm.add_encoder(
+            drm_device,
+            encoder_ids[0],
+            crtc_ids[0],
+            possible_crtcs_mask);
+        mock_drm.add_connector(
+            drm_device,
+            connector_ids[0],
+            DRM_MODE_CONNECTOR_DVID,
+            DRM_MODE_CONNECTED,
+            encoder_ids[0],
+            modes,
+            possible_encoder_ids1,
+            geom::Size());
+
+        for (auto i = 0u; i != plane_types.size(); ++i)
+            mock_drm.add_plane(drm_device, plane_ids[i], possible_crtcs_mask, plane_types[i]);
+
+        mock_drm.prepare(drm_device);
+    }
+
+    /// Two connected CRTCs with a primary plane each, either usable with both CRTCs
+    void setup_two_outputs_with_shared_primary_planes(uint32_t plane0_crtc_id, uint32_t plane1_crtc_id)
+    {
+        uint32_t const possible_crtcs_mask_all{0x3};
+
+        mock_drm.reset(drm_device);
+
+        for (auto i = 0u; i != 2; ++i)
+        {
+            std::vector<uint32_t> possible_encoder_ids{encoder_ids[i]};
+
+            mock_drm.add_crtc(
+                drm_device,
+                crtc_ids[i],
+                modes[0]);
+            mock_drm.add_encoder(
+                drm_device,
+                encoder_ids[i],
+                crtc_ids[i],
+                uint32_t{1} << i);
+            mock_drm.add_connector(
+                drm_device,
+                connector_ids[i],
+                DRM_MODE_CONNECTOR_DVID,
+                DRM_MODE_CONNECTED,
+                encoder_ids[i],
+                modes,
+                possible_encoder_ids,
+                geom::Size());
+        }
+
+        mock_drm.add_plane(drm_device, plane_ids[0], possible_crtcs_mask_all, DRM_PLANE_TYPE_PRIMARY, plane0_crtc_id);
+        mock_drm.add_plane(drm_device, plane_ids[1], possible_crtcs_mask_all, DRM_PLANE_TYPE_PRIMARY, plane1_crtc_id);
+
+        mock_drm.prepare(drm_device);
+    }
+
+    /// The plane the output for connector_id flips fb_id onto
+    auto plane_flipped_to(uint32_t connector_id, uint32_t crtc_id) -> uint32_t
+    {
+        uint32_t const fb_id{67};
+        append_fb_id(fb_id);
+
+        mgm::RealKMSOutput output{
+            drm_fd,
+            mg::kms::get_connector(drm_fd, connector_id),
+            mt::fake_shared(mock_page_flipper)};
+
+        auto fb = output.fb_for(fake_bo);
+
+        std::map<std::pair<uint32_t, uint32_t>, uint64_t> flipped;
+        EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(crtc_id, _, connector_id))
+            .WillOnce(Invoke(
+                [&flipped](uint32_t, drmModeAtomicReq* request, uint32_t)
+                {
+                    flipped = mtd::MockDRM::atomic_properties(request);
+                    return true;
+                }));
+
+        EXPECT_TRUE(output.set_crtc(*fb));
+        EXPECT_TRUE(output.schedule_page_flip(*fb));
+
+        auto const fb_id_prop = mtd::MockDRM::plane_property_id("FB_ID");
+        for (auto const& property : flipped)
+        {
+            if (property.first.second == fb_id_prop && property.second == fb_id)
+                return property.first.first;
+        }
+        return invalid_id;
+    }
+
     void setup_outputs_no_connected_crtc()
     {
         uint32_t const possible_crtcs_mask1{0x1};
@@ -162,6 +267,8 @@ public:
     MockPageFlipper mock_page_flipper;
     NullPageFlipper null_page_flipper;
     std::vector<drmModeModeInfo> modes_empty;
+    std::vector<drmModeModeInfo> modes{mtd::FakeDRMResources::create_mode(
+        1920, 1080, 138500, 2080, 1111, mtd::FakeDRMResources::PreferredMode)};
 
     char const* const drm_device = "/dev/dri/card0";
     int const drm_fd;
@@ -171,6 +278,7 @@ public:
     std::vector<uint32_t> const crtc_ids;
     std::vector<uint32_t> const encoder_ids;
     std::vector<uint32_t> const connector_ids;
+    std::vector<uint32_t> const plane_ids{40, 41, 42, 43};
     std::vector<uint32_t> possible_encoder_ids1;
     std::vector<uint32_t> possible_encoder_ids2;
 };
@@ -548,3 +656,199 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, has_no_layers_without_hardware_planes)
+{
+    setup_outputs_connected_crtc();
+
+    uint32_t const fb_id{67};
+    append_fb_id(fb_id);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_CALL(mock_page_flipper, schedule_flip(crtc_ids[0], fb_id, connector_ids[0]))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(_, _, _))
+        .Times(0);
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_THAT(output.max_layers(), Eq(0u));
+    EXPECT_FALSE(output.can_show({{fb, {{0, 0}, {64, 64}}, {{0, 0}, {64, 64}}}}));
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+}
+
+TEST_F(RealKMSOutputTest, max_layers_counts_primary_and_overlay_planes)
+{
+    setup_outputs_connected_crtc_with_planes(
+        {DRM_PLANE_TYPE_PRIMARY, DRM_PLANE_TYPE_OVERLAY, DRM_PLANE_TYPE_CURSOR, DRM_PLANE_TYPE_OVERLAY});
+
+    append_fb_id(67);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_THAT(output.max_layers(), Eq(3u));
+}
+
+TEST_F(RealKMSOutputTest, page_flip_with_hardware_planes_is_atomic_and_disables_overlays)
+{
+    setup_outputs_connected_crtc_with_planes({DRM_PLANE_TYPE_PRIMARY, DRM_PLANE_TYPE_OVERLAY});
+
+    uint32_t const fb_id{67};
+    append_fb_id(fb_id);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> flipped;
+    EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, _))
+        .Times(0);
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(crtc_ids[0], _, connector_ids[0]))
+        .WillOnce(Invoke(
+            [&flipped](uint32_t, drmModeAtomicReq* request, uint32_t)
+            {
+                flipped = mtd::MockDRM::atomic_properties(request);
+                return true;
+            }));
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+
+    auto const fb_id_prop = mtd::MockDRM::plane_property_id("FB_ID");
+    auto const crtc_w_prop = mtd::MockDRM::plane_property_id("CRTC_W");
+    EXPECT_THAT(flipped[std::make_pair(plane_ids[0], fb_id_prop)], Eq(fb_id));
+    EXPECT_THAT(flipped[std::make_pair(plane_ids[0], crtc_w_prop)], Eq(1920u));
+    EXPECT_THAT(flipped.count(std::make_pair(plane_ids[1], fb_id_prop)), Eq(1u));
+    EXPECT_THAT(flipped[std::make_pair(plane_ids[1], fb_id_prop)], Eq(0u));
+}
+
+TEST_F(RealKMSOutputTest, page_flip_to_layers_puts_each_on_a_plane)
+{
+    setup_outputs_connected_crtc_with_planes({DRM_PLANE_TYPE_PRIMARY, DRM_PLANE_TYPE_OVERLAY});
+
+    uint32_t const fb_ids[]{67, 68};
+    append_fb_id(fb_ids[0]);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto primary_fb = output.fb_for(fake_bo);
+    append_fb_id(fb_ids[1]);
+    auto overlay_fb = output.fb_for(reinterpret_cast<gbm_bo*>(0x456cd));
+
+    geom::Rectangle const overlay_source{{0, 0}, {200, 100}};
+    geom::Rectangle const overlay_destination{{300, 400}, {200, 100}};
+
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> flipped;
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(crtc_ids[0], _, connector_ids[0]))
+        .WillOnce(Invoke(
+            [&flipped](uint32_t, drmModeAtomicReq* request, uint32_t)
+            {
+                flipped = mtd::MockDRM::atomic_properties(request);
+                return true;
+            }));
+
+    EXPECT_TRUE(output.set_crtc(*primary_fb));
+    EXPECT_TRUE(output.schedule_page_flip(
+        std::vector<mgm::PlaneLayer>{
+            {primary_fb, {{0, 0}, output.size()}, {{0, 0}, output.size()}},
+            {overlay_fb, overlay_source, overlay_destination}}));
+
+    auto const overlay_prop =
+        [&](char const* name) { return flipped[std::make_pair(plane_ids[1], mtd::MockDRM::plane_property_id(name))]; };
+
+    EXPECT_THAT(overlay_prop("FB_ID"), Eq(fb_ids[1]));
+    EXPECT_THAT(overlay_prop("CRTC_ID"), Eq(crtc_ids[0]));
+    EXPECT_THAT(overlay_prop("SRC_W"), Eq(200u << 16));
+    EXPECT_THAT(overlay_prop("SRC_H"), Eq(100u << 16));
+    EXPECT_THAT(overlay_prop("CRTC_X"), Eq(300u));
+    EXPECT_THAT(overlay_prop("CRTC_Y"), Eq(400u));
+    EXPECT_THAT(overlay_prop("CRTC_W"), Eq(200u));
+    EXPECT_THAT(overlay_prop("CRTC_H"), Eq(100u));
+}
+
+TEST_F(RealKMSOutputTest, can_show_asks_the_kernel_with_a_test_only_commit)
+{
+    setup_outputs_connected_crtc_with_planes({DRM_PLANE_TYPE_PRIMARY, DRM_PLANE_TYPE_OVERLAY});
+
+    append_fb_id(67);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    std::vector<mgm::PlaneLayer> const layers{
+        {fb, {{0, 0}, output.size()}, {{0, 0}, output.size()}},
+        {fb, {{0, 0}, {64, 64}}, {{10, 10}, {64, 64}}}};
+
+    // Other (modesetting) commits are fine
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .WillOnce(Return(0))
+        .WillOnce(Return(-EINVAL));
+
+    EXPECT_TRUE(output.can_show(layers));
+    EXPECT_FALSE(output.can_show(layers));
+}
+
+TEST_F(RealKMSOutputTest, can_not_show_more_layers_than_planes)
+{
+    setup_outputs_connected_crtc_with_planes({DRM_PLANE_TYPE_PRIMARY, DRM_PLANE_TYPE_OVERLAY});
+
+    append_fb_id(67);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    mgm::PlaneLayer const layer{fb, {{0, 0}, {64, 64}}, {{0, 0}, {64, 64}}};
+
+    // Other (modesetting) commits are fine
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .Times(0);
+
+    EXPECT_FALSE(output.can_show({layer, layer, layer}));
+}
+
+TEST_F(RealKMSOutputTest, uses_the_primary_plane_already_driving_its_crtc)
+{
+    // The first primary plane is compatible with both CRTCs, but in use by the other one
+    setup_two_outputs_with_shared_primary_planes(crtc_ids[1], crtc_ids[0]);
+
+    EXPECT_THAT(plane_flipped_to(connector_ids[0], crtc_ids[0]), Eq(plane_ids[1]));
+}
+
+TEST_F(RealKMSOutputTest, uses_the_primary_plane_at_its_crtc_index_if_none_is_driving_it)
+{
+    setup_two_outputs_with_shared_primary_planes(invalid_id, invalid_id);
+
+    EXPECT_THAT(plane_flipped_to(connector_ids[0], crtc_ids[0]), Eq(plane_ids[0]));
+    EXPECT_THAT(plane_flipped_to(connector_ids[1], crtc_ids[1]), Eq(plane_ids[1]));
+}
@@ -183,6 +183,34 @@ TEST_F(GLRenderer, enables_blending_for_rgba_surfaces)
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, disables_blending_for_rgba_surfaces_that_are_entirely_opaque)
+{
+    EXPECT_CALL(*renderable, shaped()).WillRepeatedly(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1,2},{3,4}}}));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, blends_only_outside_opaque_region_of_rgba_surfaces)
+{
+    EXPECT_CALL(*renderable, shaped()).WillRepeatedly(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1,2},{3,2}}}));
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, enables_blending_for_rgbx_translucent_surfaces)
 {
     EXPECT_CALL(*renderable, alpha()).WillRepeatedly(Return(0.5f));
@@ -220,6 +248,41 @@ TEST_F(GLRenderer, avoids_src_alpha_for_rgbx_blending)  // LP: #1423462
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, batched_submission_streams_frame_into_vertex_buffer)
+{
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, 6 * sizeof(mgl::Vertex), _, GL_STREAM_DRAW));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 0, 6));
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::Submission::batched);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, batched_submission_draws_renderables_sharing_state_together)
+{
+    renderable_list.push_back(renderable);
+
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 0, 12));
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::Submission::batched);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, batched_submission_blends_only_outside_opaque_region_of_rgba_surfaces)
+{
+    EXPECT_CALL(*renderable, shaped()).WillRepeatedly(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1,2},{3,2}}}));
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 0, 6));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 6, 6));
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::Submission::batched);
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, clears_all_channels_zero)
 {
     InSequence seq;
@@ -466,3 +529,93 @@ TEST_F(GLRenderer, sets_viewport_downscaled_wide)
 
     mrg::Renderer renderer(mock_display_buffer);
 }
+
+namespace
+{
+struct GLRendererWithBufferAge : GLRenderer
+{
+    GLRendererWithBufferAge()
+    {
+        ON_CALL(mock_egl, eglGetCurrentSurface(EGL_DRAW))
+            .WillByDefault(Return(fake_surface));
+        ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+            .WillByDefault(DoAll(SetArgPointee<3>(view_area.size.width.as_int()),
+                                 Return(EGL_TRUE)));
+        ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+            .WillByDefault(DoAll(SetArgPointee<3>(view_area.size.height.as_int()),
+                                 Return(EGL_TRUE)));
+        ON_CALL(mock_display_buffer, view_area())
+            .WillByDefault(Return(view_area));
+    }
+
+    void set_buffer_age(EGLint age)
+    {
+        ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_BUFFER_AGE_EXT,_))
+            .WillByDefault(DoAll(SetArgPointee<3>(age),
+                                 Return(EGL_TRUE)));
+    }
+
+    EGLSurface const fake_surface{reinterpret_cast<EGLSurface>(0x5ca1ab1e)};
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+    mir::geometry::Rectangle const damage{{10,20}, {30,40}};
+};
+}
+
+TEST_F(GLRendererWithBufferAge, repaints_only_damage_when_back_buffer_is_previous_frame)
+{
+    set_buffer_age(1);
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_gl, glEnable(GL_SCISSOR_TEST));
+    EXPECT_CALL(mock_gl, glScissor(10, 1020, 30, 40));
+    EXPECT_CALL(mock_gl, glDisable(GL_SCISSOR_TEST));
+
+    renderer.set_damage(mir::geometry::Rectangles{damage});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererWithBufferAge, repaints_everything_when_buffer_age_is_unknown)
+{
+    set_buffer_age(0);
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_gl, glScissor(_, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glClear(_));
+
+    renderer.set_damage(mir::geometry::Rectangles{damage});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererWithBufferAge, repaints_everything_when_no_damage_is_set)
+{
+    set_buffer_age(1);
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_gl, glScissor(_, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glClear(_));
+
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererWithBufferAge, repaints_damage_from_frames_missing_from_back_buffer)
+{
+    mir::geometry::Rectangle const earlier_damage{{100,200}, {50,60}};
+
+    set_buffer_age(1);
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    renderer.set_damage(mir::geometry::Rectangles{earlier_damage});
+    renderer.render(renderable_list);
+
+    set_buffer_age(2);
+
+    EXPECT_CALL(mock_gl, glScissor(10, 1020, 30, 40));
+    EXPECT_CALL(mock_gl, glScissor(100, 820, 50, 60));
+
+    renderer.set_damage(mir::geometry::Rectangles{damage});
+    renderer.render(renderable_list);
+}
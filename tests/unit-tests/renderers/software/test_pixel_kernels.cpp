@@ -0,0 +1,199 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/pixel_kernels.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+
+namespace mrs = mir::renderer::software;
+
+using namespace testing;
+
+namespace
+{
+// Enough to cover the widest vector loop and its scalar tail
+int const max_count = 37;
+
+std::vector<uint32_t> premultiplied_pixels(size_t count)
+{
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<uint32_t> channel{0, 255};
+
+    std::vector<uint32_t> pixels(count);
+    for (auto& pixel : pixels)
+    {
+        // Plenty of the fully opaque and fully transparent pixels the fast paths look for
+        auto alpha = channel(generator);
+        if (alpha < 64)
+            alpha = 0;
+        else if (alpha > 192)
+            alpha = 255;
+
+        auto const premultiplied = [&] { return channel(generator) * alpha / 255; };
+        pixel = alpha << 24 | premultiplied() << 16 | premultiplied() << 8 | premultiplied();
+    }
+    return pixels;
+}
+
+struct PixelKernels : TestWithParam<mrs::PixelKernels const*>
+{
+    mrs::PixelKernels const& kernels{*GetParam()};
+    mrs::PixelKernels const& reference{mrs::scalar_kernels()};
+
+    std::vector<uint32_t> const src{premultiplied_pixels(max_count + 1)};
+    std::vector<uint32_t> const dst{premultiplied_pixels(2*max_count + 1)};
+};
+
+std::string name_of(TestParamInfo<mrs::PixelKernels const*> const& info)
+{
+    return info.param->name;
+}
+}
+
+TEST(ScalarPixelKernels, opaque_source_replaces_destination)
+{
+    uint32_t dst = 0xff102030;
+    uint32_t const src = 0xff405060;
+
+    mrs::scalar_kernels().blend(&dst, &src, 1, 255);
+
+    EXPECT_THAT(dst, Eq(src));
+}
+
+TEST(ScalarPixelKernels, transparent_source_leaves_destination)
+{
+    uint32_t dst = 0xff102030;
+    uint32_t const src = 0;
+
+    mrs::scalar_kernels().blend(&dst, &src, 1, 255);
+
+    EXPECT_THAT(dst, Eq(0xff102030u));
+}
+
+TEST(ScalarPixelKernels, blends_premultiplied_source_over_destination)
+{
+    uint32_t dst = 0xffffffff;
+    uint32_t const src = 0x80800000;
+
+    mrs::scalar_kernels().blend(&dst, &src, 1, 255);
+
+    EXPECT_THAT(dst, Eq(0xffff7f7fu));
+}
+
+TEST(ScalarPixelKernels, opaque_blend_ignores_source_alpha_channel)
+{
+    uint32_t dst = 0xffffffff;
+    uint32_t const src = 0x00000000;
+
+    mrs::scalar_kernels().blend_opaque(&dst, &src, 1, 255);
+
+    EXPECT_THAT(dst, Eq(0xff000000u));
+}
+
+TEST(ScalarPixelKernels, scales_source_by_alpha)
+{
+    uint32_t dst = 0xff000000;
+    uint32_t const src = 0xffffffff;
+
+    mrs::scalar_kernels().blend(&dst, &src, 1, 128);
+
+    EXPECT_THAT(dst, Eq(0xff808080u));
+}
+
+TEST_P(PixelKernels, blend_matches_scalar_reference)
+{
+    for (unsigned alpha : {255u, 200u, 1u})
+    {
+        for (int count = 0; count <= max_count; ++count)
+        {
+            // Offset by one to exercise unaligned loads and stores
+            auto expected = dst;
+            auto actual = dst;
+            reference.blend(expected.data() + 1, src.data() + 1, count, alpha);
+            kernels.blend(actual.data() + 1, src.data() + 1, count, alpha);
+
+            ASSERT_THAT(actual, ContainerEq(expected)) << "count=" << count << " alpha=" << alpha;
+        }
+    }
+}
+
+TEST_P(PixelKernels, opaque_blend_matches_scalar_reference)
+{
+    for (unsigned alpha : {255u, 200u, 1u})
+    {
+        for (int count = 0; count <= max_count; ++count)
+        {
+            auto expected = dst;
+            auto actual = dst;
+            reference.blend_opaque(expected.data(), src.data(), count, alpha);
+            kernels.blend_opaque(actual.data(), src.data(), count, alpha);
+
+            ASSERT_THAT(actual, ContainerEq(expected)) << "count=" << count << " alpha=" << alpha;
+        }
+    }
+}
+
+TEST_P(PixelKernels, reverse_matches_scalar_reference)
+{
+    for (int count = 0; count <= max_count; ++count)
+    {
+        auto expected = dst;
+        auto actual = dst;
+        reference.reverse(expected.data() + 1, src.data(), count);
+        kernels.reverse(actual.data() + 1, src.data(), count);
+
+        ASSERT_THAT(actual, ContainerEq(expected)) << "count=" << count;
+    }
+}
+
+TEST_P(PixelKernels, transpose_matches_scalar_reference)
+{
+    int const stride = 11;
+    auto const image = premultiplied_pixels(stride*stride);
+
+    for (int width = 0; width <= stride; ++width)
+    {
+        for (int height = 0; height <= stride; ++height)
+        {
+            std::vector<uint32_t> expected(stride*stride);
+            auto actual = expected;
+            reference.transpose(expected.data(), stride, image.data(), stride, width, height);
+            kernels.transpose(actual.data(), stride, image.data(), stride, width, height);
+
+            ASSERT_THAT(actual, ContainerEq(expected)) << "width=" << width << " height=" << height;
+        }
+    }
+}
+
+TEST_P(PixelKernels, transpose_handles_negative_strides)
+{
+    int const stride = 11;
+    auto const image = premultiplied_pixels(stride*stride);
+    auto const last_row = image.data() + (stride - 1)*stride;
+
+    std::vector<uint32_t> expected(stride*stride);
+    auto actual = expected;
+    reference.transpose(expected.data() + (stride - 1)*stride, -stride, last_row, -stride, 9, 10);
+    kernels.transpose(actual.data() + (stride - 1)*stride, -stride, last_row, -stride, 9, 10);
+
+    EXPECT_THAT(actual, ContainerEq(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SupportedKernels, PixelKernels, ValuesIn(mrs::supported_kernels()), name_of);
@@ -0,0 +1,323 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "src/renderers/software/renderer_factory.h"
+
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/buffer_properties.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const black = 0xff000000;
+uint32_t const red = 0xffff0000;
+uint32_t const blue = 0xff0000ff;
+uint32_t const marker = 0x12345678;
+
+class SoftwareDisplayBuffer : public mtd::StubDisplayBuffer, public mrs::RenderTarget
+{
+public:
+    SoftwareDisplayBuffer(geom::Rectangle const& view_area, geom::Size const& target_size)
+        : StubDisplayBuffer{view_area},
+          target_size{target_size},
+          pixels(target_size.width.as_int() * target_size.height.as_int(), marker)
+    {
+    }
+
+    geom::Size size() const override
+    {
+        return target_size;
+    }
+
+    void write(std::function<void(unsigned char*, geom::Stride)> const& do_with_pixels) override
+    {
+        do_with_pixels(
+            reinterpret_cast<unsigned char*>(pixels.data()),
+            geom::Stride{target_size.width.as_int() * 4});
+    }
+
+    void swap_buffers() override
+    {
+        ++swaps;
+    }
+
+    uint32_t pixel_at(int x, int y) const
+    {
+        return pixels[y * target_size.width.as_int() + x];
+    }
+
+    geom::Size const target_size;
+    std::vector<uint32_t> pixels;
+    int swaps{0};
+};
+
+std::shared_ptr<mtd::StubBuffer> buffer_of(
+    geom::Size const& size, uint32_t colour, MirPixelFormat format = mir_pixel_format_argb_8888)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+    std::vector<uint32_t> const pixels(size.width.as_int() * size.height.as_int(), colour);
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * 4);
+    return buffer;
+}
+
+std::shared_ptr<mtd::FakeRenderable> renderable_of(
+    geom::Rectangle const& position, uint32_t colour, float alpha = 1.0f, bool rectangular = true)
+{
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(position, alpha, rectangular);
+    renderable->set_buffer(buffer_of(position.size, colour));
+    return renderable;
+}
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {8, 6}};
+    SoftwareDisplayBuffer display_buffer{view_area, view_area.size};
+};
+}
+
+TEST_F(SoftwareRenderer, draws_buffer_at_its_screen_position_over_black)
+{
+    mrs::Renderer renderer{display_buffer};
+
+    renderer.render({renderable_of({{2, 1}, {3, 2}}, red)});
+
+    EXPECT_THAT(display_buffer.pixel_at(2, 1), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(4, 2), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(1, 1), Eq(black));
+    EXPECT_THAT(display_buffer.pixel_at(5, 2), Eq(black));
+    EXPECT_THAT(display_buffer.pixel_at(2, 3), Eq(black));
+    EXPECT_THAT(display_buffer.swaps, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, draws_relative_to_viewport)
+{
+    display_buffer.pixels.assign(display_buffer.pixels.size(), marker);
+    mrs::Renderer renderer{display_buffer};
+    renderer.set_viewport({{100, 100}, view_area.size});
+
+    renderer.render({renderable_of({{101, 102}, {1, 1}}, red)});
+
+    EXPECT_THAT(display_buffer.pixel_at(1, 2), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, blends_translucent_renderable_over_those_below)
+{
+    mrs::Renderer renderer{display_buffer};
+
+    renderer.render({
+        renderable_of({{0, 0}, {8, 6}}, blue),
+        renderable_of({{0, 0}, {4, 6}}, red, 0.5f)});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0xff80007fu));
+    EXPECT_THAT(display_buffer.pixel_at(4, 0), Eq(blue));
+}
+
+TEST_F(SoftwareRenderer, honours_alpha_channel_of_shaped_renderables)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const translucent = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {8, 6}}, 1.0f, false);
+    translucent->set_buffer(buffer_of({8, 6}, 0x80800000));
+
+    renderer.render({renderable_of({{0, 0}, {8, 6}}, blue), translucent});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0xff80007fu));
+}
+
+TEST_F(SoftwareRenderer, treats_xrgb_buffers_as_opaque)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const xrgb = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {8, 6}}, 1.0f, false);
+    xrgb->set_buffer(buffer_of({8, 6}, 0x00ff0000, mir_pixel_format_xrgb_8888));
+
+    renderer.render({renderable_of({{0, 0}, {8, 6}}, blue), xrgb});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(red));
+}
+
+TEST_F(SoftwareRenderer, skips_unsupported_pixel_formats)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const abgr = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {8, 6}});
+    abgr->set_buffer(buffer_of({8, 6}, red, mir_pixel_format_abgr_8888));
+
+    renderer.render({abgr});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, clips_to_clip_area)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const clipped = renderable_of({{0, 0}, {8, 6}}, red);
+    clipped->set_clip_area(geom::Rectangle{{1, 1}, {2, 2}});
+
+    renderer.render({clipped});
+
+    EXPECT_THAT(display_buffer.pixel_at(1, 1), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(2, 2), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(black));
+    EXPECT_THAT(display_buffer.pixel_at(3, 3), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, scales_buffer_to_screen_position)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const scaled = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {4, 1}});
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{{2, 1}, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+    uint32_t const pixels[] = {red, blue};
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels), sizeof pixels);
+    scaled->set_buffer(buffer);
+
+    renderer.render({scaled});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(1, 0), Eq(red));
+    EXPECT_THAT(display_buffer.pixel_at(2, 0), Eq(blue));
+    EXPECT_THAT(display_buffer.pixel_at(3, 0), Eq(blue));
+}
+
+TEST_F(SoftwareRenderer, only_repaints_damaged_areas)
+{
+    mrs::Renderer renderer{display_buffer};
+    renderer.render({renderable_of({{0, 0}, {8, 6}}, red)});
+    display_buffer.pixels.assign(display_buffer.pixels.size(), marker);
+
+    renderer.set_damage(geom::Rectangles{{{1, 1}, {2, 2}}});
+    renderer.render({renderable_of({{0, 0}, {8, 6}}, blue)});
+
+    EXPECT_THAT(display_buffer.pixel_at(1, 1), Eq(blue));
+    EXPECT_THAT(display_buffer.pixel_at(2, 2), Eq(blue));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(marker));
+    EXPECT_THAT(display_buffer.pixel_at(3, 3), Eq(marker));
+}
+
+TEST_F(SoftwareRenderer, overlapping_damage_is_blended_once)
+{
+    mrs::Renderer renderer{display_buffer};
+    renderer.render({});
+
+    renderer.set_damage(geom::Rectangles{{{0, 0}, {4, 4}}, {{2, 2}, {4, 4}}});
+    renderer.render({renderable_of({{0, 0}, {8, 6}}, red, 0.5f)});
+
+    EXPECT_THAT(display_buffer.pixel_at(3, 3), Eq(display_buffer.pixel_at(0, 0)));
+}
+
+TEST_F(SoftwareRenderer, repaints_everything_after_suspend)
+{
+    mrs::Renderer renderer{display_buffer};
+    renderer.render({});
+    display_buffer.pixels.assign(display_buffer.pixels.size(), marker);
+
+    renderer.suspend();
+    renderer.set_damage(geom::Rectangles{{{1, 1}, {1, 1}}});
+    renderer.render({});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(black)));
+}
+
+TEST(SoftwareRendererTransform, rotates_output)
+{
+    // Scene pixel (x, y) lands at (5 - y, x) of the 6×8 target
+    SoftwareDisplayBuffer display_buffer{{{0, 0}, {8, 6}}, {6, 8}};
+    mrs::Renderer renderer{display_buffer};
+    renderer.set_output_transform(glm::mat2{0, 1, -1, 0});
+
+    renderer.render({renderable_of({{2, 1}, {1, 1}}, red)});
+
+    EXPECT_THAT(display_buffer.pixel_at(4, 2), Eq(red));
+    EXPECT_THAT(std::count(display_buffer.pixels.begin(), display_buffer.pixels.end(), red), Eq(1));
+    EXPECT_THAT(display_buffer.pixels, Each(AnyOf(Eq(red), Eq(black))));
+}
+
+TEST(SoftwareRendererTransform, rotates_output_the_other_way)
+{
+    // Scene pixel (x, y) lands at (y, 7 - x) of the 6×8 target
+    SoftwareDisplayBuffer display_buffer{{{0, 0}, {8, 6}}, {6, 8}};
+    mrs::Renderer renderer{display_buffer};
+    renderer.set_output_transform(glm::mat2{0, -1, 1, 0});
+
+    renderer.render({renderable_of({{2, 1}, {1, 1}}, red)});
+
+    EXPECT_THAT(display_buffer.pixel_at(1, 5), Eq(red));
+    EXPECT_THAT(std::count(display_buffer.pixels.begin(), display_buffer.pixels.end(), red), Eq(1));
+}
+
+TEST(SoftwareRendererTransform, inverts_output)
+{
+    SoftwareDisplayBuffer display_buffer{{{0, 0}, {8, 6}}, {8, 6}};
+    mrs::Renderer renderer{display_buffer};
+    renderer.set_output_transform(glm::mat2{-1, 0, 0, -1});
+
+    renderer.render({renderable_of({{2, 1}, {1, 1}}, red)});
+
+    EXPECT_THAT(display_buffer.pixel_at(5, 4), Eq(red));
+    EXPECT_THAT(std::count(display_buffer.pixels.begin(), display_buffer.pixels.end(), red), Eq(1));
+}
+
+TEST(SoftwareRendererFactory, creates_renderers_for_software_display_buffers)
+{
+    struct FailingFactory : mir::renderer::RendererFactory
+    {
+        std::unique_ptr<mir::renderer::Renderer> create_renderer_for(mg::DisplayBuffer&) override
+        {
+            ADD_FAILURE() << "Unexpected fallback";
+            return nullptr;
+        }
+    };
+
+    SoftwareDisplayBuffer display_buffer{{{0, 0}, {8, 6}}, {8, 6}};
+    mrs::RendererFactory factory{std::make_shared<FailingFactory>()};
+
+    EXPECT_THAT(factory.create_renderer_for(display_buffer), NotNull());
+}
+
+TEST(SoftwareRendererFactory, falls_back_for_other_display_buffers)
+{
+    struct CountingFactory : mir::renderer::RendererFactory
+    {
+        std::unique_ptr<mir::renderer::Renderer> create_renderer_for(mg::DisplayBuffer&) override
+        {
+            ++calls;
+            return nullptr;
+        }
+        int calls{0};
+    };
+
+    mtd::StubDisplayBuffer display_buffer{{{0, 0}, {8, 6}}};
+    auto const fallback = std::make_shared<CountingFactory>();
+    mrs::RendererFactory factory{fallback};
+
+    factory.create_renderer_for(display_buffer);
+
+    EXPECT_THAT(fallback->calls, Eq(1));
+}
@@ -72,6 +72,7 @@ public:
     MOCK_METHOD2(cursor_image_set_to, void(ms::Surface const*, mir::graphics::CursorImage const& image));
     MOCK_METHOD1(cursor_image_removed, void(ms::Surface const*));
     MOCK_METHOD2(application_id_set_to, void(ms::Surface const*, std::string const&));
+    MOCK_METHOD2(input_region_set_to, void(ms::Surface const*, std::vector<geom::Rectangle> const&));
 };
 
 struct BasicSurfaceTest : public testing::Test
@@ -640,6 +641,50 @@ TEST_F(BasicSurfaceTest, updates_default_input_region_when_surface_is_resized_to
     }
 }
 
+TEST_F(BasicSurfaceTest, input_region_may_extend_beyond_input_bounds)
+{
+    // As for a Wayland subsurface placed outside its parent
+    surface.set_input_region({{{0, 0}, {12, 15}}, {{-10, -10}, {5, 5}}});
+
+    EXPECT_TRUE(surface.input_area_contains(rect.top_left));
+    EXPECT_TRUE(surface.input_area_contains(rect.top_left - geom::Displacement{10, 10}));
+    EXPECT_FALSE(surface.input_area_contains(rect.top_left - geom::Displacement{1, 1}));
+    EXPECT_FALSE(surface.input_area_contains(rect.bottom_right()));
+}
+
+TEST_F(BasicSurfaceTest, input_area_bounds_are_input_bounds_by_default)
+{
+    EXPECT_THAT(surface.input_area_bounds(), Eq(surface.input_bounds()));
+}
+
+TEST_F(BasicSurfaceTest, input_area_bounds_cover_custom_input_region)
+{
+    surface.set_input_region({{{0, 0}, {12, 15}}, {{-10, -10}, {5, 5}}, {{100, 100}, {0, 0}}});
+
+    EXPECT_THAT(surface.input_area_bounds(), Eq(geom::Rectangle{rect.top_left - geom::Displacement{10, 10}, {22, 25}}));
+}
+
+TEST_F(BasicSurfaceTest, input_area_bounds_are_empty_when_input_is_disabled)
+{
+    surface.set_input_region({geom::Rectangle{}});
+
+    EXPECT_THAT(surface.input_area_bounds(), Eq(geom::Rectangle{}));
+}
+
+TEST_F(BasicSurfaceTest, notifies_observers_of_input_region)
+{
+    using namespace testing;
+
+    std::vector<geom::Rectangle> const region{{{1, 2}, {3, 4}}};
+
+    auto const mock_surface_observer = std::make_shared<NiceMock<MockSurfaceObserver>>();
+    surface.add_observer(mock_surface_observer);
+
+    EXPECT_CALL(*mock_surface_observer, input_region_set_to(_, Eq(region)));
+
+    surface.set_input_region(region);
+}
+
 TEST_F(BasicSurfaceTest, restores_default_input_region_when_setting_empty_input_region)
 {
     std::vector<geom::Rectangle> const rectangles = {
@@ -1230,6 +1275,23 @@ TEST_F(BasicSurfaceTest, adds_buffer_streams)
 
 }
 
+TEST_F(BasicSurfaceTest, opaque_region_of_stream_is_reported_in_screen_coordinates)
+{
+    using namespace testing;
+    ms::StreamInfo info{mock_buffer_stream, {0,0}, geom::Size{12, 15}};
+    info.opaque_region = {{{2, 3}, {4, 5}}, {{10, 10}, {100, 100}}};
+
+    surface.set_streams({info});
+
+    auto renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+    EXPECT_THAT(
+        renderables[0]->opaque_region(),
+        Eq(geom::Rectangles{
+            {rect.top_left + geom::Displacement{2, 3}, {4, 5}},
+            {rect.top_left + geom::Displacement{10, 10}, {2, 5}}}));
+}
+
 TEST_F(BasicSurfaceTest, moving_surface_repositions_all_associated_streams)
 {
     using namespace testing;
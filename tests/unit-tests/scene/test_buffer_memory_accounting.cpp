@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/scene/buffer_memory_accounting.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+
+namespace ms = mir::scene;
+
+using namespace testing;
+
+namespace
+{
+struct BufferMemoryAccounting : Test
+{
+    ms::BufferMemoryAccounting accounting{1024, ms::BufferMemoryPolicy::reject};
+
+    ms::Session const* const session1 = reinterpret_cast<ms::Session const*>(0x1);
+    ms::Session const* const session2 = reinterpret_cast<ms::Session const*>(0x2);
+
+    static auto usage(size_t buffers, size_t bytes) -> ms::BufferMemoryUsage
+    {
+        ms::BufferMemoryUsage result;
+        result.buffers = buffers;
+        result.bytes = bytes;
+        return result;
+    }
+};
+}
+
+TEST_F(BufferMemoryAccounting, reports_configuration)
+{
+    EXPECT_THAT(accounting.limit(), Eq(1024u));
+    EXPECT_THAT(accounting.policy(), Eq(ms::BufferMemoryPolicy::reject));
+}
+
+TEST_F(BufferMemoryAccounting, unknown_session_has_no_usage)
+{
+    EXPECT_THAT(accounting.usage_of(session1).buffers, Eq(0u));
+    EXPECT_THAT(accounting.usage_of(session1).bytes, Eq(0u));
+}
+
+TEST_F(BufferMemoryAccounting, reports_latest_update_per_session)
+{
+    accounting.update(session1, usage(1, 100));
+    accounting.update(session2, usage(2, 200));
+    accounting.update(session1, usage(3, 300));
+
+    EXPECT_THAT(accounting.usage_of(session1).bytes, Eq(300u));
+    EXPECT_THAT(accounting.usage_of(session2).bytes, Eq(200u));
+
+    std::map<ms::Session const*, size_t> seen;
+    accounting.for_each([&](ms::Session const* session, ms::BufferMemoryUsage const& usage)
+        { seen[session] = usage.buffers; });
+
+    EXPECT_THAT(seen, ElementsAre(Pair(session1, 3u), Pair(session2, 2u)));
+}
+
+TEST_F(BufferMemoryAccounting, forgets_removed_session)
+{
+    accounting.update(session1, usage(1, 100));
+    accounting.remove(session1);
+
+    EXPECT_THAT(accounting.usage_of(session1).bytes, Eq(0u));
+
+    auto calls = 0;
+    accounting.for_each([&](ms::Session const*, ms::BufferMemoryUsage const&) { ++calls; });
+    EXPECT_THAT(calls, Eq(0));
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/surface_input_index.h"
+
+#include "mir/test/doubles/mock_surface.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+struct SurfaceInputIndex : Test
+{
+    std::shared_ptr<ms::Surface> surface_at(geom::Rectangle const& bounds)
+    {
+        auto const surface = std::make_shared<NiceMock<mtd::MockSurface>>();
+        surface->move_to(bounds.top_left);
+        surface->resize(bounds.size);
+        return surface;
+    }
+
+    void restack(std::vector<std::shared_ptr<ms::Surface>> const& bottom_to_top)
+    {
+        index.restack({bottom_to_top});
+    }
+
+    std::shared_ptr<ms::Surface> const bottom{surface_at({{0, 0}, {1000, 1000}})};
+    std::shared_ptr<ms::Surface> const middle{surface_at({{100, 100}, {200, 200}})};
+    std::shared_ptr<ms::Surface> const top{surface_at({{150, 150}, {500, 500}})};
+
+    ms::SurfaceInputIndex index;
+};
+}
+
+TEST_F(SurfaceInputIndex, finds_nothing_when_empty)
+{
+    EXPECT_THAT(index.candidates_at({10, 10}), IsEmpty());
+}
+
+TEST_F(SurfaceInputIndex, finds_surfaces_containing_point_topmost_first)
+{
+    index.add(bottom);
+    index.add(middle);
+    index.add(top);
+    restack({bottom, middle, top});
+
+    EXPECT_THAT(index.candidates_at({200, 200}), ElementsAre(top, middle, bottom));
+    EXPECT_THAT(index.candidates_at({120, 120}), ElementsAre(middle, bottom));
+    EXPECT_THAT(index.candidates_at({900, 900}), ElementsAre(bottom));
+    EXPECT_THAT(index.candidates_at({1000, 1000}), IsEmpty());
+}
+
+TEST_F(SurfaceInputIndex, follows_stacking_order)
+{
+    index.add(bottom);
+    index.add(middle);
+    index.add(top);
+    restack({top, middle, bottom});
+
+    EXPECT_THAT(index.candidates_at({200, 200}), ElementsAre(bottom, middle, top));
+}
+
+TEST_F(SurfaceInputIndex, later_layers_are_above_earlier_ones)
+{
+    index.add(bottom);
+    index.add(top);
+    index.restack({{top}, {bottom}});
+
+    EXPECT_THAT(index.candidates_at({200, 200}), ElementsAre(bottom, top));
+}
+
+TEST_F(SurfaceInputIndex, removed_surface_is_not_found)
+{
+    index.add(bottom);
+    index.add(middle);
+    restack({bottom, middle});
+
+    index.remove(middle.get());
+
+    EXPECT_THAT(index.candidates_at({120, 120}), ElementsAre(bottom));
+}
+
+TEST_F(SurfaceInputIndex, finds_surface_at_new_position_after_update)
+{
+    index.add(middle);
+    restack({middle});
+
+    middle->move_to({2000, 2000});
+    index.update(middle.get());
+
+    EXPECT_THAT(index.candidates_at({120, 120}), IsEmpty());
+    EXPECT_THAT(index.candidates_at({2100, 2100}), ElementsAre(middle));
+}
+
+TEST_F(SurfaceInputIndex, finds_surface_at_new_size_after_update)
+{
+    index.add(middle);
+    restack({middle});
+
+    middle->resize({10, 10});
+    index.update(middle.get());
+
+    EXPECT_THAT(index.candidates_at({120, 120}), IsEmpty());
+    EXPECT_THAT(index.candidates_at({105, 105}), ElementsAre(middle));
+}
+
+TEST_F(SurfaceInputIndex, finds_surface_by_input_region_outside_its_bounds)
+{
+    // A Wayland parent's input region includes its subsurfaces, even outside the parent
+    middle->set_input_region({{{0, 0}, {200, 200}}, {{1000, 0}, {100, 100}}});
+    index.add(middle);
+    restack({middle});
+
+    EXPECT_THAT(index.candidates_at({1150, 150}), ElementsAre(middle));
+    EXPECT_THAT(index.candidates_at({2000, 150}), IsEmpty());
+}
+
+TEST_F(SurfaceInputIndex, finds_surface_by_new_input_region_after_update)
+{
+    index.add(middle);
+    restack({middle});
+
+    middle->set_input_region({{{-50, -50}, {10, 10}}});
+    index.update(middle.get());
+
+    EXPECT_THAT(index.candidates_at({55, 55}), ElementsAre(middle));
+    EXPECT_THAT(index.candidates_at({150, 150}), IsEmpty());
+}
+
+TEST_F(SurfaceInputIndex, finds_surfaces_at_negative_coordinates)
+{
+    auto const left_of_origin = surface_at({{-300, -300}, {200, 200}});
+    index.add(left_of_origin);
+    restack({left_of_origin});
+
+    EXPECT_THAT(index.candidates_at({-200, -200}), ElementsAre(left_of_origin));
+    EXPECT_THAT(index.candidates_at({-50, -50}), IsEmpty());
+}
+
+TEST_F(SurfaceInputIndex, finds_very_large_surfaces)
+{
+    auto const huge = surface_at({{-100000, -100000}, {200000, 200000}});
+    index.add(bottom);
+    index.add(huge);
+    restack({bottom, huge});
+
+    EXPECT_THAT(index.candidates_at({500, 500}), ElementsAre(huge, bottom));
+    EXPECT_THAT(index.candidates_at({-99000, 99000}), ElementsAre(huge));
+
+    index.remove(huge.get());
+
+    EXPECT_THAT(index.candidates_at({500, 500}), ElementsAre(bottom));
+}
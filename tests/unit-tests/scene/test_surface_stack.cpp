@@ -235,7 +235,7 @@ TEST_F(SurfaceStack, scene_counts_pending_accurately)
     ms::SurfaceStack stack{report};
     stack.register_compositor(this);
 
-    auto stream = std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888);
+    auto stream = std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888, mr::null_compositor_report());
 
     auto surface = std::make_shared<ms::BasicSurface>(
         nullptr /* session */,
@@ -337,6 +337,37 @@ TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_partially_exposed_su
     EXPECT_EQ(0, stack.frames_pending(comp2));
 }
 
+TEST_F(SurfaceStack, scene_elements_remain_usable_after_their_compositor_is_unregistered)
+{
+    using namespace testing;
+
+    stack.register_compositor(compositor_id);
+    stack.add_surface(stub_surface1, default_params.input_mode);
+
+    auto const elements = stack.scene_elements_for(compositor_id);
+    stack.unregister_compositor(compositor_id);
+
+    ASSERT_THAT(elements, SizeIs(1));
+    EXPECT_THAT(elements.front()->renderable(), NotNull());
+}
+
+TEST_F(SurfaceStack, released_scene_elements_do_not_keep_their_renderables)
+{
+    using namespace testing;
+
+    auto overlay = std::make_shared<mtd::StubRenderable>();
+    std::weak_ptr<mg::Renderable> const weak_overlay{overlay};
+
+    stack.add_input_visualization(overlay);
+    auto elements = stack.scene_elements_for(compositor_id);
+    stack.remove_input_visualization(overlay);
+    overlay.reset();
+
+    EXPECT_FALSE(weak_overlay.expired());
+    elements.clear();
+    EXPECT_TRUE(weak_overlay.expired());
+}
+
 TEST_F(SurfaceStack, surfaces_are_emitted_by_layer)
 {
     using namespace testing;
@@ -998,6 +1029,27 @@ TEST_F(SurfaceStack, returns_top_visible_surface_under_cursor)
     EXPECT_THAT(stack.surface_at(cursor_over_none).get(), IsNull());
 }
 
+TEST_F(SurfaceStack, returns_surface_under_cursor_in_input_region_outside_its_bounds)
+{
+    // A Wayland window's input region includes subsurfaces, which may lie outside it
+    geom::Point const cursor_over_subsurface{450, 150};
+    geom::Point const cursor_outside_region{450, 250};
+
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({900, 900});
+    stub_surface2->resize({200, 200});
+    stub_surface2->set_input_region({{{0, 0}, {200, 200}}, {{400, 100}, {100, 100}}});
+
+    EXPECT_THAT(stack.surface_at(cursor_over_subsurface), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at(cursor_outside_region), Eq(stub_surface1));
+
+    stub_surface2->set_input_region({});
+
+    EXPECT_THAT(stack.surface_at(cursor_over_subsurface), Eq(stub_surface1));
+}
+
 TEST_F(SurfaceStack, raise_surfaces_to_top)
 {
     stack.add_surface(stub_surface1, default_params.input_mode);
@@ -0,0 +1,266 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/rcu_list.h"
+#include "mir/test/signal.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+using namespace testing;
+
+namespace
+{
+
+struct Dummy {};
+using Element = std::shared_ptr<Dummy>;
+using SharedPtrList = mir::RcuList<Element>;
+
+struct RcuListTest : Test
+{
+    SharedPtrList list;
+
+    Element const element1 = std::make_shared<Dummy>();
+    Element const element2 = std::make_shared<Dummy>();
+
+    auto elements_seen() -> std::vector<Element>
+    {
+        std::vector<Element> seen;
+        list.for_each([&] (Element const& element) { seen.push_back(element); });
+        return seen;
+    }
+};
+
+}
+
+TEST_F(RcuListTest, iterates_elements_in_the_order_added)
+{
+    list.add(element1);
+    list.add(element2);
+
+    EXPECT_THAT(elements_seen(), ElementsAre(element1, element2));
+}
+
+TEST_F(RcuListTest, can_remove_element_while_iterating_same_element)
+{
+    list.add(element1);
+
+    list.for_each(
+        [&] (Element const& element)
+        {
+            list.remove(element);
+        });
+
+    EXPECT_THAT(elements_seen(), IsEmpty());
+}
+
+TEST_F(RcuListTest, can_remove_unused_element_while_iterating_different_element)
+{
+    list.add(element1);
+    list.add(element2);
+
+    int elements_seen = 0;
+
+    list.for_each(
+        [&] (Element const&)
+        {
+            list.remove(element2);
+            ++elements_seen;
+        });
+
+    EXPECT_THAT(elements_seen, Eq(1));
+}
+
+TEST_F(RcuListTest, elements_added_while_iterating_are_seen_by_the_next_iteration)
+{
+    list.add(element1);
+
+    int elements_seen = 0;
+
+    list.for_each(
+        [&] (Element const&)
+        {
+            list.add(element2);
+            ++elements_seen;
+        });
+
+    EXPECT_THAT(elements_seen, Eq(1));
+    EXPECT_THAT(this->elements_seen(), ElementsAre(element1, element2));
+}
+
+TEST_F(RcuListTest, can_remove_unused_element_while_different_element_is_used_in_different_thread)
+{
+    list.add(element1);
+    list.add(element2);
+
+    mir::test::Signal first_element_in_use;
+    mir::test::Signal second_element_removed;
+
+    int elements_seen = 0;
+
+    std::thread t{
+        [&]
+        {
+            list.for_each(
+                [&] (Element const&)
+                {
+                    first_element_in_use.raise();
+                    second_element_removed.wait_for(std::chrono::seconds{3});
+                    EXPECT_TRUE(second_element_removed.raised());
+                    ++elements_seen;
+                });
+        }};
+
+    first_element_in_use.wait_for(std::chrono::seconds{3});
+    list.remove(element2);
+    second_element_removed.raise();
+
+    t.join();
+
+    EXPECT_THAT(elements_seen, Eq(1));
+}
+
+TEST_F(RcuListTest, remove_waits_for_element_in_use_in_different_thread)
+{
+    list.add(element1);
+
+    mir::test::Signal element_in_use;
+    mir::test::Signal release_element;
+    std::atomic<bool> call_finished{false};
+
+    std::thread t{
+        [&]
+        {
+            list.for_each(
+                [&] (Element const&)
+                {
+                    element_in_use.raise();
+                    release_element.wait_for(std::chrono::seconds{3});
+                    call_finished = true;
+                });
+        }};
+
+    element_in_use.wait_for(std::chrono::seconds{3});
+
+    auto removed = std::async(std::launch::async, [&] { list.remove(element1); });
+    EXPECT_THAT(removed.wait_for(std::chrono::milliseconds{50}), Eq(std::future_status::timeout));
+
+    release_element.raise();
+    removed.wait();
+    EXPECT_TRUE(call_finished);
+
+    t.join();
+}
+
+TEST_F(RcuListTest, releases_removed_element_once_unused)
+{
+    std::weak_ptr<Dummy> weak_element;
+    {
+        auto const element = std::make_shared<Dummy>();
+        weak_element = element;
+        list.add(element);
+        list.add(element2);
+        list.remove(element);
+    }
+
+    EXPECT_TRUE(weak_element.expired());
+}
+
+TEST_F(RcuListTest, releases_element_removed_from_its_own_call_after_the_call)
+{
+    std::weak_ptr<Dummy> weak_element;
+    {
+        auto const element = std::make_shared<Dummy>();
+        weak_element = element;
+        list.add(element);
+    }
+
+    list.for_each(
+        [&] (Element const& element)
+        {
+            list.remove(element);
+            EXPECT_FALSE(weak_element.expired());
+        });
+
+    EXPECT_TRUE(weak_element.expired());
+}
+
+TEST_F(RcuListTest, removes_all_matching_elements)
+{
+    list.add(element1);
+    list.add(element2);
+    list.add(element1);
+
+    EXPECT_THAT(list.remove_all(element1), Eq(2u));
+    EXPECT_THAT(elements_seen(), ElementsAre(element2));
+}
+
+TEST_F(RcuListTest, remove_only_removes_one_matching_element)
+{
+    list.add(element1);
+    list.add(element2);
+    list.add(element1);
+
+    list.remove(element1);
+
+    EXPECT_THAT(elements_seen(), ElementsAre(element2, element1));
+}
+
+TEST_F(RcuListTest, clears_all_elements)
+{
+    list.add(element1);
+    list.add(element2);
+    list.add(element1);
+
+    list.clear();
+
+    EXPECT_THAT(elements_seen(), IsEmpty());
+}
+
+TEST_F(RcuListTest, survives_concurrent_iteration_and_updates)
+{
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> iterators;
+    for (int i = 0; i != 3; ++i)
+    {
+        iterators.emplace_back(
+            [&]
+            {
+                while (!done)
+                    list.for_each([] (Element const& element) { EXPECT_TRUE(element); });
+            });
+    }
+
+    for (int i = 0; i != 10000; ++i)
+    {
+        auto const element = std::make_shared<Dummy>();
+        list.add(element);
+        list.add(element1);
+        list.remove(element);
+        list.remove(element1);
+    }
+
+    done = true;
+    for (auto& t : iterators)
+        t.join();
+
+    EXPECT_THAT(elements_seen(), IsEmpty());
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/rcu_ptr.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+
+struct Counted
+{
+    Counted(int value, std::shared_ptr<int> const& alive) : value{value}, alive{alive} {}
+
+    int const value;
+    std::shared_ptr<int> const alive;
+};
+
+struct RcuPtrTest : Test
+{
+    mir::RcuPtr<Counted> ptr;
+
+    std::shared_ptr<int> const first_alive = std::make_shared<int>();
+    std::shared_ptr<int> const second_alive = std::make_shared<int>();
+
+    void publish(int value, std::shared_ptr<int> const& alive)
+    {
+        ptr.update([&](Counted const*) { return std::make_unique<Counted>(value, alive); });
+    }
+
+    auto current_value() -> int
+    {
+        int result = -1;
+        ptr.read([&](Counted const* current) { if (current) result = current->value; });
+        return result;
+    }
+};
+
+}
+
+TEST_F(RcuPtrTest, reads_null_before_anything_is_published)
+{
+    bool was_null = false;
+
+    ptr.read([&](Counted const* current) { was_null = !current; });
+
+    EXPECT_TRUE(was_null);
+}
+
+TEST_F(RcuPtrTest, reads_the_latest_value_published)
+{
+    publish(1, first_alive);
+    publish(2, second_alive);
+
+    EXPECT_THAT(current_value(), Eq(2));
+}
+
+TEST_F(RcuPtrTest, update_sees_the_current_value)
+{
+    publish(1, first_alive);
+
+    ptr.update([&](Counted const* current) { return std::make_unique<Counted>(current->value + 1, second_alive); });
+
+    EXPECT_THAT(current_value(), Eq(2));
+}
+
+TEST_F(RcuPtrTest, update_returning_null_keeps_the_current_value)
+{
+    publish(1, first_alive);
+
+    ptr.update([](Counted const*) { return std::unique_ptr<Counted>{}; });
+
+    EXPECT_THAT(current_value(), Eq(1));
+    EXPECT_THAT(first_alive.use_count(), Eq(2));
+}
+
+TEST_F(RcuPtrTest, deletes_replaced_value_when_nothing_is_reading)
+{
+    publish(1, first_alive);
+    publish(2, second_alive);
+
+    EXPECT_THAT(first_alive.use_count(), Eq(1));
+}
+
+TEST_F(RcuPtrTest, keeps_replaced_value_until_read_in_progress_finishes)
+{
+    publish(1, first_alive);
+
+    ptr.read(
+        [&](Counted const* current)
+        {
+            publish(2, second_alive);
+
+            EXPECT_THAT(current->value, Eq(1));
+            EXPECT_THAT(first_alive.use_count(), Eq(2));
+        });
+
+    EXPECT_THAT(first_alive.use_count(), Eq(1));
+    EXPECT_THAT(current_value(), Eq(2));
+}
+
+TEST_F(RcuPtrTest, deletes_value_when_destroyed)
+{
+    {
+        mir::RcuPtr<Counted> local;
+        local.update([&](Counted const*) { return std::make_unique<Counted>(1, first_alive); });
+    }
+
+    EXPECT_THAT(first_alive.use_count(), Eq(1));
+}
+
+TEST_F(RcuPtrTest, survives_concurrent_reads_and_updates)
+{
+    publish(0, first_alive);
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> saw_a_bad_value{false};
+
+    std::vector<std::thread> readers;
+    for (auto i = 0; i != 4; ++i)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                int last = 0;
+                while (!done)
+                {
+                    ptr.read(
+                        [&](Counted const* current)
+                        {
+                            // Values only increase, and a value being read is never deleted
+                            if (current->value < last || !current->alive)
+                                saw_a_bad_value = true;
+                            last = current->value;
+                        });
+                }
+            });
+    }
+
+    for (auto i = 1; i != 10000; ++i)
+        ptr.update([&](Counted const* current) { return std::make_unique<Counted>(current->value + 1, current->alive); });
+
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_FALSE(saw_a_bad_value);
+    EXPECT_THAT(current_value(), Eq(9999));
+}
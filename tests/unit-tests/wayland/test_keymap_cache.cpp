@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/keymap_cache.h"
+#include "mir/input/keymap.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+using namespace testing;
+
+namespace
+{
+struct KeymapCache : Test
+{
+    mf::KeymapCache cache;
+    mi::Keymap const us{"pc105", "us", "", ""};
+    mi::Keymap const gb{"pc105", "gb", "", ""};
+};
+}
+
+TEST_F(KeymapCache, compiles_each_keymap_once)
+{
+    auto const first = cache.keymap_for(us);
+    auto const second = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+
+    EXPECT_THAT(second, Eq(first));
+    EXPECT_THAT(second->keymap, Eq(first->keymap));
+}
+
+TEST_F(KeymapCache, distinguishes_different_keymaps)
+{
+    EXPECT_THAT(cache.keymap_for(gb), Ne(cache.keymap_for(us)));
+    EXPECT_THAT(cache.keymap_for(mi::Keymap{"pc105", "us", "dvorak", ""}), Ne(cache.keymap_for(us)));
+    EXPECT_THAT(cache.keymap_for(mi::Keymap{"pc105", "us", "", "ctrl:nocaps"}), Ne(cache.keymap_for(us)));
+}
+
+TEST_F(KeymapCache, keymap_fd_holds_nul_terminated_keymap_text)
+{
+    auto const compiled = cache.keymap_for(us);
+    auto const fd = compiled->fd();
+
+    auto const mapping = mmap(nullptr, compiled->size(), PROT_READ, MAP_PRIVATE, fd, 0);
+    ASSERT_THAT(mapping, Ne(MAP_FAILED));
+
+    auto const text = static_cast<char const*>(mapping);
+    EXPECT_THAT(text[compiled->size() - 1], Eq('\0'));
+    EXPECT_THAT(text, StartsWith("xkb_keymap"));
+
+    munmap(mapping, compiled->size());
+}
+
+TEST_F(KeymapCache, keymap_fd_is_shared_and_cannot_be_modified)
+{
+    auto const compiled = cache.keymap_for(us);
+    auto const fd = compiled->fd();
+
+    auto const seals = fcntl(fd, F_GET_SEALS);
+    ASSERT_THAT(seals, Ge(0));
+
+    EXPECT_TRUE(seals & F_SEAL_WRITE);
+    EXPECT_TRUE(seals & F_SEAL_SHRINK);
+    EXPECT_THAT(mmap(nullptr, compiled->size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), Eq(MAP_FAILED));
+
+    struct stat first, second;
+    ASSERT_THAT(fstat(fd, &first), Eq(0));
+    ASSERT_THAT(fstat(cache.keymap_for(us)->fd(), &second), Eq(0));
+    EXPECT_THAT(second.st_ino, Eq(first.st_ino));
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/presentation_tracker.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/test/doubles/mock_buffer_stream.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+geom::Rectangle const left_output{{0, 0}, {640, 480}};
+geom::Rectangle const right_output{{640, 0}, {640, 480}};
+
+struct PresentationTracker : Test
+{
+    PresentationTracker()
+    {
+        surface->configure(mir_window_attrib_visibility, mir_window_visibility_exposed);
+    }
+
+    void track(std::weak_ptr<ms::Surface> const& tracked)
+    {
+        tracker.on_next_presentation(
+            tracked,
+            [this](geom::Rectangle const& view_area, mg::Frame const& frame)
+                {
+                    presented_on.push_back(view_area);
+                    presented_frames.push_back(frame);
+                },
+            [this]() { ++discarded; });
+    }
+
+    static auto frame(int64_t msc, mir::time::PosixTimestamp const& ust) -> mg::Frame
+    {
+        mg::Frame frame;
+        frame.msc = msc;
+        frame.ust = ust;
+        return frame;
+    }
+
+    static auto monotonic(std::chrono::nanoseconds ns) -> mir::time::PosixTimestamp
+    {
+        return {CLOCK_MONOTONIC, ns};
+    }
+
+    std::shared_ptr<NiceMock<mtd::MockBufferStream>> const stream{std::make_shared<NiceMock<mtd::MockBufferStream>>()};
+    std::shared_ptr<ms::BasicSurface> surface{std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        "surface",
+        geom::Rectangle{{10, 10}, {100, 100}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo>{{stream, {}, {}}},
+        nullptr,
+        mir::report::null_scene_report())};
+
+    mf::PresentationTracker tracker;
+    std::vector<geom::Rectangle> presented_on;
+    std::vector<mg::Frame> presented_frames;
+    int discarded{0};
+};
+}
+
+TEST_F(PresentationTracker, presents_after_a_post_of_an_output_showing_the_surface)
+{
+    track(surface);
+
+    tracker.frame_presented(left_output, frame(7, monotonic(std::chrono::seconds{3})));
+
+    EXPECT_THAT(presented_on, ElementsAre(left_output));
+    ASSERT_THAT(presented_frames.size(), Eq(1u));
+    EXPECT_THAT(presented_frames[0].msc, Eq(7));
+    EXPECT_THAT(presented_frames[0].ust, Eq(monotonic(std::chrono::seconds{3})));
+    EXPECT_THAT(discarded, Eq(0));
+}
+
+TEST_F(PresentationTracker, presents_only_once)
+{
+    track(surface);
+
+    tracker.frame_presented(left_output, frame(1, monotonic(std::chrono::seconds{1})));
+    tracker.frame_presented(left_output, frame(2, monotonic(std::chrono::seconds{2})));
+
+    EXPECT_THAT(presented_on.size(), Eq(1u));
+}
+
+TEST_F(PresentationTracker, waits_through_posts_of_outputs_not_showing_the_surface)
+{
+    track(surface);
+
+    tracker.frame_presented(right_output, frame(1, monotonic(std::chrono::seconds{1})));
+    EXPECT_THAT(presented_on, IsEmpty());
+
+    tracker.frame_presented(left_output, frame(2, monotonic(std::chrono::seconds{2})));
+    EXPECT_THAT(presented_on, ElementsAre(left_output));
+}
+
+TEST_F(PresentationTracker, pauses_while_the_surface_is_hidden)
+{
+    surface->set_hidden(true);
+    track(surface);
+
+    tracker.frame_presented(left_output, frame(1, monotonic(std::chrono::seconds{1})));
+    EXPECT_THAT(presented_on, IsEmpty());
+    EXPECT_THAT(discarded, Eq(0));
+
+    surface->set_hidden(false);
+    tracker.frame_presented(left_output, frame(2, monotonic(std::chrono::seconds{2})));
+    EXPECT_THAT(presented_on, ElementsAre(left_output));
+}
+
+TEST_F(PresentationTracker, pauses_while_the_surface_is_occluded)
+{
+    surface->configure(mir_window_attrib_visibility, mir_window_visibility_occluded);
+    track(surface);
+
+    tracker.frame_presented(left_output, frame(1, monotonic(std::chrono::seconds{1})));
+    EXPECT_THAT(presented_on, IsEmpty());
+    EXPECT_THAT(discarded, Eq(0));
+
+    surface->configure(mir_window_attrib_visibility, mir_window_visibility_exposed);
+    tracker.frame_presented(left_output, frame(2, monotonic(std::chrono::seconds{2})));
+    EXPECT_THAT(presented_on, ElementsAre(left_output));
+}
+
+TEST_F(PresentationTracker, discards_when_the_surface_goes_away)
+{
+    track(surface);
+    surface.reset();
+
+    tracker.frame_presented(right_output, frame(1, monotonic(std::chrono::seconds{1})));
+
+    EXPECT_THAT(presented_on, IsEmpty());
+    EXPECT_THAT(discarded, Eq(1));
+}
+
+TEST_F(PresentationTracker, work_queued_on_presentation_waits_for_the_next_post)
+{
+    tracker.on_next_presentation(
+        surface,
+        [this](geom::Rectangle const&, mg::Frame const&) { track(surface); },
+        []{});
+
+    tracker.frame_presented(left_output, frame(1, monotonic(std::chrono::seconds{1})));
+    EXPECT_THAT(presented_on, IsEmpty());
+
+    tracker.frame_presented(left_output, frame(2, monotonic(std::chrono::seconds{2})));
+    EXPECT_THAT(presented_on, ElementsAre(left_output));
+}
+
+TEST_F(PresentationTracker, converts_timestamps_to_its_clock)
+{
+    track(surface);
+
+    auto const before = mir::time::PosixTimestamp::now(mf::PresentationTracker::clock);
+    tracker.frame_presented(left_output, frame(1, mir::time::PosixTimestamp::now(CLOCK_REALTIME)));
+    auto const after = mir::time::PosixTimestamp::now(mf::PresentationTracker::clock);
+
+    ASSERT_THAT(presented_frames.size(), Eq(1u));
+    EXPECT_THAT(presented_frames[0].ust.clock_id, Eq(mf::PresentationTracker::clock));
+    EXPECT_THAT(presented_frames[0].ust.nanoseconds, Ge(before.nanoseconds));
+    EXPECT_THAT(presented_frames[0].ust.nanoseconds, Le(after.nanoseconds));
+}
+
+TEST_F(PresentationTracker, timestamps_frames_that_have_none_as_presented_now)
+{
+    track(surface);
+
+    auto const before = mir::time::PosixTimestamp::now(mf::PresentationTracker::clock);
+    tracker.frame_presented(left_output, frame(0, {}));
+
+    ASSERT_THAT(presented_frames.size(), Eq(1u));
+    EXPECT_THAT(presented_frames[0].ust.clock_id, Eq(mf::PresentationTracker::clock));
+    EXPECT_THAT(presented_frames[0].ust.nanoseconds, Ge(before.nanoseconds));
+}
+
+TEST_F(PresentationTracker, surface_is_shown_when_visible_and_exposed)
+{
+    EXPECT_TRUE(mf::is_shown(*surface));
+}
+
+TEST_F(PresentationTracker, surface_is_not_shown_when_hidden)
+{
+    surface->set_hidden(true);
+
+    EXPECT_FALSE(mf::is_shown(*surface));
+}
+
+TEST_F(PresentationTracker, surface_is_not_shown_when_occluded)
+{
+    surface->configure(mir_window_attrib_visibility, mir_window_visibility_occluded);
+
+    EXPECT_FALSE(mf::is_shown(*surface));
+}
+
+TEST_F(PresentationTracker, surface_is_not_shown_without_content)
+{
+    ON_CALL(*stream, has_submitted_buffer()).WillByDefault(Return(false));
+
+    EXPECT_FALSE(mf::is_shown(*surface));
+}
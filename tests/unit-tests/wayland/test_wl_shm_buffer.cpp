@@ -0,0 +1,246 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wlshmbuffer.h"
+
+#include "mir/anonymous_shm_file.h"
+
+#include "mir/test/doubles/explicit_executor.h"
+#include "mir/test/doubles/mock_gl.h"
+
+#include <wayland-server-core.h>
+#include <wayland-client.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+int const width = 16;
+int const height = 8;
+int const stride = width * 4;
+size_t const pool_size = stride * height;
+
+MATCHER_P(Named, name, "")
+{
+    return arg == name;
+}
+
+struct WlShmBufferTest : Test
+{
+    WlShmBufferTest()
+    {
+        if (wl_display_init_shm(display))
+            throw std::runtime_error{"Failed to initialise wl_shm"};
+
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+            throw std::system_error(errno, std::system_category(), "Failed to create socket pair");
+
+        client = wl_client_create(display, fds[0]);
+        client_display = wl_display_connect_to_fd(fds[1]);
+        logger = wl_display_add_protocol_logger(display, &log_event, this);
+
+        auto const pixels = static_cast<unsigned char*>(pool_file.base_ptr());
+        for (size_t i = 0; i != pool_size; ++i)
+            pixels[i] = static_cast<unsigned char>(i % 251 + 1);
+
+        registry = wl_display_get_registry(client_display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        exchange();
+
+        pool = wl_shm_create_pool(shm, pool_file.fd(), pool_size);
+        client_buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+        exchange();
+
+        resource = wl_client_get_object(client, wl_proxy_get_id(reinterpret_cast<wl_proxy*>(client_buffer)));
+    }
+
+    ~WlShmBufferTest()
+    {
+        executor->execute();
+        wl_protocol_logger_destroy(logger);
+        wl_client_destroy(client);
+
+        if (client_buffer)
+            wl_buffer_destroy(client_buffer);
+        wl_shm_pool_destroy(pool);
+        wl_shm_destroy(shm);
+        wl_registry_destroy(registry);
+        wl_display_disconnect(client_display);
+    }
+
+    auto make_buffer() -> std::shared_ptr<mf::WlShmBuffer>
+    {
+        return std::dynamic_pointer_cast<mf::WlShmBuffer>(
+            mf::WlShmBuffer::mir_buffer_from_wl_buffer(resource, executor, []{}));
+    }
+
+    auto pool_data() const -> unsigned char const*
+    {
+        return static_cast<unsigned char const*>(wl_shm_buffer_get_data(wl_shm_buffer_get(resource)));
+    }
+
+    /// Delivers the client's requests to the server, and any events it sends back
+    void exchange()
+    {
+        wl_display_flush(client_display);
+        wl_event_loop_dispatch(wl_display_get_event_loop(display), 0);
+        wl_display_flush_clients(display);
+
+        if (wl_display_prepare_read(client_display) == 0)
+        {
+            pollfd readable{wl_display_get_fd(client_display), POLLIN, 0};
+            if (poll(&readable, 1, 0) > 0)
+                wl_display_read_events(client_display);
+            else
+                wl_display_cancel_read(client_display);
+        }
+        wl_display_dispatch_pending(client_display);
+    }
+
+    static void handle_global(void* context, wl_registry* registry, uint32_t name, char const* interface, uint32_t)
+    {
+        if (interface == std::string{"wl_shm"})
+        {
+            static_cast<WlShmBufferTest*>(context)->shm =
+                static_cast<wl_shm*>(wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        }
+    }
+
+    static void handle_global_remove(void*, wl_registry*, uint32_t)
+    {
+    }
+
+    static void log_event(void* context, wl_protocol_logger_type type, wl_protocol_logger_message const* message)
+    {
+        if (type == WL_PROTOCOL_LOGGER_EVENT)
+            static_cast<WlShmBufferTest*>(context)->sent.push_back(message->message->name);
+    }
+
+    static wl_registry_listener const registry_listener;
+
+    std::unique_ptr<wl_display, decltype(&wl_display_destroy)> const owned_display{wl_display_create(), &wl_display_destroy};
+    wl_display* const display{owned_display.get()};
+    wl_client* client;
+    wl_display* client_display;
+    wl_protocol_logger* logger;
+    std::vector<std::string> sent;
+
+    mir::AnonymousShmFile pool_file{pool_size};
+    wl_registry* registry{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shm_pool* pool{nullptr};
+    wl_buffer* client_buffer{nullptr};
+    wl_resource* resource{nullptr};
+
+    NiceMock<mtd::MockGL> gl;
+    std::shared_ptr<mtd::ExplicitExectutor> const executor{std::make_shared<mtd::ExplicitExectutor>()};
+};
+
+wl_registry_listener const WlShmBufferTest::registry_listener{&handle_global, &handle_global_remove};
+}
+
+TEST_F(WlShmBufferTest, uploads_pixels_straight_from_the_clients_pool)
+{
+    auto const buffer = make_buffer();
+    ASSERT_THAT(pool_data(), NotNull());
+
+    EXPECT_CALL(gl, glTexImage2D(GL_TEXTURE_2D, 0, _, width, height, 0, _, GL_UNSIGNED_BYTE, pool_data()));
+
+    buffer->gl_bind_to_texture();
+}
+
+TEST_F(WlShmBufferTest, reads_pixels_in_place_from_the_clients_pool)
+{
+    auto const buffer = make_buffer();
+    std::vector<unsigned char> const expected{pool_data(), pool_data() + pool_size};
+
+    unsigned char const* read_from{nullptr};
+    std::vector<unsigned char> contents;
+    buffer->read(
+        [&](unsigned char const* pixels)
+        {
+            read_from = pixels;
+            contents.assign(pixels, pixels + pool_size);
+        });
+
+    EXPECT_THAT(read_from, Eq(pool_data()));
+    EXPECT_THAT(contents, Eq(expected));
+}
+
+TEST_F(WlShmBufferTest, reading_a_pool_the_client_has_truncated_is_guarded_by_shm_access)
+{
+    auto const buffer = make_buffer();
+    ASSERT_THAT(ftruncate(pool_file.fd(), 0), Eq(0));
+
+    // Outside wl_shm_buffer_begin_access()/end_access() this read would raise SIGBUS
+    std::vector<unsigned char> contents;
+    buffer->read([&](unsigned char const* pixels) { contents.assign(pixels, pixels + pool_size); });
+
+    EXPECT_THAT(contents, Each(Eq(0)));
+    EXPECT_THAT(sent, Contains(Named("error")));
+}
+
+TEST_F(WlShmBufferTest, binds_a_blank_texture_once_the_wl_buffer_is_destroyed)
+{
+    auto const buffer = make_buffer();
+    wl_buffer_destroy(client_buffer);
+    client_buffer = nullptr;
+    exchange();
+
+    EXPECT_CALL(gl, glTexImage2D(GL_TEXTURE_2D, 0, _, width, height, 0, _, GL_UNSIGNED_BYTE, _))
+        .WillOnce(WithArg<8>(Invoke(
+            [](void const* pixels)
+            {
+                auto const bytes = static_cast<unsigned char const*>(pixels);
+                ASSERT_THAT(bytes, NotNull());
+                EXPECT_TRUE(std::all_of(bytes, bytes + pool_size, [](unsigned char byte) { return byte == 0; }));
+            })));
+
+    buffer->gl_bind_to_texture();
+    EXPECT_FALSE(buffer->contents_readable());
+}
+
+TEST_F(WlShmBufferTest, wl_buffer_is_released_only_after_the_mir_buffer_is_destroyed)
+{
+    auto buffer = make_buffer();
+    buffer->gl_bind_to_texture();
+    executor->execute();
+
+    EXPECT_THAT(sent, Not(Contains(Named("release"))));
+
+    buffer.reset();
+    EXPECT_THAT(sent, Not(Contains(Named("release"))));
+
+    executor->execute();
+    EXPECT_THAT(sent, Contains(Named("release")));
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wp_presentation_time.h"
+#include "src/server/frontend_wayland/presentation_tracker.h"
+#include "src/server/frontend_wayland/output_manager.h"
+#include "src/server/frontend_wayland/mir_display.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/graphics/frame.h"
+
+#include "mir/test/doubles/mock_buffer_stream.h"
+#include "mir/test/doubles/null_display_changer.h"
+#include "mir/test/doubles/stub_display_configuration.h"
+#include "mir/test/doubles/stub_observer_registrar.h"
+
+#include <wayland-server-core.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const wp_presentation_feedback_interface_data;
+}
+}
+
+using namespace testing;
+
+namespace
+{
+geom::Rectangle const output_area{{0, 0}, {640, 480}};
+
+struct SentEvent
+{
+    std::string name;
+    std::vector<uint32_t> args;
+};
+
+MATCHER_P(Named, name, "")
+{
+    return arg.name == name;
+}
+
+struct SingleOutputChanger : mtd::NullDisplayChanger
+{
+    std::shared_ptr<mg::DisplayConfiguration> base_configuration() override
+    {
+        return std::make_shared<mtd::StubDisplayConfig>(std::vector<geom::Rectangle>{output_area});
+    }
+};
+
+struct WpPresentationFeedbackTest : Test
+{
+    WpPresentationFeedbackTest()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+            throw std::system_error(errno, std::system_category(), "Failed to create socket pair");
+
+        client_end = fds[1];
+        client = wl_client_create(display, fds[0]);
+        logger = wl_display_add_protocol_logger(display, &log_event, this);
+
+        surface->configure(mir_window_attrib_visibility, mir_window_visibility_exposed);
+    }
+
+    ~WpPresentationFeedbackTest()
+    {
+        wl_protocol_logger_destroy(logger);
+        if (client)
+            wl_client_destroy(client);
+        close(client_end);
+    }
+
+    auto make_feedback() -> std::shared_ptr<mf::WpPresentationFeedback>
+    {
+        auto const resource = wl_resource_create(client, &mir::wayland::wp_presentation_feedback_interface_data, 1, 0);
+        return std::make_shared<mf::WpPresentationFeedback>(resource, tracker, &output_manager);
+    }
+
+    static void log_event(void* context, wl_protocol_logger_type type, wl_protocol_logger_message const* message)
+    {
+        if (type != WL_PROTOCOL_LOGGER_EVENT)
+            return;
+
+        SentEvent event{message->message->name, {}};
+        for (auto i = 0; i != message->arguments_count; ++i)
+        {
+            if (message->message->signature[i] == 'u')
+                event.args.push_back(message->arguments[i].u);
+        }
+        static_cast<WpPresentationFeedbackTest*>(context)->sent.push_back(event);
+    }
+
+    static auto frame(int64_t msc, std::chrono::nanoseconds ust) -> mg::Frame
+    {
+        mg::Frame frame;
+        frame.msc = msc;
+        frame.ust = {mf::PresentationTracker::clock, ust};
+        return frame;
+    }
+
+    std::unique_ptr<wl_display, decltype(&wl_display_destroy)> const owned_display{wl_display_create(), &wl_display_destroy};
+    wl_display* const display{owned_display.get()};
+    int client_end;
+    wl_client* client;
+    wl_protocol_logger* logger;
+    std::vector<SentEvent> sent;
+
+    mf::OutputManager output_manager{
+        display,
+        std::make_shared<mf::MirDisplay>(
+            std::make_shared<SingleOutputChanger>(),
+            std::make_shared<mtd::StubObserverRegistrar<mg::DisplayConfigurationObserver>>()),
+        nullptr};
+    std::shared_ptr<mf::PresentationTracker> const tracker{std::make_shared<mf::PresentationTracker>()};
+    std::shared_ptr<ms::BasicSurface> surface{std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        "surface",
+        geom::Rectangle{{10, 10}, {100, 100}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo>{{std::make_shared<NiceMock<mtd::MockBufferStream>>(), {}, {}}},
+        nullptr,
+        mir::report::null_scene_report())};
+};
+}
+
+TEST_F(WpPresentationFeedbackTest, presented_sends_the_frame_split_into_protocol_words)
+{
+    auto const feedback = make_feedback();
+    auto const seconds = (int64_t{1} << 32) + 7;
+
+    feedback->presented(nullptr, frame((int64_t{5} << 32) + 9, std::chrono::seconds{seconds} + std::chrono::nanoseconds{123}));
+
+    ASSERT_THAT(sent, ElementsAre(Named("presented")));
+    EXPECT_THAT(sent[0].args, ElementsAre(
+        1u, 7u,                                 // tv_sec_hi, tv_sec_lo
+        123u,                                   // tv_nsec
+        0u,                                     // refresh (no output)
+        5u, 9u,                                 // seq_hi, seq_lo
+        uint32_t{mf::WpPresentationFeedback::Kind::vsync}));
+}
+
+TEST_F(WpPresentationFeedbackTest, presented_reports_the_refresh_interval_of_the_output)
+{
+    auto const feedback = make_feedback();
+    auto const output = output_manager.output_for(output_area);
+    ASSERT_TRUE(output);
+
+    feedback->presented(output.value(), frame(1, std::chrono::seconds{1}));
+
+    ASSERT_THAT(sent, ElementsAre(Named("presented")));
+    EXPECT_THAT(sent[0].args[3], Eq(1000000000u / 60));
+}
+
+TEST_F(WpPresentationFeedbackTest, is_done_after_presentation)
+{
+    auto const feedback = make_feedback();
+
+    feedback->presented(nullptr, frame(1, std::chrono::seconds{1}));
+    feedback->presented(nullptr, frame(2, std::chrono::seconds{2}));
+    feedback->discard();
+
+    EXPECT_THAT(sent, ElementsAre(Named("presented")));
+}
+
+TEST_F(WpPresentationFeedbackTest, discard_sends_discarded_once)
+{
+    auto const feedback = make_feedback();
+
+    feedback->discard();
+    feedback->discard();
+    feedback->presented(nullptr, frame(1, std::chrono::seconds{1}));
+
+    EXPECT_THAT(sent, ElementsAre(Named("discarded")));
+}
+
+TEST_F(WpPresentationFeedbackTest, superseded_feedback_is_discarded)
+{
+    auto const feedback = make_feedback();
+
+    feedback->superseded();
+
+    EXPECT_THAT(sent, ElementsAre(Named("discarded")));
+}
+
+TEST_F(WpPresentationFeedbackTest, consumed_feedback_is_presented_with_the_next_post_showing_the_surface)
+{
+    auto const feedback = make_feedback();
+
+    feedback->consumed(surface);
+    EXPECT_THAT(sent, IsEmpty());
+
+    tracker->frame_presented(output_area, frame(42, std::chrono::seconds{1}));
+
+    ASSERT_THAT(sent, ElementsAre(Named("presented")));
+    EXPECT_THAT(sent[0].args[3], Eq(1000000000u / 60));
+    EXPECT_THAT(sent[0].args[5], Eq(42u));
+}
+
+TEST_F(WpPresentationFeedbackTest, consumed_feedback_is_not_superseded)
+{
+    auto const feedback = make_feedback();
+
+    feedback->consumed(surface);
+    feedback->superseded();
+    tracker->frame_presented(output_area, frame(1, std::chrono::seconds{1}));
+
+    EXPECT_THAT(sent, ElementsAre(Named("presented")));
+}
+
+TEST_F(WpPresentationFeedbackTest, consumed_feedback_is_discarded_when_the_surface_goes_away)
+{
+    auto const feedback = make_feedback();
+
+    feedback->consumed(surface);
+    surface.reset();
+    tracker->frame_presented(output_area, frame(1, std::chrono::seconds{1}));
+
+    EXPECT_THAT(sent, ElementsAre(Named("discarded")));
+}
+
+TEST_F(WpPresentationFeedbackTest, consumed_feedback_is_discarded_without_a_tracker)
+{
+    auto const feedback = std::make_shared<mf::WpPresentationFeedback>(
+        wl_resource_create(client, &mir::wayland::wp_presentation_feedback_interface_data, 1, 0),
+        nullptr,
+        &output_manager);
+
+    feedback->consumed(surface);
+
+    EXPECT_THAT(sent, ElementsAre(Named("discarded")));
+}
+
+TEST_F(WpPresentationFeedbackTest, sends_nothing_once_the_client_has_gone)
+{
+    auto const feedback = make_feedback();
+
+    feedback->consumed(surface);
+    wl_client_destroy(client);
+    client = nullptr;
+    tracker->frame_presented(output_area, frame(1, std::chrono::seconds{1}));
+
+    EXPECT_THAT(sent, IsEmpty());
+}